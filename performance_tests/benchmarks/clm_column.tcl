@@ -0,0 +1,334 @@
+#  CLM coupled column benchmark.
+#
+#  Grid of independent 1D CLM columns with an overland flow top and
+#  1D met forcing over twelve hourly steps; measures the CLM
+#  coupling cost (CLM timing region) next to the Richards solve.  The
+#  CLM driver files are taken from test/clm and the vegetation map is
+#  generated for the benchmark grid.
+#
+#  usage: tclsh clm_column.tcl P Q R [strong|weak]
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+source pfbench.tcl
+
+set clm_inputs [file join [pwd] .. .. test clm]
+
+#-----------------------------------------------------------------------------
+# File input version number
+#-----------------------------------------------------------------------------
+pfset FileVersion 4
+
+#-----------------------------------------------------------------------------
+# Computational Grid
+#-----------------------------------------------------------------------------
+set runname [pfbenchSetup clm_column 48 48 10]
+
+set NX [pfget ComputationalGrid.NX]
+set NY [pfget ComputationalGrid.NY]
+set NZ [pfget ComputationalGrid.NZ]
+
+pfset ComputationalGrid.Lower.X                0.0
+pfset ComputationalGrid.Lower.Y                0.0
+pfset ComputationalGrid.Lower.Z                0.0
+
+pfset ComputationalGrid.DX	               1000.
+pfset ComputationalGrid.DY                     1000.
+pfset ComputationalGrid.DZ	                 0.5
+
+#-----------------------------------------------------------------------------
+# The Names of the GeomInputs
+#-----------------------------------------------------------------------------
+pfset GeomInput.Names "domain_input"
+
+
+#-----------------------------------------------------------------------------
+# Domain Geometry Input
+#-----------------------------------------------------------------------------
+pfset GeomInput.domain_input.InputType            Box
+pfset GeomInput.domain_input.GeomName             domain
+
+#-----------------------------------------------------------------------------
+# Domain Geometry
+#-----------------------------------------------------------------------------
+pfset Geom.domain.Lower.X                        0.0 
+pfset Geom.domain.Lower.Y                        0.0
+pfset Geom.domain.Lower.Z                          0.0
+
+pfset Geom.domain.Upper.X                        [expr $NX * 1000.0]
+pfset Geom.domain.Upper.Y                        [expr $NY * 1000.0]
+pfset Geom.domain.Upper.Z                        [expr $NZ * 0.5]
+
+pfset Geom.domain.Patches  "x-lower x-upper y-lower y-upper z-lower z-upper"
+
+#-----------------------------------------------------------------------------
+# Perm
+#-----------------------------------------------------------------------------
+pfset Geom.Perm.Names "domain"
+
+pfset Geom.domain.Perm.Type            Constant
+pfset Geom.domain.Perm.Value           0.2
+
+
+pfset Perm.TensorType               TensorByGeom
+
+pfset Geom.Perm.TensorByGeom.Names  "domain"
+
+pfset Geom.domain.Perm.TensorValX  1.0
+pfset Geom.domain.Perm.TensorValY  1.0
+pfset Geom.domain.Perm.TensorValZ  1.0
+
+#-----------------------------------------------------------------------------
+# Specific Storage
+#-----------------------------------------------------------------------------
+# specific storage does not figure into the impes (fully sat) case but we still
+# need a key for it
+
+pfset SpecificStorage.Type            Constant
+pfset SpecificStorage.GeomNames       "domain"
+pfset Geom.domain.SpecificStorage.Value 1.0e-6
+
+#-----------------------------------------------------------------------------
+# Phases
+#-----------------------------------------------------------------------------
+
+pfset Phase.Names "water"
+
+pfset Phase.water.Density.Type	Constant
+pfset Phase.water.Density.Value	1.0
+
+pfset Phase.water.Viscosity.Type	Constant
+pfset Phase.water.Viscosity.Value	1.0
+
+#-----------------------------------------------------------------------------
+# Contaminants
+#-----------------------------------------------------------------------------
+pfset Contaminants.Names			""
+
+
+#-----------------------------------------------------------------------------
+# Gravity
+#-----------------------------------------------------------------------------
+
+pfset Gravity				1.0
+
+#-----------------------------------------------------------------------------
+# Setup timing info
+#-----------------------------------------------------------------------------
+ 
+pfset TimingInfo.BaseUnit        1.0
+pfset TimingInfo.StartCount      0
+pfset TimingInfo.StartTime       0.0
+pfset TimingInfo.StopTime        12
+pfset TimingInfo.DumpInterval    -1
+pfset TimeStep.Type              Constant
+pfset TimeStep.Value             1.0
+ 
+
+#-----------------------------------------------------------------------------
+# Porosity
+#-----------------------------------------------------------------------------
+
+pfset Geom.Porosity.GeomNames          domain
+
+pfset Geom.domain.Porosity.Type    Constant
+pfset Geom.domain.Porosity.Value   0.390
+
+#-----------------------------------------------------------------------------
+# Domain
+#-----------------------------------------------------------------------------
+pfset Domain.GeomName domain
+
+#-----------------------------------------------------------------------------
+# Mobility
+#-----------------------------------------------------------------------------
+pfset Phase.water.Mobility.Type        Constant
+pfset Phase.water.Mobility.Value       1.0
+
+#-----------------------------------------------------------------------------
+# Relative Permeability
+#-----------------------------------------------------------------------------
+ 
+pfset Phase.RelPerm.Type               VanGenuchten
+pfset Phase.RelPerm.GeomNames          "domain"
+ 
+pfset Geom.domain.RelPerm.Alpha         3.5
+pfset Geom.domain.RelPerm.N             2.
+
+#---------------------------------------------------------
+# Saturation
+#---------------------------------------------------------
+
+pfset Phase.Saturation.Type              VanGenuchten 
+pfset Phase.Saturation.GeomNames         "domain"
+ 
+pfset Geom.domain.Saturation.Alpha        3.5
+pfset Geom.domain.Saturation.N            2.
+pfset Geom.domain.Saturation.SRes         0.01
+pfset Geom.domain.Saturation.SSat         1.0
+
+#-----------------------------------------------------------------------------
+# Wells
+#-----------------------------------------------------------------------------
+pfset Wells.Names ""
+
+
+#-----------------------------------------------------------------------------
+# Time Cycles
+#-----------------------------------------------------------------------------
+pfset Cycle.Names constant
+pfset Cycle.constant.Names		"alltime"
+pfset Cycle.constant.alltime.Length	 1
+pfset Cycle.constant.Repeat		-1
+
+#-----------------------------------------------------------------------------
+# Boundary Conditions: Pressure
+#-----------------------------------------------------------------------------
+pfset BCPressure.PatchNames                   [pfget Geom.domain.Patches]
+ 
+pfset Patch.x-lower.BCPressure.Type                   FluxConst
+pfset Patch.x-lower.BCPressure.Cycle                  "constant"
+pfset Patch.x-lower.BCPressure.alltime.Value          0.0
+ 
+pfset Patch.y-lower.BCPressure.Type                   FluxConst
+pfset Patch.y-lower.BCPressure.Cycle                  "constant"
+pfset Patch.y-lower.BCPressure.alltime.Value          0.0
+ 
+pfset Patch.z-lower.BCPressure.Type                   FluxConst
+pfset Patch.z-lower.BCPressure.Cycle                  "constant"
+pfset Patch.z-lower.BCPressure.alltime.Value          0.0
+ 
+pfset Patch.x-upper.BCPressure.Type                   FluxConst
+pfset Patch.x-upper.BCPressure.Cycle                  "constant"
+pfset Patch.x-upper.BCPressure.alltime.Value          0.0
+ 
+pfset Patch.y-upper.BCPressure.Type                   FluxConst
+pfset Patch.y-upper.BCPressure.Cycle                  "constant"
+pfset Patch.y-upper.BCPressure.alltime.Value          0.0
+ 
+pfset Patch.z-upper.BCPressure.Type                   OverlandFlow
+##pfset Patch.z-upper.BCPressure.Type                FluxConst 
+pfset Patch.z-upper.BCPressure.Cycle                  "constant"
+pfset Patch.z-upper.BCPressure.alltime.Value          0.0
+
+#---------------------------------------------------------
+# Topo slopes in x-direction
+#---------------------------------------------------------
+ 
+pfset TopoSlopesX.Type "Constant"
+pfset TopoSlopesX.GeomNames "domain"
+pfset TopoSlopesX.Geom.domain.Value -0.001
+ 
+#---------------------------------------------------------
+# Topo slopes in y-direction
+#---------------------------------------------------------
+ 
+pfset TopoSlopesY.Type "Constant"
+pfset TopoSlopesY.GeomNames "domain"
+pfset TopoSlopesY.Geom.domain.Value 0.001
+ 
+#---------------------------------------------------------
+# Mannings coefficient 
+#---------------------------------------------------------
+ 
+pfset Mannings.Type "Constant"
+pfset Mannings.GeomNames "domain"
+pfset Mannings.Geom.domain.Value 5.52e-6
+
+#-----------------------------------------------------------------------------
+# Phase sources:
+#-----------------------------------------------------------------------------
+
+pfset PhaseSources.water.Type                         Constant
+pfset PhaseSources.water.GeomNames                    domain
+pfset PhaseSources.water.Geom.domain.Value        0.0
+ 
+#-----------------------------------------------------------------------------
+# Exact solution specification for error calculations
+#-----------------------------------------------------------------------------
+ 
+pfset KnownSolution                                      NoKnownSolution
+
+#-----------------------------------------------------------------------------
+# Set solver parameters
+#-----------------------------------------------------------------------------
+ 
+pfset Solver                                             Richards
+pfset Solver.MaxIter                                     500
+ 
+pfset Solver.Nonlinear.MaxIter                           15
+pfset Solver.Nonlinear.ResidualTol                       1e-6
+pfset Solver.Nonlinear.EtaChoice                         EtaConstant
+pfset Solver.Nonlinear.EtaValue                          0.01
+pfset Solver.Nonlinear.UseJacobian                       False
+pfset Solver.Nonlinear.DerivativeEpsilon                 1e-16
+pfset Solver.Nonlinear.StepTol                           1e-20
+pfset Solver.Nonlinear.Globalization                     LineSearch
+pfset Solver.Linear.KrylovDimension                      15
+pfset Solver.Linear.MaxRestart                           2
+ 
+pfset Solver.Linear.Preconditioner                       $pfbench_precond
+pfset Solver.Drop                                        1E-20
+pfset Solver.AbsTol                                      1E-9
+ 
+pfset Solver.LSM                                         CLM
+pfset Solver.CLM.MetForcing                              1D
+pfset Solver.CLM.MetFileName                             narr_1hr.sc3.txt.0
+pfset Solver.CLM.MetFilePath                             $clm_inputs
+
+pfset Solver.CLM.Print1dOut                              False
+pfset Solver.CLM.WriteLogs                               False
+pfset Solver.CLM.WriteLastRST                            False
+
+pfset Solver.PrintSubsurfData                            False
+pfset Solver.PrintPressure                               False
+pfset Solver.PrintSaturation                             False
+pfset Solver.PrintMask                                   False
+pfset Solver.PrintCLM                                    False
+pfset Solver.WriteCLMBinary                              False
+
+# Initial conditions: water pressure
+#---------------------------------------------------------
+ 
+pfset ICPressure.Type                                   HydroStaticPatch
+pfset ICPressure.GeomNames                              domain
+pfset Geom.domain.ICPressure.Value                      -2.0
+ 
+pfset Geom.domain.ICPressure.RefGeom                    domain
+pfset Geom.domain.ICPressure.RefPatch                   z-upper
+
+
+
+#-----------------------------------------------------------------------------
+# CLM driver files; every column gets the same vegetation
+#-----------------------------------------------------------------------------
+file copy -force [file join $clm_inputs drv_clmin.dat] drv_clmin.dat
+file copy -force [file join $clm_inputs drv_vegp.dat] drv_vegp.dat
+
+set file [open drv_vegm.dat w]
+puts $file " x  y  lat    lon    sand clay color  fractional coverage of grid by vegetation class (Must/Should Add to 1.0)"
+puts $file "       (Deg)\t (Deg)  (%/100)   index  1    2    3    4    5    6    7    8    9    10   11   12   13   14   15   16   17   18"
+for {set i 1} {$i <= $NX} {incr i} {
+    for {set j 1} {$j <= $NY} {incr j} {
+	puts $file [format "%4d%4d   34.750 -98.138  0.16 0.265   2   0.0 0.0  0.0  0.0  0.0  0.0  0.0  0.0  0.0  1.0  0.0  0.0  0.0  0.0  0.0  0.0  0.0  0.0" $i $j]
+    }
+}
+close $file
+
+#-----------------------------------------------------------------------------
+# Run and report
+#-----------------------------------------------------------------------------
+pfrun $runname
+
+set passed [pfbenchReport $runname]
+
+foreach file [concat drv_clmin.dat drv_vegp.dat drv_vegm.dat [glob -nocomplain CLM.out.clm.log clm.rst.* clm_output.*]] {
+    file delete $file
+}
+
+pfbenchFinish $runname $passed
@@ -0,0 +1,289 @@
+#  Variably saturated benchmark with overland flow.
+#
+#  Richards solve of a tilted V catchment with a rain/recession cycle
+#  on an overland flow top boundary; exercises the nonlinear function
+#  evaluation, the Jacobian and the preconditioner setup.
+#
+#  usage: tclsh overland.tcl P Q R [strong|weak]
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+source pfbench.tcl
+
+pfset FileVersion 4
+
+#---------------------------------------------------------
+# Computational Grid
+#---------------------------------------------------------
+set runname [pfbenchSetup overland 60 60 20]
+
+set NX [pfget ComputationalGrid.NX]
+set NY [pfget ComputationalGrid.NY]
+set NZ [pfget ComputationalGrid.NZ]
+
+set DX 10.0
+set DY 10.0
+set DZ 0.1
+
+pfset ComputationalGrid.Lower.X           0.0
+pfset ComputationalGrid.Lower.Y           0.0
+pfset ComputationalGrid.Lower.Z           0.0
+
+pfset ComputationalGrid.DX                $DX
+pfset ComputationalGrid.DY                $DY
+pfset ComputationalGrid.DZ                $DZ
+
+set UpperX [expr $NX * $DX]
+set UpperY [expr $NY * $DY]
+set UpperZ [expr $NZ * $DZ]
+set MidX   [expr 0.5 * $UpperX]
+
+#---------------------------------------------------------
+# The Names of the GeomInputs
+#---------------------------------------------------------
+pfset GeomInput.Names                 "domaininput leftinput rightinput"
+
+pfset GeomInput.domaininput.GeomName  domain
+pfset GeomInput.leftinput.GeomName    left
+pfset GeomInput.rightinput.GeomName   right
+
+pfset GeomInput.domaininput.InputType Box
+pfset GeomInput.leftinput.InputType   Box
+pfset GeomInput.rightinput.InputType  Box
+
+#---------------------------------------------------------
+# Domain Geometry
+#---------------------------------------------------------
+pfset Geom.domain.Lower.X                        0.0
+pfset Geom.domain.Lower.Y                        0.0
+pfset Geom.domain.Lower.Z                        0.0
+
+pfset Geom.domain.Upper.X                        $UpperX
+pfset Geom.domain.Upper.Y                        $UpperY
+pfset Geom.domain.Upper.Z                        $UpperZ
+pfset Geom.domain.Patches             "x-lower x-upper y-lower y-upper z-lower z-upper"
+
+#---------------------------------------------------------
+# Left and right hillslopes
+#---------------------------------------------------------
+pfset Geom.left.Lower.X                          0.0
+pfset Geom.left.Lower.Y                          0.0
+pfset Geom.left.Lower.Z                          0.0
+pfset Geom.left.Upper.X                          $MidX
+pfset Geom.left.Upper.Y                          $UpperY
+pfset Geom.left.Upper.Z                          $UpperZ
+
+pfset Geom.right.Lower.X                         $MidX
+pfset Geom.right.Lower.Y                         0.0
+pfset Geom.right.Lower.Z                         0.0
+pfset Geom.right.Upper.X                         $UpperX
+pfset Geom.right.Upper.Y                         $UpperY
+pfset Geom.right.Upper.Z                         $UpperZ
+
+#-----------------------------------------------------------------------------
+# Perm
+#-----------------------------------------------------------------------------
+pfset Geom.Perm.Names                 "left right"
+
+pfset Geom.left.Perm.Type             Constant
+pfset Geom.left.Perm.Value            0.001
+
+pfset Geom.right.Perm.Type            Constant
+pfset Geom.right.Perm.Value           0.01
+
+pfset Perm.TensorType                 TensorByGeom
+
+pfset Geom.Perm.TensorByGeom.Names    "domain"
+
+pfset Geom.domain.Perm.TensorValX     1.0d0
+pfset Geom.domain.Perm.TensorValY     1.0d0
+pfset Geom.domain.Perm.TensorValZ     1.0d0
+
+#-----------------------------------------------------------------------------
+# Specific Storage
+#-----------------------------------------------------------------------------
+pfset SpecificStorage.Type            Constant
+pfset SpecificStorage.GeomNames       "domain"
+pfset Geom.domain.SpecificStorage.Value 1.0e-4
+
+#-----------------------------------------------------------------------------
+# Phases
+#-----------------------------------------------------------------------------
+pfset Phase.Names "water"
+
+pfset Phase.water.Density.Type	        Constant
+pfset Phase.water.Density.Value	        1.0
+
+pfset Phase.water.Viscosity.Type	Constant
+pfset Phase.water.Viscosity.Value	1.0
+
+#-----------------------------------------------------------------------------
+# Contaminants
+#-----------------------------------------------------------------------------
+pfset Contaminants.Names			""
+
+#-----------------------------------------------------------------------------
+# Retardation
+#-----------------------------------------------------------------------------
+pfset Geom.Retardation.GeomNames           ""
+
+#-----------------------------------------------------------------------------
+# Gravity
+#-----------------------------------------------------------------------------
+pfset Gravity				1.0
+
+#-----------------------------------------------------------------------------
+# Setup timing info
+#-----------------------------------------------------------------------------
+pfset TimingInfo.BaseUnit        0.1
+pfset TimingInfo.StartCount      0
+pfset TimingInfo.StartTime       0.0
+pfset TimingInfo.StopTime        0.5
+pfset TimingInfo.DumpInterval    -1
+pfset TimeStep.Type              Constant
+pfset TimeStep.Value             0.1
+
+#-----------------------------------------------------------------------------
+# Porosity
+#-----------------------------------------------------------------------------
+pfset Geom.Porosity.GeomNames          "domain"
+pfset Geom.domain.Porosity.Type        Constant
+pfset Geom.domain.Porosity.Value       0.25
+
+#-----------------------------------------------------------------------------
+# Domain
+#-----------------------------------------------------------------------------
+pfset Domain.GeomName domain
+
+#-----------------------------------------------------------------------------
+# Relative Permeability
+#-----------------------------------------------------------------------------
+pfset Phase.RelPerm.Type               VanGenuchten
+pfset Phase.RelPerm.GeomNames          "domain"
+
+pfset Geom.domain.RelPerm.Alpha         6.0
+pfset Geom.domain.RelPerm.N             2.
+
+#---------------------------------------------------------
+# Saturation
+#---------------------------------------------------------
+pfset Phase.Saturation.Type              VanGenuchten
+pfset Phase.Saturation.GeomNames         "domain"
+
+pfset Geom.domain.Saturation.Alpha        6.0
+pfset Geom.domain.Saturation.N            2.
+pfset Geom.domain.Saturation.SRes         0.2
+pfset Geom.domain.Saturation.SSat         1.0
+
+#-----------------------------------------------------------------------------
+# Wells
+#-----------------------------------------------------------------------------
+pfset Wells.Names                           ""
+
+#-----------------------------------------------------------------------------
+# Time Cycles
+#-----------------------------------------------------------------------------
+pfset Cycle.Names "constant rainrec"
+pfset Cycle.constant.Names              "alltime"
+pfset Cycle.constant.alltime.Length      1
+pfset Cycle.constant.Repeat             -1
+
+pfset Cycle.rainrec.Names                 "rain rec"
+pfset Cycle.rainrec.rain.Length           1
+pfset Cycle.rainrec.rec.Length            4
+pfset Cycle.rainrec.Repeat                -1
+
+#-----------------------------------------------------------------------------
+# Boundary Conditions: Pressure
+#-----------------------------------------------------------------------------
+pfset BCPressure.PatchNames                   [pfget Geom.domain.Patches]
+
+foreach patch "x-lower x-upper y-lower y-upper z-lower" {
+    pfset Patch.$patch.BCPressure.Type		      FluxConst
+    pfset Patch.$patch.BCPressure.Cycle		      "constant"
+    pfset Patch.$patch.BCPressure.alltime.Value	      0.0
+}
+
+pfset Patch.z-upper.BCPressure.Type		      OverlandFlow
+pfset Patch.z-upper.BCPressure.Cycle		      "rainrec"
+pfset Patch.z-upper.BCPressure.rain.Value	      -0.05
+pfset Patch.z-upper.BCPressure.rec.Value	      0.000001
+
+#---------------------------------------------------------
+# Topo slopes
+#---------------------------------------------------------
+pfset TopoSlopesX.Type "Constant"
+pfset TopoSlopesX.GeomNames "left right"
+pfset TopoSlopesX.Geom.left.Value -0.005
+pfset TopoSlopesX.Geom.right.Value 0.005
+
+pfset TopoSlopesY.Type "Constant"
+pfset TopoSlopesY.GeomNames "domain"
+pfset TopoSlopesY.Geom.domain.Value 0.001
+
+#---------------------------------------------------------
+# Mannings coefficient
+#---------------------------------------------------------
+pfset Mannings.Type "Constant"
+pfset Mannings.GeomNames "domain"
+pfset Mannings.Geom.domain.Value 5.e-6
+
+#-----------------------------------------------------------------------------
+# Phase sources:
+#-----------------------------------------------------------------------------
+pfset PhaseSources.water.Type                         Constant
+pfset PhaseSources.water.GeomNames                    domain
+pfset PhaseSources.water.Geom.domain.Value            0.0
+
+#-----------------------------------------------------------------------------
+# Exact solution specification for error calculations
+#-----------------------------------------------------------------------------
+pfset KnownSolution                                    NoKnownSolution
+
+#-----------------------------------------------------------------------------
+# Set solver parameters
+#-----------------------------------------------------------------------------
+pfset Solver                                             Richards
+pfset Solver.MaxIter                                     2500
+
+pfset Solver.Nonlinear.MaxIter                           300
+pfset Solver.Nonlinear.ResidualTol                       1e-9
+pfset Solver.Nonlinear.EtaChoice                         EtaConstant
+pfset Solver.Nonlinear.EtaValue                          0.001
+pfset Solver.Nonlinear.UseJacobian                       False
+pfset Solver.Nonlinear.DerivativeEpsilon                 1e-16
+pfset Solver.Nonlinear.StepTol                           1e-10
+pfset Solver.Nonlinear.Globalization                     LineSearch
+pfset Solver.Linear.KrylovDimension                      20
+pfset Solver.Linear.MaxRestart                           2
+
+pfset Solver.Linear.Preconditioner                       $pfbench_precond
+pfset Solver.Drop                                        1E-20
+pfset Solver.AbsTol                                      1E-9
+
+pfset Solver.PrintSubsurfData                            False
+pfset Solver.PrintPressure                               False
+pfset Solver.PrintSaturation                             False
+pfset Solver.PrintMask                                   False
+
+#---------------------------------------------------------
+# Initial conditions: water pressure
+#---------------------------------------------------------
+pfset ICPressure.Type                                   HydroStaticPatch
+pfset ICPressure.GeomNames                              domain
+pfset Geom.domain.ICPressure.Value                      -3.0
+
+pfset Geom.domain.ICPressure.RefGeom                    domain
+pfset Geom.domain.ICPressure.RefPatch                   z-upper
+
+#-----------------------------------------------------------------------------
+# Run and report
+#-----------------------------------------------------------------------------
+pfrun $runname
+
+pfbenchFinish $runname [pfbenchReport $runname]
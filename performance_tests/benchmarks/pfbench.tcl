@@ -0,0 +1,273 @@
+#
+# Common support for the ParFlow benchmark suite.
+#
+# Every benchmark script is invoked as
+#
+#    tclsh <benchmark>.tcl P Q R [strong|weak]
+#
+# and calls pfbenchSetup before defining the problem and pfbenchReport
+# after pfrun.  pfbenchSetup sizes the computational grid for the
+# requested sweep:
+#
+#    strong : the global grid is fixed, NX x NY x NZ
+#    weak   : each process owns NX x NY x NZ so the global grid is
+#             P*NX x Q*NY x R*NZ
+#
+# pfbenchReport reads the <runname>.out.timing.csv file written by the
+# simulator, appends one row per timing region to the results file and
+# compares each region against the baseline results file (if one is
+# given) using the tolerances in thresholds.txt.
+#
+# The following environment variables control the suite; the CTest
+# registration in performance_tests/CMakeLists.txt sets them from the
+# PARFLOW_BENCHMARK_* cache variables.
+#
+#    PARFLOW_BENCHMARK_RESULTS        results file (default benchmark_results.csv)
+#    PARFLOW_BENCHMARK_BASELINE       results file from a reference build
+#    PARFLOW_BENCHMARK_THRESHOLDS     tolerance file (default thresholds.txt)
+#    PARFLOW_BENCHMARK_SCALE          integer multiplier on NX and NY (default 1)
+#    PARFLOW_BENCHMARK_PRECONDITIONER Richards preconditioner (default PFMG)
+#
+
+set pfbench_header "Benchmark,Mode,Processes,P,Q,R,NX,NY,NZ,Timer,Time (s),Calls,Imbalance"
+
+proc pfbenchEnv {name default} {
+    global env
+    if [info exists env($name)] {
+	if {[string length $env($name)] > 0} {
+	    return $env($name)
+	}
+    }
+    return $default
+}
+
+#
+# Set the process topology and computational grid for the sweep.
+# nx, ny and nz are the strong scaling global size or the weak scaling
+# per process size.
+#
+proc pfbenchSetup {name nx ny nz} {
+    global argv
+    global pfbench_name pfbench_mode pfbench_precond
+    global pfbench_P pfbench_Q pfbench_R
+
+    set pfbench_name $name
+    set pfbench_P [lindex $argv 0]
+    set pfbench_Q [lindex $argv 1]
+    set pfbench_R [lindex $argv 2]
+    set pfbench_mode [lindex $argv 3]
+    if {[string length $pfbench_mode] == 0} {
+	set pfbench_mode strong
+    }
+
+    set scale [pfbenchEnv PARFLOW_BENCHMARK_SCALE 1]
+    set pfbench_precond [pfbenchEnv PARFLOW_BENCHMARK_PRECONDITIONER PFMG]
+
+    set nx [expr $nx * $scale]
+    set ny [expr $ny * $scale]
+
+    switch $pfbench_mode {
+	strong {
+	}
+	weak {
+	    set nx [expr $nx * $pfbench_P]
+	    set ny [expr $ny * $pfbench_Q]
+	    set nz [expr $nz * $pfbench_R]
+	}
+	default {
+	    puts "$name : unknown scaling mode <$pfbench_mode>, expected strong or weak"
+	    exit 1
+	}
+    }
+
+    pfset Process.Topology.P $pfbench_P
+    pfset Process.Topology.Q $pfbench_Q
+    pfset Process.Topology.R $pfbench_R
+
+    pfset ComputationalGrid.NX $nx
+    pfset ComputationalGrid.NY $ny
+    pfset ComputationalGrid.NZ $nz
+
+    return "bench_${name}_${pfbench_mode}_${pfbench_P}_${pfbench_Q}_${pfbench_R}"
+}
+
+#
+# Read a results or timing CSV file, skipping the header line.
+#
+proc pfbenchReadCSV {filename} {
+    set rows {}
+    if {![file exists $filename]} {
+	return $rows
+    }
+    set file [open $filename r]
+    while {[gets $file line] >= 0} {
+	if {[string length $line] == 0} {
+	    continue
+	}
+	set fields [split $line ","]
+	if {[lindex $fields 0] == "Timer" || [lindex $fields 0] == "Benchmark"} {
+	    continue
+	}
+	lappend rows $fields
+    }
+    close $file
+    return $rows
+}
+
+#
+# Tolerances are stored one timer per line as a Tcl list:
+#
+#    {Timer name} factor floor
+#
+# A region regresses if it takes longer than both factor times and floor
+# seconds more than its baseline time.  The timer name "*" sets the
+# default.
+#
+proc pfbenchReadThresholds {filename} {
+    set thresholds(*) {1.25 0.1}
+    if [file exists $filename] {
+	set file [open $filename r]
+	while {[gets $file line] >= 0} {
+	    set line [string trim $line]
+	    if {[string length $line] == 0 || [string index $line 0] == "#"} {
+		continue
+	    }
+	    set thresholds([lindex $line 0]) [lrange $line 1 2]
+	}
+	close $file
+    }
+    return [array get thresholds]
+}
+
+proc pfbenchReport {runname} {
+    global pfbench_header pfbench_name pfbench_mode
+    global pfbench_P pfbench_Q pfbench_R
+
+    set num_procs [expr $pfbench_P * $pfbench_Q * $pfbench_R]
+    set key "$pfbench_name,$pfbench_mode,$num_procs"
+    set grid "[pfget ComputationalGrid.NX],[pfget ComputationalGrid.NY],[pfget ComputationalGrid.NZ]"
+
+    #
+    # A run that did not reach the stop time is not a valid timing.
+    #
+    if [file exists $runname.out.txt] {
+	set file [open $runname.out.txt r]
+	set log [read $file]
+	close $file
+	if {[string first "Time step failed" $log] >= 0} {
+	    puts "$pfbench_name : FAILED, solver did not complete, see $runname.out.txt"
+	    return 0
+	}
+    }
+
+    set timers [pfbenchReadCSV $runname.out.timing.csv]
+    if {[llength $timers] == 0} {
+	puts "$pfbench_name : FAILED, no timing output in $runname.out.timing.csv"
+	return 0
+    }
+    if {[llength $timers] == 1} {
+	puts "Warning : only total runtime recorded, configure with PARFLOW_ENABLE_TIMING for region timings"
+    }
+
+    #
+    # Append to the results file; write the header on creation.
+    #
+    set results_file [pfbenchEnv PARFLOW_BENCHMARK_RESULTS benchmark_results.csv]
+    set new_file [expr ![file exists $results_file]]
+    set file [open $results_file a]
+    if $new_file {
+	puts $file $pfbench_header
+    }
+    foreach timer $timers {
+	set name [lindex $timer 0]
+	set time [lindex $timer 1]
+	set calls [lindex $timer 4]
+	set imbalance [lindex $timer 7]
+	puts $file "$key,$pfbench_P,$pfbench_Q,$pfbench_R,$grid,$name,$time,$calls,$imbalance"
+	set current($name) $time
+    }
+    close $file
+
+    #
+    # Scaling efficiency relative to the single process run of this
+    # sweep, when it is already in the results file.
+    #
+    foreach row [pfbenchReadCSV $results_file] {
+	if {[lindex $row 0] == $pfbench_name && [lindex $row 1] == $pfbench_mode
+	    && [lindex $row 2] == 1 && [lindex $row 9] == "Total Runtime"} {
+	    set serial_time [lindex $row 10]
+	}
+    }
+    if {[info exists serial_time] && [info exists "current(Total Runtime)"]} {
+	set time [set "current(Total Runtime)"]
+	if {$time > 0.0} {
+	    if {$pfbench_mode == "strong"} {
+		set efficiency [expr $serial_time / ($num_procs * $time)]
+	    } {
+		set efficiency [expr $serial_time / $time]
+	    }
+	    puts [format "%s : %s scaling efficiency on %d processes = %.3f" \
+		      $pfbench_name $pfbench_mode $num_procs $efficiency]
+	}
+    }
+
+    #
+    # Compare against the baseline; the last matching row wins so a
+    # baseline file may accumulate several runs.
+    #
+    set baseline_file [pfbenchEnv PARFLOW_BENCHMARK_BASELINE ""]
+    set passed 1
+    if {[string length $baseline_file] > 0} {
+	set script_dir [file dirname [info script]]
+	array set thresholds [pfbenchReadThresholds \
+	    [pfbenchEnv PARFLOW_BENCHMARK_THRESHOLDS [file join $script_dir thresholds.txt]]]
+
+	foreach row [pfbenchReadCSV $baseline_file] {
+	    if {[join [lrange $row 0 2] ","] == $key} {
+		set baseline([lindex $row 9]) [lindex $row 10]
+	    }
+	}
+
+	foreach name [array names current] {
+	    if {![info exists baseline($name)]} {
+		continue
+	    }
+	    if [info exists thresholds($name)] {
+		set threshold $thresholds($name)
+	    } {
+		set threshold $thresholds(*)
+	    }
+	    set factor [lindex $threshold 0]
+	    set floor [lindex $threshold 1]
+	    set time $current($name)
+	    set reference $baseline($name)
+
+	    if {$time > $reference * $factor && $time > $reference + $floor} {
+		puts [format "%s : regression in <%s> %.3f s, baseline %.3f s (limit x%s)" \
+			  $pfbench_name $name $time $reference $factor]
+		set passed 0
+	    }
+	}
+    }
+
+    return $passed
+}
+
+#
+# Remove the run output, the timings are kept in the results file, and
+# print the test status.
+#
+proc pfbenchFinish {runname passed} {
+    global pfbench_name
+
+    foreach file [glob -nocomplain $runname.out.*.pfb* $runname.out.*.silo $runname.out.pftcl \
+		      $runname.out.timing.* $runname.pfidb] {
+	file delete $file
+    }
+
+    if $passed {
+	puts "$pfbench_name : PASSED"
+    } {
+	puts "$pfbench_name : FAILED"
+    }
+}
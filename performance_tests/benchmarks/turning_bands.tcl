@@ -0,0 +1,251 @@
+#  Heterogeneous permeability benchmark.
+#
+#  Log normal turning bands permeability field followed by a single
+#  IMPES pressure solve; the cost is dominated by the field generation
+#  in the SubsrfSim timing region.
+#
+#  usage: tclsh turning_bands.tcl P Q R [strong|weak]
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+source pfbench.tcl
+
+pfset FileVersion 4
+
+#---------------------------------------------------------
+# Computational Grid
+#---------------------------------------------------------
+set runname [pfbenchSetup turning_bands 128 128 32]
+
+set NX [pfget ComputationalGrid.NX]
+set NY [pfget ComputationalGrid.NY]
+set NZ [pfget ComputationalGrid.NZ]
+
+pfset ComputationalGrid.Lower.X                0.0
+pfset ComputationalGrid.Lower.Y                0.0
+pfset ComputationalGrid.Lower.Z                0.0
+
+pfset ComputationalGrid.DX                     1.0
+pfset ComputationalGrid.DY                     1.0
+pfset ComputationalGrid.DZ                     1.0
+
+#---------------------------------------------------------
+# The Names of the GeomInputs
+#---------------------------------------------------------
+pfset GeomInput.Names "domain_input background_input"
+
+#---------------------------------------------------------
+# Domain Geometry Input
+#---------------------------------------------------------
+pfset GeomInput.domain_input.InputType            Box
+pfset GeomInput.domain_input.GeomName             domain
+
+#---------------------------------------------------------
+# Domain Geometry
+#---------------------------------------------------------
+pfset Geom.domain.Lower.X                        0.0
+pfset Geom.domain.Lower.Y                        0.0
+pfset Geom.domain.Lower.Z                        0.0
+
+pfset Geom.domain.Upper.X                        $NX
+pfset Geom.domain.Upper.Y                        $NY
+pfset Geom.domain.Upper.Z                        $NZ
+
+pfset Geom.domain.Patches "left right front back bottom top"
+
+#---------------------------------------------------------
+# Background Geometry Input
+#---------------------------------------------------------
+pfset GeomInput.background_input.InputType         Box
+pfset GeomInput.background_input.GeomName          background
+
+pfset Geom.background.Lower.X -99999999.0
+pfset Geom.background.Lower.Y -99999999.0
+pfset Geom.background.Lower.Z -99999999.0
+pfset Geom.background.Upper.X  99999999.0
+pfset Geom.background.Upper.Y  99999999.0
+pfset Geom.background.Upper.Z  99999999.0
+
+#-----------------------------------------------------------------------------
+# Perm
+#-----------------------------------------------------------------------------
+pfset Geom.Perm.Names "background"
+
+pfset Geom.background.Perm.Type      TurnBands
+pfset Geom.background.Perm.LambdaX   20.0
+pfset Geom.background.Perm.LambdaY   20.0
+pfset Geom.background.Perm.LambdaZ   2.0
+pfset Geom.background.Perm.GeomMean  4.0
+pfset Geom.background.Perm.Sigma     1.0
+pfset Geom.background.Perm.NumLines  100
+pfset Geom.background.Perm.RZeta     5.0
+pfset Geom.background.Perm.KMax      100.0
+pfset Geom.background.Perm.DelK      0.2
+pfset Geom.background.Perm.Seed      23333
+pfset Geom.background.Perm.LogNormal Log
+pfset Geom.background.Perm.StratType Bottom
+
+pfset Perm.TensorType               TensorByGeom
+
+pfset Geom.Perm.TensorByGeom.Names  "background"
+
+pfset Geom.background.Perm.TensorValX  1.0
+pfset Geom.background.Perm.TensorValY  1.0
+pfset Geom.background.Perm.TensorValZ  1.0
+
+#-----------------------------------------------------------------------------
+# Specific Storage
+#-----------------------------------------------------------------------------
+pfset SpecificStorage.Type            Constant
+pfset SpecificStorage.GeomNames       ""
+pfset Geom.domain.SpecificStorage.Value 1.0e-4
+
+#-----------------------------------------------------------------------------
+# Phases
+#-----------------------------------------------------------------------------
+pfset Phase.Names "water"
+
+pfset Phase.water.Density.Type	Constant
+pfset Phase.water.Density.Value	1.0
+
+pfset Phase.water.Viscosity.Type	Constant
+pfset Phase.water.Viscosity.Value	1.0
+
+#-----------------------------------------------------------------------------
+# Contaminants
+#-----------------------------------------------------------------------------
+pfset Contaminants.Names			""
+
+#-----------------------------------------------------------------------------
+# Gravity
+#-----------------------------------------------------------------------------
+pfset Gravity				1.0
+
+#-----------------------------------------------------------------------------
+# Setup timing info
+#-----------------------------------------------------------------------------
+pfset TimingInfo.BaseUnit		1.0
+pfset TimingInfo.StartCount		0
+pfset TimingInfo.StartTime		0.0
+pfset TimingInfo.StopTime            1000.0
+pfset TimingInfo.DumpInterval	       -1
+
+#-----------------------------------------------------------------------------
+# Porosity
+#-----------------------------------------------------------------------------
+pfset Geom.Porosity.GeomNames          background
+
+pfset Geom.background.Porosity.Type    Constant
+pfset Geom.background.Porosity.Value   1.0
+
+#-----------------------------------------------------------------------------
+# Domain
+#-----------------------------------------------------------------------------
+pfset Domain.GeomName domain
+
+#-----------------------------------------------------------------------------
+# Mobility
+#-----------------------------------------------------------------------------
+pfset Phase.water.Mobility.Type        Constant
+pfset Phase.water.Mobility.Value       1.0
+
+#-----------------------------------------------------------------------------
+# Wells
+#-----------------------------------------------------------------------------
+pfset Wells.Names snoopy
+
+pfset Wells.snoopy.InputType                Recirc
+
+pfset Wells.snoopy.Cycle		    constant
+
+pfset Wells.snoopy.ExtractionType	    Flux
+pfset Wells.snoopy.InjectionType            Flux
+
+pfset Wells.snoopy.X			    [expr 0.25 * $NX + 0.5]
+pfset Wells.snoopy.Y			    [expr 0.50 * $NY + 0.5]
+pfset Wells.snoopy.ExtractionZLower	    [expr 0.75 * $NZ]
+pfset Wells.snoopy.ExtractionZUpper	    [expr 0.75 * $NZ]
+pfset Wells.snoopy.InjectionZLower	    [expr 0.25 * $NZ]
+pfset Wells.snoopy.InjectionZUpper	    [expr 0.25 * $NZ]
+
+pfset Wells.snoopy.ExtractionMethod	    Standard
+pfset Wells.snoopy.InjectionMethod          Standard
+
+pfset Wells.snoopy.alltime.Extraction.Flux.water.Value        	     5.0
+pfset Wells.snoopy.alltime.Injection.Flux.water.Value		     7.5
+
+#-----------------------------------------------------------------------------
+# Time Cycles
+#-----------------------------------------------------------------------------
+pfset Cycle.Names constant
+pfset Cycle.constant.Names		"alltime"
+pfset Cycle.constant.alltime.Length	 1
+pfset Cycle.constant.Repeat		-1
+
+#-----------------------------------------------------------------------------
+# Boundary Conditions: Pressure
+#-----------------------------------------------------------------------------
+pfset BCPressure.PatchNames "left right front back bottom top"
+
+pfset Patch.left.BCPressure.Type			DirEquilRefPatch
+pfset Patch.left.BCPressure.Cycle			"constant"
+pfset Patch.left.BCPressure.RefGeom			domain
+pfset Patch.left.BCPressure.RefPatch			bottom
+pfset Patch.left.BCPressure.alltime.Value		[expr $NZ + 5.0]
+
+pfset Patch.right.BCPressure.Type			DirEquilRefPatch
+pfset Patch.right.BCPressure.Cycle			"constant"
+pfset Patch.right.BCPressure.RefGeom			domain
+pfset Patch.right.BCPressure.RefPatch			bottom
+pfset Patch.right.BCPressure.alltime.Value		$NZ
+
+foreach patch "front back bottom top" {
+    pfset Patch.$patch.BCPressure.Type			FluxConst
+    pfset Patch.$patch.BCPressure.Cycle			"constant"
+    pfset Patch.$patch.BCPressure.alltime.Value		0.0
+}
+
+#---------------------------------------------------------
+# Topo slopes and Mannings, unused for the saturated case
+#---------------------------------------------------------
+pfset TopoSlopesX.Type "Constant"
+pfset TopoSlopesX.GeomNames ""
+pfset TopoSlopesX.Geom.domain.Value 0.0
+
+pfset TopoSlopesY.Type "Constant"
+pfset TopoSlopesY.GeomNames ""
+pfset TopoSlopesY.Geom.domain.Value 0.0
+
+pfset Mannings.Type "Constant"
+pfset Mannings.GeomNames ""
+pfset Mannings.Geom.domain.Value 0.
+
+#-----------------------------------------------------------------------------
+# Phase sources:
+#-----------------------------------------------------------------------------
+pfset PhaseSources.water.Type                         Constant
+pfset PhaseSources.water.GeomNames                    background
+pfset PhaseSources.water.Geom.background.Value        0.0
+
+#-----------------------------------------------------------------------------
+# Solver; output is turned off so the timings are of the solve only
+#-----------------------------------------------------------------------------
+pfset Solver.MaxIter 1
+
+pfset Solver.PrintSubsurf       False
+pfset Solver.PrintPressure      False
+pfset Solver.PrintSaturation    False
+pfset Solver.PrintConcentration False
+pfset Solver.PrintWells         False
+
+#-----------------------------------------------------------------------------
+# Run and report
+#-----------------------------------------------------------------------------
+pfrun $runname
+
+pfbenchFinish $runname [pfbenchReport $runname]
@@ -130,18 +130,20 @@
  *
  * {\large Notes:}
  *
- * Currently there is only the global communication context.
+ * After \Ref{amps_EnsembleInit} the global communication context only
+ * includes the nodes of this ensemble member.
  *
  * @memo Global communication context
  */
-#define amps_CommWorld MPI_COMM_WORLD
+#define amps_CommWorld worldComm
 #define amps_CommNode  nodeComm
 #define amps_CommWrite writeComm
 
+extern MPI_Comm worldComm;
 extern MPI_Comm nodeComm;
 extern MPI_Comm writeComm;
 
-/*Global ranks and size of MPI_COMM_WORLD*/
+/*Global ranks and size of worldComm*/
 extern int amps_rank;
 extern int amps_size;
 
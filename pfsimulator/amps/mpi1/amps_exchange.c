@@ -81,12 +81,12 @@ amps_Handle amps_IExchangePackage(amps_Package package)
 
   for (i = 0; i < package->num_recv; i++)
   {
-    amps_create_mpi_type(MPI_COMM_WORLD, package->recv_invoices[i]);
+    amps_create_mpi_type(amps_CommWorld, package->recv_invoices[i]);
 
     MPI_Type_commit(&(package->recv_invoices[i]->mpi_type));
 
     MPI_Irecv(MPI_BOTTOM, 1, package->recv_invoices[i]->mpi_type,
-              package->src[i], 0, MPI_COMM_WORLD,
+              package->src[i], 0, amps_CommWorld,
               &(package->requests[i]));
   }
 
@@ -95,12 +95,12 @@ amps_Handle amps_IExchangePackage(amps_Package package)
    *--------------------------------------------------------------------*/
   for (i = 0; i < package->num_send; i++)
   {
-    amps_create_mpi_type(MPI_COMM_WORLD, package->send_invoices[i]);
+    amps_create_mpi_type(amps_CommWorld, package->send_invoices[i]);
 
     MPI_Type_commit(&(package->send_invoices[i]->mpi_type));
 
     MPI_Isend(MPI_BOTTOM, 1, package->send_invoices[i]->mpi_type,
-              package->dest[i], 0, MPI_COMM_WORLD,
+              package->dest[i], 0, amps_CommWorld,
               &(package->requests[package->num_recv + i]));
   }
 
@@ -239,7 +239,7 @@ amps_Handle amps_IExchangePackage(amps_Package package)
     {
       for (i = 0; i < package->num_recv; i++)
       {
-        amps_create_mpi_type(MPI_COMM_WORLD, package->recv_invoices[i]);
+        amps_create_mpi_type(amps_CommWorld, package->recv_invoices[i]);
         MPI_Type_commit(&(package->recv_invoices[i]->mpi_type));
 
         // Temporaries needed by insure++
@@ -247,7 +247,7 @@ amps_Handle amps_IExchangePackage(amps_Package package)
         MPI_Request *request_ptr = &(package->recv_requests[i]);
         MPI_Recv_init(MPI_BOTTOM, 1,
                       type,
-                      package->src[i], 0, MPI_COMM_WORLD,
+                      package->src[i], 0, amps_CommWorld,
                       request_ptr);
       }
     }
@@ -259,7 +259,7 @@ amps_Handle amps_IExchangePackage(amps_Package package)
     {
       for (i = 0; i < package->num_send; i++)
       {
-        amps_create_mpi_type(MPI_COMM_WORLD,
+        amps_create_mpi_type(amps_CommWorld,
                              package->send_invoices[i]);
 
         MPI_Type_commit(&(package->send_invoices[i]->mpi_type));
@@ -269,7 +269,7 @@ amps_Handle amps_IExchangePackage(amps_Package package)
         MPI_Request* request_ptr = &(package->send_requests[i]);
         MPI_Ssend_init(MPI_BOTTOM, 1,
                        type,
-                       package->dest[i], 0, MPI_COMM_WORLD,
+                       package->dest[i], 0, amps_CommWorld,
                        request_ptr);
       }
     }
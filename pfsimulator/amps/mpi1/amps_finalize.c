@@ -67,6 +67,10 @@ int amps_Finalize()
   {
     MPI_Comm_free(&amps_CommNode);
     MPI_Comm_free(&amps_CommWrite);
+    if (amps_CommWorld != MPI_COMM_WORLD)
+    {
+      MPI_Comm_free(&amps_CommWorld);
+    }
 
     MPI_Finalize();
   }
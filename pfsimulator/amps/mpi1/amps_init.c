@@ -49,6 +49,7 @@ int amps_node_rank;
 int amps_node_size;
 int amps_write_rank;
 int amps_write_size;
+MPI_Comm worldComm = MPI_COMM_NULL;
 MPI_Comm nodeComm = MPI_COMM_NULL;
 MPI_Comm writeComm = MPI_COMM_NULL;
 
@@ -107,30 +108,22 @@ uint32_t Adler32(unsigned char *data, size_t len) /* where data is the location
 
   return (b << 16) | a;
 }
-int amps_Init(int *argc, char **argv[])
-{
-#ifdef AMPS_MPI_SETHOME
-  char *temp_path;
-  int length;
-#endif
 
+/*
+ * Split the node level and writing communicators out of amps_CommWorld.
+ */
+static void amps_SplitNodeComms(void)
+{
   char processor_name[MPI_MAX_PROCESSOR_NAME];
-  unsigned char processor_Name[MPI_MAX_PROCESSOR_NAME];
   int namelen;
-
-  MPI_Init(argc, argv);
-  amps_mpi_initialized = TRUE;
-
-  MPI_Comm_size(MPI_COMM_WORLD, &amps_size);
-  MPI_Comm_rank(MPI_COMM_WORLD, &amps_rank);
+  int color;
 
   /*Split the node level communicator based on Adler32 hash keys*/
   MPI_Get_processor_name(processor_name, &namelen);
-  uint32_t checkSum = Adler32(processor_name, namelen);
-  MPI_Comm_split(MPI_COMM_WORLD, checkSum, amps_rank, &amps_CommNode);
+  uint32_t checkSum = Adler32((unsigned char*)processor_name, namelen);
+  MPI_Comm_split(amps_CommWorld, checkSum, amps_rank, &amps_CommNode);
   MPI_Comm_rank(amps_CommNode, &amps_node_rank);
   MPI_Comm_size(amps_CommNode, &amps_node_size);
-  int color;
   if (amps_node_rank == 0)
   {
     color = 0;
@@ -139,11 +132,33 @@ int amps_Init(int *argc, char **argv[])
   {
     color = 1;
   }
-  MPI_Comm_split(MPI_COMM_WORLD, color, amps_rank, &amps_CommWrite);
+  MPI_Comm_split(amps_CommWorld, color, amps_rank, &amps_CommWrite);
   if (amps_node_rank == 0)
   {
     MPI_Comm_size(amps_CommWrite, &amps_write_size);
   }
+}
+
+int amps_Init(int *argc, char **argv[])
+{
+#ifdef AMPS_MPI_SETHOME
+  char *temp_path;
+  int length;
+#endif
+
+#ifdef AMPS_PRINT_HOSTNAME
+  char processor_name[MPI_MAX_PROCESSOR_NAME];
+  int namelen;
+#endif
+
+  MPI_Init(argc, argv);
+  amps_mpi_initialized = TRUE;
+
+  amps_CommWorld = MPI_COMM_WORLD;
+  MPI_Comm_size(amps_CommWorld, &amps_size);
+  MPI_Comm_rank(amps_CommWorld, &amps_rank);
+
+  amps_SplitNodeComms();
 
 
 #ifdef AMPS_STDOUT_NOBUFF
@@ -224,8 +239,9 @@ int amps_Init(int *argc, char **argv[])
  */
 int amps_EmbeddedInit(void)
 {
-  MPI_Comm_size(MPI_COMM_WORLD, &amps_size);
-  MPI_Comm_rank(MPI_COMM_WORLD, &amps_rank);
+  amps_CommWorld = MPI_COMM_WORLD;
+  MPI_Comm_size(amps_CommWorld, &amps_size);
+  MPI_Comm_rank(amps_CommWorld, &amps_rank);
 
 #ifdef AMPS_STDOUT_NOBUFF
   setbuf(stdout, NULL);
@@ -249,4 +265,65 @@ int amps_EmbeddedInit(void)
   return 0;
 }
 
+/*===========================================================================*/
+/**
+ *
+ * Split the nodes into {\bf num_members} ensemble members of equal size.
+ * Consecutive ranks are placed in the same member.  On return
+ * \Ref{amps_CommWorld}, \Ref{amps_Rank} and \Ref{amps_Size} refer to the
+ * member this node belongs to, so a program written for
+ * \Ref{amps_CommWorld} runs unchanged as one member of an ensemble.
+ * This is a collective operation, all nodes must call it.
+ *
+ * {\large Example:}
+ * \begin{verbatim}
+ * int main( int argc, char *argv)
+ * {
+ * amps_Init(argc, argv);
+ *
+ * member = amps_EnsembleInit(4);
+ *
+ * amps_Printf("Hello from member %d", member);
+ *
+ * amps_Finalize();
+ * }
+ * \end{verbatim}
+ *
+ * {\large Notes:}
+ *
+ * The number of nodes must be a multiple of {\bf num_members}.
+ *
+ * @memo Split AMPS into ensemble members
+ * @param num_members Number of ensemble members [IN]
+ * @return member index of this node or -1 on error
+ */
+int amps_EnsembleInit(int num_members)
+{
+  int member;
+
+  if (num_members < 1 || amps_size % num_members)
+  {
+    return -1;
+  }
+
+  if (num_members == 1)
+  {
+    return 0;
+  }
+
+  member = amps_rank / (amps_size / num_members);
+
+  MPI_Comm_split(amps_CommWorld, member, amps_rank, &amps_CommWorld);
+  MPI_Comm_size(amps_CommWorld, &amps_size);
+  MPI_Comm_rank(amps_CommWorld, &amps_rank);
+
+  if (amps_CommNode != MPI_COMM_NULL)
+  {
+    MPI_Comm_free(&amps_CommNode);
+    MPI_Comm_free(&amps_CommWrite);
+
+    amps_SplitNodeComms();
+  }
 
+  return member;
+}
@@ -137,6 +137,9 @@
 extern MPI_Comm oas3Comm;
 #define amps_CommWorld oas3Comm
 
+/* Ensembles are not supported by this layer, only a single member */
+#define amps_EnsembleInit(num_members) ((num_members) == 1 ? 0 : -1)
+
 extern int amps_rank;
 extern int amps_size;
 
@@ -97,6 +97,7 @@ typedef FILE *amps_File;
 #define amps_Fopen(filename, type) fopen((filename), (type))
 #define amps_Init(argc, argv) amps_clock_init(), 0
 #define amps_EmbeddedInit() amps_clock_init(), 0
+#define amps_EnsembleInit(num_members) ((num_members) == 1 ? 0 : -1)
 
 #define amps_IExchangePackage(package) 0
 
@@ -125,6 +125,9 @@
  */
 #define amps_CommWorld MPI_COMM_WORLD
 
+/* Ensembles are not supported by this layer, only a single member */
+#define amps_EnsembleInit(num_members) ((num_members) == 1 ? 0 : -1)
+
 extern int amps_rank;
 extern int amps_size;
 
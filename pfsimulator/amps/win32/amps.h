@@ -95,6 +95,9 @@ typedef int amps_Comm;
 typedef FILE *amps_File;
 
 extern amps_Comm amps_CommWorld;
+
+/* Ensembles are not supported by this layer, only a single member */
+#define amps_EnsembleInit(num_members) ((num_members) == 1 ? 0 : -1)
 extern int amps_size;
 _declspec(thread) extern int amps_rank;
 
@@ -0,0 +1,592 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+/*****************************************************************************
+*
+* Kernel microbenchmarks.
+*
+* Builds a Grid and Vectors directly, without an input deck, and times
+* the core kernels in isolation over a range of grid sizes and ghost
+* widths:
+*
+*    linearsum   PFVLinearSum  z = a x + b y
+*    dotprod     PFVDotProd    (x, y) including the global reduction
+*    matvec      Matvec        7 point stencil y = A x + y
+*    update      InitVectorUpdate/FinalizeVectorUpdate halo exchange
+*    saturation  Saturation    VanGenuchten
+*    relperm     PhaseRelPerm  VanGenuchten
+*
+* Usage:
+*
+*    parflow_kernel_bench [-P p] [-Q q] [-R r] [-n size]... [-g ghost]...
+*                         [-t seconds] [-o file]
+*
+*    -P -Q -R  process topology, defaults to all processes along X
+*    -n        global grid size (size^3), may be repeated; default 32 64 128
+*    -g        vector ghost width (at least 1), may be repeated; default 1 2
+*    -t        minimum accumulated time per kernel; default 0.25 seconds
+*    -o        also write the results as CSV to file
+*
+* Each kernel is repeated until it has run for the minimum time on
+* every process; the reported time per call is the maximum over the
+* processes.  Bandwidth is the nominal data volume the kernel has to
+* move through memory (each double read or written once) divided by
+* the time; for the halo exchange it is the data packed and unpacked.
+*
+*****************************************************************************/
+
+#include "parflow.h"
+#include "fgetopt.h"
+
+#include <string.h>
+
+#define KernelBenchMaxSizes 32
+
+/*--------------------------------------------------------------------------
+ * Kernel state shared by all kernels for one grid size and ghost width.
+ *--------------------------------------------------------------------------*/
+
+typedef struct {
+  Grid        *grid;
+  int num_ghost;
+  int update_mode;
+
+  Vector      *x;
+  Vector      *y;
+  Vector      *z;
+
+  Matrix      *A;
+
+  Vector      *pressure;
+  Vector      *density;
+  Vector      *saturation;
+  Vector      *rel_perm;
+
+  ProblemData *problem_data;
+
+  PFModule    *geometries_module;
+  PFModule    *geometries_instance;
+  PFModule    *saturation_module;
+  PFModule    *saturation_instance;
+  PFModule    *rel_perm_module;
+  PFModule    *rel_perm_instance;
+
+  double result;
+} KernelBenchData;
+
+typedef void (*KernelBenchKernel)(KernelBenchData *data);
+
+typedef struct {
+  char              *name;
+  KernelBenchKernel kernel;
+  double bytes_per_cell;
+  double flops_per_cell;
+} KernelBenchEntry;
+
+static int stencil_shape[7][3] = { { 0, 0, 0 },
+                                   { -1, 0, 0 },
+                                   { 1, 0, 0 },
+                                   { 0, -1, 0 },
+                                   { 0, 1, 0 },
+                                   { 0, 0, -1 },
+                                   { 0, 0, 1 } };
+
+/*--------------------------------------------------------------------------
+ * Kernels
+ *--------------------------------------------------------------------------*/
+
+static void KernelLinearSum(KernelBenchData *data)
+{
+  PFVLinearSum(1.0001, data->x, -0.9999, data->y, data->z);
+}
+
+static void KernelDotProd(KernelBenchData *data)
+{
+  data->result += PFVDotProd(data->x, data->y);
+}
+
+static void KernelMatvec(KernelBenchData *data)
+{
+  Matvec(1.0, data->A, data->x, 1.0, data->y);
+}
+
+static void KernelUpdate(KernelBenchData *data)
+{
+  VectorUpdateCommHandle *handle;
+
+  handle = InitVectorUpdate(data->x, data->update_mode);
+  FinalizeVectorUpdate(handle);
+}
+
+static void KernelSaturation(KernelBenchData *data)
+{
+  PFModuleInvokeType(SaturationInvoke, data->saturation_instance,
+                     (data->saturation, data->pressure, data->density,
+                      1.0, data->problem_data, CALCFCN));
+}
+
+static void KernelRelPerm(KernelBenchData *data)
+{
+  PFModuleInvokeType(PhaseRelPermInvoke, data->rel_perm_instance,
+                     (data->rel_perm, data->pressure, data->density,
+                      1.0, data->problem_data, CALCFCN));
+}
+
+/*
+ * Bytes are doubles read plus written per cell; the 7 point Matvec
+ * reads 7 coefficients, x (assuming stencil reuse in cache) and y and
+ * writes y.  The halo exchange is accounted separately.
+ */
+static KernelBenchEntry kernels[] = {
+  { "linearsum",  KernelLinearSum,  3 * sizeof(double), 3.0 },
+  { "dotprod",    KernelDotProd,    2 * sizeof(double), 2.0 },
+  { "matvec",     KernelMatvec,    10 * sizeof(double), 16.0 },
+  { "update",     KernelUpdate,     0.0,                0.0 },
+  { "saturation", KernelSaturation, 2 * sizeof(double), 0.0 },
+  { "relperm",    KernelRelPerm,    2 * sizeof(double), 0.0 },
+};
+
+/*--------------------------------------------------------------------------
+ * Input database
+ *
+ * The library reads its setup from the input database, build one in
+ * memory instead of reading a .pfidb file.
+ *--------------------------------------------------------------------------*/
+
+static void KernelBenchSet(IDB *db, char *key, char *format, double value)
+{
+  char string[IDB_MAX_VALUE_LEN];
+
+  sprintf(string, format, value);
+  HBT_insert(db, IDB_NewEntry(key, string), 0);
+}
+
+static IDB *KernelBenchNewDB(int P, int Q, int R, int size)
+{
+  IDB *db;
+
+  db = (IDB*)HBT_new(IDB_Compare, IDB_Free, IDB_Print, NULL, 0);
+
+  KernelBenchSet(db, "Process.Topology.P", "%g", P);
+  KernelBenchSet(db, "Process.Topology.Q", "%g", Q);
+  KernelBenchSet(db, "Process.Topology.R", "%g", R);
+
+  KernelBenchSet(db, "ComputationalGrid.Lower.X", "%g", 0.0);
+  KernelBenchSet(db, "ComputationalGrid.Lower.Y", "%g", 0.0);
+  KernelBenchSet(db, "ComputationalGrid.Lower.Z", "%g", 0.0);
+  KernelBenchSet(db, "ComputationalGrid.DX", "%g", 1.0);
+  KernelBenchSet(db, "ComputationalGrid.DY", "%g", 1.0);
+  KernelBenchSet(db, "ComputationalGrid.DZ", "%g", 1.0);
+  KernelBenchSet(db, "ComputationalGrid.NX", "%g", size);
+  KernelBenchSet(db, "ComputationalGrid.NY", "%g", size);
+  KernelBenchSet(db, "ComputationalGrid.NZ", "%g", size);
+
+  HBT_insert(db, IDB_NewEntry("GeomInput.Names", "domain_input"), 0);
+  HBT_insert(db, IDB_NewEntry("GeomInput.domain_input.InputType", "Box"), 0);
+  HBT_insert(db, IDB_NewEntry("GeomInput.domain_input.GeomName", "domain"), 0);
+  KernelBenchSet(db, "Geom.domain.Lower.X", "%g", 0.0);
+  KernelBenchSet(db, "Geom.domain.Lower.Y", "%g", 0.0);
+  KernelBenchSet(db, "Geom.domain.Lower.Z", "%g", 0.0);
+  KernelBenchSet(db, "Geom.domain.Upper.X", "%g", size);
+  KernelBenchSet(db, "Geom.domain.Upper.Y", "%g", size);
+  KernelBenchSet(db, "Geom.domain.Upper.Z", "%g", size);
+
+  HBT_insert(db, IDB_NewEntry("Phase.Saturation.Type", "VanGenuchten"), 0);
+  HBT_insert(db, IDB_NewEntry("Phase.Saturation.GeomNames", "domain"), 0);
+  KernelBenchSet(db, "Geom.domain.Saturation.Alpha", "%g", 3.5);
+  KernelBenchSet(db, "Geom.domain.Saturation.N", "%g", 2.0);
+  KernelBenchSet(db, "Geom.domain.Saturation.SRes", "%g", 0.01);
+  KernelBenchSet(db, "Geom.domain.Saturation.SSat", "%g", 1.0);
+
+  HBT_insert(db, IDB_NewEntry("Phase.RelPerm.Type", "VanGenuchten"), 0);
+  HBT_insert(db, IDB_NewEntry("Phase.RelPerm.GeomNames", "domain"), 0);
+  KernelBenchSet(db, "Geom.domain.RelPerm.Alpha", "%g", 3.5);
+  KernelBenchSet(db, "Geom.domain.RelPerm.N", "%g", 2.0);
+
+  return db;
+}
+
+/*--------------------------------------------------------------------------
+ * Setup and teardown of the grid, vectors and modules for one run
+ *--------------------------------------------------------------------------*/
+
+static void KernelBenchSetup(KernelBenchData *data, int num_ghost)
+{
+  Stencil *stencil;
+
+  GlobalsNumProcsX = GetIntDefault("Process.Topology.P", 1);
+  GlobalsNumProcsY = GetIntDefault("Process.Topology.Q", 1);
+  GlobalsNumProcsZ = GetIntDefault("Process.Topology.R", 1);
+
+  GlobalsNumProcs = amps_Size(amps_CommWorld);
+
+  GlobalsBackground = ReadBackground();
+  GlobalsUserGrid = ReadUserGrid();
+  SetBackgroundBounds(GlobalsBackground, GlobalsUserGrid);
+  GlobalsMaxRefLevel = 0;
+
+  data->grid = CreateGrid(GlobalsUserGrid);
+  data->num_ghost = num_ghost;
+  data->update_mode = (num_ghost > 1) ? VectorUpdateAll2 : VectorUpdateAll;
+  data->result = 0.0;
+
+  data->x = NewVectorType(data->grid, 1, num_ghost, vector_cell_centered);
+  data->y = NewVectorType(data->grid, 1, num_ghost, vector_cell_centered);
+  data->z = NewVectorType(data->grid, 1, num_ghost, vector_cell_centered);
+  InitVectorAll(data->x, 1.0);
+  InitVectorAll(data->y, 2.0);
+  InitVectorAll(data->z, 0.0);
+
+  stencil = NewStencil(stencil_shape, 7);
+  data->A = NewMatrixType(data->grid, NULL, stencil, OFF, stencil,
+                          matrix_cell_centered);
+  InitMatrix(data->A, -1.0e-3);
+
+  data->pressure = NewVectorType(data->grid, 1, num_ghost, vector_cell_centered);
+  data->density = NewVectorType(data->grid, 1, num_ghost, vector_cell_centered);
+  data->saturation = NewVectorType(data->grid, 1, num_ghost, vector_cell_centered);
+  data->rel_perm = NewVectorType(data->grid, 1, num_ghost, vector_cell_centered);
+  InitVectorAll(data->pressure, -1.0);
+  InitVectorAll(data->density, 1.0);
+  InitVectorAll(data->saturation, 0.0);
+  InitVectorAll(data->rel_perm, 0.0);
+
+  /* Only the geometry solids are needed by the constitutive relations */
+  data->problem_data = ctalloc(ProblemData, 1);
+
+  data->geometries_module = PFModuleNewModule(Geometries, ());
+  data->geometries_instance =
+    PFModuleNewInstanceType(GeometriesInitInstanceXtraInvoke,
+                            data->geometries_module, (data->grid));
+  PFModuleInvokeType(GeometriesInvoke, data->geometries_instance, (data->problem_data));
+
+  data->saturation_module = PFModuleNewModule(Saturation, ());
+  data->saturation_instance =
+    PFModuleNewInstanceType(SaturationInitInstanceXtraInvoke,
+                            data->saturation_module, (data->grid, NULL));
+
+  data->rel_perm_module = PFModuleNewModule(PhaseRelPerm, ());
+  data->rel_perm_instance =
+    PFModuleNewInstanceType(PhaseRelPermInitInstanceXtraInvoke,
+                            data->rel_perm_module, (data->grid, NULL));
+}
+
+static void KernelBenchTeardown(KernelBenchData *data)
+{
+  int i;
+
+  PFModuleFreeInstance(data->saturation_instance);
+  PFModuleFreeModule(data->saturation_module);
+
+  PFModuleFreeInstance(data->rel_perm_instance);
+  PFModuleFreeModule(data->rel_perm_module);
+
+  for (i = 0; i < ProblemDataNumSolids(data->problem_data); i++)
+    GrGeomFreeSolid(ProblemDataGrSolids(data->problem_data)[i]);
+  tfree(ProblemDataGrSolids(data->problem_data));
+  tfree(data->problem_data);
+
+  /* The geometry names are freed with the module but not reset */
+  PFModuleFreeInstance(data->geometries_instance);
+  PFModuleFreeModule(data->geometries_module);
+  GlobalsGeomNames = NULL;
+
+  FreeVector(data->x);
+  FreeVector(data->y);
+  FreeVector(data->z);
+  FreeVector(data->pressure);
+  FreeVector(data->density);
+  FreeVector(data->saturation);
+  FreeVector(data->rel_perm);
+  FreeMatrix(data->A);
+
+  FreeGrid(data->grid);
+  FreeUserGrid(GlobalsUserGrid);
+  FreeBackground(GlobalsBackground);
+}
+
+/*--------------------------------------------------------------------------
+ * Number of halo cells received by this process for the update mode.
+ *--------------------------------------------------------------------------*/
+
+static double KernelBenchHaloCells(KernelBenchData *data)
+{
+  Region         *region;
+  SubregionArray *subregion_array;
+  Subregion      *subregion;
+  double cells = 0.0;
+  int i, j;
+
+  region = ComputePkgRecvRegion(GridComputePkg(data->grid, data->update_mode));
+
+  ForSubregionArrayI(i, region)
+  {
+    subregion_array = RegionSubregionArray(region, i);
+    ForSubregionI(j, subregion_array)
+    {
+      subregion = SubregionArraySubregion(subregion_array, j);
+      cells += (double)SubregionNX(subregion) * SubregionNY(subregion)
+               * SubregionNZ(subregion);
+    }
+  }
+
+  return cells;
+}
+
+/*--------------------------------------------------------------------------
+ * Time one kernel; returns the maximum time per call over all processes.
+ *--------------------------------------------------------------------------*/
+
+static double KernelBenchTime(KernelBenchEntry *entry, KernelBenchData *data,
+                              double min_time, int *calls)
+{
+  amps_Invoice invoice;
+  amps_Clock_t start;
+  double elapsed;
+  int reps = 1;
+  int n;
+
+  /* Warm up, and touch pages the first call allocates */
+  (entry->kernel)(data);
+
+  for (;;)
+  {
+    start = amps_Clock();
+    for (n = 0; n < reps; n++)
+      (entry->kernel)(data);
+    elapsed = (double)(amps_Clock() - start) / (double)AMPS_TICKS_PER_SEC;
+
+    /* All processes must agree on the repetition count */
+    invoice = amps_NewInvoice("%d", &elapsed);
+    amps_AllReduce(amps_CommWorld, invoice, amps_Max);
+    amps_FreeInvoice(invoice);
+
+    if (elapsed >= min_time)
+      break;
+
+    reps *= (elapsed > 0.0) ? pfmax(2, (int)(1.2 * min_time / elapsed)) : 8;
+  }
+
+  *calls = reps;
+  return elapsed / reps;
+}
+
+/*--------------------------------------------------------------------------
+ * main
+ *--------------------------------------------------------------------------*/
+
+int main(int argc, char *argv [])
+{
+  KernelBenchData data;
+
+  int sizes[KernelBenchMaxSizes];
+  int num_sizes = 0;
+  int ghosts[KernelBenchMaxSizes];
+  int num_ghosts = 0;
+
+  int P = 0, Q = 1, R = 1;
+  double min_time = 0.25;
+  char *csv_filename = NULL;
+  FILE *csv_file = NULL;
+
+  amps_Invoice invoice;
+  double cells, halo_cells, bytes;
+  double time, cells_per_sec, gbytes_per_sec, mflops;
+  int calls;
+  int num_kernels = sizeof(kernels) / sizeof(kernels[0]);
+  int is, ig, ik, c;
+
+  if (amps_Init(&argc, &argv))
+  {
+    amps_Printf("Error: amps_Init initalization failed\n");
+    exit(1);
+  }
+
+  opterr = 0;
+  while ((c = getopt(argc, argv, "P:Q:R:n:g:t:o:")) != -1)
+  {
+    switch (c)
+    {
+      case 'P':
+        P = atoi(optarg);
+        break;
+
+      case 'Q':
+        Q = atoi(optarg);
+        break;
+
+      case 'R':
+        R = atoi(optarg);
+        break;
+
+      case 'n':
+        if (num_sizes < KernelBenchMaxSizes)
+          sizes[num_sizes++] = atoi(optarg);
+        break;
+
+      case 'g':
+        if (num_ghosts < KernelBenchMaxSizes)
+          ghosts[num_ghosts++] = pfmax(1, atoi(optarg));
+        break;
+
+      case 't':
+        min_time = atof(optarg);
+        break;
+
+      case 'o':
+        csv_filename = optarg;
+        break;
+
+      default:
+        if (!amps_Rank(amps_CommWorld))
+        {
+          amps_Printf("Usage: %s [-P p] [-Q q] [-R r] [-n size]... [-g ghost]... [-t seconds] [-o file]\n",
+                      argv[0]);
+        }
+        amps_Finalize();
+        return 1;
+    }
+  }
+
+  if (num_sizes == 0)
+  {
+    sizes[num_sizes++] = 32;
+    sizes[num_sizes++] = 64;
+    sizes[num_sizes++] = 128;
+  }
+
+  if (num_ghosts == 0)
+  {
+    ghosts[num_ghosts++] = 1;
+    ghosts[num_ghosts++] = 2;
+  }
+
+  if (P == 0)
+  {
+    P = amps_Size(amps_CommWorld) / (Q * R);
+  }
+
+  if (P * Q * R != amps_Size(amps_CommWorld))
+  {
+    if (!amps_Rank(amps_CommWorld))
+    {
+      amps_Printf("Error: process topology %d x %d x %d does not match %d processes\n",
+                  P, Q, R, amps_Size(amps_CommWorld));
+    }
+    amps_Finalize();
+    return 1;
+  }
+
+  NewGlobals("kernel_bench");
+
+  if (!amps_Rank(amps_CommWorld))
+  {
+    if (csv_filename)
+    {
+      if ((csv_file = fopen(csv_filename, "w")) == NULL)
+      {
+        amps_Printf("Error: can't open output file %s\n", csv_filename);
+        exit(1);
+      }
+
+      fprintf(csv_file, "Kernel,Processes,NX,NY,NZ,Ghost,Calls,Time (s),Cells/s,GB/s,MFLOPS (mops/s)\n");
+    }
+
+    amps_Printf("%-11s %5s %5s %5s %6s %9s %12s %12s %8s %9s\n",
+                "kernel", "procs", "size", "ghost", "calls", "time/call",
+                "cells/s", "halo cells", "GB/s", "MFLOPS");
+  }
+
+  for (is = 0; is < num_sizes; is++)
+  {
+    for (ig = 0; ig < num_ghosts; ig++)
+    {
+      amps_ThreadLocal(input_database) = KernelBenchNewDB(P, Q, R, sizes[is]);
+
+      NewTiming();
+
+      KernelBenchSetup(&data, ghosts[ig]);
+
+      cells = (double)sizes[is] * sizes[is] * sizes[is];
+
+      halo_cells = KernelBenchHaloCells(&data);
+      invoice = amps_NewInvoice("%d", &halo_cells);
+      amps_AllReduce(amps_CommWorld, invoice, amps_Add);
+      amps_FreeInvoice(invoice);
+
+      for (ik = 0; ik < num_kernels; ik++)
+      {
+        time = KernelBenchTime(&kernels[ik], &data, min_time, &calls);
+
+        if (kernels[ik].kernel == KernelUpdate)
+        {
+          /* Halo data is packed on the sender and unpacked on the receiver */
+          bytes = 2.0 * sizeof(double) * halo_cells;
+        }
+        else
+        {
+          bytes = kernels[ik].bytes_per_cell * cells;
+        }
+
+        cells_per_sec = (time > 0.0) ? cells / time : 0.0;
+        gbytes_per_sec = (time > 0.0) ? bytes / time / 1.0e9 : 0.0;
+        mflops = (time > 0.0) ? kernels[ik].flops_per_cell * cells / time / 1.0e6 : 0.0;
+
+        if (!amps_Rank(amps_CommWorld))
+        {
+          amps_Printf("%-11s %5d %5d %5d %6d %9.3e %12.4e %12.0f %8.3f %9.1f\n",
+                      kernels[ik].name, P * Q * R, sizes[is], ghosts[ig], calls,
+                      time, cells_per_sec, halo_cells, gbytes_per_sec, mflops);
+
+          if (csv_file)
+          {
+            fprintf(csv_file, "%s,%d,%d,%d,%d,%d,%d,%e,%e,%f,%f\n",
+                    kernels[ik].name, P * Q * R, sizes[is], sizes[is], sizes[is],
+                    ghosts[ig], calls, time, cells_per_sec, gbytes_per_sec, mflops);
+          }
+        }
+      }
+
+      KernelBenchTeardown(&data);
+
+      FreeTiming();
+
+      IDB_FreeDB(amps_ThreadLocal(input_database));
+    }
+  }
+
+  if (csv_file)
+  {
+    fclose(csv_file);
+  }
+
+  FreeGlobals();
+
+  amps_Finalize();
+
+  return 0;
+}
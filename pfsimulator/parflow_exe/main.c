@@ -280,6 +280,12 @@ int main(int argc, char *argv [])
 
     amps_ThreadLocal(input_database) = IDB_NewDB(GlobalsInFileName);
 
+    /*-----------------------------------------------------------------------
+     * Split into ensemble members
+     *-----------------------------------------------------------------------*/
+
+    NewEnsemble();
+
     /*-----------------------------------------------------------------------
      * Setup log printing
      *-----------------------------------------------------------------------*/
@@ -349,7 +355,7 @@ int main(int argc, char *argv [])
 	    InputError("Error: can't open output file %s%s\n", filename, "");
 	  }
 	  
-	    fprintf(file, "%s,%f,%s,%s\n", "Total Runtime", 
+	    fprintf(file, "%s,%f,%s,%s,,,,,\n", "Total Runtime", 
 		    (double)wall_clock_time / (double)AMPS_TICKS_PER_SEC,
 		    "-nan", "0");
 	  }
@@ -68,6 +68,10 @@ BCPressureData *NewBCPressureData()
 
   BCPressureDataValues(bc_pressure_data) = NULL;
 
+  BCPressureDataNumRebuilds(bc_pressure_data) = 0;
+
+  BCPressureDataNumRebuildsSkipped(bc_pressure_data) = 0;
+
   return bc_pressure_data;
 }
 
@@ -269,6 +269,10 @@ typedef struct {
 
   /* time info */
   TimeCycleData      *time_cycle_data;
+
+  /* patch value builds done and skipped by BCPressure */
+  int num_rebuilds;
+  int num_rebuilds_skipped;
 } BCPressureData;
 
 /*--------------------------------------------------------------------------
@@ -391,6 +395,12 @@ typedef struct {
 #define BCPressureDataTimeCycleData(bc_pressure_data) \
   ((bc_pressure_data)->time_cycle_data)
 
+#define BCPressureDataNumRebuilds(bc_pressure_data) \
+  ((bc_pressure_data)->num_rebuilds)
+
+#define BCPressureDataNumRebuildsSkipped(bc_pressure_data) \
+  ((bc_pressure_data)->num_rebuilds_skipped)
+
 /*--------------------------------------------------------------------------
  * BCPressure Data constants used in the program.
  *--------------------------------------------------------------------------*/
@@ -31,6 +31,8 @@
 #include "index_space.h"
 #include "llnlmath.h"
 
+#include <string.h>
+
 /**
  * This implementation is derived from the SAMRAI Berger-Rigoutsos
  * implementation developed by LLNL.
@@ -89,16 +91,10 @@ int HistogramBoxGetTags(HistogramBox *histogram_box, int dim, int global_index)
   return histogram_box -> histogram[dim][global_index - histogram_box -> box.lo[dim]];
 }
 
-/**
- * Add tags along the provided dimension for the global index along that dimension.
- */
-void HistogramBoxAddTags(HistogramBox *histogram_box, int dim, int global_index, int tag_count)
-{
-  histogram_box -> histogram[dim][global_index - histogram_box -> box.lo[dim]] += tag_count;
-}
-
 /**
  * Create a new histogram box for the index space spanned by the provided box.
+ *
+ * Each histogram only needs one entry per index along its own dimension.
  */
 HistogramBox* NewHistogramBox(Box *box)
 {
@@ -106,11 +102,12 @@ HistogramBox* NewHistogramBox(Box *box)
 
   BoxCopy(&(histogram_box -> box), box);
 
-  int size =  BoxSize(&(histogram_box -> box));  
+  Point num_cells;
+  BoxNumberCells(&(histogram_box -> box), &num_cells);
 
   for (int dim = 0; dim < DIM; dim++)
   {
-    histogram_box -> histogram[dim] = ctalloc(int, size);
+    histogram_box -> histogram[dim] = ctalloc(int, num_cells[dim]);
   }
 
   return histogram_box;
@@ -136,10 +133,12 @@ void FreeHistogramBox(HistogramBox* histogram_box)
  */
 void ResetHistogram(HistogramBox *histogram_box)
 {
+  Point num_cells;
+  BoxNumberCells(&(histogram_box -> box), &num_cells);
+
   for (int dim = 0; dim < DIM; dim++)
   {
-    int size =  BoxSize(&(histogram_box -> box));
-    for (int index = 0; index < size; index++) 
+    for (int index = 0; index < num_cells[dim]; index++) 
     {
       histogram_box -> histogram[dim][index] = 0;
     }
@@ -220,130 +219,82 @@ void FindBoundBoxForTags(HistogramBox* histogram_box, Box* bound_box, Point min_
 }
 
 /**
- * Reduces tag counts along an axis.
+ * Compute Tag Histogram along all dimensions.
  *
- * Reduce (count) the number of cells that have the specified tag
- * along the provided dimension and store into the provided histogram
- * box.
+ * Counts the cells that have the specified tag, projected onto each
+ * dimension of the histogram box.  The histograms for all dimensions
+ * are accumulated in a single sweep over the cells in the box so the
+ * cost is linear in the number of cells.
  */
-void ReduceTags(HistogramBox *histogram_box, Vector *vector, int dim, DoubleTags tag)
+int ComputeTagHistogram(HistogramBox *histogram_box, Vector* vector, DoubleTags tag)
 {
+  Box *box = &(histogram_box -> box);
 
-  Box intersection;
-  BoxClear(&intersection);
+  Grid* grid = VectorGrid(vector);
+  Subvector* v_sub;
+  double     *vp;
 
-  BoxCopy(&intersection, &(histogram_box -> box));
-  
-  int ilo = intersection.lo[dim];
-  int ihi = intersection.up[dim];
+  Subgrid* subgrid;
 
+  int ix, iy, iz;
+  int nx, ny, nz;
+  int nx_v, ny_v, nz_v;
 
-  for(int ic_sb = ilo; ic_sb <= ihi; ic_sb++)
-  {
+  int i_s;
+  int i, j, k, iv;
 
-    int tag_count = 0;
+  int *histogram_x = histogram_box -> histogram[0];
+  int *histogram_y = histogram_box -> histogram[1];
+  int *histogram_z = histogram_box -> histogram[2];
 
-    Box src_box;
-    BoxClear(&src_box);
+  int num_tags = 0;
 
-    BoxCopy(&src_box, &intersection);
+  ResetHistogram(histogram_box);
 
-    src_box.lo[dim] = ic_sb;
-    src_box.up[dim] = ic_sb;
+  ForSubgridI(i_s, GridSubgrids(grid))
+  {
+    subgrid = GridSubgrid(grid, i_s);
 
-    {
-      Grid* grid = VectorGrid(vector);
-      Subvector* v_sub;
-      double     *vp;
-    
-      Subgrid* subgrid;
-    
-      int ix, iy, iz;
-      int nx, ny, nz;
-      int nx_v, ny_v, nz_v;
+    v_sub = VectorSubvector(vector, i_s);
 
-      int i_s;
-      int i, j, k, iv;
+    /* Intersect the histogram box with the subgrid (including ghosts) */
+    ix = pfmax(SubgridIX(subgrid) - num_ghost, box -> lo[0]);
+    iy = pfmax(SubgridIY(subgrid) - num_ghost, box -> lo[1]);
+    iz = pfmax(SubgridIZ(subgrid) - num_ghost, box -> lo[2]);
 
-      Box bounding_box;
-      BoxClear(&bounding_box);
-      //      Point lo, up;
+    nx = pfmin(SubgridIX(subgrid) + SubgridNX(subgrid) - 1 + num_ghost, box -> up[0]) - ix + 1;
+    ny = pfmin(SubgridIY(subgrid) + SubgridNY(subgrid) - 1 + num_ghost, box -> up[1]) - iy + 1;
+    nz = pfmin(SubgridIZ(subgrid) + SubgridNZ(subgrid) - 1 + num_ghost, box -> up[2]) - iz + 1;
 
-      ForSubgridI(i_s, GridSubgrids(grid))
-      {
-	subgrid = GridSubgrid(grid, i_s);
-	
-	v_sub = VectorSubvector(vector, i_s);
-	
-	ix = SubgridIX(subgrid) - num_ghost;
-	iy = SubgridIY(subgrid) - num_ghost;
-	iz = SubgridIZ(subgrid) - num_ghost;
-	
-	nx = SubgridNX(subgrid) + 2 * num_ghost;
-	ny = SubgridNY(subgrid) + 2 * num_ghost;
-	nz = SubgridNZ(subgrid) + 2 * num_ghost;
-	
-	nx_v = SubvectorNX(v_sub);
-	ny_v = SubvectorNY(v_sub);
-	nz_v = SubvectorNZ(v_sub);
-	
-	ix = pfmax(ix,src_box.lo[0]);
-	iy = pfmax(iy,src_box.lo[1]);
-	iz = pfmax(iz,src_box.lo[2]);
-
-	nx = pfmin(nx, src_box.up[0] - src_box.lo[0] + 1);
-	ny = pfmin(ny, src_box.up[1] - src_box.lo[1] + 1);
-	nz = pfmin(nz, src_box.up[2] - src_box.lo[2] + 1);
-	vp = SubvectorElt(v_sub, ix, iy, iz);
-	
-	iv = 0;
-	BoxLoopI1(i, j, k, ix, iy, iz, nx, ny, nz,
-		  iv, nx_v, ny_v, nz_v, 1, 1, 1,
-	{
-          DoubleTags v;
-	  v.as_double = vp[iv];
-
-	  if(v.as_tags & tag.as_tags)
-	  {
-	    if( ( (src_box.lo[0] <= i) &&  (i <= src_box.up[0]) ) &&
-		( (src_box.lo[1] <= j) &&  (j <= src_box.up[1]) ) &&
-		( (src_box.lo[2] <= k) &&  (k <= src_box.up[2]) ) )
-	    {
-	      tag_count++;
-	    }
-	  }
-	});
-      }
-	  
-      HistogramBoxAddTags(histogram_box, dim, ic_sb, tag_count);
+    if ((nx <= 0) || (ny <= 0) || (nz <= 0))
+    {
+      continue;
     }
-  }
-}
 
-/**
- * Compute Tag Histogram along all dimensions.
- */
-int ComputeTagHistogram(HistogramBox *histogram_box, Vector* vector, DoubleTags tag)
-{
-   int num_tags = 0;
-   Point num_cells;
-
-   ResetHistogram(histogram_box);
+    nx_v = SubvectorNX(v_sub);
+    ny_v = SubvectorNY(v_sub);
+    nz_v = SubvectorNZ(v_sub);
 
-   for(int dim = 0; dim < DIM; dim++)
-   {
-     ReduceTags(histogram_box, vector, dim, tag);
-   }
+    vp = SubvectorElt(v_sub, ix, iy, iz);
 
-   BoxNumberCells(&(histogram_box -> box), &num_cells);
+    iv = 0;
+    BoxLoopI1(i, j, k, ix, iy, iz, nx, ny, nz,
+	      iv, nx_v, ny_v, nz_v, 1, 1, 1,
+    {
+      DoubleTags v;
+      v.as_double = vp[iv];
 
-   int dim = 0;
-   for (int index = 0; index < num_cells[dim]; index++) 
-   {
-     num_tags += (histogram_box->histogram)[dim][index];
-   }
+      if(v.as_tags & tag.as_tags)
+      {
+	histogram_x[i - box -> lo[0]]++;
+	histogram_y[j - box -> lo[1]]++;
+	histogram_z[k - box -> lo[2]]++;
+	num_tags++;
+      }
+    });
+  }
 
-   return(num_tags);
+  return(num_tags);
 }
 
 /**
@@ -786,13 +737,11 @@ void BergerRigoutsos(Vector* vector,
  * are looped over in each face direction so a box array is generated for 
  * each face direction.
  * 
- * The computed box arrays are stored in the geom_solid.
+ * The indicator vector is used as scratch space for the tags.  The
+ * computed box arrays are stored in the geom_solid.
  */
-BoxList* ComputePatchBoxes(GrGeomSolid *geom_solid, int patch)
+void ComputePatchBoxes(GrGeomSolid *geom_solid, int patch, Vector* indicator)
 {
-  Grid *grid =  CreateGrid(GlobalsUserGrid);
-
-  Vector* indicator =  NewVectorType(grid, 1, num_ghost, vector_cell_centered);
   InitVectorAll(indicator, 0.0);
 
   DoubleTags tag;
@@ -808,12 +757,9 @@ BoxList* ComputePatchBoxes(GrGeomSolid *geom_solid, int patch)
     int i, j, k, r, is;
     int ix, iy, iz;
     int nx, ny, nz;
-    double  dx, dy, dz;
 
     double *dp;
 
-    int tag_count = 0;
-
     ForSubgridI(is, GridSubgrids(grid))
     {
       subgrid = GridSubgrid(grid, is);
@@ -831,10 +777,6 @@ BoxList* ComputePatchBoxes(GrGeomSolid *geom_solid, int patch)
       ny = SubgridNY(subgrid);
       nz = SubgridNZ(subgrid);
       
-      dx = SubgridDX(subgrid);
-      dy = SubgridDY(subgrid);
-      dz = SubgridDZ(subgrid);
-      
       dp = SubvectorData(d_sub);
 
       int *fdir;
@@ -847,8 +789,6 @@ BoxList* ComputePatchBoxes(GrGeomSolid *geom_solid, int patch)
 	tag.as_double = dp[ip];
 	tag.as_tags = tag.as_tags | this_face_tag;
 	dp[ip] = tag.as_double;
-
-	tag_count++;
       });
     }
   }
@@ -879,9 +819,6 @@ BoxList* ComputePatchBoxes(GrGeomSolid *geom_solid, int patch)
 
      FreeBoxList(boxes);
   }
-  
-  FreeVector(indicator);
-  FreeGrid(grid);
 }
 
 /**
@@ -891,13 +828,11 @@ BoxList* ComputePatchBoxes(GrGeomSolid *geom_solid, int patch)
  * over in each face direction so a box array is generated for each
  * face direction.
  * 
- * The computed box arrays are stored in the geom_solid.
+ * The indicator vector is used as scratch space for the tags.  The
+ * computed box arrays are stored in the geom_solid.
  */
-void ComputeSurfaceBoxes(GrGeomSolid *geom_solid)
+void ComputeSurfaceBoxes(GrGeomSolid *geom_solid, Vector* indicator)
 {
-  Grid *grid =  CreateGrid(GlobalsUserGrid);
-
-  Vector* indicator =  NewVectorType(grid, 1, num_ghost, vector_cell_centered);
   InitVectorAll(indicator, 0.0);
 
   DoubleTags tag;
@@ -913,12 +848,9 @@ void ComputeSurfaceBoxes(GrGeomSolid *geom_solid)
     int i, j, k, r, is;
     int ix, iy, iz;
     int nx, ny, nz;
-    double  dx, dy, dz;
 
     double *dp;
 
-    int tag_count = 0;
-
     ForSubgridI(is, GridSubgrids(grid))
     {
       subgrid = GridSubgrid(grid, is);
@@ -936,10 +868,6 @@ void ComputeSurfaceBoxes(GrGeomSolid *geom_solid)
       ny = SubgridNY(subgrid);
       nz = SubgridNZ(subgrid);
       
-      dx = SubgridDX(subgrid);
-      dy = SubgridDY(subgrid);
-      dz = SubgridDZ(subgrid);
-      
       dp = SubvectorData(d_sub);
 
       int *fdir;
@@ -951,8 +879,6 @@ void ComputeSurfaceBoxes(GrGeomSolid *geom_solid)
 	tag.as_double = dp[ip];
 	tag.as_tags = tag.as_tags | this_face_tag;
 	dp[ip] = tag.as_double;
-	   
-	tag_count++;
       });
     }
   }
@@ -983,9 +909,6 @@ void ComputeSurfaceBoxes(GrGeomSolid *geom_solid)
 
      FreeBoxList(boxes);
   }
-
-  FreeVector(indicator);
-  FreeGrid(grid);
 }
 
 /**
@@ -994,17 +917,15 @@ void ComputeSurfaceBoxes(GrGeomSolid *geom_solid)
  * Compute the interior loop iteration boxes.  Boxes will exactly cover
  * all of interior of geom_solid in index space.
  * 
- * The computed box array is stored in the geom_solid.
+ * The indicator vector is used as scratch space for the tags.  The
+ * computed box array is stored in the geom_solid.
  */
-void ComputeInteriorBoxes(GrGeomSolid *geom_solid)
+void ComputeInteriorBoxes(GrGeomSolid *geom_solid, Vector* indicator)
 {
 
   DoubleTags tag;
   tag.as_tags = 1;
 
-  Grid *grid =  CreateGrid(GlobalsUserGrid);
-
-  Vector* indicator =  NewVectorType(grid, 1, num_ghost, vector_cell_centered);
   InitVectorAll(indicator, 0.0);
 
   {
@@ -1018,12 +939,9 @@ void ComputeInteriorBoxes(GrGeomSolid *geom_solid)
     int i, j, k, r, is;
     int ix, iy, iz;
     int nx, ny, nz;
-    double  dx, dy, dz;
 
     double *dp;
 
-    int tag_count = 0;
-
     ForSubgridI(is, GridSubgrids(grid))
     {
       subgrid = GridSubgrid(grid, is);
@@ -1041,10 +959,6 @@ void ComputeInteriorBoxes(GrGeomSolid *geom_solid)
       ny = SubgridNY(subgrid);
       nz = SubgridNZ(subgrid);
       
-      dx = SubgridDX(subgrid);
-      dy = SubgridDY(subgrid);
-      dz = SubgridDZ(subgrid);
-      
       dp = SubvectorData(d_sub);
 
       GrGeomInLoop(i, j, k, geom_solid, r, ix, iy, iz, nx, ny, nz,
@@ -1052,7 +966,6 @@ void ComputeInteriorBoxes(GrGeomSolid *geom_solid)
 	ip = SubvectorEltIndex(d_sub, i, j, k);
 
 	dp[ip] = tag.as_double;
-	tag_count++;
       });
     }
   }
@@ -1078,23 +991,325 @@ void ComputeInteriorBoxes(GrGeomSolid *geom_solid)
   GrGeomSolidInteriorBoxes(geom_solid) = NewBoxArray(boxes);
 
   FreeBoxList(boxes);
-  FreeVector(indicator);
-  FreeGrid(grid);
+}
+
+/*--------------------------------------------------------------------------
+ * Clustering cache
+ *
+ * The boxes computed for a solid only depend on the octrees of the
+ * solid and the local subgrids.  When a cache directory is given
+ * (Clustering.CacheDirectory) the box arrays are written to a file
+ * per process named by a hash of those inputs so later runs with the
+ * same geometry and decomposition can skip the clustering.
+ *--------------------------------------------------------------------------*/
+
+/** Version of the cache file layout; bump when the layout changes. */
+static const int clustering_cache_version = 1;
+
+/**
+ * Hash used to key the clustering cache (64 bit FNV-1a).
+ */
+typedef unsigned long long ClusteringHash;
+
+static ClusteringHash ClusteringHashInt(ClusteringHash hash, int value)
+{
+  unsigned int bits = (unsigned int)value;
+
+  for (int byte = 0; byte < 4; byte++)
+  {
+    hash ^= (bits >> (8 * byte)) & 0xff;
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+static ClusteringHash ClusteringHashOctree(ClusteringHash hash, GrGeomOctree *node)
+{
+  if (node == NULL)
+  {
+    return ClusteringHashInt(hash, -1);
+  }
+
+  hash = ClusteringHashInt(hash, GrGeomOctreeFlag(node));
+  hash = ClusteringHashInt(hash, GrGeomOctreeFaces(node));
+
+  if (GrGeomOctreeHasChildren(node))
+  {
+    for (int child = 0; child < GrGeomOctreeNumChildren; child++)
+    {
+      hash = ClusteringHashOctree(hash, GrGeomOctreeChild(node, child));
+    }
+  }
+
+  return hash;
+}
+
+/**
+ * Compute the cache key for the solid on the provided grid.
+ */
+static ClusteringHash ClusteringCacheKey(GrGeomSolid *geom_solid, Grid *grid)
+{
+  ClusteringHash hash = 14695981039346656037ULL;
+  int is;
+
+  hash = ClusteringHashInt(hash, clustering_cache_version);
+  hash = ClusteringHashInt(hash, num_ghost);
+
+  hash = ClusteringHashInt(hash, GrGeomSolidOctreeBGLevel(geom_solid));
+  hash = ClusteringHashInt(hash, GrGeomSolidOctreeIX(geom_solid));
+  hash = ClusteringHashInt(hash, GrGeomSolidOctreeIY(geom_solid));
+  hash = ClusteringHashInt(hash, GrGeomSolidOctreeIZ(geom_solid));
+
+  hash = ClusteringHashOctree(hash, GrGeomSolidData(geom_solid));
+
+  hash = ClusteringHashInt(hash, GrGeomSolidNumPatches(geom_solid));
+  for (int patch = 0; patch < GrGeomSolidNumPatches(geom_solid); patch++)
+  {
+    hash = ClusteringHashOctree(hash, GrGeomSolidPatch(geom_solid, patch));
+  }
+
+  ForSubgridI(is, GridSubgrids(grid))
+  {
+    Subgrid *subgrid = GridSubgrid(grid, is);
+
+    hash = ClusteringHashInt(hash, SubgridIX(subgrid));
+    hash = ClusteringHashInt(hash, SubgridIY(subgrid));
+    hash = ClusteringHashInt(hash, SubgridIZ(subgrid));
+    hash = ClusteringHashInt(hash, SubgridNX(subgrid));
+    hash = ClusteringHashInt(hash, SubgridNY(subgrid));
+    hash = ClusteringHashInt(hash, SubgridNZ(subgrid));
+    hash = ClusteringHashInt(hash, SubgridRX(subgrid));
+  }
+
+  return hash;
+}
+
+static void ClusteringCacheFilename(char *filename, ClusteringHash hash)
+{
+  sprintf(filename, "%s/%016llx.pfclust", GlobalsClusteringCacheDirectory, hash);
+}
+
+static void WriteClusteringCacheHeader(amps_File file, ClusteringHash hash)
+{
+  int header[3];
+
+  header[0] = clustering_cache_version;
+  header[1] = (int)(hash >> 32);
+  header[2] = (int)(hash & 0xffffffffULL);
+
+  amps_WriteInt(file, header, 3);
+}
+
+static int ReadClusteringCacheHeader(amps_File file, ClusteringHash hash)
+{
+  int header[3] = { -1, 0, 0 };
+
+  amps_ReadInt(file, header, 3);
+
+  return (header[0] == clustering_cache_version)
+         && (header[1] == (int)(hash >> 32))
+         && (header[2] == (int)(hash & 0xffffffffULL));
+}
+
+static void WriteClusteringCacheBoxArray(amps_File file, BoxArray *box_array)
+{
+  int size = BoxArraySize(box_array);
+
+  amps_WriteInt(file, &size, 1);
+
+  for (int index = 0; index < size; index++)
+  {
+    Box box = BoxArrayGetBox(box_array, index);
+    amps_WriteInt(file, box.lo, DIM);
+    amps_WriteInt(file, box.up, DIM);
+  }
+}
+
+static BoxArray* ReadClusteringCacheBoxArray(amps_File file)
+{
+  int size = -1;
+
+  amps_ReadInt(file, &size, 1);
+
+  if (size < 0)
+  {
+    return NULL;
+  }
+
+  BoxList* boxes = NewBoxList();
+
+  for (int index = 0; index < size; index++)
+  {
+    Box box;
+    BoxClear(&box);
+    amps_ReadInt(file, box.lo, DIM);
+    amps_ReadInt(file, box.up, DIM);
+    BoxListAppend(boxes, &box);
+  }
+
+  BoxArray* box_array = NewBoxArray(boxes);
+  FreeBoxList(boxes);
+
+  return box_array;
+}
+
+/**
+ * Attempt to load the box arrays for the solid from the cache.
+ *
+ * Returns TRUE if all box arrays were loaded.  A trailing copy of the
+ * header guards against using partially written files.
+ */
+static int ReadClusteringCache(GrGeomSolid *geom_solid, ClusteringHash hash)
+{
+  char filename[2048];
+  amps_File file;
+  int loaded;
+
+  ClusteringCacheFilename(filename, hash);
+
+  if ((file = amps_Fopen(filename, "rb")) == NULL)
+  {
+    return FALSE;
+  }
+
+  loaded = ReadClusteringCacheHeader(file, hash);
+
+  if (loaded)
+  {
+    GrGeomSolidInteriorBoxes(geom_solid) = ReadClusteringCacheBoxArray(file);
+    loaded = loaded && GrGeomSolidInteriorBoxes(geom_solid);
+  }
+
+  for (int face = 0; loaded && face < GrGeomOctreeNumFaces; face++)
+  {
+    GrGeomSolidSurfaceBoxes(geom_solid, face) = ReadClusteringCacheBoxArray(file);
+    loaded = loaded && GrGeomSolidSurfaceBoxes(geom_solid, face);
+  }
+
+  for (int patch = 0; loaded && patch < GrGeomSolidNumPatches(geom_solid); patch++)
+  {
+    for (int face = 0; loaded && face < GrGeomOctreeNumFaces; face++)
+    {
+      GrGeomSolidPatchBoxes(geom_solid, patch, face) = ReadClusteringCacheBoxArray(file);
+      loaded = loaded && GrGeomSolidPatchBoxes(geom_solid, patch, face);
+    }
+  }
+
+  loaded = loaded && ReadClusteringCacheHeader(file, hash);
+
+  amps_Fclose(file);
+
+  if (!loaded)
+  {
+    /* Discard anything read from a stale or truncated cache file */
+    if (GrGeomSolidInteriorBoxes(geom_solid))
+    {
+      FreeBoxArray(GrGeomSolidInteriorBoxes(geom_solid));
+      GrGeomSolidInteriorBoxes(geom_solid) = NULL;
+    }
+
+    for (int face = 0; face < GrGeomOctreeNumFaces; face++)
+    {
+      if (GrGeomSolidSurfaceBoxes(geom_solid, face))
+      {
+	FreeBoxArray(GrGeomSolidSurfaceBoxes(geom_solid, face));
+	GrGeomSolidSurfaceBoxes(geom_solid, face) = NULL;
+      }
+
+      for (int patch = 0; patch < GrGeomSolidNumPatches(geom_solid); patch++)
+      {
+	if (GrGeomSolidPatchBoxes(geom_solid, patch, face))
+	{
+	  FreeBoxArray(GrGeomSolidPatchBoxes(geom_solid, patch, face));
+	  GrGeomSolidPatchBoxes(geom_solid, patch, face) = NULL;
+	}
+      }
+    }
+  }
+
+  return loaded;
+}
+
+/**
+ * Store the box arrays for the solid in the cache.
+ */
+static void WriteClusteringCache(GrGeomSolid *geom_solid, ClusteringHash hash)
+{
+  char filename[2048];
+  amps_File file;
+
+  ClusteringCacheFilename(filename, hash);
+
+  if ((file = amps_Fopen(filename, "wb")) == NULL)
+  {
+    amps_Printf("Warning: can't open clustering cache file %s\n", filename);
+    return;
+  }
+
+  WriteClusteringCacheHeader(file, hash);
+
+  WriteClusteringCacheBoxArray(file, GrGeomSolidInteriorBoxes(geom_solid));
+
+  for (int face = 0; face < GrGeomOctreeNumFaces; face++)
+  {
+    WriteClusteringCacheBoxArray(file, GrGeomSolidSurfaceBoxes(geom_solid, face));
+  }
+
+  for (int patch = 0; patch < GrGeomSolidNumPatches(geom_solid); patch++)
+  {
+    for (int face = 0; face < GrGeomOctreeNumFaces; face++)
+    {
+      WriteClusteringCacheBoxArray(file, GrGeomSolidPatchBoxes(geom_solid, patch, face));
+    }
+  }
+
+  WriteClusteringCacheHeader(file, hash);
+
+  amps_Fclose(file);
 }
 
 void ComputeBoxes(GrGeomSolid *geom_solid)
 {
   BeginTiming(ClusteringTimingIndex);
 
-  ComputeInteriorBoxes(geom_solid);
+  Grid *grid =  CreateGrid(GlobalsUserGrid);
+
+  int use_cache = (GlobalsClusteringCacheDirectory != NULL)
+                  && (strlen(GlobalsClusteringCacheDirectory) > 0);
+  ClusteringHash hash = 0;
 
-  ComputeSurfaceBoxes(geom_solid);
+  if (use_cache)
+  {
+    hash = ClusteringCacheKey(geom_solid, grid);
+  }
 
-  for(int patch = 0 ; patch < GrGeomSolidNumPatches(geom_solid); patch++)
+  if (!use_cache || !ReadClusteringCache(geom_solid, hash))
   {
-     ComputePatchBoxes(geom_solid, patch);
+    /*
+     * The indicator vector is shared by the interior, surface and
+     * patch computations to avoid reallocating for each patch.
+     */
+    Vector* indicator =  NewVectorType(grid, 1, num_ghost, vector_cell_centered);
+
+    ComputeInteriorBoxes(geom_solid, indicator);
+
+    ComputeSurfaceBoxes(geom_solid, indicator);
+
+    for(int patch = 0 ; patch < GrGeomSolidNumPatches(geom_solid); patch++)
+    {
+      ComputePatchBoxes(geom_solid, patch, indicator);
+    }
+
+    FreeVector(indicator);
+
+    if (use_cache)
+    {
+      WriteClusteringCache(geom_solid, hash);
+    }
   }
+
+  FreeGrid(grid);
   
   EndTiming(ClusteringTimingIndex);
 }
-
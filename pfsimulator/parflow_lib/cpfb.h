@@ -0,0 +1,60 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+
+#ifndef _CPFB_HEADER
+#define _CPFB_HEADER
+
+/*----------------------------------------------------------------
+ * CPFB block compression methods, stored in the file header and index.
+ * CPFB_DELTA is or'ed into the method of a snapshot (or block) encoded
+ * against the previous snapshot of a time series.
+ *----------------------------------------------------------------*/
+
+#define CPFB_NONE          0
+#define CPFB_LOSSLESS      1
+#define CPFB_ERROR_BOUNDED 2
+#define CPFB_DELTA         4
+
+/*----------------------------------------------------------------
+ * CPFBSeries structure
+ *
+ * Time series of CPFB snapshots of one vector.  reference holds the
+ * last snapshot of each local subgrid as it will be read back, which
+ * the next snapshot is delta encoded against unless it is a keyframe.
+ *----------------------------------------------------------------*/
+
+typedef struct {
+  int keyframe_interval;
+  int num_written;
+  int previous;
+
+  int num_subgrids;
+  double **reference;
+} CPFBSeries;
+
+#endif
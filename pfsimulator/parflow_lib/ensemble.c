@@ -0,0 +1,178 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+/*****************************************************************************
+*
+* Ensemble mode.
+*
+* A single launch of ParFlow can run several realizations (members) of
+* the same problem concurrently.  The processes are split into
+* Ensemble.NumMembers equal groups and each group runs one member on
+* its own communicator.  The input database is read once for all the
+* members; keys of the form
+*
+*    Ensemble.Member.<member>.<key>
+*
+* replace <key> for that member only, so members may differ in random
+* field seeds, forcing files etc.  Member output is written with the run
+* name <runname>.member.<member>.
+*
+*****************************************************************************/
+
+#include "parflow.h"
+
+#include <string.h>
+
+
+typedef struct {
+  char       *prefix;
+  int prefix_len;
+
+  int num_entries;
+  IDB_Entry **entries;
+} EnsembleOverrides;
+
+
+/*--------------------------------------------------------------------------
+ * EnsembleFindOverrides:
+ *   Marks all member keys as used and collects the ones for this member.
+ *--------------------------------------------------------------------------*/
+
+static void EnsembleFindOverrides(void *obj, void *data)
+{
+  IDB_Entry         *entry = (IDB_Entry*)obj;
+  EnsembleOverrides *overrides = (EnsembleOverrides*)data;
+
+  if (strncmp(entry->key, "Ensemble.Member.", 16) == 0)
+  {
+    entry->used = 1;
+  }
+
+  if (strncmp(entry->key, overrides->prefix, overrides->prefix_len) == 0)
+  {
+    if (overrides->entries)
+    {
+      overrides->entries[overrides->num_entries] = entry;
+    }
+    overrides->num_entries++;
+  }
+}
+
+
+/*--------------------------------------------------------------------------
+ * NewEnsemble:
+ *   Splits the processes into the ensemble members and applies the
+ *   member keys to the input database.  Must be called after the input
+ *   database is read and before any other communication.
+ *--------------------------------------------------------------------------*/
+
+void NewEnsemble()
+{
+  IDB               *database = amps_ThreadLocal(input_database);
+  EnsembleOverrides overrides;
+
+  IDB_Entry         *entry;
+  IDB_Entry lookup_entry;
+  IDB_Entry         *result;
+
+  char prefix[IDB_MAX_KEY_LEN];
+  char run_name[256];
+  char num_members_str[32];
+  char member_str[32];
+  int num_members;
+  int member;
+  int i;
+
+  num_members = GetIntDefault("Ensemble.NumMembers", 1);
+
+  member = amps_EnsembleInit(num_members);
+  if (member < 0)
+  {
+    sprintf(num_members_str, "%d", num_members);
+    InputError("Error: Ensemble.NumMembers <%s> must be positive and divide the number of processes%s\n",
+               num_members_str, "");
+  }
+
+  GlobalsEnsembleNumMembers = num_members;
+  GlobalsEnsembleMember = member;
+
+  if (num_members == 1)
+  {
+    return;
+  }
+
+  if (snprintf(run_name, sizeof(run_name), "%s.member.%d",
+               GlobalsRunName, member) >= (int)sizeof(run_name)
+      || snprintf(GlobalsOutFileName, sizeof(GlobalsOutFileName), "%s.%s",
+                  run_name, "out") >= (int)sizeof(GlobalsOutFileName))
+  {
+    sprintf(member_str, "%d", member);
+    InputError("Error: the run name <%s> is too long for ensemble member %s\n",
+               GlobalsRunName, member_str);
+  }
+  snprintf(GlobalsRunName, sizeof(GlobalsRunName), "%s", run_name);
+
+  /*-----------------------------------------------------------------------
+   * Collect this member's keys; the database can not be modified while
+   * it is being traversed.
+   *-----------------------------------------------------------------------*/
+
+  sprintf(prefix, "Ensemble.Member.%d.", member);
+  overrides.prefix = prefix;
+  overrides.prefix_len = strlen(prefix);
+  overrides.num_entries = 0;
+  overrides.entries = NULL;
+
+  HBT_foreach(database, EnsembleFindOverrides, &overrides);
+
+  if (overrides.num_entries)
+  {
+    overrides.entries = ctalloc(IDB_Entry *, overrides.num_entries);
+    overrides.num_entries = 0;
+    HBT_foreach(database, EnsembleFindOverrides, &overrides);
+  }
+
+  for (i = 0; i < overrides.num_entries; i++)
+  {
+    lookup_entry.key = overrides.entries[i]->key + overrides.prefix_len;
+
+    result = (IDB_Entry*)HBT_lookup(database, &lookup_entry);
+
+    if (result)
+    {
+      free(result->value);
+      result->value = strdup(overrides.entries[i]->value);
+    }
+    else
+    {
+      entry = IDB_NewEntry(lookup_entry.key, overrides.entries[i]->value);
+      HBT_insert(database, entry, 0);
+    }
+  }
+
+  tfree(overrides.entries);
+}
@@ -53,6 +53,9 @@ void   NewGlobals(char *run_name)
 
   globals_ptr->logging_level = 0;
 
+  globals_ptr->ensemble_num_members = 1;
+  globals_ptr->ensemble_member = 0;
+
 #ifdef min
 #undef min
 #endif
@@ -109,6 +112,11 @@ void  LogGlobals()
             GlobalsRunName);
     fprintf(log_file, "Logging Level = %d\n",
             GlobalsLoggingLevel);
+    if (GlobalsEnsembleNumMembers > 1)
+    {
+      fprintf(log_file, "Ensemble member = %d of %d\n",
+              GlobalsEnsembleMember, GlobalsEnsembleNumMembers);
+    }
     fprintf(log_file, "Num processes = %d\n",
             GlobalsNumProcs);
     fprintf(log_file, "Process grid = (%d,%d,%d)\n",
@@ -49,6 +49,9 @@ typedef struct _Globals {
 
   int logging_level;
 
+  int ensemble_num_members;   /* number of ensemble members */
+  int ensemble_member;        /* ensemble member of this process */
+
   int num_procs;              /* number of processes */
   int num_procs_x;            /* number of processes in x */
   int num_procs_y;            /* number of processes in y */
@@ -88,6 +91,7 @@ typedef struct _Globals {
   Grid     *grid2d;
 
   int use_clustering;
+  char *clustering_cache_directory;
 
 #ifdef  HAVE_SAMRAI
   SAMRAI::tbox::Pointer < Parflow > parflow_simulation;
@@ -115,6 +119,9 @@ amps_ThreadLocalDcl(extern IDB *, input_database);
 
 #define GlobalsLoggingLevel    (globals->logging_level)
 
+#define GlobalsEnsembleNumMembers (globals->ensemble_num_members)
+#define GlobalsEnsembleMember     (globals->ensemble_member)
+
 #define GlobalsNumProcs        (globals->num_procs)
 #define GlobalsNumProcsX       (globals->num_procs_x)
 #define GlobalsNumProcsY       (globals->num_procs_y)
@@ -144,6 +151,7 @@ amps_ThreadLocalDcl(extern IDB *, input_database);
 #define GlobalsParflowSimulation   (globals->parflow_simulation)
 
 #define GlobalsUseClustering      (globals->use_clustering)
+#define GlobalsClusteringCacheDirectory (globals->clustering_cache_directory)
 
 #define pqr_to_process(p, q, r, P, Q, R)  ((((r) * (Q)) + (q)) * (P) + (p))
 
@@ -571,6 +571,9 @@ void GrGeomOctreeFromTIN(
   int           *ixu_lines, *iyu_lines, *izu_lines;
   int           *nx_lines, *ny_lines, *nz_lines;
   int num_indices, num_triangles;
+  int ixl_min, iyl_min, izl_min;
+  int ixu_max, iyu_max, izu_max;
+  int overlaps;
   int ea_size;
   double dx_lines, dy_lines, dz_lines;
 
@@ -593,9 +596,9 @@ void GrGeomOctreeFromTIN(
   int index;
   int intersects, component, state, start_state;
 
-  double x_lower, y_lower, z_lower;
+  double z_lower;
   double x_center, y_center, z_center;
-  double x_upper, y_upper, z_upper;
+  double z_upper;
   double point;
 
   int p, i, j, k, ie, m, n, level, new_level;
@@ -606,6 +609,8 @@ void GrGeomOctreeFromTIN(
   int patch_list_blocksz = 5;
 
   int           *edge_tag, *triangle_tag;
+  int           *crossed_faces, num_crossed;
+  unsigned char *face_crossed;
   unsigned char *interior_tag;
 
   /*-------------------------------------------------------------
@@ -704,6 +709,19 @@ void GrGeomOctreeFromTIN(
     }
   }
 
+  /* Bounds of the lines over all extents on this process */
+  ixl_min = iyl_min = izl_min = 2 * num_indices + 1;
+  ixu_max = iyu_max = izu_max = -1;
+  for (ie = 0; ie < ea_size; ie++)
+  {
+    ixl_min = pfmin(ixl_min, ixl_lines[ie]);
+    iyl_min = pfmin(iyl_min, iyl_lines[ie]);
+    izl_min = pfmin(izl_min, izl_lines[ie]);
+    ixu_max = pfmax(ixu_max, ixu_lines[ie]);
+    iyu_max = pfmax(iyu_max, iyu_lines[ie]);
+    izu_max = pfmax(izu_max, izu_lines[ie]);
+  }
+
   /*-------------------------------------------------------------
    * Set up the triangle-to-patch mapping (patch_table)
    *-------------------------------------------------------------*/
@@ -791,6 +809,20 @@ void GrGeomOctreeFromTIN(
     tbox_y_upper = pfmax(tbox_y_upper, -1);
     tbox_z_upper = pfmax(tbox_z_upper, -1);
 
+    /*
+     * Skip triangles that can not cross any line on this process.
+     * Lines run through the whole domain along one axis so a
+     * triangle is needed if it overlaps the local extents along at
+     * least two axes.
+     */
+    overlaps = ((tbox_x_upper >= ixl_min - 1) && (tbox_x_lower <= ixu_max + 1))
+               + ((tbox_y_upper >= iyl_min - 1) && (tbox_y_lower <= iyu_max + 1))
+               + ((tbox_z_upper >= izl_min - 1) && (tbox_z_lower <= izu_max + 1));
+    if (overlaps < 2)
+    {
+      continue;
+    }
+
     for (ie = 0; ie < ea_size; ie++)
     {
       /* Intersect bounds with xyz_lines extents */
@@ -917,6 +949,8 @@ void GrGeomOctreeFromTIN(
 
       edge_tag = ctalloc(int, (nz + 1));
       triangle_tag = ctalloc(int, (nz + 1));
+      crossed_faces = talloc(int, (nz + 1));
+      face_crossed = ctalloc(unsigned char, (nz + 1));
       for (j = iy_lower; j <= iy_upper; j++)
       {
         for (i = ix_lower; i <= ix_upper; i++)
@@ -941,65 +975,85 @@ void GrGeomOctreeFromTIN(
             }
           }
 
-          /* Fill in the edge crossing info */
-          edge_tag[0] = 0;
-          triangle_tag[0] = 0;
-          for (k = 0; k < nz; k++)
+          /*
+           * Fill in the edge crossing info.  Only the cells holding
+           * line crossings are visited; each crossing is assigned to
+           * the first cell whose closed interval contains it.
+           */
+          num_crossed = 0;
+          while (current_member != NULL)
           {
-            z_lower = zlower + ((double)k) * dz;
+            point = (ListMemberValue(current_member) - zlower) / dz;
+            k = (int)pfmin(pfmax(point, 0.0), (double)nz);
+            while ((k > 0) && ListValueLEPoint(current_member, zlower + ((double)k) * dz))
+            {
+              k--;
+            }
+            while ((k < nz) && ListValueGTPoint(current_member, zlower + (((double)k) + 1.0) * dz))
+            {
+              k++;
+            }
+            if (k >= nz)
+            {
+              break;
+            }
+
             z_center = zlower + (((double)k) + 0.5) * dz;
-            z_upper = zlower + (((double)k) + 1.0) * dz;
-            edge_tag[k + 1] = 0;
-            triangle_tag[k + 1] = 0;
 
-            if (ListValueLEPoint(current_member, z_upper))
+            if (ListValueGTPoint(current_member, z_center))
             {
-              while (ListValueInClosedInterval(current_member,
-                                               z_lower, z_upper))
+              face_index = k + 1;
+            }
+            else if (ListValueLTPoint(current_member, z_center))
+            {
+              face_index = k;
+            }
+            else
+            {
+              if (component == 1)
               {
-                if (ListValueGTPoint(current_member, z_center))
-                {
-                  face_index = k + 1;
-                }
-                else if (ListValueLTPoint(current_member, z_center))
-                {
-                  face_index = k;
-                }
-                else
-                {
-                  if (component == 1)
-                  {
-                    face_index = k + 1;
-                  }
-                  else if (component == -1)
-                  {
-                    face_index = k;
-                  }
-                }
-                edge_tag[face_index] += component;
+                face_index = k + 1;
+              }
+              else if (component == -1)
+              {
+                face_index = k;
+              }
+            }
+            edge_tag[face_index] += component;
 
-                /* Want nonzero edge_tag with same sign as component */
-                if ((edge_tag[face_index] * component) > 0)
-                {
-                  triangle_tag[face_index] =
-                    ListMemberTriangleID(current_member);
-                }
-                else
-                {
-                  triangle_tag[face_index] = 0;
-                }
-                current_member = ListMemberNextListMember(current_member);
-                if (current_member != NULL)
-                {
-                  component = ListMemberNormalComponent(current_member);
-                }
+            /* Want nonzero edge_tag with same sign as component */
+            if ((edge_tag[face_index] * component) > 0)
+            {
+              triangle_tag[face_index] = ListMemberTriangleID(current_member);
+            }
+            else
+            {
+              triangle_tag[face_index] = 0;
+            }
+
+            /* Keep the crossed faces sorted so faces are added in order */
+            if (!face_crossed[face_index])
+            {
+              face_crossed[face_index] = TRUE;
+              for (m = num_crossed; (m > 0) && (crossed_faces[m - 1] > face_index); m--)
+              {
+                crossed_faces[m] = crossed_faces[m - 1];
               }
+              crossed_faces[m] = face_index;
+              num_crossed++;
+            }
+
+            current_member = ListMemberNextListMember(current_member);
+            if (current_member != NULL)
+            {
+              component = ListMemberNormalComponent(current_member);
             }
           }
 
           /* Add faces using the edge crossing info */
-          for (k = 0; k < (nz + 1); k++)
+          for (m = 0; m < num_crossed; m++)
           {
+            k = crossed_faces[m];
             if (edge_tag[k] != 0)
             {
               GrGeomOctreeAddFace(solid_octree, ZDIRECTION,
@@ -1015,9 +1069,14 @@ void GrGeomOctreeFromTIN(
                                     edge_tag[k]);
               }
             }
+            edge_tag[k] = 0;
+            triangle_tag[k] = 0;
+            face_crossed[k] = FALSE;
           }
         }
       }
+      tfree(face_crossed);
+      tfree(crossed_faces);
       tfree(triangle_tag);
       tfree(edge_tag);
 
@@ -1027,6 +1086,8 @@ void GrGeomOctreeFromTIN(
 
       edge_tag = ctalloc(int, (ny + 1));
       triangle_tag = ctalloc(int, (ny + 1));
+      crossed_faces = talloc(int, (ny + 1));
+      face_crossed = ctalloc(unsigned char, (ny + 1));
       for (k = iz_lower; k <= iz_upper; k++)
       {
         for (i = ix_lower; i <= ix_upper; i++)
@@ -1050,64 +1111,85 @@ void GrGeomOctreeFromTIN(
             }
           }
 
-          /* Fill in the edge crossing info */
-          edge_tag[0] = 0;
-          triangle_tag[0] = 0;
-          for (j = 0; j < ny; j++)
+          /*
+           * Fill in the edge crossing info.  Only the cells holding
+           * line crossings are visited; each crossing is assigned to
+           * the first cell whose closed interval contains it.
+           */
+          num_crossed = 0;
+          while (current_member != NULL)
           {
-            y_lower = ylower + ((double)j) * dy;
+            point = (ListMemberValue(current_member) - ylower) / dy;
+            j = (int)pfmin(pfmax(point, 0.0), (double)ny);
+            while ((j > 0) && ListValueLEPoint(current_member, ylower + ((double)j) * dy))
+            {
+              j--;
+            }
+            while ((j < ny) && ListValueGTPoint(current_member, ylower + (((double)j) + 1.0) * dy))
+            {
+              j++;
+            }
+            if (j >= ny)
+            {
+              break;
+            }
+
             y_center = ylower + (((double)j) + 0.5) * dy;
-            y_upper = ylower + (((double)j) + 1.0) * dy;
 
-            edge_tag[j + 1] = 0;
-            triangle_tag[j + 1] = 0;
-            if (ListValueLEPoint(current_member, y_upper))
+            if (ListValueGTPoint(current_member, y_center))
             {
-              while (ListValueInClosedInterval(current_member,
-                                               y_lower, y_upper))
+              face_index = j + 1;
+            }
+            else if (ListValueLTPoint(current_member, y_center))
+            {
+              face_index = j;
+            }
+            else
+            {
+              if (component == 1)
               {
-                if (ListValueGTPoint(current_member, y_center))
-                {
-                  face_index = j + 1;
-                }
-                else if (ListValueLTPoint(current_member, y_center))
-                {
-                  face_index = j;
-                }
-                else
-                {
-                  if (component == 1)
-                  {
-                    face_index = j + 1;
-                  }
-                  else if (component == -1)
-                  {
-                    face_index = j;
-                  }
-                }
-                edge_tag[face_index] += component;
+                face_index = j + 1;
+              }
+              else if (component == -1)
+              {
+                face_index = j;
+              }
+            }
+            edge_tag[face_index] += component;
 
-                /* Want nonzero edge_tag with same sign as component */
-                if ((edge_tag[face_index] * component) > 0)
-                {
-                  triangle_tag[face_index] = ListMemberTriangleID(current_member);
-                }
-                else
-                {
-                  triangle_tag[face_index] = 0;
-                }
-                current_member = ListMemberNextListMember(current_member);
-                if (current_member != NULL)
-                {
-                  component = ListMemberNormalComponent(current_member);
-                }
+            /* Want nonzero edge_tag with same sign as component */
+            if ((edge_tag[face_index] * component) > 0)
+            {
+              triangle_tag[face_index] = ListMemberTriangleID(current_member);
+            }
+            else
+            {
+              triangle_tag[face_index] = 0;
+            }
+
+            /* Keep the crossed faces sorted so faces are added in order */
+            if (!face_crossed[face_index])
+            {
+              face_crossed[face_index] = TRUE;
+              for (m = num_crossed; (m > 0) && (crossed_faces[m - 1] > face_index); m--)
+              {
+                crossed_faces[m] = crossed_faces[m - 1];
               }
+              crossed_faces[m] = face_index;
+              num_crossed++;
+            }
+
+            current_member = ListMemberNextListMember(current_member);
+            if (current_member != NULL)
+            {
+              component = ListMemberNormalComponent(current_member);
             }
           }
 
           /* Add faces using the edge crossing info */
-          for (j = 0; j < (ny + 1); j++)
+          for (m = 0; m < num_crossed; m++)
           {
+            j = crossed_faces[m];
             if (edge_tag[j] != 0)
             {
               GrGeomOctreeAddFace(solid_octree, YDIRECTION,
@@ -1123,9 +1205,14 @@ void GrGeomOctreeFromTIN(
                                     edge_tag[j]);
               }
             }
+            edge_tag[j] = 0;
+            triangle_tag[j] = 0;
+            face_crossed[j] = FALSE;
           }
         }
       }
+      tfree(face_crossed);
+      tfree(crossed_faces);
       tfree(triangle_tag);
       tfree(edge_tag);
 
@@ -1135,6 +1222,8 @@ void GrGeomOctreeFromTIN(
 
       edge_tag = ctalloc(int, (nx + 1));
       triangle_tag = ctalloc(int, (nx + 1));
+      crossed_faces = talloc(int, (nx + 1));
+      face_crossed = ctalloc(unsigned char, (nx + 1));
       for (k = iz_lower; k <= iz_upper; k++)
       {
         for (j = iy_lower; j <= iy_upper; j++)
@@ -1158,64 +1247,85 @@ void GrGeomOctreeFromTIN(
             }
           }
 
-          /* Fill in the edge crossing info */
-          edge_tag[0] = 0;
-          triangle_tag[0] = 0;
-          for (i = 0; i < nx; i++)
+          /*
+           * Fill in the edge crossing info.  Only the cells holding
+           * line crossings are visited; each crossing is assigned to
+           * the first cell whose closed interval contains it.
+           */
+          num_crossed = 0;
+          while (current_member != NULL)
           {
-            x_lower = xlower + ((double)i) * dx;
+            point = (ListMemberValue(current_member) - xlower) / dx;
+            i = (int)pfmin(pfmax(point, 0.0), (double)nx);
+            while ((i > 0) && ListValueLEPoint(current_member, xlower + ((double)i) * dx))
+            {
+              i--;
+            }
+            while ((i < nx) && ListValueGTPoint(current_member, xlower + (((double)i) + 1.0) * dx))
+            {
+              i++;
+            }
+            if (i >= nx)
+            {
+              break;
+            }
+
             x_center = xlower + (((double)i) + 0.5) * dx;
-            x_upper = xlower + (((double)i) + 1.0) * dx;
 
-            edge_tag[i + 1] = 0;
-            triangle_tag[i + 1] = 0;
-            if (ListValueLEPoint(current_member, x_upper))
+            if (ListValueGTPoint(current_member, x_center))
             {
-              while (ListValueInClosedInterval(current_member,
-                                               x_lower, x_upper))
+              face_index = i + 1;
+            }
+            else if (ListValueLTPoint(current_member, x_center))
+            {
+              face_index = i;
+            }
+            else
+            {
+              if (component == 1)
               {
-                if (ListValueGTPoint(current_member, x_center))
-                {
-                  face_index = i + 1;
-                }
-                else if (ListValueLTPoint(current_member, x_center))
-                {
-                  face_index = i;
-                }
-                else
-                {
-                  if (component == 1)
-                  {
-                    face_index = i + 1;
-                  }
-                  else if (component == -1)
-                  {
-                    face_index = i;
-                  }
-                }
-                edge_tag[face_index] += component;
+                face_index = i + 1;
+              }
+              else if (component == -1)
+              {
+                face_index = i;
+              }
+            }
+            edge_tag[face_index] += component;
 
-                /* Want nonzero edge_tag with same sign as component */
-                if ((edge_tag[face_index] * component) > 0)
-                {
-                  triangle_tag[face_index] = ListMemberTriangleID(current_member);
-                }
-                else
-                {
-                  triangle_tag[face_index] = 0;
-                }
-                current_member = ListMemberNextListMember(current_member);
-                if (current_member != NULL)
-                {
-                  component = ListMemberNormalComponent(current_member);
-                }
+            /* Want nonzero edge_tag with same sign as component */
+            if ((edge_tag[face_index] * component) > 0)
+            {
+              triangle_tag[face_index] = ListMemberTriangleID(current_member);
+            }
+            else
+            {
+              triangle_tag[face_index] = 0;
+            }
+
+            /* Keep the crossed faces sorted so faces are added in order */
+            if (!face_crossed[face_index])
+            {
+              face_crossed[face_index] = TRUE;
+              for (m = num_crossed; (m > 0) && (crossed_faces[m - 1] > face_index); m--)
+              {
+                crossed_faces[m] = crossed_faces[m - 1];
               }
+              crossed_faces[m] = face_index;
+              num_crossed++;
+            }
+
+            current_member = ListMemberNextListMember(current_member);
+            if (current_member != NULL)
+            {
+              component = ListMemberNormalComponent(current_member);
             }
           }
 
           /* Add faces using the edge crossing info */
-          for (i = 0; i < (nx + 1); i++)
+          for (m = 0; m < num_crossed; m++)
           {
+            i = crossed_faces[m];
             if (edge_tag[i] != 0)
             {
               GrGeomOctreeAddFace(solid_octree, XDIRECTION,
@@ -1231,9 +1341,14 @@ void GrGeomOctreeFromTIN(
                                     edge_tag[i]);
               }
             }
+            edge_tag[i] = 0;
+            triangle_tag[i] = 0;
+            face_crossed[i] = FALSE;
           }
         }
       }
+      tfree(face_crossed);
+      tfree(crossed_faces);
       tfree(triangle_tag);
       tfree(edge_tag);
     }
@@ -990,6 +990,34 @@ void HBT_printf(
   _HBT_printf(file, tree->printf, tree->root);
 }
 
+/*===========================================================================*/
+/* Applies a method to each object in order.  Recursive.                     */
+/*===========================================================================*/
+void _HBT_foreach(
+                  void (*method)(void *, void *),
+                  void *       data,
+                  HBT_element *tree)
+{
+  if (tree != NULL)
+  {
+    _HBT_foreach(method, data, tree->left);
+    (*method)(tree->obj, data);
+    _HBT_foreach(method, data, tree->right);
+  }
+}
+
+/*===========================================================================*/
+/* Apply a method to each object in the tree, in the order of the compare    */
+/* method.  The data pointer is passed through to the method.                */
+/*===========================================================================*/
+void HBT_foreach(
+                 HBT * tree,
+                 void (*method)(void *, void *),
+                 void *data)
+{
+  _HBT_foreach(method, data, tree->root);
+}
+
 /*===========================================================================*/
 /* Scan the current contents of the tree.                                   */
 /*===========================================================================*/
@@ -34,6 +34,12 @@
 #include "parflow.h"
 
 
+/*--------------------------------------------------------------------------
+ * Macros
+ *--------------------------------------------------------------------------*/
+
+#define LINE_PROC_BLOCK 64
+
 /*--------------------------------------------------------------------------
  * LineProc
  *--------------------------------------------------------------------------*/
@@ -89,3 +95,158 @@ void  LineProc(
     }
   }
 }
+
+
+/*--------------------------------------------------------------------------
+ * LineProcModes:
+ *   Draw the spectral modes of one line process.  The random numbers
+ *   are consumed in the same order as LineProc so a line built from
+ *   these modes sees the same phases and frequencies.
+ *--------------------------------------------------------------------------*/
+
+void  LineProcModes(
+                    double *phase,
+                    double *freq,
+                    double *amp,
+                    double  Kmax,
+                    double  dK)
+{
+  double pi = acos(-1.0);
+
+  int M;
+  double dk;
+  double kj, S1;
+
+  int j;
+
+  /* compute M and dk */
+  M = (int)(Kmax / dK);
+  dk = dK;
+
+  for (j = 0; j < M; j++)
+  {
+    phase[j] = 2.0 * pi * Rand();
+    kj = dk * (j + 0.5);
+
+    freq[j] = kj + (dk / 20.0) * (2.0 * (Rand() - 0.5));
+
+    S1 = (2.0 * kj * kj) / (pi * (kj * kj + 1.0) * (kj * kj + 1.0));
+
+    amp[j] = 2.0 * sqrt(S1 * dk);
+  }
+}
+
+
+/*--------------------------------------------------------------------------
+ * LineProcModesCounter:
+ *   Draw the spectral modes of line `line' from the counter-based
+ *   generator.  The modes of each line are independent of every other
+ *   line, so the lines may be drawn in any order.  The mode draws use
+ *   k = 1 in the counter; k = 0 is left for the line direction.
+ *--------------------------------------------------------------------------*/
+
+void  LineProcModesCounter(
+                           double *phase,
+                           double *freq,
+                           double *amp,
+                           double  Kmax,
+                           double  dK,
+                           int     seed,
+                           int     line)
+{
+  double pi = acos(-1.0);
+
+  int M;
+  double dk;
+  double kj, S1;
+
+  int j;
+
+  /* compute M and dk */
+  M = (int)(Kmax / dK);
+  dk = dK;
+
+  for (j = 0; j < M; j++)
+  {
+    phase[j] = 2.0 * pi * CounterRand(seed, line, j, 0, 1);
+    kj = dk * (j + 0.5);
+
+    freq[j] = kj + (dk / 20.0) * (2.0 * (CounterRand(seed, line, j, 1, 1) - 0.5));
+
+    S1 = (2.0 * kj * kj) / (pi * (kj * kj + 1.0) * (kj * kj + 1.0));
+
+    amp[j] = 2.0 * sqrt(S1 * dk);
+  }
+}
+
+
+/*--------------------------------------------------------------------------
+ * LineProcSynthesize:
+ *   Evaluate the line process for zeta indices izeta to izeta+nzeta-1.
+ *
+ *   The line is cut into blocks of LINE_PROC_BLOCK points aligned on
+ *   multiples of the block size in absolute zeta index.  Each mode is
+ *   evaluated exactly at the block starts and rotated through the block
+ *   with a per-mode table, so the inner loop has no trig calls and the
+ *   value at a given zeta index does not depend on izeta.  Any two
+ *   ranges that overlap therefore agree bitwise on the overlap.
+ *--------------------------------------------------------------------------*/
+
+void  LineProcSynthesize(
+                         double *Z,
+                         double *phase,
+                         double *freq,
+                         double *amp,
+                         int     num_modes,
+                         double  dzeta,
+                         int     izeta,
+                         int     nzeta)
+{
+  double cos_table[LINE_PROC_BLOCK];
+  double sin_table[LINE_PROC_BLOCK];
+
+  double c, s, zeta;
+
+  int b, b_lo, b_hi;
+  int n, n_lo, n_hi;
+  int i, j, m;
+
+  /* initialize Z */
+  for (i = 0; i < nzeta; i++)
+    Z[i] = 0.0;
+
+  if (nzeta <= 0)
+    return;
+
+  /* blocks holding the first and last points, rounding toward -inf */
+  b_lo = (izeta >= 0) ? izeta / LINE_PROC_BLOCK :
+         -((-izeta + LINE_PROC_BLOCK - 1) / LINE_PROC_BLOCK);
+  n = izeta + nzeta - 1;
+  b_hi = (n >= 0) ? n / LINE_PROC_BLOCK :
+         -((-n + LINE_PROC_BLOCK - 1) / LINE_PROC_BLOCK);
+
+  for (j = 0; j < num_modes; j++)
+  {
+    for (m = 0; m < LINE_PROC_BLOCK; m++)
+    {
+      cos_table[m] = amp[j] * cos(freq[j] * (m * dzeta));
+      sin_table[m] = amp[j] * sin(freq[j] * (m * dzeta));
+    }
+
+    for (b = b_lo; b <= b_hi; b++)
+    {
+      zeta = (b * LINE_PROC_BLOCK) * dzeta;
+      c = cos(freq[j] * zeta + phase[j]);
+      s = sin(freq[j] * zeta + phase[j]);
+
+      n_lo = pfmax(b * LINE_PROC_BLOCK, izeta);
+      n_hi = pfmin((b + 1) * LINE_PROC_BLOCK, izeta + nzeta);
+
+      for (n = n_lo; n < n_hi; n++)
+      {
+        m = n - b * LINE_PROC_BLOCK;
+        Z[n - izeta] += c * cos_table[m] - s * sin_table[m];
+      }
+    }
+  }
+}
@@ -45,6 +45,7 @@
 #include "info_header.h"
 #include "general.h"
 #include "file_versions.h"
+#include "cpfb.h"
 #include "input_database.h"
 #include "logging.h"
 #include "timing.h"
@@ -41,10 +41,14 @@ void WritePFNC(char * file_prefix, char* file_postfix, double t, Vector  *v, int
 void CreateNCFile(char *file_name, int *netCDFIDs);
 void NCDefDimensions(Vector *v, int dimensionality, int *netCDFIDs);
 void CloseNC(int ncID);
+void NCDefVarStorage(int ncID, int varID, varNCData *myVarNCData);
 int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs);
 void PutDataInNC(int varID, Vector *v, double t, varNCData *myVarNCData, int dimensionality, int *netCDFIDs);
 void find_variable_length(int nid, int varid, long dim_lengths[MAX_NC_VARS]);
 void CreateNCFileNode(char *file_name, Vector *v, int *netCDFIDs);
+#ifdef PARFLOW_HAVE_NETCDF
+MPI_Info NCCreateInfo(void);
+#endif
 void PutDataInNCNode(int varID, double *data_nc_node, int *nodeXIndices, int *nodeYIndices, int *nodeZIndices,
                      int *nodeXCount, int *nodeYCount, int *nodeZCount, double t, varNCData *myVarNCData, int *netCDFIDs);
 void ReadPFNC(char *fileName, Vector *v, char *varName, int tStep, int dimensionality);
@@ -270,6 +270,7 @@ void *HBT_successor(HBT *tree, void *obj);
 
 void HBT_printf(FILE *file, HBT *tree);
 void HBT_scanf(FILE *file, HBT *tree);
+void HBT_foreach(HBT *tree, void (*method)(void *, void *), void *data);
 
 /* infinity_norm.c */
 double InfinityNorm(Vector *x);
@@ -355,6 +356,9 @@ int L2ErrorNormSizeOfTempData(void);
 
 /* line_process.c */
 void LineProc(double *Z, double phi, double theta, double dzeta, int izeta, int nzeta, double Kmax, double dK);
+void LineProcModes(double *phase, double *freq, double *amp, double Kmax, double dK);
+void LineProcModesCounter(double *phase, double *freq, double *amp, double Kmax, double dK, int seed, int line);
+void LineProcSynthesize(double *Z, double *phase, double *freq, double *amp, int num_modes, double dzeta, int izeta, int nzeta);
 
 /* logging.c */
 void NewLogging(void);
@@ -988,6 +992,8 @@ int YSlopeSizeOfTempData(void);
 /* random.c */
 void SeedRand(int seed);
 double Rand(void);
+void Philox4x32(unsigned int ctr[4], unsigned int key[2], unsigned int out[4]);
+double CounterRand(int seed, int stream, int i, int j, int k);
 
 /* ratqr.c */
 int ratqr_(int *n, double *eps1, double *d, double *e, double *e2, int *m, double *w, int *ind, double *bd, int *type, int *idef, int *ierr);
@@ -1087,6 +1093,11 @@ PFModule *SetProblemDataNewPublicXtra(void);
 void SetProblemDataFreePublicXtra(void);
 int SetProblemDataSizeOfTempData(void);
 
+/* setup_cache.c */
+unsigned long long SetupCacheHash(void);
+int SetupCacheLoad(char *directory, unsigned long long hash, int num_vectors, Vector **vectors);
+void SetupCacheStore(char *directory, unsigned long long hash, int num_vectors, Vector **vectors);
+
 /* sim_shear.c */
 double **SimShear(double **shear_min_ptr, double **shear_max_ptr, GeomSolid *geom_solid, SubgridArray *subgrids, int type);
 
@@ -1143,6 +1154,7 @@ typedef PFModule *(*SubsrfSimInitInstanceXtraInvoke) (Grid *grid, double *temp_d
 
 /* subsrf_sim.c */
 void SubsrfSim(ProblemData *problem_data, Vector *perm_x, Vector *perm_y, Vector *perm_z, int num_geounits, GeomSolid **geounits, GrGeomSolid **gr_geounits);
+void SubsrfSimWellPermeability(ProblemData *problem_data, Vector *perm_x, Vector *perm_y, Vector *perm_z);
 PFModule *SubsrfSimInitInstanceXtra(Grid *grid, double *temp_data);
 void SubsrfSimFreeInstanceXtra(void);
 PFModule *SubsrfSimNewPublicXtra(void);
@@ -1162,6 +1174,7 @@ void FreeGlobalTimeCycleData(void);
 #if defined(PF_TIMING)
 void NewTiming(void);
 int RegisterTiming(char *name);
+void RecordTimingStep(int step, double time);
 void PrintTiming(void);
 void FreeTiming(void);
 #endif
@@ -1267,6 +1280,8 @@ WellData *NewWellData(void);
 void FreeWellData(WellData *well_data);
 void PrintWellData(WellData *well_data, unsigned int print_mask);
 void WriteWells(char *file_prefix, Problem *problem, WellData *well_data, double time, int write_header);
+WellIndex *NewWellIndex(WellData *well_data, Grid *grid, Vector *perm_x, Vector *perm_y, Vector *perm_z);
+void FreeWellIndex(WellIndex *well_index);
 
 typedef void (*WellPackageInvoke) (ProblemData *problem_data);
 typedef PFModule *(*WellPackageNewPublicXtraInvoke) (int num_phases, int num_contaminants);
@@ -1290,6 +1305,14 @@ long SizeofPFSBinarySubvector(Subvector *subvector, Subgrid *subgrid, double dro
 void WritePFSBinary_Subvector(amps_File file, Subvector *subvector, Subgrid *subgrid, double drop_tolerance);
 void WritePFSBinary(char *file_prefix, char *file_suffix, Vector *v, double drop_tolerance);
 
+/* write_parflow_cpfb.c */
+int CPFBCompression(double *tolerance, int *level);
+int CPFBEncode(double *values, double *reference, int n, int method, double tolerance, int level, unsigned char **buffer, int *nbytes, double *recon);
+CPFBSeries *NewCPFBSeries(void);
+void FreeCPFBSeries(CPFBSeries *series);
+void WritePFCBinary(char *file_prefix, char *file_suffix, Vector *v, int method, double tolerance, int level, CPFBSeries *series, int file_number);
+void WritePFBinarySeries(char *file_prefix, char *file_suffix, int file_number, Vector *v, CPFBSeries *series);
+
 /* write_parflow_silo.c */
 void WriteSilo(char *  file_prefix,
                char *  file_type,
@@ -1350,6 +1373,9 @@ void ComputeTop(Problem *    problem,
 
 int CheckTime(Problem *problem, char *key, double time);
 
+/* ensemble.c */
+void NewEnsemble(void);
+
 /* evaptranssum.c */
 void EvapTransSum(ProblemData *problem_data, double dt, Vector *evap_trans_sum, Vector *evap_trans);
 
@@ -290,7 +290,7 @@ PFModule  *PFMGInitInstanceXtra(
     }
 
     /* Set the HYPRE grid */
-    HYPRE_StructGridCreate(MPI_COMM_WORLD, 3, &(instance_xtra->hypre_grid));
+    HYPRE_StructGridCreate(amps_CommWorld, 3, &(instance_xtra->hypre_grid));
 
     /* Set local grid extents as global grid values */
     ForSubgridI(sg, GridSubgrids(grid))
@@ -344,7 +344,7 @@ PFModule  *PFMGInitInstanceXtra(
     symmetric = MatrixSymmetric(pf_Bmat);
     if (!(instance_xtra->hypre_mat))
     {
-      HYPRE_StructMatrixCreate(MPI_COMM_WORLD, instance_xtra->hypre_grid,
+      HYPRE_StructMatrixCreate(amps_CommWorld, instance_xtra->hypre_grid,
                                instance_xtra->hypre_stencil,
                                &(instance_xtra->hypre_mat));
       HYPRE_StructMatrixSetNumGhost(instance_xtra->hypre_mat, full_ghosts);
@@ -355,7 +355,7 @@ PFModule  *PFMGInitInstanceXtra(
     /* Set up new right-hand-side vector */
     if (!(instance_xtra->hypre_b))
     {
-      HYPRE_StructVectorCreate(MPI_COMM_WORLD,
+      HYPRE_StructVectorCreate(amps_CommWorld,
                                instance_xtra->hypre_grid,
                                &(instance_xtra->hypre_b));
       HYPRE_StructVectorSetNumGhost(instance_xtra->hypre_b, no_ghosts);
@@ -365,7 +365,7 @@ PFModule  *PFMGInitInstanceXtra(
     /* Set up new solution vector */
     if (!(instance_xtra->hypre_x))
     {
-      HYPRE_StructVectorCreate(MPI_COMM_WORLD,
+      HYPRE_StructVectorCreate(amps_CommWorld,
                                instance_xtra->hypre_grid,
                                &(instance_xtra->hypre_x));
       HYPRE_StructVectorSetNumGhost(instance_xtra->hypre_x, full_ghosts);
@@ -635,7 +635,7 @@ PFModule  *PFMGInitInstanceXtra(
     EndTiming(public_xtra->time_index_copy_hypre);
 
     /* Set up the PFMG preconditioner */
-    HYPRE_StructPFMGCreate(MPI_COMM_WORLD,
+    HYPRE_StructPFMGCreate(amps_CommWorld,
                            &(instance_xtra->hypre_pfmg_data));
 
     HYPRE_StructPFMGSetTol(instance_xtra->hypre_pfmg_data, 1.0e-30);
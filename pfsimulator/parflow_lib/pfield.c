@@ -37,6 +37,18 @@
 
 #include "parflow.h"
 
+#include <string.h>
+
+/*--------------------------------------------------------------------------
+ * PFieldCompareInt: qsort comparison for the conditioning point indices
+ *--------------------------------------------------------------------------*/
+
+static int PFieldCompareInt(const void *a, const void *b)
+{
+  return *(const int*)a - *(const int*)b;
+}
+
+
 /*--------------------------------------------------------------------------
  * PField
  *--------------------------------------------------------------------------*/
@@ -110,6 +122,21 @@ void         PField(
   /* Conditioning data variables */
   int       *ci, *cj, *ck;      /* Indices for conditioning data points */
 
+  /* Buckets of conditioning data points for the neighbor search */
+  int bx0, by0, bz0;            /* Index of the first bucket */
+  int bsx, bsy, bsz;            /* Bucket size */
+  int nbx, nby, nbz;            /* Number of buckets */
+  int       *bucket_start;      /* Start of each bucket in bucket_pts */
+  int       *bucket_pts;        /* Points sorted by bucket, then index */
+  int bi, bj, bk, bilo, bjlo, bklo, bihi, bjhi, bkhi;
+  int b_idx;
+  int       *cand;              /* Candidate points near a node */
+  int ncand;
+
+  /* The factored kriging matrix of the last node */
+  int       *A_array;           /* Points in the factored matrix */
+  int A_cpts;                   /* Number of points, -1 if none */
+
   (void)geounit;
 
   /*-----------------------------------------------------------------------
@@ -141,6 +168,8 @@ void         PField(
   ck = ctalloc(int, nc);
   i_array = ctalloc(int, nc);
   v_sub = ctalloc(double, nc);
+  cand = ctalloc(int, nc);
+  A_array = ctalloc(int, nc);
 
   /*-----------------------------------------------------------------------
    * Compute correlation lookup table
@@ -269,15 +298,72 @@ void         PField(
 
     if (nc_sub)
     {
+      /* Sort the points into buckets one correlation length wide so
+       * only the neighboring buckets are searched for each node. The
+       * points in a bucket stay in index order. */
+      bsx = iLx + 1;
+      bsy = iLy + 1;
+      bsz = iLz + 1;
+      bx0 = ix - max_search_radius;
+      by0 = iy - max_search_radius;
+      bz0 = iz - max_search_radius;
+      nbx = (nx + 2 * max_search_radius) / bsx + 1;
+      nby = (ny + 2 * max_search_radius) / bsy + 1;
+      nbz = (nz + 2 * max_search_radius) / bsz + 1;
+
+      bucket_start = ctalloc(int, nbx * nby * nbz + 1);
+      bucket_pts = ctalloc(int, nc_sub);
+
+      for (n = 0; n < nc_sub; n++)
+      {
+        b_idx = ((ci[n] - bx0) / bsx)
+                + ((cj[n] - by0) / bsy + ((ck[n] - bz0) / bsz) * nby) * nbx;
+        bucket_start[b_idx + 1]++;
+      }
+      for (m = 0; m < nbx * nby * nbz; m++)
+        bucket_start[m + 1] += bucket_start[m];
+      for (n = 0; n < nc_sub; n++)
+      {
+        b_idx = ((ci[n] - bx0) / bsx)
+                + ((cj[n] - by0) / bsy + ((ck[n] - bz0) / bsz) * nby) * nbx;
+        bucket_pts[bucket_start[b_idx]++] = n;
+      }
+      for (m = nbx * nby * nbz; m > 0; m--)
+        bucket_start[m] = bucket_start[m - 1];
+      bucket_start[0] = 0;
+
+      A_cpts = -1;
+
       GrGeomInLoop(i, j, k, gr_geounit, ref, ix, iy, iz, nx, ny, nz,
       {
         index1 = SubvectorEltIndex(sub_field, i, j, k);
 
+        /* Gather the points in the buckets within a correlation
+         * length of this node, in index order */
+        bilo = pfmax(i - iLx - bx0, 0) / bsx;
+        bjlo = pfmax(j - iLy - by0, 0) / bsy;
+        bklo = pfmax(k - iLz - bz0, 0) / bsz;
+        bihi = pfmin((i + iLx - bx0) / bsx, nbx - 1);
+        bjhi = pfmin((j + iLy - by0) / bsy, nby - 1);
+        bkhi = pfmin((k + iLz - bz0) / bsz, nbz - 1);
+
+        ncand = 0;
+        for (bk = bklo; bk <= bkhi; bk++)
+          for (bj = bjlo; bj <= bjhi; bj++)
+            for (bi = bilo; bi <= bihi; bi++)
+            {
+              b_idx = bi + (bj + bk * nby) * nbx;
+              for (m = bucket_start[b_idx]; m < bucket_start[b_idx + 1]; m++)
+                cand[ncand++] = bucket_pts[m];
+            }
+        qsort(cand, ncand, sizeof(int), PFieldCompareInt);
+
         /* Construct the input matrix and vector for kriging */
         cpts = 0;
-        n = 0;
-        while (n < nc_sub)
+        nn = 0;
+        while (nn < ncand)
         {
+          n = cand[nn];
           di = abs(i - ci[n]);
           dj = abs(j - cj[n]);
           dk = abs(k - ck[n]);
@@ -285,7 +371,7 @@ void         PField(
           if ((di + dj + dk) == 0)    /* that is, if di=dj=dk=0 */
           {
             fieldp[index1] = v_sub[n];
-            n = nc_sub;
+            nn = ncand;
             cpts = 0;
           }
 
@@ -296,20 +382,33 @@ void         PField(
             b[cpts++] = cov[di][dj][dk];
           }
 
-          n++;
+          nn++;
         }
 
         if (cpts > 0)
         {
-          nn = 0;
-          for (n = 0; n < cpts; n++)
-            for (m = 0; m < cpts; m++)
-            {
-              di = abs(ci[i_array[n]] - ci[i_array[m]]);
-              dj = abs(cj[i_array[n]] - cj[i_array[m]]);
-              dk = abs(ck[i_array[n]] - ck[i_array[m]]);
-              A[nn++] = cov[di][dj][dk];
-            }
+          /* Neighboring nodes usually see the same conditioning
+           * points, so the factored matrix of the last node is
+           * reused when it was built from the same points */
+          if ((cpts != A_cpts) ||
+              (memcmp(i_array, A_array, cpts * sizeof(int)) != 0))
+          {
+            nn = 0;
+            for (n = 0; n < cpts; n++)
+              for (m = 0; m < cpts; m++)
+              {
+                di = abs(ci[i_array[n]] - ci[i_array[m]]);
+                dj = abs(cj[i_array[n]] - cj[i_array[m]]);
+                dk = abs(ck[i_array[n]] - ck[i_array[m]]);
+                A[nn++] = cov[di][dj][dk];
+              }
+
+            dpofa_(A, &cpts, &cpts, &ierr);
+
+            for (n = 0; n < cpts; n++)
+              A_array[n] = i_array[n];
+            A_cpts = cpts;
+          }
 
           /* Solve the linear system and compute the
            * conditional mean and standard deviation
@@ -319,7 +418,6 @@ void         PField(
           for (n = 0; n < cpts; n++)
             w[n] = b[n];
 
-          dpofa_(A, &cpts, &cpts, &ierr);
           dposl_(A, &cpts, &cpts, w);
 
           for (m = 0; m < cpts; m++)
@@ -332,6 +430,9 @@ void         PField(
           fieldp[index1] = cmean + csigma * fieldp[index1];
         }     /* if(cpts ...  */
       });    /* GrGeomInLoop */
+
+      tfree(bucket_start);
+      tfree(bucket_pts);
     }   /* if(nc_sub) */
   }  /* gridloop */
      /*-----------------------------------------------------------------------
@@ -350,6 +451,8 @@ void         PField(
   tfree(b);
   tfree(w);
   tfree(value);
+  tfree(cand);
+  tfree(A_array);
 }
 
 
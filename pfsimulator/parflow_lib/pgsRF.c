@@ -38,6 +38,15 @@
 
 #include <limits.h>
 #include <float.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------------
+ * Macros
+ *--------------------------------------------------------------------------*/
+
+/* Number of entries in the per template cache of kriging weights for
+ * external conditioning data patterns. */
+#define PGS_KRIGE_CACHE_SIZE 64
 
 /*--------------------------------------------------------------------------
  * Structures
@@ -58,6 +67,7 @@ typedef struct {
   int max_search_rad;
   int max_npts;
   int max_cpts;
+  int rng;
 } PublicXtra;
 
 typedef struct {
@@ -66,6 +76,30 @@ typedef struct {
 } InstanceXtra;
 
 
+/*--------------------------------------------------------------------------
+ * PGSCondCount: number of conditioning data points in the box
+ * [a0,a1] x [b0,b1] x [c0,c1] (local tmpRF indices) from the summed
+ * area table count, which has strides 1, sx and sxy.
+ *--------------------------------------------------------------------------*/
+
+static int PGSCondCount(int *count, int sx, int sxy,
+                        int a0, int a1, int b0, int b1, int c0, int c1)
+{
+  a1++;
+  b1++;
+  c1++;
+
+  return count[a1 + b1 * sx + c1 * sxy]
+         - count[a0 + b1 * sx + c1 * sxy]
+         - count[a1 + b0 * sx + c1 * sxy]
+         - count[a1 + b1 * sx + c0 * sxy]
+         + count[a0 + b0 * sx + c1 * sxy]
+         + count[a0 + b1 * sx + c0 * sxy]
+         + count[a1 + b0 * sx + c0 * sxy]
+         - count[a0 + b0 * sx + c0 * sxy];
+}
+
+
 /*--------------------------------------------------------------------------
  * PGSRF
  *--------------------------------------------------------------------------*/
@@ -163,6 +197,20 @@ void         PGSRF(
   /* Conditioning data variables */
   int cpts;                     /* N cond pts for a single simulated node */
   double    *cval;              /* Values for cond data for single node */
+  int       *cond_count;        /* Summed area count of cond data in tmpRF */
+  int sx, sxy;                  /* Strides of cond_count */
+  int ci, cj, ck;               /* Local tmpRF indices of a node */
+  int       *nbr_offset;        /* tmpRF offsets of the simulated neighbors */
+
+  /* Kriging weights cached by external conditioning pattern */
+  int       *kc_cpts;           /* Number of cond pts, 0 if entry is empty */
+  int       **kc_pts;           /* Cond pt positions in the template */
+  double    **kc_w;             /* Weights of the simulated points, w_tmp */
+  double    **kc_b;             /* Covariance vector b */
+  double    **kc_b2;            /* Weights of the cond pts, b2 */
+  int       *kc_key;            /* Cond pt positions of the current node */
+  unsigned int kc_hash;
+  int kc;
 
   /* Communications */
   VectorUpdateCommHandle *handle;
@@ -337,6 +385,21 @@ void         PGSRF(
   ixx = ctalloc(int, nLxyz);
   iyy = ctalloc(int, nLxyz);
   izz = ctalloc(int, nLxyz);
+  nbr_offset = ctalloc(int, nLxyz);
+
+  kc_cpts = ctalloc(int, PGS_KRIGE_CACHE_SIZE);
+  kc_pts = ctalloc(int*, PGS_KRIGE_CACHE_SIZE);
+  kc_w = ctalloc(double*, PGS_KRIGE_CACHE_SIZE);
+  kc_b = ctalloc(double*, PGS_KRIGE_CACHE_SIZE);
+  kc_b2 = ctalloc(double*, PGS_KRIGE_CACHE_SIZE);
+  for (i = 0; i < PGS_KRIGE_CACHE_SIZE; i++)
+  {
+    kc_pts[i] = ctalloc(int, 3 * nLxyz);
+    kc_w[i] = ctalloc(double, nLxyz);
+    kc_b[i] = ctalloc(double, nLxyz);
+    kc_b2[i] = ctalloc(double, nLxyz);
+  }
+  kc_key = ctalloc(int, 3 * nLxyz);
 
   /* Allocate space for the "marker" used to keep track of which
    * points in a representative correlation box have been simulated
@@ -466,6 +529,30 @@ void         PGSRF(
       }
     }
 
+    /* Summed area count of the conditioning data in tmpRF, including
+     * the ghost layer, so nodes with no conditioning data within their
+     * search neighborhood skip the scan for it. Only simulated nodes,
+     * which are tracked by the marker, are added to tmpRF after this
+     * point. */
+    sx = nx_v2 + 1;
+    sxy = sx * (ny_v2 + 1);
+    cond_count = ctalloc(int, sxy * (nz_v2 + 1));
+    for (k = 1; k <= nz_v2; k++)
+      for (j = 1; j <= ny_v2; j++)
+        for (i = 1; i <= nx_v2; i++)
+        {
+          index3 = (i - 1) + ((j - 1) + (k - 1) * ny_v2) * nx_v2;
+          cond_count[i + j * sx + k * sxy] =
+            (fabs(tmpRFp[index3]) > Tiny)
+            + cond_count[(i - 1) + j * sx + k * sxy]
+            + cond_count[i + (j - 1) * sx + k * sxy]
+            + cond_count[i + j * sx + (k - 1) * sxy]
+            - cond_count[(i - 1) + (j - 1) * sx + k * sxy]
+            - cond_count[(i - 1) + j * sx + (k - 1) * sxy]
+            - cond_count[i + (j - 1) * sx + (k - 1) * sxy]
+            + cond_count[(i - 1) + (j - 1) * sx + (k - 1) * sxy];
+        }
+
     /* Set the search radii in each direction. If the maximum
      * number of points in a neighborhood is exceeded, these limits
      * will be reduced. */
@@ -596,6 +683,17 @@ void         PGSRF(
           }
         }
 
+        /* Offsets of the simulated points from a node in tmpRF, in
+         * the order of the search neighborhood loop below */
+        for (m = 0; m < npts; m++)
+          nbr_offset[m] = (ixx[m] - rpx)
+                          + ((iyy[m] - rpy) + (izz[m] - rpz) * ny_v2) * nx_v2;
+
+        /* The conditioning patterns cached for the last template used
+         * a different set of simulated points */
+        for (m = 0; m < PGS_KRIGE_CACHE_SIZE; m++)
+          kc_cpts[m] = 0;
+
         /* Solve the linear system */
         for (i = 0; i < npts; i++)
           w[i] = b[i];
@@ -639,30 +737,47 @@ void         PGSRF(
                 m = 0;
                 cpts = 0;
 
-                for (kk = -k_search; kk <= k_search; kk++)
-                  for (jj = -j_search; jj <= j_search; jj++)
-                    for (ii = -i_search; ii <= i_search; ii++)
-                    {
-                      value[m] = 0.0;
-                      index3 = SubvectorEltIndex(sub_tmpRF, i + ii, j + jj, k + kk);
+                ci = i - SubvectorIX(sub_tmpRF);
+                cj = j - SubvectorIY(sub_tmpRF);
+                ck = k - SubvectorIZ(sub_tmpRF);
 
-                      if (marker[ii + rpx][jj + rpy][kk + rpz])
+                if (PGSCondCount(cond_count, sx, sxy,
+                                 ci - i_search, ci + i_search,
+                                 cj - j_search, cj + j_search,
+                                 ck - k_search, ck + k_search) == 0)
+                {
+                  /* No external conditioning data in the search
+                   * neighborhood, only the simulated points contribute */
+                  for (m = 0; m < npts; m++)
+                    value[m] = tmpRFp[index2 + nbr_offset[m]];
+                }
+                else
+                {
+                  for (kk = -k_search; kk <= k_search; kk++)
+                    for (jj = -j_search; jj <= j_search; jj++)
+                      for (ii = -i_search; ii <= i_search; ii++)
                       {
-                        value[m++] = tmpRFp[index3];
-                      }
+                        value[m] = 0.0;
+                        index3 = SubvectorEltIndex(sub_tmpRF, i + ii, j + jj, k + kk);
 
-                      /* In this case, there is a value at this point,
-                       * but it wasn't simulated yet (as indicated by the
-                       * fact that the marker has no place for it). Thus,
-                       * it must be external conditioning data.  */
-                      else if (fabs(tmpRFp[index3]) > Tiny)
-                      {
-                        ixx[npts + cpts] = rpx + ii;
-                        iyy[npts + cpts] = rpy + jj;
-                        izz[npts + cpts] = rpz + kk;
-                        cval[cpts++] = tmpRFp[index3];
+                        if (marker[ii + rpx][jj + rpy][kk + rpz])
+                        {
+                          value[m++] = tmpRFp[index3];
+                        }
+
+                        /* In this case, there is a value at this point,
+                         * but it wasn't simulated yet (as indicated by the
+                         * fact that the marker has no place for it). Thus,
+                         * it must be external conditioning data.  */
+                        else if (fabs(tmpRFp[index3]) > Tiny)
+                        {
+                          ixx[npts + cpts] = rpx + ii;
+                          iyy[npts + cpts] = rpy + jj;
+                          izz[npts + cpts] = rpz + kk;
+                          cval[cpts++] = tmpRFp[index3];
+                        }
                       }
-                    }
+                }
 
                 /* If cpts is too large, reduce the size of the
                  * search neighborhood, one axis at a time. */
@@ -712,88 +827,126 @@ void         PGSRF(
                  *--------------------------------------------------*/
                 if (cpts > 0)
                 {
-                  /* Compute the submatrices */
-                  for (j2 = 0; j2 < npts + cpts; j2++)
+                  /* The kriging system depends only on the positions of
+                   * the conditioning points relative to the node, so
+                   * nodes in this template that see the same pattern of
+                   * external data reuse its solution. */
+                  kc_hash = (unsigned int)cpts;
+                  for (i2 = 0; i2 < cpts; i2++)
                   {
-                    di = abs(rpx - ixx[j2]);
-                    dj = abs(rpy - iyy[j2]);
-                    dk = abs(rpz - izz[j2]);
-                    b[j2] = cov[di][dj][dk];
+                    kc_key[3 * i2] = ixx[npts + i2];
+                    kc_key[3 * i2 + 1] = iyy[npts + i2];
+                    kc_key[3 * i2 + 2] = izz[npts + i2];
+                    kc_hash = kc_hash * 31u + (unsigned int)(ixx[npts + i2]
+                                                             + nLx * (iyy[npts + i2] + nLy * izz[npts + i2]));
+                  }
+                  kc = (int)(kc_hash % PGS_KRIGE_CACHE_SIZE);
 
+                  if ((kc_cpts[kc] == cpts) &&
+                      (memcmp(kc_pts[kc], kc_key, 3 * cpts * sizeof(int)) == 0))
+                  {
+                    for (i2 = 0; i2 < npts; i2++)
+                      w_tmp[i2] = kc_w[kc][i2];
+                    for (i2 = 0; i2 < cpts; i2++)
+                      b2[i2] = kc_b2[kc][i2];
                     for (i2 = 0; i2 < npts + cpts; i2++)
-                    {
-                      di = abs(ixx[i2] - ixx[j2]);
-                      dj = abs(iyy[i2] - iyy[j2]);
-                      dk = abs(izz[i2] - izz[j2]);
-                      A = cov[di][dj][dk];
-                      if (i2 < npts && j2 >= npts)
-                        A12[i2][j2 - npts] = A;
-                      if (i2 >= npts && j2 < npts)
-                        A21[i2 - npts][j2] = A;
-                      if (i2 >= npts && j2 >= npts)
-                        A22[i2 - npts][j2 - npts] = A;
-                    }
+                      b[i2] = kc_b[kc][i2];
                   }
-
-                  /* Compute b2' = b2 - A21 * A11_inv * b1 and augment b1 */
-                  for (i2 = 0; i2 < cpts; i2++)
-                    b2[i2] = b[i2 + npts];
-                  for (i2 = 0; i2 < npts; i2++)
-                    b_tmp[i2] = b[i2];
-                  dposl_(A11, &npts, &npts, b_tmp);
-
-                  for (i2 = 0; i2 < cpts; i2++)
+                  else
                   {
-                    sum = 0.0;
-                    for (j2 = 0; j2 < npts; j2++)
+                    /* Compute the submatrices */
+                    for (j2 = 0; j2 < npts + cpts; j2++)
                     {
-                      sum += A21[i2][j2] * b_tmp[j2];
-                    }
-                    b2[i2] -= sum;
-                  }
-                  for (i2 = 0; i2 < cpts; i2++)
-                    b[i2 + npts] = b2[i2];
+                      di = abs(rpx - ixx[j2]);
+                      dj = abs(rpy - iyy[j2]);
+                      dk = abs(rpz - izz[j2]);
+                      b[j2] = cov[di][dj][dk];
 
-                  /* Compute A22' = A22 - A21 * A11_inv * A12 */
-                  for (j2 = 0; j2 < cpts; j2++)
-                    for (i2 = 0; i2 < npts; i2++)
-                      M[j2][i2] = A12[i2][j2];
+                      for (i2 = 0; i2 < npts + cpts; i2++)
+                      {
+                        di = abs(ixx[i2] - ixx[j2]);
+                        dj = abs(iyy[i2] - iyy[j2]);
+                        dk = abs(izz[i2] - izz[j2]);
+                        A = cov[di][dj][dk];
+                        if (i2 < npts && j2 >= npts)
+                          A12[i2][j2 - npts] = A;
+                        if (i2 >= npts && j2 < npts)
+                          A21[i2 - npts][j2] = A;
+                        if (i2 >= npts && j2 >= npts)
+                          A22[i2 - npts][j2 - npts] = A;
+                      }
+                    }
 
-                  if (npts > 0)
-                  {
+                    /* Compute b2' = b2 - A21 * A11_inv * b1 and augment b1 */
                     for (i2 = 0; i2 < cpts; i2++)
-                      dposl_(A11, &npts, &npts, M[i2]);
-                  }
+                      b2[i2] = b[i2 + npts];
+                    for (i2 = 0; i2 < npts; i2++)
+                      b_tmp[i2] = b[i2];
+                    dposl_(A11, &npts, &npts, b_tmp);
 
-                  for (j2 = 0; j2 < cpts; j2++)
                     for (i2 = 0; i2 < cpts; i2++)
                     {
                       sum = 0.0;
-                      for (k2 = 0; k2 < npts; k2++)
-                        sum += A21[i2][k2] * M[j2][k2];
-                      A22[i2][j2] -= sum;
+                      for (j2 = 0; j2 < npts; j2++)
+                      {
+                        sum += A21[i2][j2] * b_tmp[j2];
+                      }
+                      b2[i2] -= sum;
                     }
-
-                  m = 0;
-                  for (j2 = 0; j2 < cpts; j2++)
                     for (i2 = 0; i2 < cpts; i2++)
-                      A_sub[m++] = A22[i2][j2];
+                      b[i2 + npts] = b2[i2];
 
-                  /* Compute x2 where A22*x2 = b2' */
-                  dpofa_(A_sub, &cpts, &cpts, &ierr);
-                  dposl_(A_sub, &cpts, &cpts, b2);
+                    /* Compute A22' = A22 - A21 * A11_inv * A12 */
+                    for (j2 = 0; j2 < cpts; j2++)
+                      for (i2 = 0; i2 < npts; i2++)
+                        M[j2][i2] = A12[i2][j2];
 
-                  /* Compute w_tmp where A11*w_tmp = (b1 - A12*b2) */
-                  if (npts > 0)
-                  {
-                    for (i2 = 0; i2 < npts; i2++)
+                    if (npts > 0)
                     {
-                      sum = 0.0;
-                      for (k2 = 0; k2 < cpts; k2++)
-                        sum += A12[i2][k2] * b2[k2];
-                      w_tmp[i2] = b[i2] - sum;
+                      for (i2 = 0; i2 < cpts; i2++)
+                        dposl_(A11, &npts, &npts, M[i2]);
+                    }
+
+                    for (j2 = 0; j2 < cpts; j2++)
+                      for (i2 = 0; i2 < cpts; i2++)
+                      {
+                        sum = 0.0;
+                        for (k2 = 0; k2 < npts; k2++)
+                          sum += A21[i2][k2] * M[j2][k2];
+                        A22[i2][j2] -= sum;
+                      }
+
+                    m = 0;
+                    for (j2 = 0; j2 < cpts; j2++)
+                      for (i2 = 0; i2 < cpts; i2++)
+                        A_sub[m++] = A22[i2][j2];
+
+                    /* Compute x2 where A22*x2 = b2' */
+                    dpofa_(A_sub, &cpts, &cpts, &ierr);
+                    dposl_(A_sub, &cpts, &cpts, b2);
+
+                    /* Compute w_tmp where A11*w_tmp = (b1 - A12*b2) */
+                    if (npts > 0)
+                    {
+                      for (i2 = 0; i2 < npts; i2++)
+                      {
+                        sum = 0.0;
+                        for (k2 = 0; k2 < cpts; k2++)
+                          sum += A12[i2][k2] * b2[k2];
+                        w_tmp[i2] = b[i2] - sum;
+                      }
+                      dposl_(A11, &npts, &npts, w_tmp);
                     }
-                    dposl_(A11, &npts, &npts, w_tmp);
+
+                    for (i2 = 0; i2 < npts; i2++)
+                      kc_w[kc][i2] = w_tmp[i2];
+                    for (i2 = 0; i2 < cpts; i2++)
+                      kc_b2[kc][i2] = b2[i2];
+                    for (i2 = 0; i2 < npts + cpts; i2++)
+                      kc_b[kc][i2] = b[i2];
+                    for (i2 = 0; i2 < 3 * cpts; i2++)
+                      kc_pts[kc][i2] = kc_key[i2];
+                    kc_cpts[kc] = cpts;
                   }
 
                   /* Fill in the rest of w_tmp with b2 */
@@ -817,7 +970,10 @@ void         PGSRF(
                   cmean += w_tmp[m] * value[m];
 
                 /* uni = fieldp[index1]; */
-                uni = Rand();
+                if (public_xtra->rng == 1)
+                  uni = CounterRand(public_xtra->seed, 0, i, j, k);
+                else
+                  uni = Rand();
                 gauinv_(&uni, &gau, &ierr);
                 tmpRFp[index2] = csigma * gau + cmean;
 
@@ -872,6 +1028,8 @@ void         PGSRF(
         fieldp[index1] = mean + sigma * tmpRFp[index2];
       });
     }
+
+    tfree(cond_count);
   }  /* gridloop */
 
   /*-----------------------------------------------------------------------
@@ -913,6 +1071,21 @@ void         PGSRF(
   tfree(ixx);
   tfree(iyy);
   tfree(izz);
+  tfree(nbr_offset);
+
+  for (i = 0; i < PGS_KRIGE_CACHE_SIZE; i++)
+  {
+    tfree(kc_pts[i]);
+    tfree(kc_w[i]);
+    tfree(kc_b[i]);
+    tfree(kc_b2[i]);
+  }
+  tfree(kc_cpts);
+  tfree(kc_pts);
+  tfree(kc_w);
+  tfree(kc_b);
+  tfree(kc_b2);
+  tfree(kc_key);
 
   for (i = -iLx; i <= 2 * iLx; i++)
   {
@@ -998,6 +1171,7 @@ PFModule   *PGSRFNewPublicXtra(char *geom_name)
 
   NameArray strat_type_na;
   NameArray log_normal_na;
+  NameArray rng_na;
 
   public_xtra = ctalloc(PublicXtra, 1);
 
@@ -1064,6 +1238,17 @@ PFModule   *PGSRFNewPublicXtra(char *geom_name)
   sprintf(key, "Geom.%s.Perm.MaxSearchRad", geom_name);
   public_xtra->max_search_rad = GetInt(key);
 
+  rng_na = NA_NewNameArray("Sequential Counter");
+  sprintf(key, "Geom.%s.Perm.RandomGenerator", geom_name);
+  tmp = GetStringDefault(key, "Sequential");
+  /* Convert the name to a numeric index */
+  if ((public_xtra->rng = NA_NameToIndex(rng_na, tmp)) < 0)
+  {
+    InputError("Error: Invalid RandomGenerator for key <%s> was <%s>\n",
+               key, tmp);
+  }
+  NA_FreeNameArray(rng_na);
+
   (public_xtra->time_index) = RegisterTiming("PGS RF");
 
   PFModulePublicXtra(this_module) = public_xtra;
@@ -137,6 +137,9 @@ typedef struct {
   WellData       *well_data;
   BCPressureData *bc_pressure_data;
 
+  /* changed every time SetProblemData fills in the data */
+  int generation;
+
   /*sk  overland flow*/
   Vector *x_slope;
   Vector *y_slope;
@@ -258,6 +261,7 @@ typedef struct {
 #define ProblemDataSSlopeY(problem_data)        ((problem_data)->y_sslope)   //RMM
 #define ProblemDataZmult(problem_data)          ((problem_data)->dz_mult)    //RMM
 #define ProblemDataRealSpaceZ(problem_data)     ((problem_data)->rsz)
+#define ProblemDataGeneration(problem_data)     ((problem_data)->generation)
 /*--------------------------------------------------------------------------
  * Misc macros
  *   RDF not quite right, maybe?
@@ -31,6 +31,8 @@
 
 #include "parflow.h"
 
+#include <string.h>
+
 
 /*--------------------------------------------------------------------------
  * Structures
@@ -48,12 +50,58 @@ typedef struct {
   double     ***elevations;
   ProblemData  *problem_data;
   Grid         *grid;
+
+  /* patch values of the interval last built for each patch */
+  ProblemData  *values_problem_data;
+  Grid         *values_grid;
+  int values_num_patches;
+  int values_num_subgrids;
+  int          *values_intervals;
+  int         **values_sizes;
+  double     ***values;
 } InstanceXtra;
 
+/*--------------------------------------------------------------------------
+ * BCPressureFreeValues:
+ *   Free the patch values kept from earlier calls.
+ *--------------------------------------------------------------------------*/
+
+static void BCPressureFreeValues(InstanceXtra *instance_xtra)
+{
+  int ipatch, is;
+
+  if (instance_xtra->values)
+  {
+    for (ipatch = 0; ipatch < (instance_xtra->values_num_patches); ipatch++)
+    {
+      for (is = 0; is < (instance_xtra->values_num_subgrids); is++)
+      {
+        tfree(instance_xtra->values[ipatch][is]);
+      }
+      tfree(instance_xtra->values[ipatch]);
+      tfree(instance_xtra->values_sizes[ipatch]);
+    }
+    tfree(instance_xtra->values);
+    tfree(instance_xtra->values_sizes);
+    tfree(instance_xtra->values_intervals);
+  }
+
+  instance_xtra->values = NULL;
+  instance_xtra->values_sizes = NULL;
+  instance_xtra->values_intervals = NULL;
+  instance_xtra->values_grid = NULL;
+  instance_xtra->values_problem_data = NULL;
+}
+
 /*--------------------------------------------------------------------------
  * BCPressure:
  *   This routine returns a BCStruct structure which describes where
  *   and what the boundary conditions are.
+ *
+ *   The values of a patch only change when its time cycle crosses into
+ *   a new interval (ExactSolution aside, which depends on time), so the
+ *   values last built for each patch are kept and copied into the new
+ *   BCStruct until the interval changes.
  *--------------------------------------------------------------------------*/
 
 BCStruct    *BCPressure(
@@ -129,6 +177,28 @@ BCStruct    *BCPressure(
     values = ctalloc(double **, num_patches);
     BCStructValues(bc_struct) = values;
 
+    if ((instance_xtra->values_grid != grid)
+        || (instance_xtra->values_problem_data != problem_data))
+    {
+      BCPressureFreeValues(instance_xtra);
+
+      instance_xtra->values_grid = grid;
+      instance_xtra->values_problem_data = problem_data;
+      instance_xtra->values_num_patches = num_patches;
+      instance_xtra->values_num_subgrids = SubgridArraySize(subgrids);
+      instance_xtra->values_intervals = talloc(int, num_patches);
+      instance_xtra->values_sizes = ctalloc(int *, num_patches);
+      instance_xtra->values = ctalloc(double **, num_patches);
+      for (ipatch = 0; ipatch < num_patches; ipatch++)
+      {
+        instance_xtra->values_intervals[ipatch] = -1;
+        instance_xtra->values_sizes[ipatch] =
+          ctalloc(int, SubgridArraySize(subgrids));
+        instance_xtra->values[ipatch] =
+          ctalloc(double *, SubgridArraySize(subgrids));
+      }
+    }
+
     for (ipatch = 0; ipatch < num_patches; ipatch++)
     {
       values[ipatch] = ctalloc(double *, SubgridArraySize(subgrids));
@@ -137,6 +207,26 @@ BCStruct    *BCPressure(
       interval_number = TimeCycleDataComputeIntervalNumber(
                                                            problem, time, time_cycle_data, cycle_number);
 
+      /* Reuse the values if no transition has been crossed */
+      if ((BCPressureDataType(bc_pressure_data, ipatch) != ExactSolution)
+          && (instance_xtra->values_intervals[ipatch] == interval_number))
+      {
+        ForSubgridI(is, subgrids)
+        {
+          patch_values_size = instance_xtra->values_sizes[ipatch][is];
+          patch_values = ctalloc(double, patch_values_size);
+          if (patch_values_size > 0)
+          {
+            memcpy(patch_values, instance_xtra->values[ipatch][is],
+                   patch_values_size * sizeof(double));
+          }
+          values[ipatch][is] = patch_values;
+        }
+
+        BCPressureDataNumRebuildsSkipped(bc_pressure_data)++;
+        continue;
+      }
+
       switch(BCPressureDataType(bc_pressure_data, ipatch))
       {
         case DirEquilRefPatch:
@@ -1054,7 +1144,31 @@ BCStruct    *BCPressure(
 
           break;
         } /* End OverlandDiffusive */
+      }
+
+      BCPressureDataNumRebuilds(bc_pressure_data)++;
+
+      /* Keep a copy of the values for the following calls */
+      if (BCPressureDataType(bc_pressure_data, ipatch) != ExactSolution)
+      {
+        ForSubgridI(is, subgrids)
+        {
+          patch_values_size = 0;
+          BCStructPatchLoop(i, j, k, fdir, ival, bc_struct, ipatch, is,
+          {
+            patch_values_size++;
+          });
 
+          tfree(instance_xtra->values[ipatch][is]);
+          instance_xtra->values[ipatch][is] = ctalloc(double, patch_values_size);
+          instance_xtra->values_sizes[ipatch][is] = patch_values_size;
+          if (patch_values_size > 0)
+          {
+            memcpy(instance_xtra->values[ipatch][is], values[ipatch][is],
+                   patch_values_size * sizeof(double));
+          }
+        }
+        instance_xtra->values_intervals[ipatch] = interval_number;
       }
     }
   }
@@ -1141,6 +1255,7 @@ void BCPressureFreeInstanceXtra()
 
       tfree(instance_xtra->elevations);
     }
+    BCPressureFreeValues(instance_xtra);
     PFModuleFreeInstance(instance_xtra->phase_density);
     tfree(instance_xtra);
   }
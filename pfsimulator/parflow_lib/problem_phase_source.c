@@ -22,7 +22,15 @@ typedef struct {
   void  **data;
 } PublicXtra;
 
-typedef void InstanceXtra;
+typedef struct {
+  /* flux wells intersecting the local subgrids */
+  WellIndex  *well_index;
+
+  /* well cycle intervals, valid while the time is unchanged */
+  double interval_time;
+  int num_cycles;
+  int        *interval_numbers;
+} InstanceXtra;
 
 typedef struct {
   NameArray regions;
@@ -51,8 +59,10 @@ void         PhaseSource(
 {
   PFModule      *this_module = ThisPFModule;
   PublicXtra    *public_xtra = (PublicXtra*)PFModulePublicXtra(this_module);
+  InstanceXtra  *instance_xtra = (InstanceXtra*)PFModuleInstanceXtra(this_module);
 
   WellData         *well_data = ProblemDataWellData(problem_data);
+  WellIndex        *well_index;
   WellDataPhysical *well_data_physical;
   WellDataValue    *well_data_value;
 
@@ -69,31 +79,24 @@ void         PhaseSource(
 
   SubgridArray     *subgrids = GridSubgrids(grid);
 
-  Subgrid          *subgrid, *well_subgrid, *tmp_subgrid;
-  Subvector        *px_sub, *py_sub, *pz_sub, *ps_sub;
+  Subgrid          *subgrid, *tmp_subgrid;
+  Subvector        *ps_sub;
 
-  double           *data, *px, *py, *pz;
+  double           *data;
 
   int ix, iy, iz;
   int nx, ny, nz;
   int r;
 
-  int nx_p, ny_p, nz_p;
   int nx_ps, ny_ps, nz_ps;
 
-  int is, i, j, k, ip, ips;
+  int is, i, j, k, ips;
 
   /* Locals associated with wells */
-  int well;
+  int well, piece, iw;
   int cycle_number, interval_number;
   double volume, flux, well_value;
-
-// SGS FIXME why is this needed?
-#undef max
-  double weight = -FLT_MAX;
-  double area_x, area_y, area_z, area_sum;
-  double avg_x, avg_y, avg_z;
-  double dx, dy, dz;
+  double           *weights;
 
   /*-----------------------------------------------------------------------
    * Put in any user defined sources for this phase
@@ -273,23 +276,58 @@ void         PhaseSource(
 
   /*-----------------------------------------------------------------------
    * Put in any flux wells from the well package
+   *
+   * Only the wells in the index, those intersecting the local subgrids,
+   * are visited and the interval of each time cycle is computed once
+   * per time rather than once per well.
    *-----------------------------------------------------------------------*/
 
   if (WellDataNumFluxWells(well_data) > 0)
   {
     time_cycle_data = WellDataTimeCycleData(well_data);
 
-    for (well = 0; well < WellDataNumFluxWells(well_data); well++)
+    well_index = (instance_xtra->well_index);
+    if ((well_index == NULL)
+        || (WellIndexGrid(well_index) != grid)
+        || (WellIndexGeneration(well_index)
+            != ProblemDataGeneration(problem_data)))
+    {
+      FreeWellIndex(well_index);
+      well_index = NewWellIndex(well_data, grid, perm_x, perm_y, perm_z);
+      WellIndexGeneration(well_index) = ProblemDataGeneration(problem_data);
+      (instance_xtra->well_index) = well_index;
+
+      tfree(instance_xtra->interval_numbers);
+      (instance_xtra->num_cycles) =
+        TimeCycleDataNumberOfCycles(time_cycle_data);
+      (instance_xtra->interval_numbers) =
+        ctalloc(int, (instance_xtra->num_cycles));
+      (instance_xtra->interval_time) = -FLT_MAX;
+    }
+
+    if ((instance_xtra->interval_time) != time)
     {
+      for (cycle_number = 0; cycle_number < (instance_xtra->num_cycles);
+           cycle_number++)
+      {
+        (instance_xtra->interval_numbers[cycle_number]) =
+          TimeCycleDataComputeIntervalNumber(problem, time,
+                                             time_cycle_data, cycle_number);
+      }
+      (instance_xtra->interval_time) = time;
+    }
+
+    for (piece = 0; piece < WellIndexNumPieces(well_index); piece++)
+    {
+      well = WellIndexWell(well_index, piece);
+
       well_data_physical = WellDataFluxWellPhysical(well_data, well);
       cycle_number = WellDataPhysicalCycleNumber(well_data_physical);
 
-      interval_number = TimeCycleDataComputeIntervalNumber(problem, time, time_cycle_data, cycle_number);
+      interval_number = (instance_xtra->interval_numbers[cycle_number]);
 
       well_data_value = WellDataFluxWellIntervalValue(well_data, well, interval_number);
 
-      well_subgrid = WellDataPhysicalSubgrid(well_data_physical);
-
       well_value = 0.0;
       if (WellDataPhysicalAction(well_data_physical) == INJECTION_WELL)
       {
@@ -305,85 +343,33 @@ void         PhaseSource(
       volume = WellDataPhysicalSize(well_data_physical);
       flux = well_value / volume;
 
-      avg_x = WellDataPhysicalAveragePermeabilityX(well_data_physical);
-      avg_y = WellDataPhysicalAveragePermeabilityY(well_data_physical);
-      avg_z = WellDataPhysicalAveragePermeabilityZ(well_data_physical);
+      tmp_subgrid = WellIndexSubgrid(well_index, piece);
+      weights = WellIndexWeights(well_index, piece);
 
-      ForSubgridI(is, subgrids)
-      {
-        subgrid = SubgridArraySubgrid(subgrids, is);
+      ps_sub = VectorSubvector(phase_source,
+                               WellIndexSubgridIndex(well_index, piece));
 
-        px_sub = VectorSubvector(perm_x, is);
-        py_sub = VectorSubvector(perm_y, is);
-        pz_sub = VectorSubvector(perm_z, is);
+      nx_ps = SubvectorNX(ps_sub);
+      ny_ps = SubvectorNY(ps_sub);
+      nz_ps = SubvectorNZ(ps_sub);
 
-        ps_sub = VectorSubvector(phase_source, is);
+      ix = SubgridIX(tmp_subgrid);
+      iy = SubgridIY(tmp_subgrid);
+      iz = SubgridIZ(tmp_subgrid);
 
-        nx_p = SubvectorNX(ps_sub);
-        ny_p = SubvectorNY(ps_sub);
-        nz_p = SubvectorNZ(ps_sub);
+      nx = SubgridNX(tmp_subgrid);
+      ny = SubgridNY(tmp_subgrid);
+      nz = SubgridNZ(tmp_subgrid);
 
-        nx_ps = SubvectorNX(ps_sub);
-        ny_ps = SubvectorNY(ps_sub);
-        nz_ps = SubvectorNZ(ps_sub);
-
-        /*  Get the intersection of the well with the subgrid  */
-        if ((tmp_subgrid = IntersectSubgrids(subgrid, well_subgrid)))
-        {
-          /*  If an intersection;  loop over it, and insert value  */
-          ix = SubgridIX(tmp_subgrid);
-          iy = SubgridIY(tmp_subgrid);
-          iz = SubgridIZ(tmp_subgrid);
-
-          nx = SubgridNX(tmp_subgrid);
-          ny = SubgridNY(tmp_subgrid);
-          nz = SubgridNZ(tmp_subgrid);
-
-          dx = SubgridDX(tmp_subgrid);
-          dy = SubgridDY(tmp_subgrid);
-          dz = SubgridDZ(tmp_subgrid);
-
-          area_x = dy * dz;
-          area_y = dx * dz;
-          area_z = dx * dy;
-          area_sum = area_x + area_y + area_z;
-
-          px = SubvectorElt(px_sub, ix, iy, iz);
-          py = SubvectorElt(py_sub, ix, iy, iz);
-          pz = SubvectorElt(pz_sub, ix, iy, iz);
-
-          data = SubvectorElt(ps_sub, ix, iy, iz);
-
-          ip = 0;
-          ips = 0;
-          BoxLoopI2(i, j, k, ix, iy, iz, nx, ny, nz,
-                    ip, nx_p, ny_p, nz_p, 1, 1, 1,
-                    ips, nx_ps, ny_ps, nz_ps, 1, 1, 1,
-          {
-            if (WellDataPhysicalMethod(well_data_physical)
-                == FLUX_STANDARD)
-            {
-              weight = 1.0;
-            }
-            else if (WellDataPhysicalMethod(well_data_physical)
-                     == FLUX_WEIGHTED)
-            {
-              weight = (px[ip] / avg_x) * (area_x / area_sum)
-                       + (py[ip] / avg_y) * (area_y / area_sum)
-                       + (pz[ip] / avg_z) * (area_z / area_sum);
-            }
-            else if (WellDataPhysicalMethod(well_data_physical)
-                     == FLUX_PATTERNED)
-            {
-              weight = 0.0;
-            }
-            data[ips] += weight * flux;
-          });
+      data = SubvectorElt(ps_sub, ix, iy, iz);
 
-          /* done with this temporay subgrid */
-          FreeSubgrid(tmp_subgrid);
-        }
-      }
+      ips = 0;
+      iw = 0;
+      BoxLoopI1(i, j, k, ix, iy, iz, nx, ny, nz,
+                ips, nx_ps, ny_ps, nz_ps, 1, 1, 1,
+      {
+        data[ips] += weights[iw++] * flux;
+      });
     }
   }  /* End well data */
 }
@@ -399,13 +385,10 @@ PFModule  *PhaseSourceInitInstanceXtra()
   InstanceXtra  *instance_xtra;
 
 
-#if 0
   if (PFModuleInstanceXtra(this_module) == NULL)
     instance_xtra = ctalloc(InstanceXtra, 1);
   else
     instance_xtra = (InstanceXtra*)PFModuleInstanceXtra(this_module);
-#endif
-  instance_xtra = NULL;
 
   PFModuleInstanceXtra(this_module) = instance_xtra;
   return this_module;
@@ -424,6 +407,8 @@ void  PhaseSourceFreeInstanceXtra()
 
   if (instance_xtra)
   {
+    FreeWellIndex(instance_xtra->well_index);
+    tfree(instance_xtra->interval_numbers);
     tfree(instance_xtra);
   }
 }
@@ -26,7 +26,7 @@
  *  USA
  **********************************************************************EHEADER*/
 /*****************************************************************************
-* SeedRand, Rand
+* SeedRand, Rand, CounterRand
 *
 * Routines for generating random numbers.
 *
@@ -69,3 +69,96 @@ double  Rand()
 
   return(((double)amps_ThreadLocal(Seed)) / ((double)M));
 }
+
+
+/*--------------------------------------------------------------------------
+ * Counter-based generator:
+ *   Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as
+ *   1, 2, 3", SC11).  The output is a pure function of the key and the
+ *   counter, so any process or thread can produce the value for a given
+ *   cell or line directly without stepping through a stream.
+ *--------------------------------------------------------------------------*/
+
+#define PHILOX_M0 0xD2511F53U
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U
+#define PHILOX_W1 0xBB67AE85U
+#define PHILOX_ROUNDS 10
+
+/*--------------------------------------------------------------------------
+ * Philox4x32:
+ *   ctr and out may be the same array.
+ *--------------------------------------------------------------------------*/
+
+void  Philox4x32(
+                 unsigned int ctr[4],
+                 unsigned int key[2],
+                 unsigned int out[4])
+{
+  unsigned long long prod0, prod1;
+  unsigned int x0, x1, x2, x3;
+  unsigned int k0, k1;
+
+  int r;
+
+  x0 = ctr[0];
+  x1 = ctr[1];
+  x2 = ctr[2];
+  x3 = ctr[3];
+  k0 = key[0];
+  k1 = key[1];
+
+  for (r = 0; r < PHILOX_ROUNDS; r++)
+  {
+    if (r > 0)
+    {
+      k0 += PHILOX_W0;
+      k1 += PHILOX_W1;
+    }
+
+    prod0 = (unsigned long long)PHILOX_M0 * x0;
+    prod1 = (unsigned long long)PHILOX_M1 * x2;
+
+    x0 = (unsigned int)(prod1 >> 32) ^ x1 ^ k0;
+    x2 = (unsigned int)(prod0 >> 32) ^ x3 ^ k1;
+    x1 = (unsigned int)prod1;
+    x3 = (unsigned int)prod0;
+  }
+
+  out[0] = x0;
+  out[1] = x1;
+  out[2] = x2;
+  out[3] = x3;
+}
+
+/*--------------------------------------------------------------------------
+ * CounterRand:
+ *   Returns a uniform deviate in (0,1) for the given seed, stream and
+ *   (i, j, k) index.  The stream separates independent uses of the
+ *   same seed, e.g. the lines of a turning bands field.  53 bits of
+ *   the generator output are used; the value is never exactly 0 or 1.
+ *--------------------------------------------------------------------------*/
+
+double  CounterRand(
+                    int seed,
+                    int stream,
+                    int i,
+                    int j,
+                    int k)
+{
+  unsigned int ctr[4];
+  unsigned int key[2];
+  unsigned int out[4];
+
+  ctr[0] = (unsigned int)i;
+  ctr[1] = (unsigned int)j;
+  ctr[2] = (unsigned int)k;
+  ctr[3] = 0;
+  key[0] = (unsigned int)seed;
+  key[1] = (unsigned int)stream;
+
+  Philox4x32(ctr, key, out);
+
+  return(((double)(out[0] >> 5) * 67108864.0 + (double)(out[1] >> 6) + 0.5)
+         / 9007199254740992.0);
+}
@@ -27,7 +27,8 @@
  **********************************************************************EHEADER*/
 /*****************************************************************************
 *
-* Routines to read a Vector from a distributed file.
+* Routines to read a Vector from a distributed file, or directly from a
+* PFB file that has not been distributed.
 *
 *****************************************************************************/
 #include "parflow.h"
@@ -76,6 +77,179 @@ void ReadPFBinary_Subvector(
 }
 
 
+/*-----------------------------------------------------------------------
+ * ReadPFBinary_IsDistributed:
+ *
+ * True if filename has been distributed with pfdist, i.e. the file of
+ * process 0 (split files) or the .dist file of offsets exists.  Reading a
+ * distributed file is collective, so the check is made by process 0 and
+ * shared (as the maximum over the processes) for every process to read
+ * the file the same way.
+ *-----------------------------------------------------------------------*/
+
+static int ReadPFBinary_IsDistributed(
+                                      char *filename)
+{
+  char dist_filename[2048];
+  FILE *file;
+
+  int distributed = FALSE;
+
+  amps_Invoice invoice;
+
+  if (amps_Rank(amps_CommWorld) == 0)
+  {
+#ifdef AMPS_SPLIT_FILE
+    sprintf(dist_filename, "%s.%05d", filename, 0);
+#else
+    sprintf(dist_filename, "%s.dist", filename);
+#endif
+
+    if ((file = fopen(dist_filename, "r")) != NULL)
+    {
+      distributed = TRUE;
+      fclose(file);
+    }
+  }
+
+  invoice = amps_NewInvoice("%i", &distributed);
+  amps_AllReduce(amps_CommWorld, invoice, amps_Max);
+  amps_FreeInvoice(invoice);
+
+  return distributed;
+}
+
+
+/*-----------------------------------------------------------------------
+ * ReadPFBinary_Undistributed:
+ *
+ * Read the subvectors of v directly from a PFB file that has not been
+ * distributed.  Every process opens the file, walks the subgrid headers
+ * and reads only the rows of values overlapping its own subgrids, so
+ * the processes read in parallel and pfdist is not needed.  The file may
+ * hold any number of subgrids, e.g. be written for another process
+ * topology, but must have the dimensions of the grid of v.
+ *-----------------------------------------------------------------------*/
+
+static void ReadPFBinary_Undistributed(
+                                       char *  filename,
+                                       Vector *v)
+{
+  Grid           *grid = VectorGrid(v);
+  SubgridArray   *subgrids = GridSubgrids(grid);
+  SubgridArray   *all_subgrids = GridAllSubgrids(grid);
+  Subgrid        *subgrid;
+  Subvector      *subvector;
+
+  FILE           *file;
+
+  int grid_nx, grid_ny, grid_nz;
+
+  double X, Y, Z;
+  int NX, NY, NZ;
+  double DX, DY, DZ;
+  int num_file_subgrids;
+
+  int ix, iy, iz;
+  int nx, ny, nz;
+  int rx, ry, rz;
+
+  int i0, i1, j0, j1, k0, k1;
+  int n, g, j, k;
+
+  long start;
+
+  if ((file = fopen(filename, "rb")) == NULL)
+  {
+    amps_Printf("Error: can't open input file %s\n", filename);
+    exit(1);
+  }
+
+  amps_ReadDouble(file, &X, 1);
+  amps_ReadDouble(file, &Y, 1);
+  amps_ReadDouble(file, &Z, 1);
+
+  amps_ReadInt(file, &NX, 1);
+  amps_ReadInt(file, &NY, 1);
+  amps_ReadInt(file, &NZ, 1);
+
+  amps_ReadDouble(file, &DX, 1);
+  amps_ReadDouble(file, &DY, 1);
+  amps_ReadDouble(file, &DZ, 1);
+
+  amps_ReadInt(file, &num_file_subgrids, 1);
+
+  /* The extents of the grid over all processes */
+  grid_nx = grid_ny = grid_nz = 0;
+  ForSubgridI(g, all_subgrids)
+  {
+    subgrid = SubgridArraySubgrid(all_subgrids, g);
+
+    grid_nx = pfmax(grid_nx, SubgridIX(subgrid) + SubgridNX(subgrid));
+    grid_ny = pfmax(grid_ny, SubgridIY(subgrid) + SubgridNY(subgrid));
+    grid_nz = pfmax(grid_nz, SubgridIZ(subgrid) + SubgridNZ(subgrid));
+  }
+
+  if (NX != grid_nx || NY != grid_ny || NZ != grid_nz)
+  {
+    fclose(file);
+    InputError("Error: the dimensions of input file <%s> do not match the grid%s\n",
+               filename, "");
+  }
+
+  start = 6 * amps_SizeofDouble + 4 * amps_SizeofInt;
+
+  for (n = 0; n < num_file_subgrids; n++)
+  {
+    fseek(file, start, SEEK_SET);
+
+    amps_ReadInt(file, &ix, 1);
+    amps_ReadInt(file, &iy, 1);
+    amps_ReadInt(file, &iz, 1);
+
+    amps_ReadInt(file, &nx, 1);
+    amps_ReadInt(file, &ny, 1);
+    amps_ReadInt(file, &nz, 1);
+
+    amps_ReadInt(file, &rx, 1);
+    amps_ReadInt(file, &ry, 1);
+    amps_ReadInt(file, &rz, 1);
+
+    start += 9 * amps_SizeofInt;
+
+    ForSubgridI(g, subgrids)
+    {
+      subgrid = SubgridArraySubgrid(subgrids, g);
+      subvector = VectorSubvector(v, g);
+
+      i0 = pfmax(ix, SubgridIX(subgrid));
+      j0 = pfmax(iy, SubgridIY(subgrid));
+      k0 = pfmax(iz, SubgridIZ(subgrid));
+      i1 = pfmin(ix + nx, SubgridIX(subgrid) + SubgridNX(subgrid));
+      j1 = pfmin(iy + ny, SubgridIY(subgrid) + SubgridNY(subgrid));
+      k1 = pfmin(iz + nz, SubgridIZ(subgrid) + SubgridNZ(subgrid));
+
+      if (i0 < i1 && j0 < j1 && k0 < k1)
+      {
+        for (k = k0; k < k1; k++)
+          for (j = j0; j < j1; j++)
+          {
+            fseek(file, start
+                  + (((long)(k - iz) * ny + (j - iy)) * nx + (i0 - ix))
+                  * amps_SizeofDouble, SEEK_SET);
+            amps_ReadDouble(file, SubvectorElt(subvector, i0, j, k),
+                            i1 - i0);
+          }
+      }
+    }
+
+    start += (long)nx * ny * nz * amps_SizeofDouble;
+  }
+
+  fclose(file);
+}
+
+
 void ReadPFBinary(
                   char *  filename,
                   Vector *v)
@@ -106,6 +280,15 @@ void ReadPFBinary(
     exit(1);
   }
 
+  /* Files that have not been distributed are read directly */
+  if (!ReadPFBinary_IsDistributed(filename))
+  {
+    ReadPFBinary_Undistributed(filename, v);
+
+    EndTiming(PFBTimingIndex);
+    return;
+  }
+
   if ((file = amps_FFopen(amps_CommWorld, filename, "rb", 0)) == NULL)
   {
     amps_Printf("Error: can't open input file %s\n", filename);
@@ -36,12 +36,17 @@
 
 #include "parflow.h"
 
+#include <string.h>
+
 
 /*--------------------------------------------------------------------------
  * Structures
  *--------------------------------------------------------------------------*/
 
-typedef void PublicXtra;
+typedef struct {
+  char      *setup_cache_dir;   /* NULL if the setup cache is off */
+  unsigned long long setup_cache_hash;
+} PublicXtra;
 
 typedef struct {
   PFModule  *geometries;
@@ -74,6 +79,7 @@ void          SetProblemData(
                              ProblemData *problem_data)
 {
   PFModule      *this_module = ThisPFModule;
+  PublicXtra    *public_xtra = (PublicXtra*)PFModulePublicXtra(this_module);
   InstanceXtra  *instance_xtra = (InstanceXtra*)PFModuleInstanceXtra(this_module);
 
   PFModule      *geometries = (instance_xtra->geometries);
@@ -89,6 +95,18 @@ void          SetProblemData(
   PFModule      *dz_mult = (instance_xtra->dz_mult);                //sk
   PFModule      *real_space_z = (instance_xtra->real_space_z);
 
+  Vector        *setup_fields[5];
+
+  /* Unique over all problem data, so data built elsewhere never matches */
+  static int generation = 0;
+
+  /*
+   * The well data, and the fields when the site data is formed, are
+   * refilled below; anything derived from the problem data is out of
+   * date once its generation changes
+   */
+  ProblemDataGeneration(problem_data) = ++generation;
+
   /* Note: the order in which these modules are called is important */
   PFModuleInvokeType(WellPackageInvoke, wells, (problem_data));
   if ((instance_xtra->site_data_not_formed))
@@ -96,23 +114,46 @@ void          SetProblemData(
     PFModuleInvokeType(GeometriesInvoke, geometries, (problem_data));
     PFModuleInvokeType(DomainInvoke, domain, (problem_data));
 
-    PFModuleInvokeType(SubsrfSimInvoke, permeability,
-                       (problem_data,
-                        ProblemDataPermeabilityX(problem_data),
-                        ProblemDataPermeabilityY(problem_data),
-                        ProblemDataPermeabilityZ(problem_data),
-                        ProblemDataNumSolids(problem_data),
-                        ProblemDataSolids(problem_data),
-                        ProblemDataGrSolids(problem_data)));
-    PFModuleInvokeType(PorosityInvoke, porosity,
-                       (problem_data,
-                        ProblemDataPorosity(problem_data),
-                        ProblemDataNumSolids(problem_data),
-                        ProblemDataSolids(problem_data),
-                        ProblemDataGrSolids(problem_data)));
-    PFModuleInvokeType(SpecStorageInvoke, specific_storage,                   //sk
-                       (problem_data,
-                        ProblemDataSpecificStorage(problem_data)));
+    /* The fields that may be reused from the setup cache */
+    setup_fields[0] = ProblemDataPermeabilityX(problem_data);
+    setup_fields[1] = ProblemDataPermeabilityY(problem_data);
+    setup_fields[2] = ProblemDataPermeabilityZ(problem_data);
+    setup_fields[3] = ProblemDataPorosity(problem_data);
+    setup_fields[4] = ProblemDataSpecificStorage(problem_data);
+
+    if ((public_xtra->setup_cache_dir) &&
+        SetupCacheLoad((public_xtra->setup_cache_dir),
+                       (public_xtra->setup_cache_hash), 5, setup_fields))
+    {
+      SubsrfSimWellPermeability(problem_data,
+                                ProblemDataPermeabilityX(problem_data),
+                                ProblemDataPermeabilityY(problem_data),
+                                ProblemDataPermeabilityZ(problem_data));
+    }
+    else
+    {
+      PFModuleInvokeType(SubsrfSimInvoke, permeability,
+                         (problem_data,
+                          ProblemDataPermeabilityX(problem_data),
+                          ProblemDataPermeabilityY(problem_data),
+                          ProblemDataPermeabilityZ(problem_data),
+                          ProblemDataNumSolids(problem_data),
+                          ProblemDataSolids(problem_data),
+                          ProblemDataGrSolids(problem_data)));
+      PFModuleInvokeType(PorosityInvoke, porosity,
+                         (problem_data,
+                          ProblemDataPorosity(problem_data),
+                          ProblemDataNumSolids(problem_data),
+                          ProblemDataSolids(problem_data),
+                          ProblemDataGrSolids(problem_data)));
+      PFModuleInvokeType(SpecStorageInvoke, specific_storage,                   //sk
+                         (problem_data,
+                          ProblemDataSpecificStorage(problem_data)));
+
+      if (public_xtra->setup_cache_dir)
+        SetupCacheStore((public_xtra->setup_cache_dir),
+                        (public_xtra->setup_cache_hash), 5, setup_fields);
+    }
     PFModuleInvokeType(SlopeInvoke, x_slope,                   //sk
                        (problem_data,
                         ProblemDataTSlopeX(problem_data),
@@ -296,11 +337,16 @@ PFModule   *SetProblemDataNewPublicXtra()
   PFModule      *this_module = ThisPFModule;
   PublicXtra    *public_xtra;
 
+  char          *setup_cache_dir;
 
-#if 0
   public_xtra = ctalloc(PublicXtra, 1);
-#endif
-  public_xtra = NULL;
+
+  setup_cache_dir = GetStringDefault("SetupCache.Directory", "NA");
+  if (strcmp(setup_cache_dir, "NA"))
+  {
+    (public_xtra->setup_cache_dir) = setup_cache_dir;
+    (public_xtra->setup_cache_hash) = SetupCacheHash();
+  }
 
   PFModulePublicXtra(this_module) = public_xtra;
   return this_module;
@@ -0,0 +1,385 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+
+/*****************************************************************************
+*
+* Cache of the static fields built by SetProblemData.
+*
+* The permeability, porosity and specific storage fields are regenerated
+* from the input database on every run.  When SetupCache.Directory is
+* set the fields are stored there, one file per process, under a hash of
+* the input keys and input files they can depend on.  A later run with
+* the same hash maps the files and copies the fields back instead of
+* regenerating them.
+*
+*****************************************************************************/
+
+#include "parflow.h"
+#include "pfversion.h"
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*--------------------------------------------------------------------------
+ * Macros
+ *--------------------------------------------------------------------------*/
+
+#define SETUP_CACHE_MAGIC   "PFSETUP"
+#define SETUP_CACHE_VERSION 1
+
+/* 64 bit FNV-1a hash */
+#define SETUP_CACHE_FNV_OFFSET 14695981039346656037ULL
+#define SETUP_CACHE_FNV_PRIME  1099511628211ULL
+
+/*--------------------------------------------------------------------------
+ * Input keys that can not change the cached fields.  Forcing, solver and
+ * output settings can change between runs that share a cache entry.
+ * Every other key, and every input file named by one, is hashed.
+ *--------------------------------------------------------------------------*/
+
+static const char *setup_cache_skip_keys[] = {
+  "BCPressure.",
+  "Contaminants.",
+  "Cycle.",
+  "Ensemble.",
+  "ICPressure.",
+  "KnownSolution",
+  "Mannings.",
+  "NetCDF.",
+  "Patch.",
+  "Phase.",
+  "PhaseSources.",
+  "SetupCache.",
+  "Solver.",
+  "TimingInfo.",
+  "TopoSlopesX.",
+  "TopoSlopesY.",
+  "Wells.",
+  NULL
+};
+
+/* Geom.<name>.<key> keys that can not change the cached fields */
+static const char *setup_cache_skip_geom_keys[] = {
+  "ICPressure.",
+  "RelPerm.",
+  "Saturation.",
+  NULL
+};
+
+/*--------------------------------------------------------------------------
+ * Structures
+ *--------------------------------------------------------------------------*/
+
+typedef struct {
+  char magic[8];
+  int version;
+  int num_vectors;
+  unsigned long long hash;
+} SetupCacheHeader;
+
+
+static void SetupCacheHashBytes(unsigned long long *hash, const void *bytes, size_t n)
+{
+  const unsigned char *b = (const unsigned char*)bytes;
+  size_t i;
+
+  for (i = 0; i < n; i++)
+  {
+    *hash ^= b[i];
+    *hash *= SETUP_CACHE_FNV_PRIME;
+  }
+}
+
+static int SetupCacheSkipKey(const char *key)
+{
+  const char *sub;
+  int i;
+
+  for (i = 0; setup_cache_skip_keys[i]; i++)
+    if (strncmp(key, setup_cache_skip_keys[i],
+                strlen(setup_cache_skip_keys[i])) == 0)
+      return 1;
+
+  if (strncmp(key, "Geom.", 5) == 0 && (sub = strchr(key + 5, '.')))
+  {
+    sub++;
+    for (i = 0; setup_cache_skip_geom_keys[i]; i++)
+      if (strncmp(sub, setup_cache_skip_geom_keys[i],
+                  strlen(setup_cache_skip_geom_keys[i])) == 0)
+        return 1;
+  }
+
+  return 0;
+}
+
+/* HBT_foreach method, hashes an input database entry */
+static void SetupCacheHashEntry(void *obj, void *data)
+{
+  IDB_Entry          *entry = (IDB_Entry*)obj;
+  unsigned long long *hash = (unsigned long long*)data;
+
+  struct stat status;
+  FILE               *file;
+  char buffer[65536];
+  size_t n;
+
+  if (SetupCacheSkipKey(entry->key))
+    return;
+
+  SetupCacheHashBytes(hash, entry->key, strlen(entry->key) + 1);
+  SetupCacheHashBytes(hash, entry->value, strlen(entry->value) + 1);
+
+  /* Values that name a file, such as PFB or solid files, are hashed
+   * by content */
+  if (stat(entry->value, &status) == 0 && S_ISREG(status.st_mode))
+  {
+    if ((file = fopen(entry->value, "rb")) != NULL)
+    {
+      while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        SetupCacheHashBytes(hash, buffer, n);
+      fclose(file);
+    }
+  }
+}
+
+
+/*--------------------------------------------------------------------------
+ * SetupCacheHash: hash of the input database for the setup cache.  The
+ * input files are only read on process 0; every process returns the
+ * same hash.
+ *--------------------------------------------------------------------------*/
+
+unsigned long long SetupCacheHash()
+{
+  unsigned long long hash = SETUP_CACHE_FNV_OFFSET;
+  int version = SETUP_CACHE_VERSION;
+  double hash_hi = 0.0;
+  double hash_lo = 0.0;
+
+  amps_Invoice result_invoice;
+
+  if (!amps_Rank(amps_CommWorld))
+  {
+    SetupCacheHashBytes(&hash, &version, sizeof(version));
+    SetupCacheHashBytes(&hash, PARFLOW_VERSION_STRING,
+                        strlen(PARFLOW_VERSION_STRING) + 1);
+    HBT_foreach(amps_ThreadLocal(input_database), SetupCacheHashEntry, &hash);
+
+    hash_hi = (double)(hash >> 32);
+    hash_lo = (double)(hash & 0xffffffffULL);
+  }
+
+  /* Both halves are exact in a double, the sum broadcasts them */
+  result_invoice = amps_NewInvoice("%d%d", &hash_hi, &hash_lo);
+  amps_AllReduce(amps_CommWorld, result_invoice, amps_Add);
+  amps_FreeInvoice(result_invoice);
+
+  return ((unsigned long long)hash_hi << 32) | (unsigned long long)hash_lo;
+}
+
+
+static void SetupCacheFileName(char *filename, char *directory, unsigned long long hash)
+{
+  sprintf(filename, "%s/setup.%016llx.%05d", directory,
+          hash, amps_Rank(amps_CommWorld));
+}
+
+
+/*--------------------------------------------------------------------------
+ * SetupCacheLoad: copy the vectors from the cache entry for hash.
+ * Returns 1 if every process found a complete entry; otherwise no
+ * vector is changed and 0 is returned.  A loaded entry is noted in the
+ * run log.
+ *--------------------------------------------------------------------------*/
+
+int SetupCacheLoad(
+                   char *             directory,
+                   unsigned long long hash,
+                   int                num_vectors,
+                   Vector **          vectors)
+{
+  char filename[2048];
+  struct stat status;
+  SetupCacheHeader header;
+  char      *map = NULL;
+  size_t offset;
+  int fd;
+  int valid = 0;
+  int n, sg, size;
+
+  amps_Invoice result_invoice;
+
+  SetupCacheFileName(filename, directory, hash);
+
+  if ((fd = open(filename, O_RDONLY)) >= 0)
+  {
+    if (fstat(fd, &status) == 0 && (size_t)status.st_size >= sizeof(header))
+    {
+      map = (char*)mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map == MAP_FAILED)
+        map = NULL;
+    }
+    close(fd);
+  }
+
+  /* Check the whole entry against the vectors before copying */
+  if (map)
+  {
+    memcpy(&header, map, sizeof(header));
+    valid = (memcmp(header.magic, SETUP_CACHE_MAGIC, sizeof(header.magic)) == 0)
+            && (header.version == SETUP_CACHE_VERSION)
+            && (header.num_vectors == num_vectors)
+            && (header.hash == hash);
+
+    offset = sizeof(header);
+    for (n = 0; valid && n < num_vectors; n++)
+    {
+      ForSubgridI(sg, GridSubgrids(VectorGrid(vectors[n])))
+      {
+        if (offset + sizeof(int) > (size_t)status.st_size)
+        {
+          valid = 0;
+          break;
+        }
+        memcpy(&size, map + offset, sizeof(int));
+        offset += sizeof(int) + size * sizeof(double);
+        if (size != SubvectorDataSize(VectorSubvector(vectors[n], sg))
+            || offset > (size_t)status.st_size)
+        {
+          valid = 0;
+          break;
+        }
+      }
+    }
+  }
+
+  /* Every process has to take the same path through SetProblemData */
+  result_invoice = amps_NewInvoice("%i", &valid);
+  amps_AllReduce(amps_CommWorld, result_invoice, amps_Min);
+  amps_FreeInvoice(result_invoice);
+
+  if (valid)
+  {
+    offset = sizeof(header);
+    for (n = 0; n < num_vectors; n++)
+    {
+      ForSubgridI(sg, GridSubgrids(VectorGrid(vectors[n])))
+      {
+        Subvector *subvector = VectorSubvector(vectors[n], sg);
+
+        size = SubvectorDataSize(subvector);
+        offset += sizeof(int);
+        memcpy(SubvectorData(subvector), map + offset, size * sizeof(double));
+        offset += size * sizeof(double);
+      }
+    }
+  }
+
+  if (map)
+    munmap(map, status.st_size);
+
+  IfLogging(1)
+  {
+    if (valid)
+    {
+      FILE *log_file = OpenLogFile("SetupCache");
+      fprintf(log_file, "Loaded setup cache entry %016llx from %s\n",
+              hash, directory);
+      CloseLogFile(log_file);
+    }
+  }
+
+  return valid;
+}
+
+
+/*--------------------------------------------------------------------------
+ * SetupCacheStore: write the vectors to the cache entry for hash.  The
+ * file is written under a temporary name and renamed so concurrent runs
+ * never map a partial entry.
+ *--------------------------------------------------------------------------*/
+
+void SetupCacheStore(
+                     char *             directory,
+                     unsigned long long hash,
+                     int                num_vectors,
+                     Vector **          vectors)
+{
+  char filename[2048];
+  char tmp_filename[2100];
+  SetupCacheHeader header;
+  FILE      *file;
+  int n, sg, size;
+  int ok;
+
+  if (!amps_Rank(amps_CommWorld))
+  {
+    if (mkdir(directory, S_IRWXU | S_IRWXG | S_IRWXO) < 0 && errno != EEXIST)
+      amps_Printf("Warning: can't create setup cache directory %s\n", directory);
+  }
+  amps_Sync(amps_CommWorld);
+
+  SetupCacheFileName(filename, directory, hash);
+  sprintf(tmp_filename, "%s.%d.tmp", filename, (int)getpid());
+
+  if ((file = fopen(tmp_filename, "wb")) == NULL)
+  {
+    amps_Printf("Warning: can't write setup cache file %s\n", tmp_filename);
+    return;
+  }
+
+  memset(&header, 0, sizeof(header));
+  strcpy(header.magic, SETUP_CACHE_MAGIC);
+  header.version = SETUP_CACHE_VERSION;
+  header.num_vectors = num_vectors;
+  header.hash = hash;
+
+  ok = (fwrite(&header, sizeof(header), 1, file) == 1);
+  for (n = 0; n < num_vectors; n++)
+  {
+    ForSubgridI(sg, GridSubgrids(VectorGrid(vectors[n])))
+    {
+      Subvector *subvector = VectorSubvector(vectors[n], sg);
+
+      size = SubvectorDataSize(subvector);
+      ok = ok && (fwrite(&size, sizeof(int), 1, file) == 1);
+      ok = ok && (fwrite(SubvectorData(subvector), sizeof(double), size, file)
+                  == (size_t)size);
+    }
+  }
+
+  if ((fclose(file) != 0) || !ok || rename(tmp_filename, filename) != 0)
+  {
+    amps_Printf("Warning: can't write setup cache file %s\n", filename);
+    unlink(tmp_filename);
+  }
+}
@@ -71,6 +71,8 @@ double         **SimShear(
 
   int                *fdir, dir = 0;
 
+  GrGeomOctree       *node;
+
   int is, i, j, k, ishear;
 
 
@@ -139,10 +141,19 @@ double         **SimShear(
     for (ishear = 0; ishear < (nx * ny); ishear++)
       shear_array[ishear] = zinit;
 
-    /* Construct shear_array above/below visible solid surface */
+    /* Construct shear_array above/below visible solid surface.
+     * Walk the octree directly rather than using GrGeomSurfLoop; the
+     * clustered surface boxes only cover this process's grid, so a
+     * surface above or below the subgrid would be missed and the
+     * shear would depend on the process topology. */
     shear_min[is] = zupper;
     shear_max[is] = zlower;
-    GrGeomSurfLoop(i, j, k, fdir, grgeom_solid, rz, ix, iy, iz, nx, ny, nz,
+    i = GrGeomSolidOctreeIX(grgeom_solid) * (int)Pow2(rz);
+    j = GrGeomSolidOctreeIY(grgeom_solid) * (int)Pow2(rz);
+    k = GrGeomSolidOctreeIZ(grgeom_solid) * (int)Pow2(rz);
+    GrGeomOctreeFaceLoop(i, j, k, fdir, node, GrGeomSolidData(grgeom_solid),
+                         GrGeomSolidOctreeBGLevel(grgeom_solid) + rz,
+                         ix, iy, iz, nx, ny, nz,
     {
       if (fdir[2] == dir)
       {
@@ -101,6 +101,8 @@ NewSolver()
      switch_name = GetStringDefault("UseClustering", "True");
      GlobalsUseClustering = NA_NameToIndex(switch_na, switch_name);
      NA_FreeNameArray(switch_na);
+
+     GlobalsClusteringCacheDirectory = GetStringDefault("Clustering.CacheDirectory", "");
   }
 
   /*-----------------------------------------------------------------------
@@ -283,6 +283,9 @@ typedef struct {
   char *recomp_log;
   char *dt_info_log;
 
+  CPFBSeries *press_series;      /* temporal delta encoding of press/satur output */
+  CPFBSeries *satur_series;
+
   int file_number;
   int number_logged;
   int iteration_number;
@@ -610,6 +613,8 @@ SetupRichards(PFModule * this_module)
   }
 
   instance_xtra->iteration_number = instance_xtra->file_number = start_count;
+  instance_xtra->press_series = NewCPFBSeries();
+  instance_xtra->satur_series = NewCPFBSeries();
   instance_xtra->dump_index = 1.0;
   instance_xtra->clm_dump_index = 1.0;
 
@@ -1073,7 +1078,10 @@ SetupRichards(PFModule * this_module)
     if (print_press)
     {
       sprintf(file_postfix, "press.%05d", instance_xtra->file_number);
-      WritePFBinary(file_prefix, file_postfix, instance_xtra->pressure);
+      WritePFBinarySeries(file_prefix, file_postfix,
+                          instance_xtra->file_number,
+                          instance_xtra->pressure,
+                          instance_xtra->press_series);
       any_file_dumped = 1;
     }
 
@@ -1112,8 +1120,10 @@ SetupRichards(PFModule * this_module)
     if (print_satur)
     {
       sprintf(file_postfix, "satur.%05d", instance_xtra->file_number);
-      WritePFBinary(file_prefix, file_postfix,
-                    instance_xtra->saturation);
+      WritePFBinarySeries(file_prefix, file_postfix,
+                          instance_xtra->file_number,
+                          instance_xtra->saturation,
+                          instance_xtra->satur_series);
       any_file_dumped = 1;
     }
 
@@ -2727,8 +2737,10 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
       {
         sprintf(file_postfix, "press.%05d",
                 instance_xtra->file_number);
-        WritePFBinary(file_prefix, file_postfix,
-                      instance_xtra->pressure);
+        WritePFBinarySeries(file_prefix, file_postfix,
+                            instance_xtra->file_number,
+                            instance_xtra->pressure,
+                            instance_xtra->press_series);
         any_file_dumped = 1;
       }
 
@@ -2784,8 +2796,10 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
       {
         sprintf(file_postfix, "satur.%05d",
                 instance_xtra->file_number);
-        WritePFBinary(file_prefix, file_postfix,
-                      instance_xtra->saturation);
+        WritePFBinarySeries(file_prefix, file_postfix,
+                            instance_xtra->file_number,
+                            instance_xtra->saturation,
+                            instance_xtra->satur_series);
         any_file_dumped = 1;
       }
 
@@ -3463,6 +3477,8 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
       }
     }
 #endif
+
+    RecordTimingStep(instance_xtra->iteration_number, t);
   }                             /* ends do for time loop */
   while (take_more_time_steps);
 
@@ -3476,7 +3492,10 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
     if (public_xtra->print_press)
     {
       sprintf(file_postfix, "press.%05d", instance_xtra->file_number);
-      WritePFBinary(file_prefix, file_postfix, instance_xtra->pressure);
+      WritePFBinarySeries(file_prefix, file_postfix,
+                          instance_xtra->file_number,
+                          instance_xtra->pressure,
+                          instance_xtra->press_series);
       any_file_dumped = 1;
     }
 
@@ -3493,8 +3512,10 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
     if (print_satur)
     {
       sprintf(file_postfix, "satur.%05d", instance_xtra->file_number);
-      WritePFBinary(file_prefix, file_postfix,
-                    instance_xtra->saturation);
+      WritePFBinarySeries(file_prefix, file_postfix,
+                          instance_xtra->file_number,
+                          instance_xtra->saturation,
+                          instance_xtra->satur_series);
       any_file_dumped = 1;
     }
 
@@ -3639,6 +3660,9 @@ TeardownRichards(PFModule * this_module)
   FreeVector(instance_xtra->y_velocity);
   FreeVector(instance_xtra->z_velocity);
 
+  FreeCPFBSeries(instance_xtra->press_series);
+  FreeCPFBSeries(instance_xtra->satur_series);
+
   if (instance_xtra->evap_trans_sum)
   {
     FreeVector(instance_xtra->evap_trans_sum);
@@ -3737,6 +3761,9 @@ TeardownRichards(PFModule * this_module)
       fprintf(log_file, "\n");
       fprintf(log_file, "Total Timesteps: %d\n",
               instance_xtra->number_logged - 1);
+      fprintf(log_file, "BC Pressure Patch Rebuilds: %d (%d skipped)\n",
+              BCPressureDataNumRebuilds(ProblemDataBCPressureData(problem_data)),
+              BCPressureDataNumRebuildsSkipped(ProblemDataBCPressureData(problem_data)));
       fprintf(log_file, "\n");
       fprintf(log_file, "-------------------------\n");
       fprintf(log_file,
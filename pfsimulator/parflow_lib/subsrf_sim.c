@@ -117,39 +117,25 @@ void SubsrfSim(
 
   RFCondData       *cdata;
 
-  WellData         *well_data = ProblemDataWellData(problem_data);
-  WellDataPhysical *well_data_physical;
-
   VectorUpdateCommHandle       *handle;
 
   GrGeomSolid      *gr_solid, *gr_domain;
 
   Grid             *grid = VectorGrid(perm_x);
 
-  SubgridArray     *subgrids;
-
-  Subgrid          *subgrid,
-    *well_subgrid,
-    *tmp_subgrid;
+  Subgrid          *subgrid;
 
   Subvector        *perm_x_sub, *perm_y_sub, *perm_z_sub;
   Subvector        *kx_values_sub, *ky_values_sub, *kz_values_sub;
 
   int ix, iy, iz;
   int nx, ny, nz;
-  int nx_p, ny_p, nz_p;
-  double dx, dy, dz;
   int r;
-  int i, j, k, pi, sg, well;
+  int i, j, k, sg;
   int ipx, ipy, ipz, itp;
-  double           *perm_x_elt, *perm_y_elt, *perm_z_elt;
 
   double           *perm_x_dat, *perm_y_dat, *perm_z_dat;
   double           *kx_values_dat, *ky_values_dat, *kz_values_dat;
-  double well_volume, cell_volume;
-  double perm_average_x, perm_average_y, perm_average_z;
-
-  amps_Invoice result_invoice;
 
   (void)num_geounits;
 
@@ -341,6 +327,52 @@ void SubsrfSim(
    * Compute an average permeability for each flux well
    *------------------------------------------------------------------------*/
 
+  SubsrfSimWellPermeability(problem_data, perm_x, perm_y, perm_z);
+
+  EndTiming(public_xtra->time_index);
+
+  tfree(cdata);
+
+  return;
+}
+
+
+/*--------------------------------------------------------------------------
+ * SubsrfSimWellPermeability: compute the average permeability of each
+ * flux well from the permeability fields.
+ *--------------------------------------------------------------------------*/
+
+void SubsrfSimWellPermeability(
+                               ProblemData *problem_data,
+                               Vector *     perm_x,
+                               Vector *     perm_y,
+                               Vector *     perm_z)
+{
+  WellData         *well_data = ProblemDataWellData(problem_data);
+  WellDataPhysical *well_data_physical;
+
+  Grid             *grid;
+
+  SubgridArray     *subgrids;
+
+  Subgrid          *subgrid,
+    *well_subgrid,
+    *tmp_subgrid;
+
+  Subvector        *perm_x_sub, *perm_y_sub, *perm_z_sub;
+
+  int ix, iy, iz;
+  int nx, ny, nz;
+  int nx_p, ny_p, nz_p;
+  double dx, dy, dz;
+  int i, j, k, pi, sg, well;
+  double           *perm_x_elt, *perm_y_elt, *perm_z_elt;
+
+  double well_volume, cell_volume;
+  double perm_average_x, perm_average_y, perm_average_z;
+
+  amps_Invoice result_invoice;
+
   if (WellDataNumFluxWells(well_data) > 0)
   {
     grid = VectorGrid(perm_x);
@@ -449,12 +481,6 @@ void SubsrfSim(
       }
     }
   }
-
-  EndTiming(public_xtra->time_index);
-
-  tfree(cdata);
-
-  return;
 }
 
 
@@ -66,6 +66,9 @@ TimeCycleData *NewTimeCycleData(
 
   TimeCycleDataCycleLengths(time_cycle_data) = ctalloc(int, number_of_cycles);
 
+  /* Schedules are compiled on first use, once the intervals are set */
+  TimeCycleDataSchedules(time_cycle_data) = ctalloc(TimeCycleSchedule, number_of_cycles);
+
   return time_cycle_data;
 }
 
@@ -81,6 +84,15 @@ void FreeTimeCycleData(
 
   if (time_cycle_data)
   {
+    if (TimeCycleDataSchedules(time_cycle_data))
+    {
+      for (cycle_number = 0; cycle_number < TimeCycleDataNumberOfCycles(time_cycle_data); cycle_number++)
+      {
+        tfree(TimeCycleScheduleIntervalEnds(TimeCycleDataSchedule(time_cycle_data, cycle_number)));
+      }
+      tfree(TimeCycleDataSchedules(time_cycle_data));
+    }
+
     tfree(TimeCycleDataCycleLengths(time_cycle_data));
 
     tfree(TimeCycleDataRepeatCounts(time_cycle_data));
@@ -143,6 +155,96 @@ void PrintTimeCycleData(
 }
 
 
+/*--------------------------------------------------------------------------
+ * TimeCycleDataScheduleLookup
+ *
+ * Returns the interval of a cycle that holds time, given in base time
+ * units from the start time.  An interval covers the times after the end
+ * of the previous interval up to and including its own end.
+ *
+ * The running sums of the interval lengths are compiled on first use.
+ * A lookup inside the cursor window is then O(1); a later time moves the
+ * cursor forward over the transitions crossed, while a time before the
+ * cursor or more than a cycle past it is located from scratch.
+ *--------------------------------------------------------------------------*/
+
+static int TimeCycleDataScheduleLookup(
+                                       TimeCycleData *time_cycle_data,
+                                       int            cycle_number,
+                                       int            time)
+{
+  TimeCycleSchedule *schedule = TimeCycleDataSchedule(time_cycle_data, cycle_number);
+
+  int interval_division = TimeCycleDataIntervalDivision(time_cycle_data, cycle_number);
+  int cycle_length = TimeCycleDataCycleLength(time_cycle_data, cycle_number);
+  int               *interval_ends;
+  int interval_number, intervals_completed, total;
+
+  if (TimeCycleScheduleIntervalEnds(schedule) == NULL)
+  {
+    interval_ends = ctalloc(int, interval_division);
+    total = 0;
+    for (interval_number = 0; interval_number < interval_division; interval_number++)
+    {
+      total += TimeCycleDataInterval(time_cycle_data, cycle_number, interval_number);
+      interval_ends[interval_number] = total;
+    }
+    TimeCycleScheduleIntervalEnds(schedule) = interval_ends;
+    TimeCycleScheduleLower(schedule) = 0;
+    TimeCycleScheduleUpper(schedule) = 0;
+  }
+  interval_ends = TimeCycleScheduleIntervalEnds(schedule);
+
+  if ((TimeCycleScheduleLower(schedule) <= time)
+      && (time < TimeCycleScheduleUpper(schedule)))
+  {
+    return TimeCycleScheduleIntervalNumber(schedule);
+  }
+
+  if ((TimeCycleScheduleUpper(schedule) > 0)
+      && (TimeCycleScheduleUpper(schedule) <= time)
+      && (time < TimeCycleScheduleUpper(schedule) + cycle_length))
+  {
+    interval_number = TimeCycleScheduleIntervalNumber(schedule);
+    while (time >= TimeCycleScheduleUpper(schedule))
+    {
+      interval_number++;
+      if (interval_number == interval_division)
+      {
+        interval_number = 0;
+        TimeCycleScheduleCycleStart(schedule) += cycle_length;
+      }
+      TimeCycleScheduleLower(schedule) = TimeCycleScheduleUpper(schedule);
+      TimeCycleScheduleUpper(schedule) =
+        TimeCycleScheduleCycleStart(schedule) + interval_ends[interval_number] + 1;
+    }
+    TimeCycleScheduleIntervalNumber(schedule) = interval_number;
+
+    return interval_number;
+  }
+
+  // Determine the intervals completed in this cycle.
+  intervals_completed = (time - 1) % cycle_length;
+  interval_number = 0;
+  while (intervals_completed >= interval_ends[interval_number])
+  {
+    interval_number++;
+  }
+
+  if (time > 0)
+  {
+    TimeCycleScheduleIntervalNumber(schedule) = interval_number;
+    TimeCycleScheduleCycleStart(schedule) = (time - 1) - intervals_completed;
+    TimeCycleScheduleLower(schedule) = TimeCycleScheduleCycleStart(schedule) + 1
+                                       + ((interval_number > 0) ? interval_ends[interval_number - 1] : 0);
+    TimeCycleScheduleUpper(schedule) =
+      TimeCycleScheduleCycleStart(schedule) + interval_ends[interval_number] + 1;
+  }
+
+  return interval_number;
+}
+
+
 /*--------------------------------------------------------------------------
  * TimeCycleDataComputeIntervalNumber
  *--------------------------------------------------------------------------*/
@@ -160,9 +262,7 @@ int TimeCycleDataComputeIntervalNumber(
 
   int repeat_count;
   int cycle_length;
-  int intervals_completed;
   int interval_number;
-  int total;
 
   interval_number = -1;
   if (time_cycle_data != NULL)
@@ -180,15 +280,8 @@ int TimeCycleDataComputeIntervalNumber(
       discretized_time = pfround(time / (base_time_unit / TIME_CYCLE_SUBDIVISIONS)) / TIME_CYCLE_SUBDIVISIONS;
       discretized_start_time = pfround(start_time / (base_time_unit / TIME_CYCLE_SUBDIVISIONS)) / TIME_CYCLE_SUBDIVISIONS;
 
-      // Determine the intervals completed in this cycle.
-      intervals_completed = (discretized_time - discretized_start_time - 1) % cycle_length;
-      interval_number = 0;
-      total = TimeCycleDataInterval(time_cycle_data, cycle_number, interval_number);
-      while (intervals_completed >= total)
-      {
-        interval_number++;
-        total += TimeCycleDataInterval(time_cycle_data, cycle_number, interval_number);
-      }
+      interval_number = TimeCycleDataScheduleLookup(time_cycle_data, cycle_number,
+                                                    discretized_time - discretized_start_time);
     }
     else
     {
@@ -213,7 +306,7 @@ double TimeCycleDataComputeNextTransition(
   double stop_time = ProblemStopTime(problem);
 
   int repeat_count, cycle_length, interval_division;
-  int n, cycle_number, intervals_completed, interval_number, next_interval_number, total;
+  int n, cycle_number, interval_number, next_interval_number, total;
   int deltat_assigned;
   double deltat, time_defined, transition_time;
 
@@ -247,14 +340,10 @@ double TimeCycleDataComputeNextTransition(
         discretized_start_time = pfround(start_time / (base_time_unit / TIME_CYCLE_SUBDIVISIONS)) / TIME_CYCLE_SUBDIVISIONS;
 
         n = (discretized_time - discretized_start_time) / cycle_length;
-        intervals_completed = (discretized_time - discretized_start_time - 1) % cycle_length;
-        interval_number = 0;
-        total = TimeCycleDataInterval(time_cycle_data, cycle_number, interval_number);
-        while (intervals_completed >= total)
-        {
-          interval_number++;
-          total += TimeCycleDataInterval(time_cycle_data, cycle_number, interval_number);
-        }
+        interval_number = TimeCycleDataScheduleLookup(time_cycle_data, cycle_number,
+                                                      discretized_time - discretized_start_time);
+        total = TimeCycleScheduleIntervalEnd(TimeCycleDataSchedule(time_cycle_data, cycle_number),
+                                             interval_number);
         next_interval_number = (interval_number + 1) % interval_division;
         if (next_interval_number == 0)
         {
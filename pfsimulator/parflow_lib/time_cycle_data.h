@@ -29,6 +29,22 @@
 #ifndef _TIME_CYCLE_HEADER
 #define _TIME_CYCLE_HEADER
 
+/*----------------------------------------------------------------
+ * Time_Cycle schedule structure
+ *
+ * Compiled form of one cycle: the end of each interval within the
+ * cycle and a cursor on the interval holding the last time looked up.
+ * Times are in base time units from the start time; the cursor is valid
+ * for lower <= time < upper and moves forward as time advances.
+ *----------------------------------------------------------------*/
+
+typedef struct {
+  int  *interval_ends;
+  int interval_number;
+  int cycle_start;
+  int lower, upper;
+} TimeCycleSchedule;
+
 /*----------------------------------------------------------------
  * Time_Cycle structure
  *----------------------------------------------------------------*/
@@ -39,6 +55,8 @@ typedef struct {
   int **intervals;
   int  *repeat_counts;
   int  *cycle_lengths;
+
+  TimeCycleSchedule *schedules;
 } TimeCycleData;
 
 /*--------------------------------------------------------------------------
@@ -65,4 +83,24 @@ typedef struct {
 
 #define TimeCycleDataCycleLength(time_cycle_data, cycle_number) ((time_cycle_data)->cycle_lengths[cycle_number])
 
+#define TimeCycleDataSchedules(time_cycle_data) ((time_cycle_data)->schedules)
+
+#define TimeCycleDataSchedule(time_cycle_data, cycle_number) (&((time_cycle_data)->schedules[cycle_number]))
+
+/*--------------------------------------------------------------------------
+ * Accessor macros: TimeCycleSchedule
+ *--------------------------------------------------------------------------*/
+
+#define TimeCycleScheduleIntervalEnds(schedule) ((schedule)->interval_ends)
+
+#define TimeCycleScheduleIntervalEnd(schedule, interval_number) ((schedule)->interval_ends[interval_number])
+
+#define TimeCycleScheduleIntervalNumber(schedule) ((schedule)->interval_number)
+
+#define TimeCycleScheduleCycleStart(schedule) ((schedule)->cycle_start)
+
+#define TimeCycleScheduleLower(schedule) ((schedule)->lower)
+
+#define TimeCycleScheduleUpper(schedule) ((schedule)->upper)
+
 #endif
@@ -46,6 +46,20 @@ void  NewTiming()
 {
   timing = ctalloc(TimingType, 1);
 
+  {
+    NameArray switch_na;
+    char *switch_name;
+    switch_na = NA_NewNameArray("False True");
+    switch_name = GetStringDefault("Timing.TimeSeries", "False");
+    timing->series_enabled = NA_NameToIndex(switch_na, switch_name);
+    if (timing->series_enabled < 0)
+    {
+      InputError("Error: invalid value <%s> for key <%s>\n", switch_name,
+                 "Timing.TimeSeries");
+    }
+    NA_FreeNameArray(switch_na);
+  }
+
   /* The order of these registers need to be in sync with the defines
    * found in solver.h
    */
@@ -76,6 +90,8 @@ int  RegisterTiming(
   amps_CPUClock_t  *old_cpu_time = (timing->cpu_time);
   FLOPType         *old_flops = (timing->flops);
   char            **old_name = (timing->name);
+  int              *old_count = (timing->count);
+  int              *old_parent = (timing->parent);
   int old_size = (timing->size);
 
   int i;
@@ -85,6 +101,8 @@ int  RegisterTiming(
   (timing->cpu_time) = ctalloc(amps_CPUClock_t, (old_size + 1));
   (timing->flops) = ctalloc(FLOPType, (old_size + 1));
   (timing->name) = ctalloc(char *, (old_size + 1));
+  (timing->count) = ctalloc(int, (old_size + 1));
+  (timing->parent) = ctalloc(int, (old_size + 1));
 
   (timing->size)++;
 
@@ -94,12 +112,17 @@ int  RegisterTiming(
     (timing->cpu_time)[i] = old_cpu_time[i];
     (timing->flops)[i] = old_flops[i];
     (timing->name)[i] = old_name[i];
+    (timing->count)[i] = old_count[i];
+    (timing->parent)[i] = old_parent[i];
   }
+  (timing->parent)[old_size] = TimingNoParent;
 
   tfree(old_time);
   tfree(old_cpu_time);
   tfree(old_flops);
   tfree(old_name);
+  tfree(old_count);
+  tfree(old_parent);
 
   (timing->name)[old_size] = ctalloc(char, 50);
   strncpy((timing->name)[old_size], name, 49);
@@ -108,6 +131,121 @@ int  RegisterTiming(
 }
 
 
+/*--------------------------------------------------------------------------
+ * RecordTimingStep
+ *
+ * Record the accumulated time of every region at the end of a time
+ * step.  Only done if the Timing.TimeSeries key is set.
+ *--------------------------------------------------------------------------*/
+
+void  RecordTimingStep(
+                       int    step,
+                       double time)
+{
+  int n, i, d;
+  double *row;
+
+  if (!timing->series_enabled)
+  {
+    return;
+  }
+
+  if (timing->series_length == timing->series_capacity)
+  {
+    int new_capacity = timing->series_capacity ? 2 * timing->series_capacity : 64;
+
+    int     *new_step = ctalloc(int, new_capacity);
+    double  *new_time = ctalloc(double, new_capacity);
+    int     *new_size = ctalloc(int, new_capacity);
+    double **new_series = ctalloc(double *, new_capacity);
+
+    for (n = 0; n < timing->series_length; n++)
+    {
+      new_step[n] = timing->series_step[n];
+      new_time[n] = timing->series_time[n];
+      new_size[n] = timing->series_size[n];
+      new_series[n] = timing->series[n];
+    }
+
+    tfree(timing->series_step);
+    tfree(timing->series_time);
+    tfree(timing->series_size);
+    tfree(timing->series);
+
+    timing->series_step = new_step;
+    timing->series_time = new_time;
+    timing->series_size = new_size;
+    timing->series = new_series;
+    timing->series_capacity = new_capacity;
+  }
+
+  n = timing->series_length++;
+
+  timing->series_step[n] = step;
+  timing->series_time[n] = time;
+  timing->series_size[n] = timing->size;
+  timing->series[n] = row = ctalloc(double, timing->size);
+
+  StopTiming();
+
+  for (i = 0; i < timing->size; i++)
+  {
+    row[i] = (double)TimingTime(i);
+  }
+
+  /* Regions that are still active have not added their current time */
+  for (d = 0; d < pfmin(timing->stack_depth, TimingMaxDepth); d++)
+  {
+    row[timing->stack[d]] += (double)TimingTimeCount;
+  }
+
+  StartTiming();
+}
+
+
+/*--------------------------------------------------------------------------
+ * TimingDepth
+ *
+ * Nesting depth of a region found by following the parents.
+ *--------------------------------------------------------------------------*/
+
+static int  TimingDepth(
+                        int i)
+{
+  int depth = 0;
+  int parent = TimingParent(i);
+
+  while ((parent >= 0) && (depth < TimingMaxDepth))
+  {
+    depth++;
+    parent = TimingParent(parent);
+  }
+
+  return depth;
+}
+
+
+/*--------------------------------------------------------------------------
+ * TimingWriteJSONString
+ *--------------------------------------------------------------------------*/
+
+static void  TimingWriteJSONString(
+                                   FILE *file,
+                                   char *string)
+{
+  fputc('"', file);
+  for (; *string; string++)
+  {
+    if ((*string == '"') || (*string == '\\'))
+    {
+      fputc('\\', file);
+    }
+    fputc(*string, file);
+  }
+  fputc('"', file);
+}
+
+
 /*--------------------------------------------------------------------------
  * PrintTiming
  *--------------------------------------------------------------------------*/
@@ -116,40 +254,96 @@ void  PrintTiming()
 {
   amps_File file = NULL;
   amps_Invoice max_invoice;
+  amps_Invoice min_invoice;
+  amps_Invoice sum_invoice;
 
   double time_ticks[timing ->size];
   double cpu_ticks[timing ->size];
   double mflops[timing ->size];
+  double calls[timing ->size];
+  double min_ticks[timing ->size];
+  double mean_ticks[timing ->size];
 
-  int i;
+  double *step_ticks = NULL;
+  int num_steps = timing->series_length;
 
-  max_invoice = amps_NewInvoice("%*d%*d", timing->size, &time_ticks, timing->size, &cpu_ticks);
+  int num_procs = amps_Size(amps_CommWorld);
+
+  int i, n, depth;
+
+  max_invoice = amps_NewInvoice("%*d%*d%*d", timing->size, &time_ticks, timing->size, &cpu_ticks,
+                                timing->size, &calls);
+  min_invoice = amps_NewInvoice("%*d", timing->size, &min_ticks);
+  sum_invoice = amps_NewInvoice("%*d", timing->size, &mean_ticks);
 
   for (i = 0; i < (timing->size); i++)
   {
     time_ticks[i] = (double)((timing->time)[i]);
     cpu_ticks[i] = (double)((timing->cpu_time)[i]);
+    calls[i] = (double)((timing->count)[i]);
+    min_ticks[i] = time_ticks[i];
+    mean_ticks[i] = time_ticks[i];
   }
 
   amps_AllReduce(amps_CommWorld, max_invoice, amps_Max);
+  amps_AllReduce(amps_CommWorld, min_invoice, amps_Min);
+  amps_AllReduce(amps_CommWorld, sum_invoice, amps_Add);
 
   for (i = 0; i < (timing->size); i++)
   {
-    mflops[i] = time_ticks ?
+    mean_ticks[i] /= num_procs;
+
+    mflops[i] = time_ticks[i] ?
       ((timing->flops)[i] / (time_ticks[i] / AMPS_TICKS_PER_SEC)) / 1.0E6
       : 0.0;
   }
 
+  /*
+   * Per time step time spent in each region, as the maximum over the
+   * processes of the time accumulated during the step.
+   */
+  if (num_steps > 0)
+  {
+    amps_Invoice step_invoice;
+    int step_size = num_steps * timing->size;
+
+    step_ticks = ctalloc(double, step_size);
+
+    for (n = 0; n < num_steps; n++)
+    {
+      for (i = 0; i < timing->series_size[n]; i++)
+      {
+        double previous = (n > 0 && i < timing->series_size[n - 1]) ?
+                          timing->series[n - 1][i] : 0.0;
+        step_ticks[n * timing->size + i] = timing->series[n][i] - previous;
+      }
+    }
+
+    step_invoice = amps_NewInvoice("%*d", step_size, step_ticks);
+    amps_AllReduce(amps_CommWorld, step_invoice, amps_Max);
+    amps_FreeInvoice(step_invoice);
+  }
+
   IfLogging(0)
   {
     file = OpenLogFile("Timing");
 
     for (i = 0; i < (timing->size); i++)
     {
-      amps_Fprintf(file, "%s:\n", (timing->name)[i]);
-      amps_Fprintf(file, "  wall clock time   = %f seconds\n",
+      /* Indent nested regions under their parent */
+      depth = TimingDepth(i);
+
+      amps_Fprintf(file, "%*s%s:\n", 2 * depth, "", (timing->name)[i]);
+      amps_Fprintf(file, "%*s  wall clock time   = %f seconds\n", 2 * depth, "",
 		   time_ticks[i] / AMPS_TICKS_PER_SEC);
-      amps_Fprintf(file, "  wall MFLOPS = %f (%g)\n", mflops[i],
+      amps_Fprintf(file, "%*s  calls = %d\n", 2 * depth, "", (int)calls[i]);
+      amps_Fprintf(file, "%*s  min/mean/max time = %f/%f/%f seconds (imbalance %f)\n",
+                   2 * depth, "",
+                   min_ticks[i] / AMPS_TICKS_PER_SEC,
+                   mean_ticks[i] / AMPS_TICKS_PER_SEC,
+                   time_ticks[i] / AMPS_TICKS_PER_SEC,
+                   mean_ticks[i] > 0.0 ? time_ticks[i] / mean_ticks[i] : 1.0);
+      amps_Fprintf(file, "%*s  wall MFLOPS = %f (%g)\n", 2 * depth, "", mflops[i],
                    (timing->flops)[i]);
 #ifdef CPUTiming
       if (AMPS_CPU_TICKS_PER_SEC)
@@ -174,15 +368,99 @@ void  PrintTiming()
       InputError("Error: can't open output file %s%s\n", filename, "");
     }
 
-    fprintf(file, "Timer,Time (s),MFLOPS (mops/s),FLOP (op)\n");
+    fprintf(file, "Timer,Time (s),MFLOPS (mops/s),FLOP (op),Calls,Min Time (s),Mean Time (s),Imbalance,Parent\n");
     for (i = 0; i < (timing->size); i++)
     {
-      fprintf(file, "%s,%f,%f,%g\n", timing->name[i], 
+      fprintf(file, "%s,%f,%f,%g,%d,%f,%f,%f,%s\n", timing->name[i], 
 	      time_ticks[i] / AMPS_TICKS_PER_SEC,
-	      mflops[i], (timing->flops)[i]);
+	      mflops[i], (timing->flops)[i],
+              (int)calls[i],
+              min_ticks[i] / AMPS_TICKS_PER_SEC,
+              mean_ticks[i] / AMPS_TICKS_PER_SEC,
+              mean_ticks[i] > 0.0 ? time_ticks[i] / mean_ticks[i] : 1.0,
+              TimingParent(i) >= 0 ? timing->name[TimingParent(i)] : "");
     }
     
     fclose(file);
+
+    /*
+     * Machine readable summary including the per time step series.
+     */
+    sprintf(filename, "%s.timing.json", GlobalsOutFileName);
+
+    if ((file = fopen(filename, "w")) == NULL)
+    {
+      InputError("Error: can't open output file %s%s\n", filename, "");
+    }
+
+    fprintf(file, "{\n  \"processes\": %d,\n  \"timers\": [\n", num_procs);
+    for (i = 0; i < (timing->size); i++)
+    {
+      fprintf(file, "    {\"name\": ");
+      TimingWriteJSONString(file, timing->name[i]);
+      fprintf(file, ", \"parent\": ");
+      if (TimingParent(i) >= 0)
+      {
+        TimingWriteJSONString(file, timing->name[TimingParent(i)]);
+      }
+      else
+      {
+        fprintf(file, "null");
+      }
+      fprintf(file, ", \"depth\": %d, \"calls\": %d", TimingDepth(i), (int)calls[i]);
+      fprintf(file, ", \"time\": {\"min\": %f, \"mean\": %f, \"max\": %f, \"imbalance\": %f}",
+              min_ticks[i] / AMPS_TICKS_PER_SEC,
+              mean_ticks[i] / AMPS_TICKS_PER_SEC,
+              time_ticks[i] / AMPS_TICKS_PER_SEC,
+              mean_ticks[i] > 0.0 ? time_ticks[i] / mean_ticks[i] : 1.0);
+      fprintf(file, ", \"mflops\": %f, \"flops\": %g}%s\n",
+              mflops[i], (timing->flops)[i],
+              (i < timing->size - 1) ? "," : "");
+    }
+    fprintf(file, "  ],\n  \"steps\": [\n");
+    for (n = 0; n < num_steps; n++)
+    {
+      fprintf(file, "    {\"step\": %d, \"time\": %g, \"timers\": [",
+              timing->series_step[n], timing->series_time[n]);
+      for (i = 0; i < (timing->size); i++)
+      {
+        fprintf(file, "%s%f", i ? ", " : "",
+                step_ticks[n * timing->size + i] / AMPS_TICKS_PER_SEC);
+      }
+      fprintf(file, "]}%s\n", (n < num_steps - 1) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+
+    fclose(file);
+
+    if (num_steps > 0)
+    {
+      sprintf(filename, "%s.timing.steps.csv", GlobalsOutFileName);
+
+      if ((file = fopen(filename, "w")) == NULL)
+      {
+        InputError("Error: can't open output file %s%s\n", filename, "");
+      }
+
+      fprintf(file, "Step,Time");
+      for (i = 0; i < (timing->size); i++)
+      {
+        fprintf(file, ",%s (s)", timing->name[i]);
+      }
+      fprintf(file, "\n");
+
+      for (n = 0; n < num_steps; n++)
+      {
+        fprintf(file, "%d,%g", timing->series_step[n], timing->series_time[n]);
+        for (i = 0; i < (timing->size); i++)
+        {
+          fprintf(file, ",%f", step_ticks[n * timing->size + i] / AMPS_TICKS_PER_SEC);
+        }
+        fprintf(file, "\n");
+      }
+
+      fclose(file);
+    }
   }
 
 #ifdef VECTOR_UPDATE_TIMING
@@ -210,7 +488,11 @@ void  PrintTiming()
   }
 #endif
 
+  tfree(step_ticks);
+
   amps_FreeInvoice(max_invoice);
+  amps_FreeInvoice(min_invoice);
+  amps_FreeInvoice(sum_invoice);
 }
 
 
@@ -230,6 +512,16 @@ void  FreeTiming()
   tfree(timing->cpu_time);
   tfree(timing->flops);
   tfree(timing->name);
+  tfree(timing->count);
+  tfree(timing->parent);
+
+  for (i = 0; i < timing->series_length; i++)
+    tfree(timing->series[i]);
+
+  tfree(timing->series_step);
+  tfree(timing->series_time);
+  tfree(timing->series_size);
+  tfree(timing->series);
 
   tfree(timing);
 }
@@ -60,17 +60,40 @@
 
 typedef double FLOPType;
 
+/* Maximum nesting depth of timing regions that is tracked */
+#define TimingMaxDepth 64
+
+/* Parent value for regions that have not been entered yet */
+#define TimingNoParent -2
+
 typedef struct {
   amps_Clock_t     *time;
   amps_CPUClock_t  *cpu_time;
   FLOPType         *flops;
   char            **name;
 
+  /* Number of calls and enclosing region (-1 for top level) */
+  int              *count;
+  int              *parent;
+
   int size;
 
   amps_Clock_t time_count;
   amps_CPUClock_t CPU_count;
   FLOPType FLOP_count;
+
+  /* Stack of active regions used to find the nesting */
+  int stack[TimingMaxDepth];
+  int stack_depth;
+
+  /* Optional per time step series of the accumulated times */
+  int series_enabled;
+  int series_length;
+  int series_capacity;
+  int              *series_step;
+  double           *series_time;
+  int              *series_size;
+  double          **series;
 } TimingType;
 
 #ifdef PARFLOW_GLOBALS
@@ -90,6 +113,9 @@ amps_ThreadLocalDcl(extern TimingType *, timing_ptr);
 #define TimingFLOPS(i)   (timing->flops[(i)])
 #define TimingName(i)    (timing->name[(i)])
 
+#define TimingCount(i)   (timing->count[(i)])
+#define TimingParent(i)  (timing->parent[(i)])
+
 #define TimingSize       (timing->size)
 
 #define TimingTimeCount  (timing->time_count)
@@ -106,10 +132,38 @@ amps_ThreadLocalDcl(extern TimingType *, timing_ptr);
 #define StopTiming()      TimingTimeCount += amps_Clock(); \
   TimingCPUCount += amps_CPUClock()
 
+/*
+ * Track call counts and nesting of regions.  The parent of a region is
+ * the region that was active the first time it was entered.
+ */
+#define EnterTimingRegion(i) \
+  { \
+    TimingCount(i)++; \
+    if (TimingParent(i) == TimingNoParent) \
+    { \
+      TimingParent(i) = timing->stack_depth ? \
+                        timing->stack[timing->stack_depth - 1] : -1; \
+    } \
+    if (timing->stack_depth < TimingMaxDepth) \
+    { \
+      timing->stack[timing->stack_depth] = (i); \
+    } \
+    timing->stack_depth++; \
+  }
+
+#define ExitTimingRegion(i) \
+  { \
+    if (timing->stack_depth > 0) \
+    { \
+      timing->stack_depth--; \
+    } \
+  }
+
 #ifdef TIMING_WITH_SYNC
 #define BeginTiming(i) \
   { \
     StopTiming(); \
+    EnterTimingRegion(i); \
     TimingTime(i) -= TimingTimeCount; \
     TimingCPUTime(i) -= TimingCPUCount; \
     TimingFLOPS(i) -= TimingFLOPCount; \
@@ -120,6 +174,7 @@ amps_ThreadLocalDcl(extern TimingType *, timing_ptr);
 #define BeginTiming(i) \
   { \
     StopTiming(); \
+    EnterTimingRegion(i); \
     TimingTime(i) -= TimingTimeCount; \
     TimingCPUTime(i) -= TimingCPUCount; \
     TimingFLOPS(i) -= TimingFLOPCount; \
@@ -133,6 +188,7 @@ amps_ThreadLocalDcl(extern TimingType *, timing_ptr);
     TimingTime(i) += TimingTimeCount; \
     TimingCPUTime(i) += TimingCPUCount; \
     TimingFLOPS(i) += TimingFLOPCount; \
+    ExitTimingRegion(i); \
     StartTiming(); \
   }
 
@@ -169,6 +225,7 @@ extern EventTiming[][6];
 #define EndTiming(i)
 #define NewTiming()
 #define RegisterTiming(name) 0
+#define RecordTimingStep(step, time)
 #define PrintTiming()
 #define FreeTiming()
 
@@ -53,6 +53,8 @@ typedef struct {
   double high_cutoff;
   int seed;
   int strat_type;
+  int tb_mode;
+  int rng;
 } PublicXtra;
 
 typedef struct {
@@ -102,6 +104,8 @@ void          TurningBandsRF(
   int strat_type = (public_xtra->strat_type);
   double low_cutoff = (public_xtra->low_cutoff);
   double high_cutoff = (public_xtra->high_cutoff);
+  int tb_mode = (public_xtra->tb_mode);
+  int rng = (public_xtra->rng);
 
   double pi = acos(-1.0);
 
@@ -131,6 +135,13 @@ void          TurningBandsRF(
 
   double     *Z;
 
+  double     *unitx_array, *unity_array, *unitz_array;
+  double     *mode_phase, *mode_freq, *mode_amp;
+  double     *xs, *ys, *zs;
+  double zeta_lo, zeta_hi, sum;
+  int        *izeta_array, *nzeta_array;
+  int num_modes, nzeta_max;
+
   int is, l, i, j, k;
   int index;
   int doing_TB;
@@ -159,6 +170,62 @@ void          TurningBandsRF(
     phi_array[l] = acos(1.0 - 2.0 * Rand());
   }
 
+  /*-----------------------------------------------------------------------
+   * In Scalable mode the line directions and spectral modes are drawn
+   * once, in the order LineProc would draw them for a single subgrid,
+   * so every subgrid on every process builds its lines from the same
+   * random numbers.  With the Counter generator each line is keyed by
+   * its index and does not depend on any other line.
+   *-----------------------------------------------------------------------*/
+
+  unitx_array = unity_array = unitz_array = NULL;
+  mode_phase = mode_freq = mode_amp = NULL;
+  num_modes = 0;
+
+  if (tb_mode == 1)
+  {
+    num_modes = (int)(Kmax / dK);
+
+    unitx_array = talloc(double, num_lines);
+    unity_array = talloc(double, num_lines);
+    unitz_array = talloc(double, num_lines);
+
+    mode_phase = talloc(double, num_lines * num_modes);
+    mode_freq = talloc(double, num_lines * num_modes);
+    mode_amp = talloc(double, num_lines * num_modes);
+
+    for (l = 0; l < num_lines; l++)
+    {
+      if (rng == 1)
+      {
+        theta_array[l] = 2.0 * pi * CounterRand(public_xtra->seed, l, 0, 0, 0);
+        phi_array[l] = acos(1.0 - 2.0 * CounterRand(public_xtra->seed, l, 0, 1, 0));
+      }
+
+      theta = theta_array[l];
+      phi = phi_array[l];
+
+      unitx_array[l] = cos(theta) * sin(phi);
+      unity_array[l] = sin(theta) * sin(phi);
+      unitz_array[l] = cos(phi);
+
+      if (rng == 1)
+      {
+        LineProcModesCounter(mode_phase + l * num_modes,
+                             mode_freq + l * num_modes,
+                             mode_amp + l * num_modes,
+                             Kmax, dK, public_xtra->seed, l);
+      }
+      else
+      {
+        LineProcModes(mode_phase + l * num_modes,
+                      mode_freq + l * num_modes,
+                      mode_amp + l * num_modes,
+                      Kmax, dK);
+      }
+    }
+  }
+
   /*-----------------------------------------------------------------------
    * Determine by how much to shear the field:
    *   If there is no GeomSolid representation of the geounit, then
@@ -275,47 +342,126 @@ void          TurningBandsRF(
      * Generate lines
      *--------------------------------------------------------------------*/
 
-    /* malloc space for Z */
-    nzeta = (int)((sqrt(pow((xhi - xlo), 2.0) +
-                        pow((yhi - ylo), 2.0) +
-                        pow((sh_zhi - sh_zlo), 2.0)) / dzeta)) + 2;
-    Z = talloc(double, nzeta);
-
-    for (l = 0; l < num_lines; l++)
+    if (tb_mode == 0)
     {
-      /* determine phi, theta (line direction) */
-      theta = theta_array[l];
-      phi = phi_array[l];
-
-      /* compute unitx, unity, unitz */
-      unitx = cos(theta) * sin(phi);
-      unity = sin(theta) * sin(phi);
-      unitz = cos(phi);
-
-      /* determine izeta, and nzeta */
-      zeta = (pfmin(xlo * unitx, xhi * unitx) +
-              pfmin(ylo * unity, yhi * unity) +
-              pfmin(sh_zlo * unitz, sh_zhi * unitz));
-      izeta = Index(zeta, dzeta);
-      nzeta = (int)((fabs((xhi - xlo) * unitx) +
-                     fabs((yhi - ylo) * unity) +
-                     fabs((sh_zhi - sh_zlo) * unitz)) / dzeta) + 2;
+      /* malloc space for Z */
+      nzeta = (int)((sqrt(pow((xhi - xlo), 2.0) +
+                          pow((yhi - ylo), 2.0) +
+                          pow((sh_zhi - sh_zlo), 2.0)) / dzeta)) + 2;
+      Z = talloc(double, nzeta);
 
-      /* Get the line process, Z */
-      LineProc(Z, phi, theta, dzeta, izeta, nzeta, Kmax, dK);
-
-      /* Project Z onto field */
+      for (l = 0; l < num_lines; l++)
+      {
+        /* determine phi, theta (line direction) */
+        theta = theta_array[l];
+        phi = phi_array[l];
+
+        /* compute unitx, unity, unitz */
+        unitx = cos(theta) * sin(phi);
+        unity = sin(theta) * sin(phi);
+        unitz = cos(phi);
+
+        /* determine izeta, and nzeta */
+        zeta = (pfmin(xlo * unitx, xhi * unitx) +
+                pfmin(ylo * unity, yhi * unity) +
+                pfmin(sh_zlo * unitz, sh_zhi * unitz));
+        izeta = Index(zeta, dzeta);
+        nzeta = (int)((fabs((xhi - xlo) * unitx) +
+                       fabs((yhi - ylo) * unity) +
+                       fabs((sh_zhi - sh_zlo) * unitz)) / dzeta) + 2;
+
+        /* Get the line process, Z */
+        LineProc(Z, phi, theta, dzeta, izeta, nzeta, Kmax, dK);
+
+        /* Project Z onto field */
+        fieldp = SubvectorData(field_sub);
+        GrGeomInLoop(i, j, k, gr_geounit, r, ix, iy, iz, nx, ny, nz,
+        {
+          index = SubvectorEltIndex(field_sub, i, j, k);
+
+          x = xlo + (i - ix) * dx;
+          y = ylo + (j - iy) * dy;
+          z = zlo + (k - iz) * dz - shear_array[(j - iy) * nx + (i - ix)];
+          zeta = x * unitx + y * unity + z * unitz;
+          fieldp[index] += Z[Index(zeta, dzeta) - izeta];
+        });
+      }
+    }
+    else
+    {
+      /*------------------------------------------------------------------
+       * Cell coordinates are computed from the global cell indices, not
+       * from the subgrid origin, so a cell gets the same zeta on every
+       * line however the domain is decomposed.
+       *------------------------------------------------------------------*/
+
+      xs = talloc(double, nx);
+      ys = talloc(double, ny);
+      zs = talloc(double, nz);
+      for (i = 0; i < nx; i++)
+        xs[i] = RealSpaceX(ix + i, SubgridRX(subgrid)) / lambdaX;
+      for (j = 0; j < ny; j++)
+        ys[j] = RealSpaceY(iy + j, SubgridRY(subgrid)) / lambdaY;
+      for (k = 0; k < nz; k++)
+        zs[k] = RealSpaceZ(iz + k, SubgridRZ(subgrid)) / lambdaZ;
+
+      /* Each line only covers the zeta range of this subgrid; the extra
+       * point on either end absorbs rounding in the cell zeta values */
+      izeta_array = talloc(int, num_lines);
+      nzeta_array = talloc(int, num_lines);
+      nzeta_max = 0;
+      for (l = 0; l < num_lines; l++)
+      {
+        zeta_lo = (pfmin(xs[0] * unitx_array[l], xs[nx - 1] * unitx_array[l]) +
+                   pfmin(ys[0] * unity_array[l], ys[ny - 1] * unity_array[l]) +
+                   pfmin((zs[0] - shear_max[is]) * unitz_array[l],
+                         (zs[nz - 1] - shear_min[is]) * unitz_array[l]));
+        zeta_hi = (pfmax(xs[0] * unitx_array[l], xs[nx - 1] * unitx_array[l]) +
+                   pfmax(ys[0] * unity_array[l], ys[ny - 1] * unity_array[l]) +
+                   pfmax((zs[0] - shear_max[is]) * unitz_array[l],
+                         (zs[nz - 1] - shear_min[is]) * unitz_array[l]));
+
+        izeta_array[l] = Index(zeta_lo, dzeta) - 1;
+        nzeta_array[l] = Index(zeta_hi, dzeta) + 1 - izeta_array[l] + 1;
+        nzeta_max = pfmax(nzeta_max, nzeta_array[l]);
+      }
+
+      Z = talloc(double, num_lines * nzeta_max);
+      for (l = 0; l < num_lines; l++)
+      {
+        LineProcSynthesize(Z + l * nzeta_max,
+                           mode_phase + l * num_modes,
+                           mode_freq + l * num_modes,
+                           mode_amp + l * num_modes,
+                           num_modes, dzeta, izeta_array[l], nzeta_array[l]);
+      }
+
+      /* Project all of the lines onto each cell in one pass; the sum
+       * over lines is in line order so it matches the Standard mode
+       * accumulation */
       fieldp = SubvectorData(field_sub);
       GrGeomInLoop(i, j, k, gr_geounit, r, ix, iy, iz, nx, ny, nz,
       {
         index = SubvectorEltIndex(field_sub, i, j, k);
 
-        x = xlo + (i - ix) * dx;
-        y = ylo + (j - iy) * dy;
-        z = zlo + (k - iz) * dz - shear_array[(j - iy) * nx + (i - ix)];
-        zeta = x * unitx + y * unity + z * unitz;
-        fieldp[index] += Z[Index(zeta, dzeta) - izeta];
+        x = xs[i - ix];
+        y = ys[j - iy];
+        z = zs[k - iz] - shear_array[(j - iy) * nx + (i - ix)];
+
+        sum = 0.0;
+        for (l = 0; l < num_lines; l++)
+        {
+          zeta = x * unitx_array[l] + y * unity_array[l] + z * unitz_array[l];
+          sum += Z[l * nzeta_max + Index(zeta, dzeta) - izeta_array[l]];
+        }
+        fieldp[index] = sum;
       });
+
+      tfree(izeta_array);
+      tfree(nzeta_array);
+      tfree(xs);
+      tfree(ys);
+      tfree(zs);
     }
 
     /*--------------------------------------------------------------------
@@ -402,6 +548,12 @@ void          TurningBandsRF(
   tfree(shear_max);
   tfree(theta_array);
   tfree(phi_array);
+  tfree(unitx_array);
+  tfree(unity_array);
+  tfree(unitz_array);
+  tfree(mode_phase);
+  tfree(mode_freq);
+  tfree(mode_amp);
 
   /*-----------------------------------------------------------------------
    * END grid loop
@@ -482,6 +634,8 @@ PFModule   *TurningBandsRFNewPublicXtra(char *geom_name)
 
   NameArray log_normal_na;
   NameArray strat_type_na;
+  NameArray tb_mode_na;
+  NameArray rng_na;
 
   char *tmp;
 
@@ -535,6 +689,34 @@ PFModule   *TurningBandsRFNewPublicXtra(char *geom_name)
   }
   NA_FreeNameArray(strat_type_na);
 
+  tb_mode_na = NA_NewNameArray("Standard Scalable");
+  sprintf(key, "Geom.%s.Perm.TurnBandsMode", geom_name);
+  tmp = GetStringDefault(key, "Standard");
+  /* Convert the name to a numeric index */
+  if ((public_xtra->tb_mode = NA_NameToIndex(tb_mode_na, tmp)) < 0)
+  {
+    InputError("Error: Invalid TurnBandsMode for key <%s> was <%s>\n",
+               key, tmp);
+  }
+  NA_FreeNameArray(tb_mode_na);
+
+  rng_na = NA_NewNameArray("Sequential Counter");
+  sprintf(key, "Geom.%s.Perm.RandomGenerator", geom_name);
+  tmp = GetStringDefault(key, "Sequential");
+  /* Convert the name to a numeric index */
+  if ((public_xtra->rng = NA_NameToIndex(rng_na, tmp)) < 0)
+  {
+    InputError("Error: Invalid RandomGenerator for key <%s> was <%s>\n",
+               key, tmp);
+  }
+  NA_FreeNameArray(rng_na);
+
+  if ((public_xtra->rng == 1) && (public_xtra->tb_mode == 0))
+  {
+    InputError("Error: RandomGenerator <%s> for key <%s> requires TurnBandsMode Scalable\n",
+               tmp, key);
+  }
+
   if (public_xtra->log_normal > 1)
   {
     sprintf(key, "Geom.%s.Perm.LowCutoff", geom_name);
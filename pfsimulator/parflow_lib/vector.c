@@ -877,7 +877,9 @@ void    InitVectorInc(
 
 
 /*--------------------------------------------------------------------------
- * InitVectorRandom
+ * InitVectorRandom:
+ *   Each cell gets the counter-based deviate for its global index, so
+ *   the vector is the same for any process topology.
  *--------------------------------------------------------------------------*/
 
 void    InitVectorRandom(
@@ -898,8 +900,6 @@ void    InitVectorRandom(
   int i_s;
   int i, j, k, iv;
 
-  srand48(seed);
-
   ForSubgridI(i_s, GridSubgrids(grid))
   {
     subgrid = GridSubgrid(grid, i_s);
@@ -924,7 +924,7 @@ void    InitVectorRandom(
     BoxLoopI1(i, j, k, ix, iy, iz, nx, ny, nz,
               iv, nx_v, ny_v, nz_v, 1, 1, 1,
     {
-      vp[iv] = drand48();
+      vp[iv] = CounterRand((int)seed, 0, i, j, k);
     });
   }
 }
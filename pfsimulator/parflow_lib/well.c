@@ -785,7 +785,7 @@ void WriteWells(
 
   Subgrid          *subgrid;
 
-  int cycle_number, interval_number;
+  int cycle_number, interval_number, *interval_numbers;
   int well, phase, concentration, indx;
   double value, stat;
 
@@ -804,6 +804,13 @@ void WriteWells(
 
     if (p == 0)
     {
+      /* The interval of each cycle, shared by all the wells on it */
+      interval_numbers = ctalloc(int, TimeCycleDataNumberOfCycles(time_cycle_data));
+      for (cycle_number = 0; cycle_number < TimeCycleDataNumberOfCycles(time_cycle_data); cycle_number++)
+      {
+        interval_numbers[cycle_number] = TimeCycleDataComputeIntervalNumber(problem, time, time_cycle_data, cycle_number);
+      }
+
       sprintf(filename, "%s.%s", file_prefix, file_suffix);
 
       if (write_header)
@@ -904,7 +911,7 @@ void WriteWells(
 
         /* Write out the current well values */
         cycle_number = WellDataPhysicalCycleNumber(well_data_physical);
-        interval_number = TimeCycleDataComputeIntervalNumber(problem, time, time_cycle_data, cycle_number);
+        interval_number = interval_numbers[cycle_number];
 
         well_data_value = WellDataFluxWellIntervalValue(well_data, well, interval_number);
 
@@ -1054,8 +1061,7 @@ void WriteWells(
 
         /* Write out the current well values */
         cycle_number = WellDataPhysicalCycleNumber(well_data_physical);
-        interval_number = TimeCycleDataComputeIntervalNumber(problem,
-                                                             time, time_cycle_data, cycle_number);
+        interval_number = interval_numbers[cycle_number];
 
         well_data_value = WellDataPressWellIntervalValue(well_data, well,
                                                          interval_number);
@@ -1188,6 +1194,218 @@ void WriteWells(
       }
 
       fclose(file);
+
+      tfree(interval_numbers);
+    }
+  }
+}
+
+
+/*--------------------------------------------------------------------------
+ * WellIndexMayIntersect
+ *
+ * Cheap test used to skip the wells that cannot intersect a subgrid
+ * before calling IntersectSubgrids, which allocates.  Subgrids at
+ * different resolutions are always passed through.
+ *--------------------------------------------------------------------------*/
+
+static int WellIndexMayIntersect(
+                                 Subgrid *well_subgrid,
+                                 Subgrid *subgrid)
+{
+  if ((SubgridRX(well_subgrid) != SubgridRX(subgrid)) ||
+      (SubgridRY(well_subgrid) != SubgridRY(subgrid)) ||
+      (SubgridRZ(well_subgrid) != SubgridRZ(subgrid)))
+  {
+    return 1;
+  }
+
+  return (SubgridIX(well_subgrid) < SubgridIX(subgrid) + SubgridNX(subgrid)) &&
+         (SubgridIX(subgrid) < SubgridIX(well_subgrid) + SubgridNX(well_subgrid)) &&
+         (SubgridIY(well_subgrid) < SubgridIY(subgrid) + SubgridNY(subgrid)) &&
+         (SubgridIY(subgrid) < SubgridIY(well_subgrid) + SubgridNY(well_subgrid)) &&
+         (SubgridIZ(well_subgrid) < SubgridIZ(subgrid) + SubgridNZ(subgrid)) &&
+         (SubgridIZ(subgrid) < SubgridIZ(well_subgrid) + SubgridNZ(well_subgrid));
+}
+
+
+/*--------------------------------------------------------------------------
+ * NewWellIndex
+ *
+ * Build the index of the flux wells that intersect the subgrids of grid
+ * on this process.  The per cell weights of the flux methods depend only
+ * on the permeability so they are computed once here; the index must be
+ * rebuilt if the grid, the well data or the permeability changes.
+ *--------------------------------------------------------------------------*/
+
+WellIndex *NewWellIndex(
+                        WellData *well_data,
+                        Grid *    grid,
+                        Vector *  perm_x,
+                        Vector *  perm_y,
+                        Vector *  perm_z)
+{
+  WellIndex        *well_index;
+  WellDataPhysical *well_data_physical;
+
+  SubgridArray     *subgrids = GridSubgrids(grid);
+  Subgrid          *subgrid, *well_subgrid, *tmp_subgrid;
+  Subvector        *px_sub, *py_sub, *pz_sub;
+
+  double           *px, *py, *pz, *weights;
+  double weight;
+  double area_x, area_y, area_z, area_sum;
+  double avg_x, avg_y, avg_z;
+  double dx, dy, dz;
+
+  int ix, iy, iz, nx, ny, nz;
+  int nx_p, ny_p, nz_p;
+  int i, j, k, ip, iw;
+  int well, is, pass, piece, num_cells;
+
+  well_index = ctalloc(WellIndex, 1);
+
+  WellIndexGrid(well_index) = grid;
+  WellIndexWellData(well_index) = well_data;
+  WellIndexGeneration(well_index) = -1;
+
+  /*
+   * The first pass counts the pieces and cells, the second fills them in.
+   */
+  for (pass = 0; pass < 2; pass++)
+  {
+    piece = 0;
+    num_cells = 0;
+
+    for (well = 0; well < WellDataNumFluxWells(well_data); well++)
+    {
+      well_data_physical = WellDataFluxWellPhysical(well_data, well);
+      well_subgrid = WellDataPhysicalSubgrid(well_data_physical);
+
+      ForSubgridI(is, subgrids)
+      {
+        subgrid = SubgridArraySubgrid(subgrids, is);
+
+        if (!WellIndexMayIntersect(well_subgrid, subgrid))
+          continue;
+
+        if (!(tmp_subgrid = IntersectSubgrids(subgrid, well_subgrid)))
+          continue;
+
+        ix = SubgridIX(tmp_subgrid);
+        iy = SubgridIY(tmp_subgrid);
+        iz = SubgridIZ(tmp_subgrid);
+
+        nx = SubgridNX(tmp_subgrid);
+        ny = SubgridNY(tmp_subgrid);
+        nz = SubgridNZ(tmp_subgrid);
+
+        if (pass == 0)
+        {
+          FreeSubgrid(tmp_subgrid);
+        }
+        else
+        {
+          well_index->wells[piece] = well;
+          well_index->subgrid_indices[piece] = is;
+          well_index->subgrids[piece] = tmp_subgrid;
+          well_index->weight_offsets[piece] = num_cells;
+
+          dx = SubgridDX(tmp_subgrid);
+          dy = SubgridDY(tmp_subgrid);
+          dz = SubgridDZ(tmp_subgrid);
+
+          area_x = dy * dz;
+          area_y = dx * dz;
+          area_z = dx * dy;
+          area_sum = area_x + area_y + area_z;
+
+          avg_x = WellDataPhysicalAveragePermeabilityX(well_data_physical);
+          avg_y = WellDataPhysicalAveragePermeabilityY(well_data_physical);
+          avg_z = WellDataPhysicalAveragePermeabilityZ(well_data_physical);
+
+          px_sub = VectorSubvector(perm_x, is);
+          py_sub = VectorSubvector(perm_y, is);
+          pz_sub = VectorSubvector(perm_z, is);
+
+          nx_p = SubvectorNX(px_sub);
+          ny_p = SubvectorNY(px_sub);
+          nz_p = SubvectorNZ(px_sub);
+
+          px = SubvectorElt(px_sub, ix, iy, iz);
+          py = SubvectorElt(py_sub, ix, iy, iz);
+          pz = SubvectorElt(pz_sub, ix, iy, iz);
+
+          weights = well_index->weights + num_cells;
+
+          ip = 0;
+          iw = 0;
+          BoxLoopI1(i, j, k, ix, iy, iz, nx, ny, nz,
+                    ip, nx_p, ny_p, nz_p, 1, 1, 1,
+          {
+            weight = 0.0;
+            if (WellDataPhysicalMethod(well_data_physical)
+                == FLUX_STANDARD)
+            {
+              weight = 1.0;
+            }
+            else if (WellDataPhysicalMethod(well_data_physical)
+                     == FLUX_WEIGHTED)
+            {
+              weight = (px[ip] / avg_x) * (area_x / area_sum)
+                       + (py[ip] / avg_y) * (area_y / area_sum)
+                       + (pz[ip] / avg_z) * (area_z / area_sum);
+            }
+            weights[iw++] = weight;
+          });
+        }
+
+        piece++;
+        num_cells += nx * ny * nz;
+      }
     }
+
+    if (pass == 0)
+    {
+      WellIndexNumPieces(well_index) = piece;
+
+      well_index->wells = ctalloc(int, piece);
+      well_index->subgrid_indices = ctalloc(int, piece);
+      well_index->subgrids = ctalloc(Subgrid *, piece);
+      well_index->weight_offsets = ctalloc(int, piece + 1);
+      well_index->weights = ctalloc(double, num_cells);
+    }
+    else
+    {
+      well_index->weight_offsets[piece] = num_cells;
+    }
+  }
+
+  return well_index;
+}
+
+
+/*--------------------------------------------------------------------------
+ * FreeWellIndex
+ *--------------------------------------------------------------------------*/
+
+void FreeWellIndex(
+                   WellIndex *well_index)
+{
+  int piece;
+
+  if (well_index)
+  {
+    for (piece = 0; piece < WellIndexNumPieces(well_index); piece++)
+    {
+      FreeSubgrid(WellIndexSubgrid(well_index, piece));
+    }
+
+    tfree(well_index->weights);
+    tfree(well_index->weight_offsets);
+    tfree(well_index->subgrids);
+    tfree(well_index->subgrid_indices);
+    tfree(well_index->wells);
+    tfree(well_index);
   }
 }
@@ -103,6 +103,31 @@ typedef struct {
   TimeCycleData      *time_cycle_data;
 } WellData;
 
+/*----------------------------------------------------------------
+ * Flux Well Index structure
+ *
+ * The flux wells that intersect the local subgrids of a grid; one
+ * piece for each well and subgrid intersection along with the source
+ * weight of every cell in the piece, in BoxLoop order.  The weights are
+ * computed from the permeability, so the index is only valid for the
+ * problem data generation it was built from.
+ *----------------------------------------------------------------*/
+
+typedef struct {
+  Grid          *grid;
+  WellData      *well_data;
+
+  int generation;                   /* problem data generation */
+
+  int num_pieces;
+
+  int           *wells;             /* flux well number     */
+  int           *subgrid_indices;   /* local subgrid number */
+  Subgrid      **subgrids;          /* well * subgrid       */
+  int           *weight_offsets;    /* num_pieces + 1       */
+  double        *weights;
+} WellIndex;
+
 /*--------------------------------------------------------------------------
  * Accessor macros: WellDataPhysical
  *--------------------------------------------------------------------------*/
@@ -276,6 +301,24 @@ typedef struct {
 #define WellDataFluxWellStat(well_data, i) \
   ((well_data)->flux_well_stats[i])
 
+/*--------------------------------------------------------------------------
+ * Accessor macros: WellIndex
+ *--------------------------------------------------------------------------*/
+#define WellIndexGrid(well_index)     ((well_index)->grid)
+#define WellIndexWellData(well_index) ((well_index)->well_data)
+#define WellIndexGeneration(well_index) ((well_index)->generation)
+
+#define WellIndexNumPieces(well_index) ((well_index)->num_pieces)
+
+#define WellIndexWell(well_index, i) \
+  ((well_index)->wells[i])
+#define WellIndexSubgridIndex(well_index, i) \
+  ((well_index)->subgrid_indices[i])
+#define WellIndexSubgrid(well_index, i) \
+  ((well_index)->subgrids[i])
+#define WellIndexWeights(well_index, i) \
+  ((well_index)->weights + (well_index)->weight_offsets[i])
+
 /*--------------------------------------------------------------------------
  * Well Data constants used in the program.
  *--------------------------------------------------------------------------*/
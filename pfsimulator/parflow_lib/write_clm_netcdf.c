@@ -96,35 +96,13 @@ void WriteCLMNC(char * file_prefix, char* file_postfix, double t, Vector  *v, in
 void CreateCLMNCFile(char *file_name, int *clmIDs)
 {
 #ifdef PARFLOW_HAVE_NETCDF
-  char *switch_name;
-  char key[IDB_MAX_KEY_LEN];
-  char *default_val = "None";
-  int old_fill_mode;
-
-  sprintf(key, "NetCDF.ROMIOhints");
-  switch_name = GetStringDefault(key, "None");
-  if (strcmp(switch_name, default_val) != 0)
-  {
-    if (access(switch_name, F_OK | R_OK) == -1)
-    {
-      InputError("Error: check if the file is present and readable <%s> for key <%s>\n",
-                 switch_name, key);
-    }
-    MPI_Info romio_info;
-    FILE *fp;
-    MPI_Info_create(&romio_info);
-    char line[100], romio_key[100], value[100];
-    fp = fopen(switch_name, "r");
-    while (fgets(line, sizeof line, fp) != NULL)      /* read a line */
-    {
-      sscanf(line, "%s%s", romio_key, value);
-      MPI_Info_set(romio_info, romio_key, value);
-    }
-    int res = nc_create_par(file_name, NC_NETCDF4 | NC_MPIIO, amps_CommWorld, romio_info, &clmIDs[0]);
-  }
-  else
+  MPI_Info romio_info = NCCreateInfo();
+
+  int res = nc_create_par(file_name, NC_NETCDF4 | NC_MPIIO, amps_CommWorld, romio_info, &clmIDs[0]);
+
+  if (romio_info != MPI_INFO_NULL)
   {
-    int res = nc_create_par(file_name, NC_NETCDF4 | NC_MPIIO, amps_CommWorld, MPI_INFO_NULL, &clmIDs[0]);
+    MPI_Info_free(&romio_info);
   }
 #else
   amps_Printf("Parflow not compiled with NetCDF, can't create NetCDF file\n");
@@ -134,6 +134,18 @@ void     WritePFBinary(
   char filename[255];
   amps_File file;
 
+  double tolerance;
+  int method, level;
+
+  /* PFB.Compression redirects all PFB output to compressed CPFB files */
+  method = CPFBCompression(&tolerance, &level);
+  if (method != CPFB_NONE)
+  {
+    WritePFCBinary(file_prefix, file_suffix, v, method, tolerance, level,
+                   NULL, 0);
+    return;
+  }
+
   BeginTiming(PFBTimingIndex);
 
   p = amps_Rank(amps_CommWorld);
@@ -0,0 +1,552 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+/*****************************************************************************
+*
+* Routines to write a Vector to a compressed parflow binary (CPFB) file.
+*
+* A CPFB file starts with the PFB header followed by the compression
+* method, the error tolerance and an index with one entry of 11 ints per
+* subgrid:
+*
+*    ix iy iz nx ny nz rx ry rz method nbytes
+*
+* The compressed subgrid blocks follow the index in the same order so a
+* reader can seek to any subgrid without decompressing the others.  A
+* block holds the subgrid values in x fastest order as 64 bit words,
+* delta encoded against the previous word, split into byte planes (most
+* significant first) and compressed with zlib.  The words are
+*
+*    CPFB_LOSSLESS       the IEEE bits of the value, delta is XOR
+*    CPFB_ERROR_BOUNDED  round(value / (2 tolerance)), delta is the
+*                        zigzag encoded difference
+*
+* A block that can not be quantized within the tolerance is stored
+* lossless.
+*
+* Snapshots of a time series may instead be delta encoded against the
+* previous snapshot (CPFB_DELTA set in the method).  The header method
+* is then followed by the file number of the previous snapshot and the
+* words of the CPFB_DELTA blocks are encoded against the words of the
+* previous snapshot, as read back, at the same position instead of the
+* previous word.  Every keyframe_interval'th snapshot is a keyframe
+* without CPFB_DELTA.
+*
+*****************************************************************************/
+
+#include "parflow.h"
+
+#ifdef PARFLOW_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Largest quantized value, small enough that value / (2 tolerance)
+ * recovers the quantized value from the value as read back */
+#define CPFB_MAX_QUANTUM 1.0e12
+
+/*--------------------------------------------------------------------------
+ * Compression method for PFB output from the PFB.Compression keys,
+ * CPFB_NONE if output is plain PFB.
+ *--------------------------------------------------------------------------*/
+
+int CPFBCompression(
+                    double *tolerance,
+                    int *   level)
+{
+  NameArray switch_na;
+  char      *switch_name;
+  int method;
+
+  switch_na = NA_NewNameArray("None Lossless ErrorBounded");
+  switch_name = GetStringDefault("PFB.Compression", "None");
+  method = NA_NameToIndex(switch_na, switch_name);
+  if (method < 0)
+  {
+    InputError("Error: invalid value <%s> for key <%s>\n",
+               switch_name, "PFB.Compression");
+  }
+  NA_FreeNameArray(switch_na);
+
+#ifndef PARFLOW_HAVE_ZLIB
+  if (method != CPFB_NONE)
+  {
+    InputError("Error: value <%s> for key <%s> requires ParFlow to be built with zlib\n",
+               switch_name, "PFB.Compression");
+  }
+#endif
+
+  *tolerance = 0.0;
+  if (method == CPFB_ERROR_BOUNDED)
+  {
+    *tolerance = GetDouble("PFB.Compression.Tolerance");
+    if (!(*tolerance > 0.0))
+    {
+      InputError("Error: key <%s> must be positive%s\n",
+                 "PFB.Compression.Tolerance", "");
+    }
+  }
+
+  *level = GetIntDefault("PFB.Compression.Level", 1);
+  if (*level < 0 || *level > 9)
+  {
+    InputError("Error: invalid compression level for key <%s>%s, must be 0 to 9\n",
+               "PFB.Compression.Level", "");
+  }
+
+  return method;
+}
+
+#ifdef PARFLOW_HAVE_ZLIB
+
+/*--------------------------------------------------------------------------
+ * Compress n values into a newly allocated buffer, delta encoded against
+ * the reference values if reference is not NULL.  The values as they
+ * will be read back are returned in recon.  Returns the method actually
+ * used: CPFB_LOSSLESS if the values can not be quantized within the
+ * tolerance, with CPFB_DELTA set if the reference was used.
+ *--------------------------------------------------------------------------*/
+
+int CPFBEncode(
+               double *        values,
+               double *        reference,
+               int             n,
+               int             method,
+               double          tolerance,
+               int             level,
+               unsigned char **buffer,
+               int *           nbytes,
+               double *        recon)
+{
+  uint64_t      *words = ctalloc(uint64_t, n);
+  uint64_t      *ref_words = NULL;
+  unsigned char *planes = ctalloc(unsigned char, 8 * n);
+  uLongf length;
+  uint64_t prev, word;
+  int64_t d;
+  double step = 2.0 * tolerance;
+  double r;
+  int i, b;
+
+  if (method == CPFB_ERROR_BOUNDED)
+  {
+    for (i = 0; i < n; i++)
+    {
+      /* Reject values whose quantized reconstruction is not within
+       * the tolerance, including NaN, infinity and overflow */
+      r = values[i] / step;
+      if (!(fabs(r) < CPFB_MAX_QUANTUM)
+          || !(fabs(values[i] - (double)llround(r) * step) <= tolerance))
+      {
+        method = CPFB_LOSSLESS;
+        break;
+      }
+      words[i] = (uint64_t)llround(r);
+    }
+  }
+
+  if (method == CPFB_LOSSLESS)
+  {
+    memcpy(words, values, n * sizeof(double));
+  }
+
+  if (reference)
+  {
+    ref_words = ctalloc(uint64_t, n);
+    if (method == CPFB_ERROR_BOUNDED)
+    {
+      for (i = 0; i < n && ref_words; i++)
+      {
+        r = reference[i] / step;
+        if (!(fabs(r) < CPFB_MAX_QUANTUM))
+        {
+          /* Not representable, encode the block on its own */
+          tfree(ref_words);
+          ref_words = NULL;
+        }
+        else
+        {
+          ref_words[i] = (uint64_t)llround(r);
+        }
+      }
+    }
+    else
+    {
+      memcpy(ref_words, reference, n * sizeof(double));
+    }
+  }
+
+  prev = 0;
+  for (i = 0; i < n; i++)
+  {
+    if (ref_words)
+    {
+      prev = ref_words[i];
+    }
+
+    if (method == CPFB_ERROR_BOUNDED)
+    {
+      d = (int64_t)(words[i] - prev);
+      word = ((uint64_t)d << 1) ^ (uint64_t)(d >> 63);
+    }
+    else
+    {
+      word = words[i] ^ prev;
+    }
+    prev = words[i];
+
+    for (b = 0; b < 8; b++)
+    {
+      planes[b * n + i] = (unsigned char)(word >> (56 - 8 * b));
+    }
+  }
+
+  for (i = 0; i < n; i++)
+  {
+    recon[i] = (method == CPFB_ERROR_BOUNDED) ?
+               (double)(int64_t)words[i] * step : values[i];
+  }
+
+  length = compressBound(8 * n);
+  *buffer = ctalloc(unsigned char, length);
+  if (compress2(*buffer, &length, planes, 8 * n, level) != Z_OK)
+  {
+    amps_Printf("Error: zlib compression of CPFB block failed\n");
+    exit(1);
+  }
+  *nbytes = (int)length;
+
+  if (ref_words)
+  {
+    method |= CPFB_DELTA;
+    tfree(ref_words);
+  }
+
+  tfree(planes);
+  tfree(words);
+
+  return method;
+}
+
+#endif
+
+/*--------------------------------------------------------------------------
+ * Time series of snapshots with temporal delta encoding, the keyframe
+ * interval is PFB.Compression.KeyframeInterval.
+ *--------------------------------------------------------------------------*/
+
+CPFBSeries *NewCPFBSeries()
+{
+  CPFBSeries *series = ctalloc(CPFBSeries, 1);
+  double tolerance;
+  int level;
+
+  series->keyframe_interval =
+    GetIntDefault("PFB.Compression.KeyframeInterval", 1);
+  if (series->keyframe_interval < 1)
+  {
+    InputError("Error: key <%s> must be positive%s\n",
+               "PFB.Compression.KeyframeInterval", "");
+  }
+  if (series->keyframe_interval > 1
+      && CPFBCompression(&tolerance, &level) == CPFB_NONE)
+  {
+    InputError("Error: key <%s> requires PFB.Compression to be Lossless or ErrorBounded%s\n",
+               "PFB.Compression.KeyframeInterval", "");
+  }
+
+  return series;
+}
+
+void FreeCPFBSeries(
+                    CPFBSeries *series)
+{
+  int g;
+
+  if (series)
+  {
+    for (g = 0; g < series->num_subgrids; g++)
+    {
+      tfree(series->reference[g]);
+    }
+    tfree(series->reference);
+    tfree(series);
+  }
+}
+
+/*--------------------------------------------------------------------------
+ * Write the vector to <prefix>.<suffix>.cpfb, delta encoded against the
+ * previous snapshot of the series unless series is NULL or this snapshot
+ * is a keyframe.  file_number is the number of this snapshot.
+ *--------------------------------------------------------------------------*/
+
+void     WritePFCBinary(
+                        char *      file_prefix,
+                        char *      file_suffix,
+                        Vector *    v,
+                        int         method,
+                        double      tolerance,
+                        int         level,
+                        CPFBSeries *series,
+                        int         file_number)
+{
+#ifdef PARFLOW_HAVE_ZLIB
+  Grid           *grid = VectorGrid(v);
+  SubgridArray   *subgrids = GridSubgrids(grid);
+  Subgrid        *subgrid;
+  Subvector      *subvector;
+
+  int num_local = GridNumSubgrids(grid);
+  int num_subgrids, first;
+
+  unsigned char **blocks;
+  int            *index;
+  int            *counts;
+  double         *values, *recon, *data;
+
+  int g, m, n, p, P;
+  int i, j, k, ai, vi;
+  int delta, header_method;
+
+  long size;
+
+  char file_extn[7] = "cpfb";
+  char filename[255];
+  amps_File file;
+  amps_Invoice invoice;
+
+  BeginTiming(PFBTimingIndex);
+
+  p = amps_Rank(amps_CommWorld);
+  P = amps_Size(amps_CommWorld);
+
+  /* The reference snapshot, allocated with the first snapshot */
+  delta = 0;
+  if (series)
+  {
+    if (series->reference == NULL)
+    {
+      series->num_subgrids = num_local;
+      series->reference = ctalloc(double *, num_local);
+    }
+    /* A snapshot rewritten under the same number (a dump at the end
+     * of the run) can not refer to itself */
+    delta = (series->num_written % series->keyframe_interval) != 0
+            && series->previous != file_number;
+  }
+
+  /* The index position of this process' subgrids */
+  counts = ctalloc(int, P);
+  counts[p] = num_local;
+  invoice = amps_NewInvoice("%*i", P, counts);
+  amps_AllReduce(amps_CommWorld, invoice, amps_Add);
+  amps_FreeInvoice(invoice);
+
+  num_subgrids = 0;
+  first = 0;
+  for (m = 0; m < P; m++)
+  {
+    if (m == p)
+    {
+      first = num_subgrids;
+    }
+    num_subgrids += counts[m];
+  }
+  tfree(counts);
+
+  index = ctalloc(int, 11 * num_subgrids);
+  blocks = ctalloc(unsigned char *, num_local);
+
+  size = 0;
+  ForSubgridI(g, subgrids)
+  {
+    subgrid = SubgridArraySubgrid(subgrids, g);
+    subvector = VectorSubvector(v, g);
+
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
+
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
+
+    int nx_v = SubvectorNX(subvector);
+    int ny_v = SubvectorNY(subvector);
+
+    int *entry = index + 11 * (first + g);
+
+    n = nx * ny * nz;
+    values = ctalloc(double, n);
+    recon = ctalloc(double, n);
+    data = SubvectorElt(subvector, ix, iy, iz);
+
+    ai = 0; vi = 0;
+    BoxLoopI1(i, j, k,
+              ix, iy, iz, nx, ny, nz,
+              ai, nx_v, ny_v, nz_v, 1, 1, 1,
+    {
+      values[vi++] = data[ai];
+    });
+
+    entry[0] = ix;
+    entry[1] = iy;
+    entry[2] = iz;
+    entry[3] = nx;
+    entry[4] = ny;
+    entry[5] = nz;
+    entry[6] = SubgridRX(subgrid);
+    entry[7] = SubgridRY(subgrid);
+    entry[8] = SubgridRZ(subgrid);
+    entry[9] = CPFBEncode(values, delta ? series->reference[g] : NULL,
+                          n, method, tolerance, level,
+                          &blocks[g], &entry[10], recon);
+
+    size += entry[10] * amps_SizeofChar;
+
+    if (series)
+    {
+      tfree(series->reference[g]);
+      series->reference[g] = recon;
+    }
+    else
+    {
+      tfree(recon);
+    }
+    tfree(values);
+  }
+
+  invoice = amps_NewInvoice("%*i", 11 * num_subgrids, index);
+  amps_AllReduce(amps_CommWorld, invoice, amps_Add);
+  amps_FreeInvoice(invoice);
+
+  if (p == 0)
+  {
+    size += 7 * amps_SizeofDouble + (5 + 11 * num_subgrids) * amps_SizeofInt;
+    if (delta)
+    {
+      size += amps_SizeofInt;
+    }
+  }
+
+  /* open file */
+  sprintf(filename, "%s.%s.%s", file_prefix, file_suffix, file_extn);
+
+  if ((file = amps_FFopen(amps_CommWorld, filename, "wb", size)) == NULL)
+  {
+    amps_Printf("Error: can't open output file %s\n", filename);
+    exit(1);
+  }
+
+  if (p == 0)
+  {
+    amps_WriteDouble(file, &BackgroundX(GlobalsBackground), 1);
+    amps_WriteDouble(file, &BackgroundY(GlobalsBackground), 1);
+    amps_WriteDouble(file, &BackgroundZ(GlobalsBackground), 1);
+
+    amps_WriteInt(file, &SubgridNX(GridBackground(grid)), 1);
+    amps_WriteInt(file, &SubgridNY(GridBackground(grid)), 1);
+    amps_WriteInt(file, &SubgridNZ(GridBackground(grid)), 1);
+
+    amps_WriteDouble(file, &BackgroundDX(GlobalsBackground), 1);
+    amps_WriteDouble(file, &BackgroundDY(GlobalsBackground), 1);
+    amps_WriteDouble(file, &BackgroundDZ(GlobalsBackground), 1);
+
+    amps_WriteInt(file, &num_subgrids, 1);
+
+    header_method = delta ? (method | CPFB_DELTA) : method;
+    amps_WriteInt(file, &header_method, 1);
+    amps_WriteDouble(file, &tolerance, 1);
+    if (delta)
+    {
+      amps_WriteInt(file, &series->previous, 1);
+    }
+
+    amps_WriteInt(file, index, 11 * num_subgrids);
+  }
+
+  ForSubgridI(g, subgrids)
+  {
+    amps_WriteChar(file, (char*)blocks[g], index[11 * (first + g) + 10]);
+    tfree(blocks[g]);
+  }
+
+  amps_FFclose(file);
+
+  tfree(blocks);
+  tfree(index);
+
+  if (series)
+  {
+    series->num_written++;
+    series->previous = file_number;
+  }
+
+  EndTiming(PFBTimingIndex);
+#else
+  (void)file_prefix;
+  (void)file_suffix;
+  (void)v;
+  (void)method;
+  (void)tolerance;
+  (void)level;
+  (void)series;
+  (void)file_number;
+  amps_Printf("Error: CPFB output requires ParFlow to be built with zlib\n");
+  exit(1);
+#endif
+}
+
+/*--------------------------------------------------------------------------
+ * Write snapshot file_number of a time series, as WritePFBinary but
+ * with temporal delta encoding if PFB output is compressed.
+ *--------------------------------------------------------------------------*/
+
+void     WritePFBinarySeries(
+                             char *      file_prefix,
+                             char *      file_suffix,
+                             int         file_number,
+                             Vector *    v,
+                             CPFBSeries *series)
+{
+  double tolerance;
+  int method, level;
+
+  method = CPFBCompression(&tolerance, &level);
+  if (method == CPFB_NONE)
+  {
+    WritePFBinary(file_prefix, file_suffix, v);
+  }
+  else
+  {
+    WritePFCBinary(file_prefix, file_suffix, v, method, tolerance, level,
+                   series, file_number);
+  }
+}
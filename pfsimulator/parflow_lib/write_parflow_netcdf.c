@@ -259,14 +259,19 @@ void WritePFNC(char * file_prefix, char* file_postfix, double t, Vector  *v, int
 #endif
 }
 
-void CreateNCFile(char *file_name, int *netCDFIDs)
-{
 #ifdef PARFLOW_HAVE_NETCDF
+/*
+ * MPI-IO hints for creating a file: the user ROMIO hints file and the
+ * number of collective buffering aggregators.  Returns MPI_INFO_NULL if
+ * no hints are set, otherwise the caller frees the info.
+ */
+MPI_Info NCCreateInfo()
+{
   char *switch_name;
   char key[IDB_MAX_KEY_LEN];
   char *default_val = "None";
-  int old_fill_mode;
-
+  MPI_Info romio_info = MPI_INFO_NULL;
+  int aggregators;
 
   sprintf(key, "NetCDF.ROMIOhints");
   switch_name = GetStringDefault(key, "None");
@@ -277,7 +282,6 @@ void CreateNCFile(char *file_name, int *netCDFIDs)
       InputError("Error: check if the file is present and readable <%s> for key <%s>\n",
                  switch_name, key);
     }
-    MPI_Info romio_info;
     FILE *fp;
     MPI_Info_create(&romio_info);
     char line[100], romio_key[100], value[100];
@@ -287,11 +291,37 @@ void CreateNCFile(char *file_name, int *netCDFIDs)
       sscanf(line, "%s%s", romio_key, value);
       MPI_Info_set(romio_info, romio_key, value);
     }
-    int res = nc_create_par(file_name, NC_NETCDF4 | NC_MPIIO, amps_CommWorld, romio_info, &netCDFIDs[0]);
+    fclose(fp);
   }
-  else
+
+  /* Number of processes that gather and write for collective writes */
+  aggregators = GetIntDefault("NetCDF.Aggregators", 0);
+  if (aggregators > 0)
+  {
+    char value[32];
+    if (romio_info == MPI_INFO_NULL)
+    {
+      MPI_Info_create(&romio_info);
+    }
+    sprintf(value, "%d", aggregators);
+    MPI_Info_set(romio_info, "cb_nodes", value);
+    MPI_Info_set(romio_info, "romio_cb_write", "enable");
+  }
+
+  return romio_info;
+}
+#endif
+
+void CreateNCFile(char *file_name, int *netCDFIDs)
+{
+#ifdef PARFLOW_HAVE_NETCDF
+  MPI_Info romio_info = NCCreateInfo();
+
+  int res = nc_create_par(file_name, NC_NETCDF4 | NC_MPIIO, amps_CommWorld, romio_info, &netCDFIDs[0]);
+
+  if (romio_info != MPI_INFO_NULL)
   {
-    int res = nc_create_par(file_name, NC_NETCDF4 | NC_MPIIO, amps_CommWorld, MPI_INFO_NULL, &netCDFIDs[0]);
+    MPI_Info_free(&romio_info);
   }
 #else
   amps_Printf("Parflow not compiled with NetCDF, can't create NetCDF file\n");
@@ -306,41 +336,20 @@ void CreateNCFileNode(char *file_name, Vector *v, int *netCDFIDs)
   Subgrid        *subgrid;
   Subvector      *subvector;
 
-  char *switch_name;
-  char key[IDB_MAX_KEY_LEN];
-  char *default_val = "None";
-  int old_fill_mode;
-
   int nX = SubgridNX(GridBackground(grid));
   int nY = SubgridNY(GridBackground(grid));
   int nZ = SubgridNZ(GridBackground(grid));
 
-  sprintf(key, "NetCDF.ROMIOhints");
-  switch_name = GetStringDefault(key, "None");
-  if (strcmp(switch_name, default_val) != 0)
-  {
-    if (access(switch_name, F_OK | R_OK) == -1)
-    {
-      InputError("Error: check if the file is present and readable <%s> for key <%s>\n",
-                 switch_name, key);
-    }
-    MPI_Info romio_info;
-    FILE *fp;
-    MPI_Info_create(&romio_info);
-    char line[100], romio_key[100], value[100];
-    fp = fopen(switch_name, "r");
-    while (fgets(line, sizeof line, fp) != NULL)      /* read a line */
-    {
-      sscanf(line, "%s%s", romio_key, value);
-      MPI_Info_set(romio_info, romio_key, value);
-    }
-    int res = nc_create_par(file_name, NC_NETCDF4 | NC_MPIIO, amps_CommWrite, romio_info, &netCDFIDs[0]);
-  }
-  else
+  MPI_Info romio_info = NCCreateInfo();
+
+  int res = nc_create_par(file_name, NC_NETCDF4 | NC_MPIIO, amps_CommWrite, romio_info, &netCDFIDs[0]);
+
+  if (romio_info != MPI_INFO_NULL)
   {
-    int res = nc_create_par(file_name, NC_NETCDF4 | NC_MPIIO, amps_CommWrite, MPI_INFO_NULL, &netCDFIDs[0]);
+    MPI_Info_free(&romio_info);
   }
-  int res = nc_def_dim(netCDFIDs[0], "x", nX, &netCDFIDs[4]);
+
+  res = nc_def_dim(netCDFIDs[0], "x", nX, &netCDFIDs[4]);
   res = nc_def_dim(netCDFIDs[0], "y", nY, &netCDFIDs[3]);
   res = nc_def_dim(netCDFIDs[0], "z", nZ, &netCDFIDs[2]);
   res = nc_def_dim(netCDFIDs[0], "time", NC_UNLIMITED, &netCDFIDs[1]);
@@ -356,6 +365,91 @@ void CloseNC(int ncID)
 #endif
 }
 
+/*
+ * Storage settings for a new variable: chunking, and deflate compression
+ * and bit rounding.  Compression and bit rounding may be set for each
+ * variable with NetCDF.<variable>.CompressionLevel and
+ * NetCDF.<variable>.BitRound, the defaults are NetCDF.CompressionLevel and
+ * NetCDF.BitRound.  Parallel writes of compressed variables must be
+ * collective, see PutDataInNC and PutDataInNCNode.
+ */
+void NCDefVarStorage(int ncID, int varID, varNCData *myVarNCData)
+{
+#ifdef PARFLOW_HAVE_NETCDF
+  char *switch_name;
+  char key[IDB_MAX_KEY_LEN];
+  char *default_val = "None";
+  int level;
+  int nsb;
+  int res;
+
+  sprintf(key, "NetCDF.Chunking");
+  switch_name = GetStringDefault(key, "None");
+  if (strcmp(switch_name, default_val) != 0)
+  {
+    size_t chunksize[myVarNCData->dimSize];
+    chunksize[0] = 1;
+    if (myVarNCData->dimSize == 4)
+    {
+      chunksize[1] = GetInt("NetCDF.ChunkZ");
+      chunksize[2] = GetInt("NetCDF.ChunkY");
+      chunksize[3] = GetInt("NetCDF.ChunkX");
+    }
+    else
+    {
+      chunksize[1] = GetInt("NetCDF.ChunkY");
+      chunksize[2] = GetInt("NetCDF.ChunkX");
+    }
+    nc_def_var_chunking(ncID, varID, NC_CHUNKED, chunksize);
+  }
+
+  sprintf(key, "NetCDF.Compression");
+  switch_name = GetStringDefault(key, "False");
+  if (strcmp(switch_name, "False") != 0)
+  {
+    sprintf(key, "NetCDF.%s.CompressionLevel", myVarNCData->varName);
+    level = GetIntDefault(key, GetIntDefault("NetCDF.CompressionLevel", 1));
+    if (level < 0 || level > 9)
+    {
+      InputError("Error: invalid compression level for key <%s>%s, must be 0 to 9\n", key, "");
+    }
+
+    if (level > 0)
+    {
+      /* shuffle groups the bytes of the doubles so they deflate better */
+      res = nc_def_var_deflate(ncID, varID, 1, 1, level);
+      if (res != NC_NOERR)
+      {
+        amps_Printf("Warning: NetCDF compression of %s failed: %s\n",
+                    myVarNCData->varName, nc_strerror(res));
+      }
+    }
+
+    sprintf(key, "NetCDF.%s.BitRound", myVarNCData->varName);
+    nsb = GetIntDefault(key, GetIntDefault("NetCDF.BitRound", 0));
+    if (nsb < 0 || nsb > 52)
+    {
+      InputError("Error: invalid number of bits for key <%s>%s, must be 0 to 52\n", key, "");
+    }
+
+    if (nsb > 0)
+    {
+#ifdef NC_QUANTIZE_BITROUND
+      /* lossy, keeps nsb significant bits of the mantissa */
+      res = nc_def_var_quantize(ncID, varID, NC_QUANTIZE_BITROUND, nsb);
+      if (res != NC_NOERR)
+      {
+        amps_Printf("Warning: NetCDF bit rounding of %s failed: %s\n",
+                    myVarNCData->varName, nc_strerror(res));
+      }
+#else
+      InputError("Error: the NetCDF library does not support bit rounding, required by key <%s>%s\n", key, "");
+#endif
+    }
+  }
+#endif
+}
+
 int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
 {
 #ifdef PARFLOW_HAVE_NETCDF
@@ -394,20 +488,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
                          (*myVarNCData)->dimIDs, &pressVarID);
     if (res != NC_ENAMEINUSE)
     {
-      char *switch_name;
-      char key[IDB_MAX_KEY_LEN];
-      char *default_val = "None";
-      sprintf(key, "NetCDF.Chunking");
-      switch_name = GetStringDefault(key, "None");
-      if (strcmp(switch_name, default_val) != 0)
-      {
-        size_t chunksize[(*myVarNCData)->dimSize];
-        chunksize[0] = 1;
-        chunksize[1] = GetInt("NetCDF.ChunkZ");
-        chunksize[2] = GetInt("NetCDF.ChunkY");
-        chunksize[3] = GetInt("NetCDF.ChunkX");
-        nc_def_var_chunking(netCDFIDs[0], pressVarID, NC_CHUNKED, chunksize);
-      }
+      NCDefVarStorage(netCDFIDs[0], pressVarID, *myVarNCData);
     }
     if (res == NC_ENAMEINUSE)
     {
@@ -431,20 +512,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
                          (*myVarNCData)->dimIDs, &satVarID);
     if (res != NC_ENAMEINUSE)
     {
-      char *switch_name;
-      char key[IDB_MAX_KEY_LEN];
-      char *default_val = "None";
-      sprintf(key, "NetCDF.Chunking");
-      switch_name = GetStringDefault(key, "None");
-      if (strcmp(switch_name, default_val) != 0)
-      {
-        size_t chunksize[(*myVarNCData)->dimSize];
-        chunksize[0] = 1;
-        chunksize[1] = GetInt("NetCDF.ChunkZ");
-        chunksize[2] = GetInt("NetCDF.ChunkY");
-        chunksize[3] = GetInt("NetCDF.ChunkX");
-        nc_def_var_chunking(netCDFIDs[0], satVarID, NC_CHUNKED, chunksize);
-      }
+      NCDefVarStorage(netCDFIDs[0], satVarID, *myVarNCData);
     }
     if (res == NC_ENAMEINUSE)
     {
@@ -469,20 +537,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
                          (*myVarNCData)->dimIDs, &maskVarID);
     if (res != NC_ENAMEINUSE)
     {
-      char *switch_name;
-      char key[IDB_MAX_KEY_LEN];
-      char *default_val = "None";
-      sprintf(key, "NetCDF.Chunking");
-      switch_name = GetStringDefault(key, "None");
-      if (strcmp(switch_name, default_val) != 0)
-      {
-        size_t chunksize[(*myVarNCData)->dimSize];
-        chunksize[0] = 1;
-        chunksize[1] = GetInt("NetCDF.ChunkZ");
-        chunksize[2] = GetInt("NetCDF.ChunkY");
-        chunksize[3] = GetInt("NetCDF.ChunkX");
-        nc_def_var_chunking(netCDFIDs[0], maskVarID, NC_CHUNKED, chunksize);
-      }
+      NCDefVarStorage(netCDFIDs[0], maskVarID, *myVarNCData);
     }
     if (res == NC_ENAMEINUSE)
     {
@@ -506,19 +561,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
                          (*myVarNCData)->dimIDs, &manningsVarID);
     if (res != NC_ENAMEINUSE)
     {
-      char *switch_name;
-      char key[IDB_MAX_KEY_LEN];
-      char *default_val = "None";
-      sprintf(key, "NetCDF.Chunking");
-      switch_name = GetStringDefault(key, "None");
-      if (strcmp(switch_name, default_val) != 0)
-      {
-        size_t chunksize[(*myVarNCData)->dimSize];
-        chunksize[0] = 1;
-        chunksize[1] = GetInt("NetCDF.ChunkY");
-        chunksize[2] = GetInt("NetCDF.ChunkX");
-        nc_def_var_chunking(netCDFIDs[0], manningsVarID, NC_CHUNKED, chunksize);
-      }
+      NCDefVarStorage(netCDFIDs[0], manningsVarID, *myVarNCData);
     }
     if (res == NC_ENAMEINUSE)
     {
@@ -543,20 +586,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
                          (*myVarNCData)->dimIDs, &perm_xVarID);
     if (res != NC_ENAMEINUSE)
     {
-      char *switch_name;
-      char key[IDB_MAX_KEY_LEN];
-      char *default_val = "None";
-      sprintf(key, "NetCDF.Chunking");
-      switch_name = GetStringDefault(key, "None");
-      if (strcmp(switch_name, default_val) != 0)
-      {
-        size_t chunksize[(*myVarNCData)->dimSize];
-        chunksize[0] = 1;
-        chunksize[1] = GetInt("NetCDF.ChunkZ");
-        chunksize[2] = GetInt("NetCDF.ChunkY");
-        chunksize[3] = GetInt("NetCDF.ChunkX");
-        nc_def_var_chunking(netCDFIDs[0], perm_xVarID, NC_CHUNKED, chunksize);
-      }
+      NCDefVarStorage(netCDFIDs[0], perm_xVarID, *myVarNCData);
     }
     if (res == NC_ENAMEINUSE)
     {
@@ -581,20 +611,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
                          (*myVarNCData)->dimIDs, &perm_yVarID);
     if (res != NC_ENAMEINUSE)
     {
-      char *switch_name;
-      char key[IDB_MAX_KEY_LEN];
-      char *default_val = "None";
-      sprintf(key, "NetCDF.Chunking");
-      switch_name = GetStringDefault(key, "None");
-      if (strcmp(switch_name, default_val) != 0)
-      {
-        size_t chunksize[(*myVarNCData)->dimSize];
-        chunksize[0] = 1;
-        chunksize[1] = GetInt("NetCDF.ChunkZ");
-        chunksize[2] = GetInt("NetCDF.ChunkY");
-        chunksize[3] = GetInt("NetCDF.ChunkX");
-        nc_def_var_chunking(netCDFIDs[0], perm_yVarID, NC_CHUNKED, chunksize);
-      }
+      NCDefVarStorage(netCDFIDs[0], perm_yVarID, *myVarNCData);
     }
     if (res == NC_ENAMEINUSE)
     {
@@ -619,20 +636,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
                          (*myVarNCData)->dimIDs, &perm_zVarID);
     if (res != NC_ENAMEINUSE)
     {
-      char *switch_name;
-      char key[IDB_MAX_KEY_LEN];
-      char *default_val = "None";
-      sprintf(key, "NetCDF.Chunking");
-      switch_name = GetStringDefault(key, "None");
-      if (strcmp(switch_name, default_val) != 0)
-      {
-        size_t chunksize[(*myVarNCData)->dimSize];
-        chunksize[0] = 1;
-        chunksize[1] = GetInt("NetCDF.ChunkZ");
-        chunksize[2] = GetInt("NetCDF.ChunkY");
-        chunksize[3] = GetInt("NetCDF.ChunkX");
-        nc_def_var_chunking(netCDFIDs[0], perm_zVarID, NC_CHUNKED, chunksize);
-      }
+      NCDefVarStorage(netCDFIDs[0], perm_zVarID, *myVarNCData);
     }
     if (res == NC_ENAMEINUSE)
     {
@@ -657,20 +661,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
                          (*myVarNCData)->dimIDs, &porosityVarID);
     if (res != NC_ENAMEINUSE)
     {
-      char *switch_name;
-      char key[IDB_MAX_KEY_LEN];
-      char *default_val = "None";
-      sprintf(key, "NetCDF.Chunking");
-      switch_name = GetStringDefault(key, "None");
-      if (strcmp(switch_name, default_val) != 0)
-      {
-        size_t chunksize[(*myVarNCData)->dimSize];
-        chunksize[0] = 1;
-        chunksize[1] = GetInt("NetCDF.ChunkZ");
-        chunksize[2] = GetInt("NetCDF.ChunkY");
-        chunksize[3] = GetInt("NetCDF.ChunkX");
-        nc_def_var_chunking(netCDFIDs[0], porosityVarID, NC_CHUNKED, chunksize);
-      }
+      NCDefVarStorage(netCDFIDs[0], porosityVarID, *myVarNCData);
     }
     if (res == NC_ENAMEINUSE)
     {
@@ -695,20 +686,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
                          (*myVarNCData)->dimIDs, &specStorageVarID);
     if (res != NC_ENAMEINUSE)
     {
-      char *switch_name;
-      char key[IDB_MAX_KEY_LEN];
-      char *default_val = "None";
-      sprintf(key, "NetCDF.Chunking");
-      switch_name = GetStringDefault(key, "None");
-      if (strcmp(switch_name, default_val) != 0)
-      {
-        size_t chunksize[(*myVarNCData)->dimSize];
-        chunksize[0] = 1;
-        chunksize[1] = GetInt("NetCDF.ChunkZ");
-        chunksize[2] = GetInt("NetCDF.ChunkY");
-        chunksize[3] = GetInt("NetCDF.ChunkX");
-        nc_def_var_chunking(netCDFIDs[0], specStorageVarID, NC_CHUNKED, chunksize);
-      }
+      NCDefVarStorage(netCDFIDs[0], specStorageVarID, *myVarNCData);
     }
     if (res == NC_ENAMEINUSE)
     {
@@ -732,19 +710,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
                          (*myVarNCData)->dimIDs, &slopexVarID);
     if (res != NC_ENAMEINUSE)
     {
-      char *switch_name;
-      char key[IDB_MAX_KEY_LEN];
-      char *default_val = "None";
-      sprintf(key, "NetCDF.Chunking");
-      switch_name = GetStringDefault(key, "None");
-      if (strcmp(switch_name, default_val) != 0)
-      {
-        size_t chunksize[(*myVarNCData)->dimSize];
-        chunksize[0] = 1;
-        chunksize[1] = GetInt("NetCDF.ChunkY");
-        chunksize[2] = GetInt("NetCDF.ChunkX");
-        nc_def_var_chunking(netCDFIDs[0], slopexVarID, NC_CHUNKED, chunksize);
-      }
+      NCDefVarStorage(netCDFIDs[0], slopexVarID, *myVarNCData);
     }
     if (res == NC_ENAMEINUSE)
     {
@@ -767,19 +733,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
                          (*myVarNCData)->dimIDs, &slopeyVarID);
     if (res != NC_ENAMEINUSE)
     {
-      char *switch_name;
-      char key[IDB_MAX_KEY_LEN];
-      char *default_val = "None";
-      sprintf(key, "NetCDF.Chunking");
-      switch_name = GetStringDefault(key, "None");
-      if (strcmp(switch_name, default_val) != 0)
-      {
-        size_t chunksize[(*myVarNCData)->dimSize];
-        chunksize[0] = 1;
-        chunksize[1] = GetInt("NetCDF.ChunkY");
-        chunksize[2] = GetInt("NetCDF.ChunkX");
-        nc_def_var_chunking(netCDFIDs[0], slopeyVarID, NC_CHUNKED, chunksize);
-      }
+      NCDefVarStorage(netCDFIDs[0], slopeyVarID, *myVarNCData);
     }
     if (res == NC_ENAMEINUSE)
     {
@@ -803,20 +757,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
                          (*myVarNCData)->dimIDs, &dzmultVarID);
     if (res != NC_ENAMEINUSE)
     {
-      char *switch_name;
-      char key[IDB_MAX_KEY_LEN];
-      char *default_val = "None";
-      sprintf(key, "NetCDF.Chunking");
-      switch_name = GetStringDefault(key, "None");
-      if (strcmp(switch_name, default_val) != 0)
-      {
-        size_t chunksize[(*myVarNCData)->dimSize];
-        chunksize[0] = 1;
-        chunksize[1] = GetInt("NetCDF.ChunkZ");
-        chunksize[2] = GetInt("NetCDF.ChunkY");
-        chunksize[3] = GetInt("NetCDF.ChunkX");
-        nc_def_var_chunking(netCDFIDs[0], dzmultVarID, NC_CHUNKED, chunksize);
-      }
+      NCDefVarStorage(netCDFIDs[0], dzmultVarID, *myVarNCData);
     }
     if (res == NC_ENAMEINUSE)
     {
@@ -841,20 +782,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
                          (*myVarNCData)->dimIDs, &evaptransVarID);
     if (res != NC_ENAMEINUSE)
     {
-      char *switch_name;
-      char key[IDB_MAX_KEY_LEN];
-      char *default_val = "None";
-      sprintf(key, "NetCDF.Chunking");
-      switch_name = GetStringDefault(key, "None");
-      if (strcmp(switch_name, default_val) != 0)
-      {
-        size_t chunksize[(*myVarNCData)->dimSize];
-        chunksize[0] = 1;
-        chunksize[1] = GetInt("NetCDF.ChunkZ");
-        chunksize[2] = GetInt("NetCDF.ChunkY");
-        chunksize[3] = GetInt("NetCDF.ChunkX");
-        nc_def_var_chunking(netCDFIDs[0], evaptransVarID, NC_CHUNKED, chunksize);
-      }
+      NCDefVarStorage(netCDFIDs[0], evaptransVarID, *myVarNCData);
     }
     if (res == NC_ENAMEINUSE)
     {
@@ -879,20 +807,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
                          (*myVarNCData)->dimIDs, &evaptrans_sumVarID);
     if (res != NC_ENAMEINUSE)
     {
-      char *switch_name;
-      char key[IDB_MAX_KEY_LEN];
-      char *default_val = "None";
-      sprintf(key, "NetCDF.Chunking");
-      switch_name = GetStringDefault(key, "None");
-      if (strcmp(switch_name, default_val) != 0)
-      {
-        size_t chunksize[(*myVarNCData)->dimSize];
-        chunksize[0] = 1;
-        chunksize[1] = GetInt("NetCDF.ChunkZ");
-        chunksize[2] = GetInt("NetCDF.ChunkY");
-        chunksize[3] = GetInt("NetCDF.ChunkX");
-        nc_def_var_chunking(netCDFIDs[0], evaptrans_sumVarID, NC_CHUNKED, chunksize);
-      }
+      NCDefVarStorage(netCDFIDs[0], evaptrans_sumVarID, *myVarNCData);
     }
     if (res == NC_ENAMEINUSE)
     {
@@ -915,19 +830,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
                          (*myVarNCData)->dimIDs, &overland_sumVarID);
     if (res != NC_ENAMEINUSE)
     {
-      char *switch_name;
-      char key[IDB_MAX_KEY_LEN];
-      char *default_val = "None";
-      sprintf(key, "NetCDF.Chunking");
-      switch_name = GetStringDefault(key, "None");
-      if (strcmp(switch_name, default_val) != 0)
-      {
-        size_t chunksize[(*myVarNCData)->dimSize];
-        chunksize[0] = 1;
-        chunksize[1] = GetInt("NetCDF.ChunkY");
-        chunksize[2] = GetInt("NetCDF.ChunkX");
-        nc_def_var_chunking(netCDFIDs[0], overland_sumVarID, NC_CHUNKED, chunksize);
-      }
+      NCDefVarStorage(netCDFIDs[0], overland_sumVarID, *myVarNCData);
     }
     if (res == NC_ENAMEINUSE)
     {
@@ -951,19 +854,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
                          (*myVarNCData)->dimIDs, &overland_bc_fluxVarID);
     if (res != NC_ENAMEINUSE)
     {
-      char *switch_name;
-      char key[IDB_MAX_KEY_LEN];
-      char *default_val = "None";
-      sprintf(key, "NetCDF.Chunking");
-      switch_name = GetStringDefault(key, "None");
-      if (strcmp(switch_name, default_val) != 0)
-      {
-        size_t chunksize[(*myVarNCData)->dimSize];
-        chunksize[0] = 1;
-        chunksize[1] = GetInt("NetCDF.ChunkY");
-        chunksize[2] = GetInt("NetCDF.ChunkX");
-        nc_def_var_chunking(netCDFIDs[0], overland_bc_fluxVarID, NC_CHUNKED, chunksize);
-      }
+      NCDefVarStorage(netCDFIDs[0], overland_bc_fluxVarID, *myVarNCData);
     }
     if (res == NC_ENAMEINUSE)
     {
@@ -1102,15 +993,33 @@ void PutDataInNCNode(int varID, double *data_nc_node, int *nodeXIndices, int *no
     size_t start[myVarNCData->dimSize], count[myVarNCData->dimSize];
 
     int i, j, index, status;
+    int max_node_size;
+
+    /*
+     * Collective access requires every writer to make the same number
+     * of calls, writers on nodes with fewer processes write empty
+     * blocks.
+     */
+    MPI_Allreduce(&amps_node_size, &max_node_size, 1, MPI_INT, MPI_MAX, amps_CommWrite);
+
     start[0] = end[0] - 1; count[0] = 1;
-    for (i = 0; i < amps_node_size; i++)
+    for (i = 0; i < max_node_size; i++)
     {
-      start[1] = nodeZIndices[i]; start[2] = nodeYIndices[i]; start[3] = nodeXIndices[i];
-      count[1] = nodeZCount[i]; count[2] = nodeYCount[i]; count[3] = nodeXCount[i];
-      index = 0;
-      for (j = 0; j < i; j++)
+      if (i < amps_node_size)
+      {
+        start[1] = nodeZIndices[i]; start[2] = nodeYIndices[i]; start[3] = nodeXIndices[i];
+        count[1] = nodeZCount[i]; count[2] = nodeYCount[i]; count[3] = nodeXCount[i];
+        index = 0;
+        for (j = 0; j < i; j++)
+        {
+          index += nodeZCount[j] * nodeYCount[j] * nodeXCount[j];
+        }
+      }
+      else
       {
-        index += nodeZCount[j] * nodeYCount[j] * nodeXCount[j];
+        start[1] = 0; start[2] = 0; start[3] = 0;
+        count[1] = 0; count[2] = 0; count[3] = 0;
+        index = 0;
       }
       status = nc_put_vara_double(netCDFIDs[0], varID, start, count, &data_nc_node[index]);
     }
@@ -37,6 +37,26 @@
 *****************************************************************************/
 
 #include "databox.h"
+#include "parallel.h"
+
+typedef struct {
+  double alpha;
+  double         *xp, *yp;
+} AxpyArgs;
+
+static void AxpyCells(void *arg, int lo, int hi, int thread)
+{
+  AxpyArgs       *args = (AxpyArgs*)arg;
+  double alpha = args->alpha;
+  double         *xp = args->xp;
+  double         *yp = args->yp;
+  int m;
+
+  for (m = lo; m < hi; m++)
+  {
+    yp[m] += alpha * xp[m];
+  }
+}
 
 /*-----------------------------------------------------------------------
  * Compute Y = alpha*X + Y
@@ -44,39 +64,15 @@
 
 void       Axpy(double alpha, Databox *X, Databox *Y)
 {
-  int nx, ny, nz;
-  double x, y, z;
-  double dx, dy, dz;
-
-  double         *xp, *yp;
-
-  int m, sx, sy, sz;
-
-
-  nx = DataboxNx(X);
-  ny = DataboxNy(X);
-  nz = DataboxNz(X);
-
-  x = DataboxX(X);
-  y = DataboxY(X);
-  z = DataboxZ(X);
+  AxpyArgs args;
+  int n;
 
-  dx = DataboxDx(X);
-  dy = DataboxDy(X);
-  dz = DataboxDz(X);
 
-  xp = DataboxCoeffs(X);
-  yp = DataboxCoeffs(Y);
+  n = DataboxNx(X) * DataboxNy(X) * DataboxNz(X);
 
-  m = 0;
-  sx = 1;
-  sy = nx;
-  sz = ny * nx;
+  args.alpha = alpha;
+  args.xp = DataboxCoeffs(X);
+  args.yp = DataboxCoeffs(Y);
 
-  for (m = 0; m < (nx * ny * nz); m++)
-  {
-    yp[m] += alpha * xp[m];
-  }
+  ParallelFor(n, (double)n, AxpyCells, &args);
 }
-
-
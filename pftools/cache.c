@@ -0,0 +1,363 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+
+/*****************************************************************************
+* Cache of Databoxes loaded from files.
+*
+* Files loaded with pfload are kept in memory, up to a limit on the total
+* size, so loading the same file again only copies the cached values.  The
+* entries are keyed by the absolute path of the file, the file type and
+* the default value and are validated against the inode, size and
+* modification and status change times (with nanoseconds where the system
+* provides them) of the file, so a file that has been rewritten or
+* replaced is read again.  When
+* the limit is exceeded the least recently used entries are dropped.  The
+* cache is disabled until a limit is set with pfcache.
+*
+*****************************************************************************/
+
+#include "parflow_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <tcl.h>
+
+#include "cache.h"
+
+#ifndef PATH_MAX
+#define PATH_MAX 4096
+#endif
+
+/* Nanoseconds of the modification and status change times of a stat */
+#if defined(__APPLE__)
+#define CacheMtimeNsec(file_stat) ((file_stat)->st_mtimespec.tv_nsec)
+#define CacheCtimeNsec(file_stat) ((file_stat)->st_ctimespec.tv_nsec)
+#elif defined(_WIN32)
+#define CacheMtimeNsec(file_stat) 0
+#define CacheCtimeNsec(file_stat) 0
+#else
+#define CacheMtimeNsec(file_stat) ((file_stat)->st_mtim.tv_nsec)
+#define CacheCtimeNsec(file_stat) ((file_stat)->st_ctim.tv_nsec)
+#endif
+
+typedef struct _CacheEntry {
+  Tcl_HashEntry      *hash_entry;
+
+  struct stat file_stat;
+
+  Databox            *databox;
+  double bytes;
+
+  struct _CacheEntry *prev;     /* more recently used  */
+  struct _CacheEntry *next;     /* less recently used  */
+} CacheEntry;
+
+static Tcl_HashTable cache_table;
+static int cache_initialized = 0;
+
+static CacheEntry   *cache_head = NULL;
+static CacheEntry   *cache_tail = NULL;
+
+static CacheStats cache_stats = { 0.0, 0.0, 0, 0, 0 };
+
+
+/*-----------------------------------------------------------------------
+ * CacheKey:
+ *   Build the key of a file in key.  Returns zero if the file does not
+ *   exist, otherwise its status is returned in file_stat.
+ *-----------------------------------------------------------------------*/
+
+static int CacheKey(
+                    char *       filename,
+                    char *       filetype,
+                    double       default_value,
+                    Tcl_DString *key,
+                    struct stat *file_stat)
+{
+  char path[PATH_MAX];
+  char value[32];
+
+  if (stat(filename, file_stat) != 0)
+    return 0;
+
+#ifdef _WIN32
+  if (_fullpath(path, filename, PATH_MAX) == NULL)
+    return 0;
+#else
+  if (realpath(filename, path) == NULL)
+    return 0;
+#endif
+
+  sprintf(value, "%.17g", default_value);
+
+  Tcl_DStringInit(key);
+  Tcl_DStringAppendElement(key, filetype);
+  Tcl_DStringAppendElement(key, value);
+  Tcl_DStringAppendElement(key, path);
+
+  return 1;
+}
+
+
+/*-----------------------------------------------------------------------
+ * CacheSameFile:
+ *   Returns non-zero if the two stats are of the same, unmodified file.
+ *   A file rewritten within the resolution of the file system times
+ *   with the same size is not detected.
+ *-----------------------------------------------------------------------*/
+
+static int CacheSameFile(
+                         struct stat *cached,
+                         struct stat *current)
+{
+  return cached->st_dev == current->st_dev
+         && cached->st_ino == current->st_ino
+         && cached->st_size == current->st_size
+         && cached->st_mtime == current->st_mtime
+         && CacheMtimeNsec(cached) == CacheMtimeNsec(current)
+         && cached->st_ctime == current->st_ctime
+         && CacheCtimeNsec(cached) == CacheCtimeNsec(current);
+}
+
+
+/*-----------------------------------------------------------------------
+ * Unlink an entry from the recently used list, and put it back at the
+ * front of the list
+ *-----------------------------------------------------------------------*/
+
+static void CacheUnlink(
+                        CacheEntry *entry)
+{
+  if (entry->prev)
+    entry->prev->next = entry->next;
+  else
+    cache_head = entry->next;
+
+  if (entry->next)
+    entry->next->prev = entry->prev;
+  else
+    cache_tail = entry->prev;
+}
+
+static void CachePushFront(
+                           CacheEntry *entry)
+{
+  entry->prev = NULL;
+  entry->next = cache_head;
+
+  if (cache_head)
+    cache_head->prev = entry;
+  else
+    cache_tail = entry;
+
+  cache_head = entry;
+}
+
+
+/*-----------------------------------------------------------------------
+ * Drop an entry from the cache
+ *-----------------------------------------------------------------------*/
+
+static void CacheRemove(
+                        CacheEntry *entry)
+{
+  CacheUnlink(entry);
+  Tcl_DeleteHashEntry(entry->hash_entry);
+
+  cache_stats.used -= entry->bytes;
+  cache_stats.entries--;
+
+  FreeDatabox(entry->databox);
+  free(entry);
+}
+
+
+/*-----------------------------------------------------------------------
+ * SetCacheLimit:
+ *   Set the capacity of the cache in bytes, dropping the least recently
+ *   used entries that no longer fit.  A limit of zero disables the cache.
+ *-----------------------------------------------------------------------*/
+
+void SetCacheLimit(
+                   double limit)
+{
+  if (!cache_initialized)
+  {
+    Tcl_InitHashTable(&cache_table, TCL_STRING_KEYS);
+    cache_initialized = 1;
+  }
+
+  cache_stats.limit = limit;
+
+  while (cache_tail && cache_stats.used > cache_stats.limit)
+    CacheRemove(cache_tail);
+}
+
+
+/*-----------------------------------------------------------------------
+ * CacheLookup:
+ *   Returns a copy of the cached Databox of a file, or NULL if the file
+ *   is not cached or has changed since it was cached.
+ *-----------------------------------------------------------------------*/
+
+Databox         *CacheLookup(
+                             char * filename,
+                             char * filetype,
+                             double default_value)
+{
+  Tcl_DString key;
+  struct stat file_stat;
+  Tcl_HashEntry *hash_entry;
+  CacheEntry    *entry = NULL;
+
+  if (cache_stats.limit <= 0.0)
+    return NULL;
+
+  if (!CacheKey(filename, filetype, default_value, &key, &file_stat))
+    return NULL;
+
+  if ((hash_entry = Tcl_FindHashEntry(&cache_table, Tcl_DStringValue(&key))))
+  {
+    entry = (CacheEntry*)Tcl_GetHashValue(hash_entry);
+
+    if (!CacheSameFile(&entry->file_stat, &file_stat))
+    {
+      CacheRemove(entry);
+      entry = NULL;
+    }
+  }
+
+  Tcl_DStringFree(&key);
+
+  if (entry == NULL)
+  {
+    cache_stats.misses++;
+    return NULL;
+  }
+
+  CacheUnlink(entry);
+  CachePushFront(entry);
+
+  cache_stats.hits++;
+
+  return CopyDatabox(entry->databox);
+}
+
+
+/*-----------------------------------------------------------------------
+ * CacheInsert:
+ *   Keep a copy of a Databox read from a file.  Databoxes larger than the
+ *   whole cache are not kept.
+ *-----------------------------------------------------------------------*/
+
+void             CacheInsert(
+                             char *   filename,
+                             char *   filetype,
+                             double   default_value,
+                             Databox *databox)
+{
+  Tcl_DString key;
+  struct stat file_stat;
+  Tcl_HashEntry *hash_entry;
+  CacheEntry    *entry;
+  double bytes;
+  int new_entry;
+
+  if (cache_stats.limit <= 0.0)
+    return;
+
+  bytes = (double)DataboxNx(databox) * DataboxNy(databox) * DataboxNz(databox)
+          * sizeof(double) + sizeof(Databox);
+
+  if (bytes > cache_stats.limit)
+    return;
+
+  if (!CacheKey(filename, filetype, default_value, &key, &file_stat))
+    return;
+
+  if ((hash_entry = Tcl_FindHashEntry(&cache_table, Tcl_DStringValue(&key))))
+    CacheRemove((CacheEntry*)Tcl_GetHashValue(hash_entry));
+
+  while (cache_tail && cache_stats.used + bytes > cache_stats.limit)
+    CacheRemove(cache_tail);
+
+  if ((entry = (CacheEntry*)malloc(sizeof(CacheEntry))) == NULL)
+  {
+    Tcl_DStringFree(&key);
+    return;
+  }
+
+  if ((entry->databox = CopyDatabox(databox)) == NULL)
+  {
+    free(entry);
+    Tcl_DStringFree(&key);
+    return;
+  }
+
+  entry->file_stat = file_stat;
+  entry->bytes = bytes;
+
+  entry->hash_entry = Tcl_CreateHashEntry(&cache_table, Tcl_DStringValue(&key),
+                                          &new_entry);
+  Tcl_SetHashValue(entry->hash_entry, entry);
+  Tcl_DStringFree(&key);
+
+  CachePushFront(entry);
+
+  cache_stats.used += bytes;
+  cache_stats.entries++;
+}
+
+
+/*-----------------------------------------------------------------------
+ * FlushCache:
+ *   Drop all entries from the cache
+ *-----------------------------------------------------------------------*/
+
+void FlushCache()
+{
+  while (cache_tail)
+    CacheRemove(cache_tail);
+}
+
+
+/*-----------------------------------------------------------------------
+ * GetCacheStats:
+ *   Return the limit, usage and hit counts of the cache
+ *-----------------------------------------------------------------------*/
+
+void GetCacheStats(
+                   CacheStats *stats)
+{
+  *stats = cache_stats;
+}
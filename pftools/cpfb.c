@@ -0,0 +1,231 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+/*****************************************************************************
+* Block codec for compressed parflow binary (CPFB) files.
+*
+* A block holds n values as 64 bit words, delta encoded against the
+* previous word, split into byte planes (most significant first) and
+* compressed with zlib.  The words are the IEEE bits of the values
+* (CPFB_LOSSLESS, XOR delta) or round(value / (2 tolerance))
+* (CPFB_ERROR_BOUNDED, zigzag encoded difference).  Blocks with
+* CPFB_DELTA set are encoded against the words of the reference values,
+* the previous snapshot of a time series, instead of the previous word.
+*
+*****************************************************************************/
+
+#include "cpfb.h"
+#include "general.h"
+
+#ifdef PARFLOW_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*-----------------------------------------------------------------------
+ * Compress n values into a newly allocated buffer.  Returns the method
+ * actually used, CPFB_LOSSLESS if the values can not be quantized within
+ * the tolerance, or -1 on failure.
+ *-----------------------------------------------------------------------*/
+
+int            CPFBEncode(
+                          double *        values,
+                          int             n,
+                          int             method,
+                          double          tolerance,
+                          unsigned char **buffer,
+                          int *           nbytes)
+{
+#ifdef PARFLOW_HAVE_ZLIB
+  uint64_t      *words;
+  unsigned char *planes;
+  uLongf length;
+  uint64_t prev, word, bits;
+  int64_t q;
+  double step = 2.0 * tolerance;
+  int i, b;
+
+  words = ctalloc(uint64_t, n);
+  planes = ctalloc(unsigned char, 8 * n);
+
+  if (method == CPFB_ERROR_BOUNDED)
+  {
+    for (i = 0; i < n; i++)
+    {
+      double r = values[i] / step;
+      if (!(fabs(r) < CPFB_MAX_QUANTUM))
+      {
+        method = CPFB_LOSSLESS;
+        break;
+      }
+      q = llround(r);
+      if (!(fabs(values[i] - (double)q * step) <= tolerance))
+      {
+        method = CPFB_LOSSLESS;
+        break;
+      }
+      words[i] = (uint64_t)q;
+    }
+  }
+
+  prev = 0;
+  for (i = 0; i < n; i++)
+  {
+    if (method == CPFB_ERROR_BOUNDED)
+    {
+      q = (int64_t)(words[i] - prev);
+      prev = words[i];
+      word = ((uint64_t)q << 1) ^ (uint64_t)(q >> 63);
+    }
+    else
+    {
+      memcpy(&bits, &values[i], sizeof(bits));
+      word = bits ^ prev;
+      prev = bits;
+    }
+
+    for (b = 0; b < 8; b++)
+      planes[b * n + i] = (unsigned char)(word >> (56 - 8 * b));
+  }
+
+  length = compressBound(8 * n);
+  *buffer = ctalloc(unsigned char, length);
+  if (compress2(*buffer, &length, planes, 8 * n, Z_DEFAULT_COMPRESSION) != Z_OK)
+  {
+    tfree(*buffer);
+    method = -1;
+  }
+  *nbytes = (int)length;
+
+  tfree(planes);
+  tfree(words);
+
+  return method;
+#else
+  (void)values;
+  (void)n;
+  (void)method;
+  (void)tolerance;
+  (void)buffer;
+  (void)nbytes;
+  return -1;
+#endif
+}
+
+/*-----------------------------------------------------------------------
+ * Decompress a block of n values.  reference holds the n values of the
+ * previous snapshot if CPFB_DELTA is set in method.  Returns 0 on
+ * success.
+ *-----------------------------------------------------------------------*/
+
+int            CPFBDecode(
+                          unsigned char *buffer,
+                          int            nbytes,
+                          int            method,
+                          double         tolerance,
+                          double *       reference,
+                          double *       values,
+                          int            n)
+{
+#ifdef PARFLOW_HAVE_ZLIB
+  unsigned char *planes;
+  uLongf length = 8 * (uLongf)n;
+  uint64_t prev, word;
+  int64_t q;
+  double step = 2.0 * tolerance;
+  double r;
+  int delta = (method & CPFB_DELTA) != 0;
+  int i, b;
+
+  method &= ~CPFB_DELTA;
+  if (delta && reference == NULL)
+    return 1;
+
+  planes = ctalloc(unsigned char, 8 * n);
+
+  if (uncompress(planes, &length, buffer, nbytes) != Z_OK
+      || length != 8 * (uLongf)n)
+  {
+    tfree(planes);
+    return 1;
+  }
+
+  prev = 0;
+  for (i = 0; i < n; i++)
+  {
+    word = 0;
+    for (b = 0; b < 8; b++)
+      word = (word << 8) | planes[b * n + i];
+
+    if (delta)
+    {
+      if (method == CPFB_ERROR_BOUNDED)
+      {
+        r = reference[i] / step;
+        if (!(fabs(r) < CPFB_MAX_QUANTUM))
+        {
+          tfree(planes);
+          return 1;
+        }
+        prev = (uint64_t)llround(r);
+      }
+      else
+        memcpy(&prev, &reference[i], sizeof(prev));
+    }
+
+    if (method == CPFB_ERROR_BOUNDED)
+    {
+      q = (int64_t)((word >> 1) ^ (~(word & 1) + 1));
+      prev += (uint64_t)q;
+      values[i] = (double)(int64_t)prev * step;
+    }
+    else
+    {
+      prev ^= word;
+      memcpy(&values[i], &prev, sizeof(prev));
+    }
+  }
+
+  tfree(planes);
+
+  return 0;
+#else
+  (void)buffer;
+  (void)nbytes;
+  (void)method;
+  (void)tolerance;
+  (void)reference;
+  (void)values;
+  (void)n;
+  return 1;
+#endif
+}
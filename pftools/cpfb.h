@@ -0,0 +1,70 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+/*****************************************************************************
+* Header file for `cpfb.c'
+*
+* Block codec for compressed parflow binary (CPFB) files, see
+* pfsimulator/parflow_lib/write_parflow_cpfb.c for the file layout.
+*
+*****************************************************************************/
+
+#ifndef CPFB_HEADER
+#define CPFB_HEADER
+
+#include "parflow_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Block compression methods, stored in the file header and index, with
+ * CPFB_DELTA set for snapshots encoded against the previous snapshot */
+#define CPFB_NONE          0
+#define CPFB_LOSSLESS      1
+#define CPFB_ERROR_BOUNDED 2
+#define CPFB_DELTA         4
+
+/* Largest quantized value of an error bounded block */
+#define CPFB_MAX_QUANTUM   1.0e12
+
+/* Values per side of the x-y tiles written by pftools */
+#define CPFB_TILE_SIZE     64
+
+/*-----------------------------------------------------------------------
+ * function prototypes
+ *-----------------------------------------------------------------------*/
+
+/* cpfb.c */
+int CPFBEncode(double *values, int n, int method, double tolerance, unsigned char **buffer, int *nbytes);
+int CPFBDecode(unsigned char *buffer, int nbytes, int method, double tolerance, double *reference, double *values, int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
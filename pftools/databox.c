@@ -34,6 +34,7 @@
 
 #include "databox.h"
 #include <stdlib.h>
+#include <string.h>
 
 /*-----------------------------------------------------------------------
  * create new Databox structure
@@ -111,6 +112,35 @@ Databox         *NewDataboxDefault(
 }
 
 
+/*-----------------------------------------------------------------------
+ * create a copy of a Databox, including its label
+ *-----------------------------------------------------------------------*/
+
+Databox         *CopyDatabox(
+                             Databox *databox)
+{
+  Databox         *new_databox;
+  size_t size;
+
+  size = (size_t)DataboxNx(databox) * DataboxNy(databox) * DataboxNz(databox);
+
+  if ((new_databox = (Databox*)malloc(sizeof(Databox))) == NULL)
+    return((Databox*)NULL);
+
+  *new_databox = *databox;
+
+  if ((DataboxCoeffs(new_databox) = (double*)malloc(size * sizeof(double))) == NULL)
+  {
+    free(new_databox);
+    return((Databox*)NULL);
+  }
+
+  memcpy(DataboxCoeffs(new_databox), DataboxCoeffs(databox), size * sizeof(double));
+
+  return new_databox;
+}
+
+
 /*-----------------------------------------------------------------------
  * print Databox grid info
  *-----------------------------------------------------------------------*/
@@ -129,6 +129,9 @@ int IsValidFileType(
                     char *option)
 {
   if (strcmp(option, "pfb") == 0
+#ifdef PARFLOW_HAVE_ZLIB
+      || strcmp(option, "cpfb") == 0
+#endif
       || strcmp(option, "pfsb") == 0
       || strcmp(option, "sa") == 0
       || strcmp(option, "sa2d") == 0     // Added @ IMF
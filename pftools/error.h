@@ -113,14 +113,22 @@ static char *SAVESDSUSAGE = "Usage: pfsavesds dataset -filetype filename\n
 static char *BFCVELUSAGE = "Usage: pfbfcvel conductivity phead\n";
 static char *GETSUBBOXUSAGE = "Usage: pfgetsubbox dataset il jl kl iu ju ku\n";
 static char *ENLARGEBOXUSAGE = "Usage: pfenlargebox dataset new_nx new_ny new_nz\n";
-static char *LOADPFUSAGE = "Usage: pfload [-filetype] filename\n       file types: pfb pfsb sa sb rsa\n";
+static char *LOADPFUSAGE = "Usage: pfload [-filetype] filename\n       file types: pfb cpfb pfsb sa sb rsa\n";
+static char *LOADSUBBOXUSAGE = "Usage: pfloadsubbox filename il jl kl iu ju ku [default_value]\n       file types: pfb cpfb\n";
+static char *LOADTOPUSAGE = "Usage: pfloadtop filename top [default_value]\n       file types: pfb cpfb\n";
+static char *LOADWATERTABLEDEPTHUSAGE = "Usage: pfloadwatertabledepth filename top\n       file types: pfb cpfb\n";
 static char *RELOADUSAGE = "Usage: pfreload dataset\n";
-static char *SAVEPFUSAGE = "Usage: pfsave dataset -filetype filename\n       file types: pfb sa sb\n";
+static char *SAVEPFUSAGE = "Usage: pfsave dataset -filetype filename [tolerance]\n       file types: pfb cpfb sa sb\n";
 static char *GETLISTUSAGE = "Usage: pfgetlist [dataset]\n";
 static char *GETELTUSAGE = "Usage: pfgetelt dataset i j k\n";
 static char *GETGRIDUSAGE = "Usage: pfgetgrid dataset\n";
 static char *SETGRIDUSAGE = "Usage: pfsetgrid { nx ny nz } { x y z } { dx dy dz } dataset\n       Types: int nx, ny, nz;  double x, y, z, dx, dy, dz;\n";
 static char *GRIDTYPEUSAGE = "Usage: pfgridtype [vertex | cell]\n";
+static char *PFVTSSAVEUSAGE = "Usage: pfvtssave filename {name dataset [name dataset ...]}\n       [-flt] [-dem dem] [-dzscale {dz_1 ... dz_nz}]\n       [-box {il jl kl iu ju ku}] [-stride {sx sy sz}]\n";
+static char *SETTHREADSUSAGE = "Usage: pfsetthreads [num_threads]\n";
+static char *CACHEUSAGE = "Usage: pfcache [-limit megabytes | -flush]\n";
+static char *SERVEUSAGE = "Usage: pfserve socket\n       pfserve -stop\n";
+static char *SENDUSAGE = "Usage: pfsend socket script\n";
 static char *CVELUSAGE = "Usage: pfcvel conductivity phead\n";
 static char *VVELUSAGE = "Usage: pfvvel conductivity phead\n";
 static char *VMAGUSEAGE = "Usage: pfvmag datasetx datasety datasetz\n";
@@ -155,12 +163,14 @@ static char *PFSURFACESTORAGEUSAGE = "Usage: pfsuracestorge top pressure\n";
 static char *PFSUBSURFACESTORAGEUSAGE = "Usage: pfsubsuracestorge mask porosity pressure saturation specific_storage\n";
 static char *PFGWSTORAGEUSAGE = "Usage: pfgwstorge mask porosity pressure saturation specific_storage\n";
 static char *PFSURFACERUNOFFUSAGE = "Usage: pfsuracerunoff top slope_x slope_y mannings pressure\n";
+static char *PFREDUCESERIESUSAGE = "Usage: pfreduceseries pattern start stop [increment]\n       [-subsurface saturation_pattern mask porosity specific_storage]\n       [-surface top slope_x slope_y mannings]\n";
 static char *PFWATERTABLEDEPTHUSAGE = "Usage: pfwatertabledepth top saturation\n";
 static char *PFSLOPEXUSAGE = "Usage: pfslopex dem\n";
 static char *PFSLOPEYUSAGE = "Usage: pfslopey dem\n";
 static char *PFUPSTREAMAREAUSAGE = "Usage: pfupstreamarea dem sx sy\n";
 static char *PFFILLFLATSUSAGE = "Usage: pffillflats dem \n";
 static char *PFPITFILLDEMUSAGE = "Usage: pfpitfilldem dem dpit maxiter\n";
+static char *PFPRIORITYFILLDEMUSAGE = "Usage: pfpriorityfilldem dem [epsilon]\n";
 static char *PFMOVINGAVGDEMUSAGE = "Usage: pfmovingavgdem dem wsize maxiter\n";
 static char *PFSATTRANSUSAGE = "Usage: pfsattrans nlayers mask perm\n";
 static char *PFTOPODEFTOWTUSAGE = "Usage: pftopowt deficit porosity ssat sres mask top \n";
@@ -40,6 +40,7 @@
 *****************************************************************************/
 
 #include "flux.h"
+#include "parallel.h"
 
 #if 0
 #define Mean(a, b) (0.5*((a) + (b)))
@@ -47,6 +48,69 @@
 #endif
 #define Mean(a, b)    (((a) + (b)) ? ((2.0*(a)*(b)) / ((a) + (b))) : 0)
 
+typedef struct {
+  double         *kp, *hp, *fluxp;
+  int nx, ny;
+  double dx, dy, dz;
+} FluxArgs;
+
+/*-----------------------------------------------------------------------
+ * Compute the flux on interior rows [lo, hi); row r is (jj, kk) =
+ * (1 + r % (ny - 2), 1 + r / (ny - 2))
+ *-----------------------------------------------------------------------*/
+
+static void FluxRows(void *arg, int lo, int hi, int thread)
+{
+  FluxArgs       *args = (FluxArgs*)arg;
+  double         *kp, *hp, *fluxp;
+  int nx = args->nx;
+  int ny = args->ny;
+  double dx = args->dx;
+  double dy = args->dy;
+  double dz = args->dz;
+
+  double qxp, qxm, qyp, qym, qzp, qzm;
+  int cell,
+    cell_xm1, cell_xp1,
+    cell_ym1, cell_yp1,
+    cell_zm1, cell_zp1;
+  int ii, jj, kk, r, m;
+
+  cell = 0;
+  cell_xm1 = cell - 1;
+  cell_xp1 = cell + 1;
+  cell_ym1 = cell - nx;
+  cell_yp1 = cell + nx;
+  cell_zm1 = cell - nx * ny;
+  cell_zp1 = cell + nx * ny;
+
+  for (r = lo; r < hi; r++)
+  {
+    jj = 1 + r % (ny - 2);
+    kk = 1 + r / (ny - 2);
+    m = kk * nx * ny + jj * nx + 1;
+
+    kp = args->kp + m;
+    hp = args->hp + m;
+    fluxp = args->fluxp + m;
+    for (ii = 1; ii < (nx - 1); ii++)
+    {
+      qxp = -Mean(kp[cell_xp1], kp[cell]) * (hp[cell_xp1] - hp[cell]) / dx;
+      qxm = -Mean(kp[cell], kp[cell_xm1]) * (hp[cell] - hp[cell_xm1]) / dx;
+      qyp = -Mean(kp[cell_yp1], kp[cell]) * (hp[cell_yp1] - hp[cell]) / dy;
+      qym = -Mean(kp[cell], kp[cell_ym1]) * (hp[cell] - hp[cell_ym1]) / dy;
+      qzp = -Mean(kp[cell_zp1], kp[cell]) * (hp[cell_zp1] - hp[cell]) / dz;
+      qzm = -Mean(kp[cell], kp[cell_zm1]) * (hp[cell] - hp[cell_zm1]) / dz;
+
+      fluxp[cell] = (qxp - qxm) * dy * dz + (qyp - qym) * dx * dz + (qzp - qzm) * dx * dy;
+
+      kp++;
+      hp++;
+      fluxp++;
+    }
+  }
+}
+
 /*-----------------------------------------------------------------------
  * Compute net cell flux from conductivity and hydraulic head
  *-----------------------------------------------------------------------*/
@@ -56,20 +120,12 @@ Databox       *CompFlux(
                         Databox *h)
 {
   Databox        *flux;
+  FluxArgs args;
 
   int nx, ny, nz;
   double x, y, z;
   double dx, dy, dz;
 
-  double         *fluxp, *kp, *hp;
-
-  double qxp, qxm, qyp, qym, qzp, qzm;
-  int cell,
-    cell_xm1, cell_xp1,
-    cell_ym1, cell_yp1,
-    cell_zm1, cell_zp1;
-  int ii, jj, kk;
-
   nx = DataboxNx(k);
   ny = DataboxNy(k);
   nz = DataboxNz(k);
@@ -95,53 +151,18 @@ Databox       *CompFlux(
   if ((flux = NewDatabox(nx, ny, nz, x, y, z, dx, dy, dz)) == NULL)
     return((Databox*)NULL);
 
-  kp = DataboxCoeffs(k);
-  hp = DataboxCoeffs(h);
-  fluxp = DataboxCoeffs(flux);
-
-  cell = 0;
-  cell_xm1 = cell - 1;
-  cell_xp1 = cell + 1;
-  cell_ym1 = cell - nx;
-  cell_yp1 = cell + nx;
-  cell_zm1 = cell - nx * ny;
-  cell_zp1 = cell + nx * ny;
-
-  kp += nx * ny;
-  hp += nx * ny;
-  fluxp += nx * ny;
-  for (kk = 1; kk < (nz - 1); kk++)
+  if (ny > 2 && nz > 2)
   {
-    kp += nx;
-    hp += nx;
-    fluxp += nx;
-    for (jj = 1; jj < (ny - 1); jj++)
-    {
-      kp++;
-      hp++;
-      fluxp++;
-      for (ii = 1; ii < (nx - 1); ii++)
-      {
-        qxp = -Mean(kp[cell_xp1], kp[cell]) * (hp[cell_xp1] - hp[cell]) / dx;
-        qxm = -Mean(kp[cell], kp[cell_xm1]) * (hp[cell] - hp[cell_xm1]) / dx;
-        qyp = -Mean(kp[cell_yp1], kp[cell]) * (hp[cell_yp1] - hp[cell]) / dy;
-        qym = -Mean(kp[cell], kp[cell_ym1]) * (hp[cell] - hp[cell_ym1]) / dy;
-        qzp = -Mean(kp[cell_zp1], kp[cell]) * (hp[cell_zp1] - hp[cell]) / dz;
-        qzm = -Mean(kp[cell], kp[cell_zm1]) * (hp[cell] - hp[cell_zm1]) / dz;
-
-        fluxp[cell] = (qxp - qxm) * dy * dz + (qyp - qym) * dx * dz + (qzp - qzm) * dx * dy;
-
-        kp++;
-        hp++;
-        fluxp++;
-      }
-      kp++;
-      hp++;
-      fluxp++;
-    }
-    kp += nx;
-    hp += nx;
-    fluxp += nx;
+    args.kp = DataboxCoeffs(k);
+    args.hp = DataboxCoeffs(h);
+    args.fluxp = DataboxCoeffs(flux);
+    args.nx = nx;
+    args.ny = ny;
+    args.dx = dx;
+    args.dy = dy;
+    args.dz = dz;
+
+    ParallelFor((ny - 2) * (nz - 2), (double)nx * ny * nz, FluxRows, &args);
   }
 
   return flux;
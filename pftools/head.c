@@ -56,6 +56,34 @@
 *****************************************************************************/
 
 #include "head.h"
+#include "parallel.h"
+
+/*-----------------------------------------------------------------------
+ * Add sign*z to each k-plane of h; threaded over k
+ *-----------------------------------------------------------------------*/
+
+typedef struct {
+  double         *hp, *vp;
+  double z, dz, dz2, sign;
+  int nxy;
+} HeadArgs;
+
+static void HeadPlanes(void *arg, int lo, int hi, int thread)
+{
+  HeadArgs       *args = (HeadArgs*)arg;
+  double         *hp, *vp;
+  double zz;
+  int ji, k;
+
+  for (k = lo; k < hi; k++)
+  {
+    zz = args->sign * (args->z + ((double)k) * args->dz + args->dz2);
+    hp = args->hp + k * args->nxy;
+    vp = args->vp + k * args->nxy;
+    for (ji = 0; ji < args->nxy; ji++)
+      vp[ji] = hp[ji] + zz;
+  }
+}
 
 
 /*-----------------------------------------------------------------------
@@ -72,11 +100,9 @@ Databox        *HHead(
   double x, y, z;
   double dx, dy, dz;
 
-  double         *hp, *vp;
-
-  int ji, k;
+  HeadArgs args;
 
-  double zz, dz2 = 0.0;
+  double dz2 = 0.0;
 
 
   nx = DataboxNx(h);
@@ -105,15 +131,15 @@ Databox        *HHead(
   if ((v = NewDatabox(nx, ny, nz, x, y, z, dx, dy, dz)) == NULL)
     return((Databox*)NULL);
 
-  hp = DataboxCoeffs(h);
-  vp = DataboxCoeffs(v);
+  args.hp = DataboxCoeffs(h);
+  args.vp = DataboxCoeffs(v);
+  args.z = z;
+  args.dz = dz;
+  args.dz2 = dz2;
+  args.sign = 1.0;
+  args.nxy = nx * ny;
 
-  for (k = 0; k < nz; k++)
-  {
-    zz = z + ((double)k) * dz + dz2;
-    for (ji = 0; ji < ny * nx; ji++)
-      *(vp++) = *(hp++) + zz;
-  }
+  ParallelFor(nz, (double)nx * ny * nz, HeadPlanes, &args);
 
   return v;
 }
@@ -133,11 +159,9 @@ Databox        *PHead(
   double x, y, z;
   double dx, dy, dz;
 
-  double         *hp, *vp;
-
-  int ji, k;
+  HeadArgs args;
 
-  double zz, dz2 = 0.0;
+  double dz2 = 0.0;
 
 
   nx = DataboxNx(h);
@@ -166,15 +190,15 @@ Databox        *PHead(
   if ((v = NewDatabox(nx, ny, nz, x, y, z, dx, dy, dz)) == NULL)
     return((Databox*)NULL);
 
-  hp = DataboxCoeffs(h);
-  vp = DataboxCoeffs(v);
+  args.hp = DataboxCoeffs(h);
+  args.vp = DataboxCoeffs(v);
+  args.z = z;
+  args.dz = dz;
+  args.dz2 = dz2;
+  args.sign = -1.0;
+  args.nxy = nx * ny;
 
-  for (k = 0; k < nz; k++)
-  {
-    zz = z + ((double)k) * dz + dz2;
-    for (ji = 0; ji < ny * nx; ji++)
-      *(vp++) = *(hp++) - zz;
-  }
+  ParallelFor(nz, (double)nx * ny * nz, HeadPlanes, &args);
 
   return v;
 }
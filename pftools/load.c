@@ -34,46 +34,73 @@
 
 #include "pfload_file.h"
 #include "load.h"
+#include "readdatabox.h"
 #include "tools_io.h"
+#include "general.h"
 
 
 /*-----------------------------------------------------------------------
- * LoadParflowB:
+ * DistParflowB:
+ *
+ * Write the subgrids of all_subgrids to filename in the distributed
+ * layout, with the offset of each process in filename.dist, reading the
+ * values from the PFB file src_filename instead of a Databox holding
+ * the whole domain.  The subgrids are written in process order.
+ * Consecutive subgrids next to each other in x with the same y and z
+ * extents (one row of processes) are read from the source as a single
+ * slab, so the source is read in order and only one slab is held in
+ * memory.  The source may itself be a distributed file with any number
+ * of subgrids.
+ *
+ * Returns 0 on success, 1 if a file cannot be opened or a slab cannot
+ * be allocated.
  *-----------------------------------------------------------------------*/
 
-void           LoadParflowB(
+int            DistParflowB(
+                            char *        src_filename,
                             char *        filename,
                             SubgridArray *all_subgrids,
-                            Background *  background,
-                            Databox *     databox)
+                            Background *  background)
 {
   char output_name[MAXPATHLEN];
-  FILE     *file;
-  FILE     *dist_file;
+  FILE     *file = NULL;
+  FILE     *dist_file = NULL;
 
-  Subgrid  *subgrid;
+  ParflowBFile *src;
+  Databox  *slab;
 
-  int process, num_procs;
-  int p;
+  Subgrid  *subgrid, *next;
 
-  double   *ptr;
+  int process, num_procs;
+  int num_subgrids;
+  int      *order, *count;
+  int first, last, g;
 
-  int NX = DataboxNx(databox);
-  int NY = DataboxNy(databox);
-  int NZ = DataboxNz(databox);
+  int NX, NY, NZ;
 
   int ix, iy, iz;
   int nx, ny, nz;
+  int slab_ix, slab_nx;
 
   int k, j, s_i;
 
   long file_pos = 0;
 
 
+  if ((src = OpenParflowB(src_filename)) == NULL)
+    return 1;
+
+  NX = src->NX;
+  NY = src->NY;
+  NZ = src->NZ;
+
   /*--------------------------------------------------------------------
-   * Determine num_procs, and clear output files
+   * Determine num_procs, clear output files and sort the subgrids by
+   * process, keeping the array order within a process
    *--------------------------------------------------------------------*/
 
+  num_subgrids = SubgridArraySize(all_subgrids);
+
   num_procs = -1;
   ForSubgridI(s_i, all_subgrids)
   {
@@ -91,6 +118,21 @@ void           LoadParflowB(
   }
   num_procs++;
 
+  count = ctalloc(int, num_procs + 1);
+  order = talloc(int, num_subgrids);
+
+  ForSubgridI(s_i, all_subgrids)
+  {
+    count[SubgridProcess(SubgridArraySubgrid(all_subgrids, s_i)) + 1]++;
+  }
+  for (process = 0; process < num_procs; process++)
+    count[process + 1] += count[process];
+  ForSubgridI(s_i, all_subgrids)
+  {
+    order[count[SubgridProcess(SubgridArraySubgrid(all_subgrids, s_i))]++] = s_i;
+  }
+  tfree(count);
+
   /*--------------------------------------------------------------------
    * Load the data
    *--------------------------------------------------------------------*/
@@ -98,103 +140,145 @@ void           LoadParflowB(
 #ifndef AMPS_SPLIT_FILE
   if ((file = fopen(filename, "wb")) == NULL)
   {
-    printf("Unable to open outputfile <%s>\n", output_name);
-    exit(1);
+    printf("Unable to open outputfile <%s>\n", filename);
+    tfree(order);
+    CloseParflowB(src);
+    return 1;
   }
 
-
   strcpy(output_name, filename);
   strcat(output_name, ".dist");
 
   if ((dist_file = fopen(output_name, "wb")) == NULL)
   {
     printf("Unable to open distribution outputfile <%s>\n", output_name);
-    exit(1);
+    fclose(file);
+    tfree(order);
+    CloseParflowB(src);
+    return 1;
   }
 
-
   fprintf(dist_file, "0\n");
 #endif
 
-  for (p = 0; p < num_procs; p++)
+  for (first = 0; first < num_subgrids; first = last + 1)
   {
-    ForSubgridI(s_i, all_subgrids)
+    /* find the row of subgrids read as one slab */
+    subgrid = SubgridArraySubgrid(all_subgrids, order[first]);
+    for (last = first; last + 1 < num_subgrids; last++)
     {
-      subgrid = SubgridArraySubgrid(all_subgrids, s_i);
+      next = SubgridArraySubgrid(all_subgrids, order[last + 1]);
+      if (SubgridIY(next) != SubgridIY(subgrid)
+          || SubgridNY(next) != SubgridNY(subgrid)
+          || SubgridIZ(next) != SubgridIZ(subgrid)
+          || SubgridNZ(next) != SubgridNZ(subgrid)
+          || SubgridIX(next) != SubgridIX(SubgridArraySubgrid(all_subgrids, order[last]))
+          + SubgridNX(SubgridArraySubgrid(all_subgrids, order[last])))
+        break;
+    }
 
-      process = SubgridProcess(subgrid);
+    next = SubgridArraySubgrid(all_subgrids, order[last]);
 
-      if (process == p)
-      {
-#ifdef AMPS_SPLIT_FILE
-        sprintf(output_name, "%s.%05d", filename, process);
+    slab_ix = SubgridIX(subgrid);
+    slab_nx = SubgridIX(next) + SubgridNX(next) - slab_ix;
 
-        if ((file = fopen(output_name, "a+")) == NULL)
-        {
-          printf("Unable to open outputfile <%s>\n", output_name);
-          exit(1);
-        }
+    iy = SubgridIY(subgrid);
+    iz = SubgridIZ(subgrid);
+
+    ny = SubgridNY(subgrid);
+    nz = SubgridNZ(subgrid);
+
+    if ((slab = NewDatabox(slab_nx, ny, nz, 0.0, 0.0, 0.0, 1.0, 1.0, 1.0)) == NULL)
+    {
+      printf("Unable to allocate a slab of %d x %d x %d values\n", slab_nx, ny, nz);
+#ifndef AMPS_SPLIT_FILE
+      fclose(file);
+      fclose(dist_file);
 #endif
+      tfree(order);
+      CloseParflowB(src);
+      return 1;
+    }
+
+    ReadParflowBBox(src, slab, slab_ix, iy, iz);
+
+    for (g = first; g <= last; g++)
+    {
+      subgrid = SubgridArraySubgrid(all_subgrids, order[g]);
+
+      process = SubgridProcess(subgrid);
 
-        /* if (process == 0), write header info */
-        if (!process)
-        {
-          tools_WriteDouble(file, &BackgroundX(background), 1);
-          tools_WriteDouble(file, &BackgroundY(background), 1);
-          tools_WriteDouble(file, &BackgroundZ(background), 1);
+#ifdef AMPS_SPLIT_FILE
+      sprintf(output_name, "%s.%05d", filename, process);
 
-          tools_WriteInt(file, &NX, 1);
-          tools_WriteInt(file, &NY, 1);
-          tools_WriteInt(file, &NZ, 1);
+      if ((file = fopen(output_name, "a+")) == NULL)
+      {
+        printf("Unable to open outputfile <%s>\n", output_name);
+        FreeDatabox(slab);
+        tfree(order);
+        CloseParflowB(src);
+        return 1;
+      }
+#endif
 
-          tools_WriteDouble(file, &BackgroundDX(background), 1);
-          tools_WriteDouble(file, &BackgroundDY(background), 1);
-          tools_WriteDouble(file, &BackgroundDZ(background), 1);
+      /* write header info before the first subgrid */
+      if (g == 0)
+      {
+        tools_WriteDouble(file, &BackgroundX(background), 1);
+        tools_WriteDouble(file, &BackgroundY(background), 1);
+        tools_WriteDouble(file, &BackgroundZ(background), 1);
 
-          tools_WriteInt(file, &num_procs, 1);
+        tools_WriteInt(file, &NX, 1);
+        tools_WriteInt(file, &NY, 1);
+        tools_WriteInt(file, &NZ, 1);
 
-          file_pos += 6 * tools_SizeofDouble + 4 * tools_SizeofInt;
-        }
+        tools_WriteDouble(file, &BackgroundDX(background), 1);
+        tools_WriteDouble(file, &BackgroundDY(background), 1);
+        tools_WriteDouble(file, &BackgroundDZ(background), 1);
 
-        ix = SubgridIX(subgrid);
-        iy = SubgridIY(subgrid);
-        iz = SubgridIZ(subgrid);
+        tools_WriteInt(file, &num_procs, 1);
 
-        nx = SubgridNX(subgrid);
-        ny = SubgridNY(subgrid);
-        nz = SubgridNZ(subgrid);
+        file_pos += 6 * tools_SizeofDouble + 4 * tools_SizeofInt;
+      }
 
-        ptr = DataboxCoeff(databox, ix, iy, iz);
+      ix = SubgridIX(subgrid);
+      nx = SubgridNX(subgrid);
 
-        tools_WriteInt(file, &ix, 1);
-        tools_WriteInt(file, &iy, 1);
-        tools_WriteInt(file, &iz, 1);
+      tools_WriteInt(file, &ix, 1);
+      tools_WriteInt(file, &iy, 1);
+      tools_WriteInt(file, &iz, 1);
 
-        tools_WriteInt(file, &nx, 1);
-        tools_WriteInt(file, &ny, 1);
-        tools_WriteInt(file, &nz, 1);
+      tools_WriteInt(file, &nx, 1);
+      tools_WriteInt(file, &ny, 1);
+      tools_WriteInt(file, &nz, 1);
 
-        tools_WriteInt(file, &SubgridRX(subgrid), 1);
-        tools_WriteInt(file, &SubgridRY(subgrid), 1);
-        tools_WriteInt(file, &SubgridRZ(subgrid), 1);
+      tools_WriteInt(file, &SubgridRX(subgrid), 1);
+      tools_WriteInt(file, &SubgridRY(subgrid), 1);
+      tools_WriteInt(file, &SubgridRZ(subgrid), 1);
 
-        for (k = 0; k < nz; k++)
-          for (j = 0; j < ny; j++)
-            tools_WriteDouble(file, ptr + j * (NX) + k * (NX)*(NY), (nx));
+      for (k = 0; k < nz; k++)
+        for (j = 0; j < ny; j++)
+          tools_WriteDouble(file, DataboxCoeff(slab, ix - slab_ix, j, k), nx);
 
-        file_pos += 9 * tools_SizeofInt + (nx * ny * nz) * tools_SizeofDouble;
+      file_pos += 9 * tools_SizeofInt + ((long)nx * ny * nz) * tools_SizeofDouble;
 
 #ifdef AMPS_SPLIT_FILE
-        fclose(file);
+      fclose(file);
 #else
-        fprintf(dist_file, "%ld\n", file_pos);
+      fprintf(dist_file, "%ld\n", file_pos);
 #endif
-      }
     }
+
+    FreeDatabox(slab);
   }
 
 #ifndef AMPS_SPLIT_FILE
   fclose(file);
   fclose(dist_file);
 #endif
+
+  tfree(order);
+  CloseParflowB(src);
+
+  return 0;
 }
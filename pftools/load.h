@@ -37,7 +37,7 @@ extern "C" {
 #endif
 
 /* load.c */
-void LoadParflowB(char *filename, SubgridArray *all_subgrids, Background *background, Databox *databox);
+int DistParflowB(char *src_filename, char *filename, SubgridArray *all_subgrids, Background *background);
 
 #ifdef __cplusplus
 }
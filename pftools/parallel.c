@@ -0,0 +1,163 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+
+/*****************************************************************************
+* Threaded execution of Databox operations.
+*
+* ParallelFor splits the index range of a loop, usually the k or j slabs
+* of a Databox, into one contiguous block per thread.  The number of
+* threads is set from Tcl with pfsetthreads and is 1 by default.  Without
+* thread support all loops run in the calling thread.
+*
+*****************************************************************************/
+
+#include "parflow_config.h"
+
+#include "parallel.h"
+#include "general.h"
+
+#ifdef PARFLOW_HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
+static int tools_num_threads = 1;
+
+typedef struct {
+  ParallelForFunction function;
+  void               *arg;
+  int lo, hi;
+  int thread;
+} ParallelForTask;
+
+
+/*-----------------------------------------------------------------------
+ * SetToolsNumThreads, GetToolsNumThreads:
+ *
+ * Number of threads used by ParallelFor, always 1 without thread
+ * support.
+ *
+ *-----------------------------------------------------------------------*/
+
+void SetToolsNumThreads(
+                        int num_threads)
+{
+#ifdef PARFLOW_HAVE_PTHREADS
+  tools_num_threads = max(num_threads, 1);
+#endif
+}
+
+int GetToolsNumThreads(void)
+{
+  return tools_num_threads;
+}
+
+
+#ifdef PARFLOW_HAVE_PTHREADS
+static void    *ParallelForRun(
+                               void *task_ptr)
+{
+  ParallelForTask *task = (ParallelForTask*)task_ptr;
+
+  (task->function)(task->arg, task->lo, task->hi, task->thread);
+
+  return NULL;
+}
+#endif
+
+
+/*-----------------------------------------------------------------------
+ * ParallelFor:
+ *
+ * Run function over the indices [0, n) split into contiguous blocks, one
+ * per thread.  work is the number of cells the whole loop touches, loops
+ * with little work are run by the calling thread.  Blocks must write to
+ * disjoint parts of the results; a thread whose creation fails has its
+ * block run by the calling thread.
+ *
+ *-----------------------------------------------------------------------*/
+
+void ParallelFor(
+                 int                 n,
+                 double              work,
+                 ParallelForFunction function,
+                 void *              arg)
+{
+#ifdef PARFLOW_HAVE_PTHREADS
+  ParallelForTask *tasks;
+  pthread_t       *threads;
+  int             *started;
+  int num_threads;
+  int t;
+
+  num_threads = min(tools_num_threads, n);
+
+  if (num_threads <= 1 || work < PARALLEL_MIN_WORK)
+  {
+    function(arg, 0, n, 0);
+    return;
+  }
+
+  tasks = talloc(ParallelForTask, num_threads);
+  threads = talloc(pthread_t, num_threads);
+  started = ctalloc(int, num_threads);
+
+  for (t = 0; t < num_threads; t++)
+  {
+    tasks[t].function = function;
+    tasks[t].arg = arg;
+    tasks[t].lo = (int)(((long)n * t) / num_threads);
+    tasks[t].hi = (int)(((long)n * (t + 1)) / num_threads);
+    tasks[t].thread = t;
+  }
+
+  /* block 0 is run by the calling thread */
+  for (t = 1; t < num_threads; t++)
+  {
+    started[t] = (pthread_create(&threads[t], NULL, ParallelForRun,
+                                 &tasks[t]) == 0);
+  }
+
+  for (t = 0; t < num_threads; t++)
+  {
+    if (t == 0 || !started[t])
+      function(arg, tasks[t].lo, tasks[t].hi, t);
+  }
+
+  for (t = 1; t < num_threads; t++)
+  {
+    if (started[t])
+      pthread_join(threads[t], NULL);
+  }
+
+  tfree(started);
+  tfree(threads);
+  tfree(tasks);
+#else
+  function(arg, 0, n, 0);
+#endif
+}
@@ -0,0 +1,64 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+#ifndef PARALLEL_HEADER
+#define PARALLEL_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------------------
+ * Loop body run by ParallelFor over the indices [lo, hi) by thread
+ * number thread, 0 <= thread < GetToolsNumThreads()
+ *-----------------------------------------------------------------------*/
+
+typedef void (*ParallelForFunction)(void *arg, int lo, int hi, int thread);
+
+/* Loops with less work than this are run by the calling thread */
+#define PARALLEL_MIN_WORK 32768
+
+/*-----------------------------------------------------------------------
+ * function prototypes
+ *-----------------------------------------------------------------------*/
+
+void SetToolsNumThreads(
+                        int num_threads);
+
+int GetToolsNumThreads(void);
+
+void ParallelFor(
+                 int                 n,
+                 double              work,
+                 ParallelForFunction function,
+                 void *              arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
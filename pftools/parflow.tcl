@@ -71,13 +71,21 @@ namespace eval Parflow {
     namespace export pfgetsubbox
     namespace export pfenlargebox
     namespace export pfload
+    namespace export pfloadsubbox
+    namespace export pfloadtop
+    namespace export pfloadwatertabledepth
     namespace export pfreload
     namespace export pfreloadall
     namespace export pfdist
     namespace export pfsave
     namespace export pfvtksave
+    namespace export pfvtssave
     namespace export pfgetelt
     namespace export pfgridtype
+    namespace export pfsetthreads
+    namespace export pfcache
+    namespace export pfserve
+    namespace export pfsend
     namespace export pfgetgrid
     namespace export pfsetgrid
     namespace export pfcvel
@@ -117,6 +125,7 @@ namespace eval Parflow {
     namespace export pfsubsurfacestorage
     namespace export pfgwstorage
     namespace export pfsurfacerunoff
+    namespace export pfreduceseries
     namespace export pfwatertabledepth
     namespace export pfwritedb
 
@@ -125,6 +134,7 @@ namespace eval Parflow {
     namespace export pfupstreamarea
     namespace export pffillflats
     namespace export pfpitfilldem
+    namespace export pfpriorityfilldem
     namespace export pfmovingavgdem
     namespace export pftopodeficit
     namespace export pfsattrans
@@ -268,7 +278,16 @@ proc Parflow::pfrun { runname args } {
 	set R 1
     }
     
-    set NumProcs [expr $P * $Q * $R]
+    #
+    # In ensemble mode each member runs on its own P x Q x R processes
+    #
+    if [pfexists Ensemble.NumMembers] {
+	set NumMembers [pfget Ensemble.NumMembers]
+    } {
+	set NumMembers 1
+    }
+
+    set NumProcs [expr $P * $Q * $R * $NumMembers]
 
     # Run parflow
     if [pfexists Process.Command] {
@@ -28,11 +28,13 @@
 
 #include "simplify.h"
 #include "readdatabox.h"
+#include "parallel.h"
 
 #include "tclap/CmdLine.h"
 
 #include <vector>
-#include <set>
+#include <map>
+#include <unordered_map>
 #include <algorithm>
 #include <iostream>
 #include <fstream>
@@ -52,12 +54,6 @@ std::vector<std::string> g_maskNames = {"top", "bottom", "left", "right", "front
 #define FRONT  4
 #define BACK   5
 
-/*
- * Keeps a record of all patch labels that have been seen.
- */
-std::set<int> g_patchLabels;
-
-
 /* Function IsValidFileType - This function is used to make sure a given file */
 /* type is a valid one.                                                       */
 /*                                                                            */
@@ -121,8 +117,7 @@ char *filename)
 
 using namespace std;
 
-#define vertexIndex(i, j, k) (((nx+1) * (ny+1) * (k)) + ((j) * (nx+1)) + (i))
-#define triangleIndex(i, j, k) ((nx * ny * (k)) + ((j) * nx) + (i))
+#define vertexIndex(i, j, k) (((tnx+1) * (tny+1) * (k)) + ((j) * (tnx+1)) + (i))
 
 typedef std::numeric_limits< double > dbl;
 
@@ -131,124 +126,143 @@ bool equal(double a, double b)
     return fabs(a - b) < DBL_EPSILON;
 }
 
-void writePFSOL(string filename, vector<Simplify::Vertex>* vertices, vector<Simplify::Triangle>* triangles)
+Databox *loadFile(char* filename)
 {
-  ofstream pfsolFile(filename);
-  pfsolFile.precision(dbl::max_digits10);
-
-  // Version
-  pfsolFile << "1" << std::endl;
+  double default_value = 0.0;
+  Databox    *databox;
 
-  pfsolFile << vertices -> size() << std::endl;
+  char* filetype;
+  /* Make sure the file extension is valid */
 
-  for (auto it = vertices->begin(); it != vertices->end(); ++it)
+  if ((filetype = GetValidFileExtension(filename)) == (char*)NULL)
   {
-    double x = (*it).p.x;
-    double y = (*it).p.y;
-    double z = (*it).p.z;
-
-    pfsolFile << x << " " << y << " " << z << std::endl;
+    std::cerr << "Invalid file extension on filename : " << filename << std::endl;
+    exit(-1);
   }
+  
+  if (strcmp(filetype, "pfb") == 0)
+    databox = ReadParflowB(filename, default_value);
+  else if (strcmp(filetype, "pfsb") == 0)
+    databox = ReadParflowSB(filename, default_value);
+  else if (strcmp(filetype, "sa") == 0)
+    databox = ReadSimpleA(filename, default_value);
+  else if (strcmp(filetype, "sb") == 0)
+    databox = ReadSimpleB(filename, default_value);
+  else if (strcmp(filetype, "fld") == 0)
+    databox = ReadAVSField(filename, default_value);
+  else if (strcmp(filetype, "silo") == 0)
+    databox = ReadSilo(filename, default_value);
+  else
+    databox = ReadRealSA(filename, default_value);
 
-  // Number of solids
-  pfsolFile << "1" << std::endl;
+  return databox;
 
-  pfsolFile << triangles -> size() << std::endl;
+}
 
-  for (auto it = triangles -> begin(); it != triangles -> end(); ++it)
+/*
+ * A mask read one band of rows at a time.  PFB files are read directly
+ * and ASC files are first copied to a temporary binary file in ParFlow
+ * row order, so only the rows of a band are held in memory.  Other file
+ * types are loaded whole.
+ */
+class MaskFile
+{
+public:
+  int nx, ny, nz;
+  double sx, sy;
+  double dx, dy, dz;
+
+  MaskFile(char *filename);
+  ~MaskFile();
+
+  // Read rows jl to ju - 1 into values, nx values per row
+  void readRows(int jl, int ju, double *values);
+
+private:
+  ParflowBFile *pfb;
+  FILE         *asc;
+  Databox      *databox;
+
+  void openASC(char *filename);
+};
+
+MaskFile::MaskFile(char *filename) : pfb(NULL), asc(NULL), databox(NULL)
+{
+  char* filetype;
+
+  if ((filetype = GetValidFileExtension(filename)) == (char*)NULL)
   {
-    pfsolFile << (*it).v[0]  << " " << (*it).v[1] << " " << (*it).v[2] << std::endl;
+    std::cerr << "Invalid file extension on filename : " << filename << std::endl;
+    exit(-1);
   }
 
-  // Number of patches
-  
-  // This looping is not very efficient but would require some extra data structures to eliminate.
-  pfsolFile << g_patchLabels.size() << std::endl;
-  for(auto patch : g_patchLabels)
+  if (strcmp(filetype, "pfb") == 0)
   {
-    int numTriangles = 0;
-    for (auto it = triangles -> begin(); it != triangles -> end(); ++it)
+    if ((pfb = OpenParflowB(filename)) == NULL)
     {
-      if((*it).patch == patch)
-      {
-	numTriangles++;
-      }
+      std::cerr << "Could not read mask file : " << filename << std::endl;
+      exit(-1);
     }
-    
-    pfsolFile << numTriangles << std::endl;
-
-    std::cout << "Number of triangles in patch " << patch << " = " << numTriangles << std::endl;
 
-    int index = 0;
-    for (auto it = triangles -> begin(); it != triangles -> end(); ++it)
+    nx = pfb -> NX;
+    ny = pfb -> NY;
+    nz = pfb -> NZ;
+    sx = pfb -> X;
+    sy = pfb -> Y;
+    dx = pfb -> DX;
+    dy = pfb -> DY;
+    dz = pfb -> DZ;
+  }
+  else if (strcmp(filetype, "asc") == 0)
+  {
+    openASC(filename);
+  }
+  else
+  {
+    if ((databox = loadFile(filename)) == NULL)
     {
-      if((*it).patch == patch)
-      {
-	pfsolFile << index << std::endl;
-      }
-
-      ++index;
+      std::cerr << "Could not read mask file : " << filename << std::endl;
+      exit(-1);
     }
-    
-  }
 
-  pfsolFile.close();
+    nx = DataboxNx(databox);
+    ny = DataboxNy(databox);
+    nz = DataboxNz(databox);
+    sx = DataboxX(databox);
+    sy = DataboxY(databox);
+    dx = DataboxDx(databox);
+    dy = DataboxDy(databox);
+    dz = DataboxDz(databox);
+  }
 }
 
-void writeVTK(string filename, vector<Simplify::Vertex>* vertices, vector<Simplify::Triangle>* triangles)
+MaskFile::~MaskFile()
 {
-  ofstream vtkFile(filename);
-
-  vtkFile.precision(dbl::max_digits10);
-
-  vtkFile << "# vtk DataFile Version 2.0" << std::endl;
-  vtkFile << filename << std::endl;
-  vtkFile << "ASCII" << std::endl;
-
-  vtkFile << "DATASET POLYDATA" << std::endl;
-  vtkFile << "POINTS " << vertices -> size() << " float" << std::endl;
-
-  for (auto it = vertices->begin(); it != vertices->end(); ++it)
+  if (pfb)
   {
-    double x = (*it).p.x;
-    double y = (*it).p.y;
-    double z = (*it).p.z;
-
-    vtkFile << x << " " << y << " " << z << std::endl;
+    CloseParflowB(pfb);
   }
 
-  vtkFile << "POLYGONS " << triangles -> size() << " " << (3+1) * triangles -> size() << std::endl;
-  for (auto it = triangles -> begin(); it != triangles -> end(); ++it)
+  if (asc)
   {
-    vtkFile << "3 " <<   (*it).v[0]  << " " << (*it).v[1] << " " << (*it).v[2] << std::endl;
+    fclose(asc);
   }
 
-  // Write out patch labeling
-  vtkFile << "CELL_DATA " << triangles -> size() << std::endl;
-  vtkFile << "SCALARS patch_index int 1" << std::endl;
-  vtkFile << "LOOKUP_TABLE default" << std::endl;
-  for (auto it = triangles -> begin(); it != triangles -> end(); ++it)
+  if (databox)
   {
-    vtkFile << (*it).patch << std::endl;
+    FreeDatabox(databox);
   }
-
-  vtkFile.close();
 }
 
-Databox         *ReadASCMask(
-                             char * file_name,
-                             double default_value)
+void MaskFile::openASC(char *filename)
 {
-  Databox         *v;
-
-  int nx, ny, nz;
-  double sx = 0, sy = 0, sz = 0;
-  double dx = 1000.0, dy = 1000.0 , dz = 1000.0;
-
-  ifstream mask(file_name);
+  ifstream mask(filename);
 
   string text;
 
+  sx = sy = 0;
+  dx = 1000.0;
+
   // X/Y size
   mask >> text >> nx;
   mask >> text >> ny;
@@ -265,265 +279,149 @@ Databox         *ReadASCMask(
   // NoData value
   mask >> text >> text;
 
-  /* create the new databox structure */
-  if ((v = NewDataboxDefault(nx, ny, nz, sx, sy, 0, dx, dy, dz, default_value)) == NULL)
+  if (!mask || (asc = tmpfile()) == NULL)
   {
-    return((Databox*)NULL);
+    std::cerr << "Could not read mask file : " << filename << std::endl;
+    exit(-1);
   }
 
+  vector<double> row(nx);
+
   for(int j = 0; j < ny; ++j)
   {
     for(int i = 0; i < nx; ++i)
     {
-      double value;
-      int k = 0;
+      mask >> row[i];
+    }
 
-      mask >> value;
-      // ASC files are flipped around J axis from PF ordering
-      int flipped_j = (ny - 1) - j;
-      *(DataboxCoeff(v, i, flipped_j, k)) = value;
+    // ASC files are flipped around J axis from PF ordering
+    int flipped_j = (ny - 1) - j;
+    fseeko(asc, (off_t)flipped_j * nx * sizeof(double), SEEK_SET);
+    if (fwrite(row.data(), sizeof(double), nx, asc) != (size_t)nx)
+    {
+      std::cerr << "Could not write temporary file for mask : " << filename << std::endl;
+      exit(-1);
     }
   }
 
   mask.close();
-
-  return v;
 }
 
-Databox *loadFile(char* filename)
+void MaskFile::readRows(int jl, int ju, double *values)
 {
-  double default_value = 0.0;
-  Databox    *databox;
+  int n = nx * (ju - jl);
 
-  char* filetype;
-  /* Make sure the file extension is valid */
-
-  if ((filetype = GetValidFileExtension(filename)) == (char*)NULL)
+  if (pfb)
   {
-    std::cerr << "Invalid file extension on filename : " << filename << std::endl;
-    exit(-1);
+    Databox *rows = NewDataboxDefault(nx, ju - jl, 1, sx, sy + jl * dy, 0,
+                                      dx, dy, dz, 0.0);
+    ReadParflowBBox(pfb, rows, 0, jl, 0);
+    memcpy(values, DataboxCoeffs(rows), n * sizeof(double));
+    FreeDatabox(rows);
+  }
+  else if (asc)
+  {
+    fseeko(asc, (off_t)jl * nx * sizeof(double), SEEK_SET);
+    if (fread(values, sizeof(double), n, asc) != (size_t)n)
+    {
+      std::cerr << "Could not read temporary mask file" << std::endl;
+      exit(-1);
+    }
   }
-  
-  if (strcmp(filetype, "pfb") == 0)
-    databox = ReadParflowB(filename, default_value);
-  else if (strcmp(filetype, "pfsb") == 0)
-    databox = ReadParflowSB(filename, default_value);
-  else if (strcmp(filetype, "sa") == 0)
-    databox = ReadSimpleA(filename, default_value);
-  else if (strcmp(filetype, "sb") == 0)
-    databox = ReadSimpleB(filename, default_value);
-  else if (strcmp(filetype, "fld") == 0)
-    databox = ReadAVSField(filename, default_value);
-  else if (strcmp(filetype, "silo") == 0)
-    databox = ReadSilo(filename, default_value);
-  else if (strcmp(filetype, "asc") == 0)
-    databox = ReadASCMask(filename, default_value);
   else
-    databox = ReadRealSA(filename, default_value);
-
-  return databox;
-
+  {
+    memcpy(values, DataboxCoeff(databox, 0, jl, 0), n * sizeof(double));
+  }
 }
 
-int main(int argc, char **argv)
+/*
+ * The surface of the cells i0 to i1 - 1 in the rows of a band, simplified
+ * independently of the other tiles.
+ */
+struct Tile
 {
-  bool singleMaskFile;
-  std::vector<string> inFilenames(g_maskNames.size());
-  string vtkOutFilename;
-  string pfsolOutFilename;
-  int bottom;
-  int side;
-  float zTop,zBot;
-
-  try {  
-
-    // Define the command line object.
-    TCLAP::CmdLine cmd("Convert mask files to pfsol file", ' ', "1.0");
-
-    TCLAP::ValueArg<string> inFilenameArg("","mask","Mask filename",false,"mask.pfb","string");
-    cmd.add( inFilenameArg );
-
-    TCLAP::ValueArg<string> vtkOutFilenameArg("","vtk","VTK ouput filename",false,"output.vtk","string");
-    cmd.add( vtkOutFilenameArg );
-
-    TCLAP::ValueArg<string> pfsolOutFilenameArg("","pfsol","PFSOL ouput filename",true,"output.pfsol","string");
-    cmd.add( pfsolOutFilenameArg );
-
-    TCLAP::ValueArg<int> bottomArg("","bottom-patch-label","Bottom index",false,2,"int");
-    cmd.add( bottomArg );
-
-    TCLAP::ValueArg<int> sideArg("","side-patch-label","Side index",false,3,"int");
-    cmd.add( sideArg );
+  int i0, i1;
 
-    TCLAP::ValueArg<float> zTopArg("","z-top","Set top of domain",false,NAN,"float");
-    cmd.add( zTopArg );
-
-    TCLAP::ValueArg<float> zBotArg("","z-bottom","Set bottom of domain",false,NAN,"float");
-    cmd.add( zBotArg );
+  vector<double> points;     // x, y, z of each vertex
+  vector<int> triangles;     // vertex indices of each triangle
+  vector<int> patches;       // patch label of each triangle
+};
 
-    TCLAP::ValueArg<string>* maskFilenamesArgs[g_maskNames.size()];
+/*
+ * The rows j0 to j1 - 1 of the masks and the tiles built from them.  The
+ * labels of the rows just below and above the band are kept as well
+ * since they decide which cells have front and back faces.
+ */
+struct Band
+{
+  int nx, ny;
+  int j0, j1;
 
-    int index = 0;
-    for(auto maskName : g_maskNames)
-    {
-      string argName =  "mask-" + maskName;
-      string help =  "Filename for " + maskName + " mask";
-      maskFilenamesArgs[index] = new TCLAP::ValueArg<string>("", argName, help, false, "", "string");
-      cmd.add( maskFilenamesArgs[index++] );
-    }
+  double sx, sy, sz;
+  double dx, dy, dz;
 
-    // Parse the args.
-    cmd.parse( argc, argv );
+  bool singleMaskFile;
+  int bottom, side;
 
-    singleMaskFile = inFilenameArg.isSet();
+  vector< vector<int> > labels;   // rows j0 - 1 to j1 of each mask
+  vector<Tile> tiles;
 
-    // Get the value parsed by each arg. 
-    if (singleMaskFile)
-    {
-      inFilenames[0] = inFilenameArg.getValue();;
-    }
-    else
+  int label(int mask, int i, int j)
+  {
+    if (singleMaskFile && mask != TOP)
     {
-      for(int i = 0; i < g_maskNames.size (); ++i)
-      {
-	inFilenames[i] = maskFilenamesArgs[i] -> getValue();
-      }
+      return (mask == BOTTOM) ? bottom : side;
     }
 
-    vtkOutFilename = vtkOutFilenameArg.getValue();
-    pfsolOutFilename = pfsolOutFilenameArg.getValue();
-    bottom = bottomArg.getValue();
-    side = sideArg.getValue();;
-    zTop = zTopArg.getValue();;
-    zBot = zBotArg.getValue();;
-
-  }
-  catch (TCLAP::ArgException &e)  // catch any exceptions
-  { 
-    cerr << "error: " << e.error() << " for arg " << e.argId() << endl; 
+    return labels[mask][(j - j0 + 1) * nx + i];
   }
+};
 
-  int nx, ny, nz;
-  double sx = 0, sy = 0, sz = 0;
-  double dx, dy, dz;
+/*
+ * Build the faces of the inside cells of a tile and simplify them.  The
+ * vertices on the seams with other tiles are locked so that both tiles
+ * keep them and the surfaces can be welded.
+ */
+void buildTile(Band *band, Tile *tile)
+{
+  int tnx = tile -> i1 - tile -> i0;
+  int tny = band -> j1 - band -> j0;
 
-  std::vector<Databox*> databox(inFilenames[0].size());
+  vector<Simplify::Vertex>* vertices = new vector<Simplify::Vertex>((tnx+1)*(tny+1)*2);
 
-  // patch_names = GetStringDefault(key,
-  // "left right front back bottom top");
-  if (singleMaskFile)
-  {
-    char* c_filename = strdup(inFilenames[0].c_str());
-    databox[0] = loadFile(c_filename);
-  } 
-  else
+  vector<Simplify::Triangle>* triangles = new vector<Simplify::Triangle>();
+
+  // Build list of all possible vertices
+  for(int k = 0; k < 2; ++k)
   {
-    for(int i = 0; i < inFilenames.size (); ++i)
+    for(int j = 0; j < tny+1; ++j)
     {
-      char* c_filename = strdup(inFilenames[i].c_str());
-      databox[i] = loadFile(c_filename);
+      for(int i = 0; i < tnx+1; ++i)
+      {
+	Simplify::Vertex *vertex = &((*vertices)[ vertexIndex(i,j,k) ]);
+	vertex -> p.x = band -> sx + (tile -> i0 + i) * band -> dx;
+	vertex -> p.y = band -> sy + (band -> j0 + j) * band -> dy;
+	vertex -> p.z = band -> sz + k * band -> dz;
+	vertex -> used = false;
+	vertex -> locked = (i == 0 && tile -> i0 > 0)
+	  || (i == tnx && tile -> i1 < band -> nx)
+	  || (j == 0 && band -> j0 > 0)
+	  || (j == tny && band -> j1 < band -> ny);
+      }
     }
   }
 
-  nx = DataboxNx(databox[0]);
-  ny = DataboxNy(databox[0]);
-  nz = DataboxNz(databox[0]);
-
-  sx = DataboxX(databox[0]);
-  sy = DataboxY(databox[0]);
-
-  dx = DataboxDx(databox[0]);
-  dy = DataboxDy(databox[0]);
-
-  // If user specifies Top/Bottom on command line override defaults
-  if(isnan(zTop))
-  {
-    sz = 0.0;
-  }
-  else
-  {
-    sz = zTop;
-  }
-
-  if(isnan(zBot))
-  {
-    dz = DataboxDz(databox[0]);
-  }
-  else
-  {
-    dz = zBot - sz;
-  }
-
-  cout << "Domain Size = (" << nx << "," << ny << "," << nz << ")" << std::endl;
-  cout << "Starting corner = (" << sx << "," << sy << "," << sz << ")" << std::endl;
-  cout << "Cell Size = (" << dx << "," << dy << "," << dz << ")" << std::endl;
-  cout << "Bottom patch = " << bottom << std::endl;
-  cout << "Side patch = " << side << std::endl;
-
-  assert(nz == 1);
-
-  vector< vector<int> > indicators;
-
-  indicators.resize(inFilenames.size ());
-  for(int i = 0; i < inFilenames.size (); ++i)
+  // Build triangles for faces on every cell
+  for(int j = 0; j < tny; ++j)
   {
-    indicators[i].resize(nx*ny);
-  }
+    for(int i = 0; i < tnx; ++i)
+    {
+      // Cell index in the whole mask
+      int mi = tile -> i0 + i;
+      int mj = band -> j0 + j;
 
-  for(int j = 0; j < ny; ++j)
-  {
-    for(int i = 0; i < nx; ++i)
-    {
-      int k = 0;
-      if (singleMaskFile)
-      {
-	indicators[TOP][ triangleIndex(i,j,0) ] = *(DataboxCoeff(databox[TOP], i, j, k));
-	indicators[BOTTOM][ triangleIndex(i,j,0) ] = bottom;
-	indicators[LEFT][ triangleIndex(i,j,0) ] = side;
-	indicators[RIGHT][ triangleIndex(i,j,0) ] = side;
-	indicators[FRONT][ triangleIndex(i,j,0) ] = side;
-	indicators[BACK][ triangleIndex(i,j,0) ] = side;
-	
-      }
-      else 
-      {
-	for(int index = 0; index < indicators.size (); ++index)
-	{
-	  indicators[index][ triangleIndex(i,j,0) ] = *(DataboxCoeff(databox[index], i, j, k));
-	}
-      }
-    }
-  }
-
-  cout << endl;
-
-  vector<Simplify::Vertex>* vertices = new vector<Simplify::Vertex>((nx+1)*(ny+1)*(nz+1));
-
-  vector<Simplify::Triangle>* triangles = new vector<Simplify::Triangle>();
-
-  // Build list of all possible vertices
-  for(int k = 0; k < nz+1; ++k)
-  {
-    for(int j = 0; j < ny+1; ++j)
-    {
-      for(int i = 0; i < nx+1; ++i)
-      {
-	Simplify::Vertex *vertex = &((*vertices)[ vertexIndex(i,j,k) ]);
-	vertex -> p.x = sx + i * dx;
-	vertex -> p.y = sy + j * dy;
-	vertex -> p.z = sz + k * dz;
-	vertex -> used = false;
-      }
-    }
-  }
-
-  // Build triangles for faces on every cell
-  for(int j = 0; j < ny; ++j)
-  {
-    for(int i = 0; i < nx; ++i)
-    {
       // Use Top to determine domain;
-      int indicator = indicators[0][ triangleIndex(i,j,0) ];
+      int indicator = band -> label(TOP, mi, mj);
       
       if (indicator != 0) 
       {
@@ -531,7 +429,6 @@ int main(int argc, char **argv)
 	{
 	  Simplify::Triangle triangle;
 	  triangle.patch = indicator;
-	  g_patchLabels.insert(triangle.patch);
 	  
 	  triangle.v[0] = vertexIndex(i,j,1);
 	  triangle.v[1]=  vertexIndex(i+1,j,1);
@@ -554,8 +451,7 @@ int main(int argc, char **argv)
 	// Bottom
 	{
 	  Simplify::Triangle triangle;
-	  triangle.patch = indicators[BOTTOM][ triangleIndex(i,j,0) ];
-	  g_patchLabels.insert(triangle.patch);
+	  triangle.patch = band -> label(BOTTOM, mi, mj);
 	
 	  triangle.v[0] = vertexIndex(i,j,0);
 	  triangle.v[1]=  vertexIndex(i+1,j+1,0);
@@ -576,11 +472,10 @@ int main(int argc, char **argv)
 	}
       
 	// Left
-	if ( (i == 0) || (indicators[0][ triangleIndex(i-1,j,0) ] == 0) )
+	if ( (mi == 0) || (band -> label(TOP, mi-1, mj) == 0) )
 	{
 	  Simplify::Triangle triangle;
-	  triangle.patch = indicators[LEFT][ triangleIndex(i,j,0) ];
-	  g_patchLabels.insert(triangle.patch);
+	  triangle.patch = band -> label(LEFT, mi, mj);
 	
 	  triangle.v[0] = vertexIndex(i,j,0);
 	  triangle.v[1]=  vertexIndex(i,j,1);
@@ -601,11 +496,10 @@ int main(int argc, char **argv)
 	}
       
 	// Right
-	if ( (i == (nx - 1)) || (indicators[0][ triangleIndex(i+1,j,0) ] == 0) )
+	if ( (mi == (band -> nx - 1)) || (band -> label(TOP, mi+1, mj) == 0) )
 	{
 	  Simplify::Triangle triangle;
-	  triangle.patch = indicators[RIGHT][ triangleIndex(i,j,0) ];
-	  g_patchLabels.insert(triangle.patch);
+	  triangle.patch = band -> label(RIGHT, mi, mj);
 	
 	  triangle.v[0]=  vertexIndex(i+1,j+1,0);
 	  triangle.v[1]=  vertexIndex(i+1,j,1);
@@ -626,11 +520,10 @@ int main(int argc, char **argv)
 	}
       
 	// Front
-	if ( (j==0) || (indicators[0][ triangleIndex(i,j-1,0) ] == 0) )
+	if ( (mj == 0) || (band -> label(TOP, mi, mj-1) == 0) )
 	{
 	  Simplify::Triangle triangle;
-	  triangle.patch = indicators[FRONT][ triangleIndex(i,j,0) ];
-	  g_patchLabels.insert(triangle.patch);
+	  triangle.patch = band -> label(FRONT, mi, mj);
 	
 	  triangle.v[0] = vertexIndex(i,j,0);
 	  triangle.v[1]=  vertexIndex(i+1,j,0);
@@ -646,16 +539,15 @@ int main(int argc, char **argv)
 	
 	  (*vertices)[ vertexIndex(i,j,0)].used = true;
 	  (*vertices)[ vertexIndex(i,j,1)].used = true;
-	  (*vertices)[ vertexIndex(i+1,j,1)].used = true;
+	  (*vertices)[ vertexIndex(i+1,j,0)].used = true;
 	  (*vertices)[ vertexIndex(i+1,j,1)].used = true;
 	}
       
 	// Back
-	if ( (j == (ny - 1)) || (indicators[0][ triangleIndex(i,j+1,0) ] == 0) )
+	if ( (mj == (band -> ny - 1)) || (band -> label(TOP, mi, mj+1) == 0) )
 	{
 	  Simplify::Triangle triangle;
-	  triangle.patch = indicators[BACK][ triangleIndex(i,j,0) ];
-	  g_patchLabels.insert(triangle.patch);
+	  triangle.patch = band -> label(BACK, mi, mj);
 	
 	  triangle.v[2] = vertexIndex(i,j+1,0);
 	  triangle.v[1]=  vertexIndex(i+1,j+1,0);
@@ -699,12 +591,536 @@ int main(int argc, char **argv)
     (*it).v[2] = (*vertices)[(*it).v[2]].new_index;
   }
 
-  vertices = 0;
+  delete vertices;
 
+  // The simplified mesh is kept by Simplify for each thread
   Simplify::swap(*new_vertices, *triangles);
 
+  delete new_vertices;
+  delete triangles;
+
   Simplify::simplify_mesh_lossless();
 
-  writeVTK(vtkOutFilename, &Simplify::vertices, &Simplify::triangles);
-  writePFSOL(pfsolOutFilename, &Simplify::vertices, &Simplify::triangles);
+  for (auto it = Simplify::vertices.begin(); it != Simplify::vertices.end(); ++it)
+  {
+    tile -> points.push_back((*it).p.x);
+    tile -> points.push_back((*it).p.y);
+    tile -> points.push_back((*it).p.z);
+  }
+
+  for (auto it = Simplify::triangles.begin(); it != Simplify::triangles.end(); ++it)
+  {
+    tile -> triangles.push_back((*it).v[0]);
+    tile -> triangles.push_back((*it).v[1]);
+    tile -> triangles.push_back((*it).v[2]);
+    tile -> patches.push_back((*it).patch);
+  }
+
+  vector<Simplify::Vertex>().swap(Simplify::vertices);
+  vector<Simplify::Triangle>().swap(Simplify::triangles);
+  vector<Simplify::Ref>().swap(Simplify::refs);
+}
+
+void buildTiles(void *arg, int lo, int hi, int thread)
+{
+  Band *band = (Band*)arg;
+
+  for (int t = lo; t < hi; ++t)
+  {
+    buildTile(band, &(band -> tiles[t]));
+  }
+}
+
+/*
+ * The surface of the solid, added one tile at a time.  The vertices,
+ * triangles and triangle patch labels are kept in temporary binary files
+ * and copied to the PFSOL and VTK files at the end, so memory use does
+ * not grow with the size of the mask.  Vertices on the seams between
+ * tiles are welded by their grid index; only the seam vertices that a
+ * later tile may share are remembered.
+ */
+class Surface
+{
+public:
+  Surface(int nx, int ny, double sx, double sy, double sz,
+          double dx, double dy);
+  ~Surface();
+
+  void addTile(Band *band, Tile *tile);
+  void endBand(Band *band);
+
+  void writePFSOL(string filename);
+  void writeVTK(string filename);
+
+private:
+  int nx, ny;
+  double sx, sy, sz;
+  double dx, dy;
+
+  FILE *vertices;
+  FILE *triangles;
+  FILE *patches;
+
+  int numVertices;
+  int numTriangles;
+
+  // Number of triangles with each patch label
+  map<int, int> patchTriangles;
+
+  unordered_map<long long, int> seamVertices;
+};
+
+Surface::Surface(int nx, int ny, double sx, double sy, double sz,
+                 double dx, double dy) :
+  nx(nx), ny(ny), sx(sx), sy(sy), sz(sz), dx(dx), dy(dy),
+  numVertices(0), numTriangles(0)
+{
+  vertices = tmpfile();
+  triangles = tmpfile();
+  patches = tmpfile();
+
+  if (!vertices || !triangles || !patches)
+  {
+    std::cerr << "Could not open temporary files" << std::endl;
+    exit(-1);
+  }
+}
+
+Surface::~Surface()
+{
+  fclose(vertices);
+  fclose(triangles);
+  fclose(patches);
+}
+
+void Surface::addTile(Band *band, Tile *tile)
+{
+  int numTileVertices = tile -> points.size() / 3;
+  vector<int> index(numTileVertices);
+
+  // Seam vertices were locked so they are still exactly on the seams
+  double x0 = sx + tile -> i0 * dx;
+  double x1 = sx + tile -> i1 * dx;
+  double y0 = sy + band -> j0 * dy;
+  double y1 = sy + band -> j1 * dy;
+
+  for (int v = 0; v < numTileVertices; ++v)
+  {
+    double *p = &(tile -> points[3 * v]);
+
+    if ((p[0] == x0 && tile -> i0 > 0) || (p[0] == x1 && tile -> i1 < nx)
+	|| (p[1] == y0 && band -> j0 > 0) || (p[1] == y1 && band -> j1 < ny))
+    {
+      long long i = llround((p[0] - sx) / dx);
+      long long j = llround((p[1] - sy) / dy);
+      long long k = (p[2] == sz) ? 0 : 1;
+      long long key = (k * (ny + 1) + j) * (nx + 1) + i;
+
+      auto it = seamVertices.find(key);
+      if (it != seamVertices.end())
+      {
+	index[v] = it -> second;
+	continue;
+      }
+
+      seamVertices[key] = numVertices;
+    }
+
+    index[v] = numVertices++;
+    fwrite(p, sizeof(double), 3, vertices);
+  }
+
+  int numTileTriangles = tile -> patches.size();
+
+  for (int t = 0; t < numTileTriangles; ++t)
+  {
+    int v[3];
+
+    v[0] = index[tile -> triangles[3 * t]];
+    v[1] = index[tile -> triangles[3 * t + 1]];
+    v[2] = index[tile -> triangles[3 * t + 2]];
+
+    fwrite(v, sizeof(int), 3, triangles);
+    fwrite(&(tile -> patches[t]), sizeof(int), 1, patches);
+
+    patchTriangles[tile -> patches[t]]++;
+  }
+
+  numTriangles += numTileTriangles;
+
+  if (ferror(vertices) || ferror(triangles) || ferror(patches))
+  {
+    std::cerr << "Could not write temporary files" << std::endl;
+    exit(-1);
+  }
+}
+
+void Surface::endBand(Band *band)
+{
+  // Only the vertices on the top seam of the band are shared with the
+  // tiles of the next band
+  for (auto it = seamVertices.begin(); it != seamVertices.end();)
+  {
+    if ((it -> first / (nx + 1)) % (ny + 1) != band -> j1)
+    {
+      it = seamVertices.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+#define SURFACE_CHUNK 4096
+
+void Surface::writePFSOL(string filename)
+{
+  ofstream pfsolFile(filename);
+  pfsolFile.precision(dbl::max_digits10);
+
+  vector<double> points(3 * SURFACE_CHUNK);
+  vector<int> values(3 * SURFACE_CHUNK);
+  size_t n;
+
+  // Version
+  pfsolFile << "1" << std::endl;
+
+  pfsolFile << numVertices << std::endl;
+
+  rewind(vertices);
+  while ((n = fread(points.data(), 3 * sizeof(double), SURFACE_CHUNK, vertices)) > 0)
+  {
+    for (size_t m = 0; m < 3 * n; m += 3)
+    {
+      pfsolFile << points[m] << " " << points[m + 1] << " " << points[m + 2] << "\n";
+    }
+  }
+
+  // Number of solids
+  pfsolFile << "1" << std::endl;
+
+  pfsolFile << numTriangles << std::endl;
+
+  rewind(triangles);
+  while ((n = fread(values.data(), 3 * sizeof(int), SURFACE_CHUNK, triangles)) > 0)
+  {
+    for (size_t m = 0; m < 3 * n; m += 3)
+    {
+      pfsolFile << values[m] << " " << values[m + 1] << " " << values[m + 2] << "\n";
+    }
+  }
+
+  // Number of patches
+
+  // The patch labels are read once for each patch.
+  pfsolFile << patchTriangles.size() << std::endl;
+  for(auto patch : patchTriangles)
+  {
+    pfsolFile << patch.second << std::endl;
+
+    std::cout << "Number of triangles in patch " << patch.first << " = " << patch.second << std::endl;
+
+    int index = 0;
+    rewind(patches);
+    while ((n = fread(values.data(), sizeof(int), SURFACE_CHUNK, patches)) > 0)
+    {
+      for (size_t m = 0; m < n; ++m, ++index)
+      {
+	if (values[m] == patch.first)
+	{
+	  pfsolFile << index << "\n";
+	}
+      }
+    }
+  }
+
+  pfsolFile.close();
+}
+
+void Surface::writeVTK(string filename)
+{
+  ofstream vtkFile(filename);
+
+  vtkFile.precision(dbl::max_digits10);
+
+  vector<double> points(3 * SURFACE_CHUNK);
+  vector<int> values(3 * SURFACE_CHUNK);
+  size_t n;
+
+  vtkFile << "# vtk DataFile Version 2.0" << std::endl;
+  vtkFile << filename << std::endl;
+  vtkFile << "ASCII" << std::endl;
+
+  vtkFile << "DATASET POLYDATA" << std::endl;
+  vtkFile << "POINTS " << numVertices << " float" << std::endl;
+
+  rewind(vertices);
+  while ((n = fread(points.data(), 3 * sizeof(double), SURFACE_CHUNK, vertices)) > 0)
+  {
+    for (size_t m = 0; m < 3 * n; m += 3)
+    {
+      vtkFile << points[m] << " " << points[m + 1] << " " << points[m + 2] << "\n";
+    }
+  }
+
+  vtkFile << "POLYGONS " << numTriangles << " " << (3+1) * numTriangles << std::endl;
+
+  rewind(triangles);
+  while ((n = fread(values.data(), 3 * sizeof(int), SURFACE_CHUNK, triangles)) > 0)
+  {
+    for (size_t m = 0; m < 3 * n; m += 3)
+    {
+      vtkFile << "3 " << values[m] << " " << values[m + 1] << " " << values[m + 2] << "\n";
+    }
+  }
+
+  // Write out patch labeling
+  vtkFile << "CELL_DATA " << numTriangles << std::endl;
+  vtkFile << "SCALARS patch_index int 1" << std::endl;
+  vtkFile << "LOOKUP_TABLE default" << std::endl;
+
+  rewind(patches);
+  while ((n = fread(values.data(), sizeof(int), SURFACE_CHUNK, patches)) > 0)
+  {
+    for (size_t m = 0; m < n; ++m)
+    {
+      vtkFile << values[m] << "\n";
+    }
+  }
+
+  vtkFile.close();
+}
+
+int main(int argc, char **argv)
+{
+  bool singleMaskFile;
+  std::vector<string> inFilenames(g_maskNames.size());
+  string vtkOutFilename;
+  string pfsolOutFilename;
+  int bottom;
+  int side;
+  float zTop,zBot;
+  int tileSize;
+  int numThreads;
+
+  try {  
+
+    // Define the command line object.
+    TCLAP::CmdLine cmd("Convert mask files to pfsol file", ' ', "1.0");
+
+    TCLAP::ValueArg<string> inFilenameArg("","mask","Mask filename",false,"mask.pfb","string");
+    cmd.add( inFilenameArg );
+
+    TCLAP::ValueArg<string> vtkOutFilenameArg("","vtk","VTK ouput filename",false,"output.vtk","string");
+    cmd.add( vtkOutFilenameArg );
+
+    TCLAP::ValueArg<string> pfsolOutFilenameArg("","pfsol","PFSOL ouput filename",true,"output.pfsol","string");
+    cmd.add( pfsolOutFilenameArg );
+
+    TCLAP::ValueArg<int> bottomArg("","bottom-patch-label","Bottom index",false,2,"int");
+    cmd.add( bottomArg );
+
+    TCLAP::ValueArg<int> sideArg("","side-patch-label","Side index",false,3,"int");
+    cmd.add( sideArg );
+
+    TCLAP::ValueArg<float> zTopArg("","z-top","Set top of domain",false,NAN,"float");
+    cmd.add( zTopArg );
+
+    TCLAP::ValueArg<float> zBotArg("","z-bottom","Set bottom of domain",false,NAN,"float");
+    cmd.add( zBotArg );
+
+    TCLAP::ValueArg<int> tileSizeArg("","tile-size","Number of cells along each side of the tiles the mask is processed in",false,0,"int");
+    cmd.add( tileSizeArg );
+
+    TCLAP::ValueArg<int> threadsArg("","threads","Number of threads building tiles",false,1,"int");
+    cmd.add( threadsArg );
+
+    TCLAP::ValueArg<string>* maskFilenamesArgs[g_maskNames.size()];
+
+    int index = 0;
+    for(auto maskName : g_maskNames)
+    {
+      string argName =  "mask-" + maskName;
+      string help =  "Filename for " + maskName + " mask";
+      maskFilenamesArgs[index] = new TCLAP::ValueArg<string>("", argName, help, false, "", "string");
+      cmd.add( maskFilenamesArgs[index++] );
+    }
+
+    // Parse the args.
+    cmd.parse( argc, argv );
+
+    singleMaskFile = inFilenameArg.isSet();
+
+    // Get the value parsed by each arg. 
+    if (singleMaskFile)
+    {
+      inFilenames[0] = inFilenameArg.getValue();;
+    }
+    else
+    {
+      for(size_t i = 0; i < g_maskNames.size (); ++i)
+      {
+	inFilenames[i] = maskFilenamesArgs[i] -> getValue();
+      }
+    }
+
+    vtkOutFilename = vtkOutFilenameArg.getValue();
+    pfsolOutFilename = pfsolOutFilenameArg.getValue();
+    bottom = bottomArg.getValue();
+    side = sideArg.getValue();;
+    zTop = zTopArg.getValue();;
+    zBot = zBotArg.getValue();;
+    tileSize = tileSizeArg.getValue();
+    numThreads = threadsArg.getValue();
+
+  }
+  catch (TCLAP::ArgException &e)  // catch any exceptions
+  { 
+    cerr << "error: " << e.error() << " for arg " << e.argId() << endl; 
+  }
+
+  int nx, ny, nz;
+  double sx = 0, sy = 0, sz = 0;
+  double dx, dy, dz;
+
+  std::vector<MaskFile*> masks(singleMaskFile ? 1 : inFilenames.size());
+
+  for(size_t i = 0; i < masks.size (); ++i)
+  {
+    char* c_filename = strdup(inFilenames[i].c_str());
+    masks[i] = new MaskFile(c_filename);
+    free(c_filename);
+  }
+
+  nx = masks[0] -> nx;
+  ny = masks[0] -> ny;
+  nz = masks[0] -> nz;
+
+  sx = masks[0] -> sx;
+  sy = masks[0] -> sy;
+
+  dx = masks[0] -> dx;
+  dy = masks[0] -> dy;
+
+  for(size_t i = 1; i < masks.size (); ++i)
+  {
+    if ((masks[i] -> nx != nx) || (masks[i] -> ny != ny))
+    {
+      std::cerr << "Mask " << inFilenames[i] << " does not have the same dimensions as " << inFilenames[0] << std::endl;
+      exit(-1);
+    }
+  }
+
+  // If user specifies Top/Bottom on command line override defaults
+  if(isnan(zTop))
+  {
+    sz = 0.0;
+  }
+  else
+  {
+    sz = zTop;
+  }
+
+  if(isnan(zBot))
+  {
+    dz = masks[0] -> dz;
+  }
+  else
+  {
+    dz = zBot - sz;
+  }
+
+  // Without a tile size the mask is a single tile
+  if (tileSize <= 0)
+  {
+    tileSize = max(nx, ny);
+  }
+
+  SetToolsNumThreads(numThreads);
+
+  cout << "Domain Size = (" << nx << "," << ny << "," << nz << ")" << std::endl;
+  cout << "Starting corner = (" << sx << "," << sy << "," << sz << ")" << std::endl;
+  cout << "Cell Size = (" << dx << "," << dy << "," << dz << ")" << std::endl;
+  cout << "Bottom patch = " << bottom << std::endl;
+  cout << "Side patch = " << side << std::endl;
+
+  assert(nz == 1);
+
+  cout << endl;
+
+  Surface surface(nx, ny, sx, sy, sz, dx, dy);
+
+  Band band;
+
+  band.nx = nx;
+  band.ny = ny;
+  band.sx = sx;
+  band.sy = sy;
+  band.sz = sz;
+  band.dx = dx;
+  band.dy = dy;
+  band.dz = dz;
+  band.singleMaskFile = singleMaskFile;
+  band.bottom = bottom;
+  band.side = side;
+  band.labels.resize(masks.size());
+
+  vector<double> values;
+
+  // The tiles of each band are built in parallel, then added to the
+  // surface in order
+  for(int j0 = 0; j0 < ny; j0 += tileSize)
+  {
+    band.j0 = j0;
+    band.j1 = min(j0 + tileSize, ny);
+
+    int jl = max(band.j0 - 1, 0);
+    int ju = min(band.j1 + 1, ny);
+
+    values.resize(nx * (ju - jl));
+
+    for(size_t index = 0; index < masks.size (); ++index)
+    {
+      vector<int> &labels = band.labels[index];
+
+      labels.assign(nx * (band.j1 - band.j0 + 2), 0);
+
+      masks[index] -> readRows(jl, ju, values.data());
+      for(size_t n = 0; n < values.size (); ++n)
+      {
+	labels[(jl - band.j0 + 1) * nx + n] = values[n];
+      }
+    }
+
+    band.tiles.clear();
+    for(int i0 = 0; i0 < nx; i0 += tileSize)
+    {
+      Tile tile;
+      tile.i0 = i0;
+      tile.i1 = min(i0 + tileSize, nx);
+      band.tiles.push_back(tile);
+    }
+
+    // Meshing and simplifying a tile repeatedly passes over all of its
+    // triangles, so each tile is counted as enough work for a thread of
+    // its own
+    ParallelFor(band.tiles.size(), (double)PARALLEL_MIN_WORK * band.tiles.size(),
+		buildTiles, &band);
+
+    for(auto it = band.tiles.begin(); it != band.tiles.end(); ++it)
+    {
+      surface.addTile(&band, &(*it));
+    }
+
+    surface.endBand(&band);
+  }
+
+  for(size_t i = 0; i < masks.size (); ++i)
+  {
+    delete masks[i];
+  }
+
+  surface.writeVTK(vtkOutFilename);
+  surface.writePFSOL(pfsolOutFilename);
 }
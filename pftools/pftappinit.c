@@ -140,6 +140,12 @@ EXPORT(int, Parflow_Init)(Tcl_Interp * interp)
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfload", (Tcl_CmdProc*)LoadPFCommand,
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
+  Tcl_CreateCommand(interp, "Parflow::pfloadsubbox", (Tcl_CmdProc*)LoadSubBoxCommand,
+                    (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
+  Tcl_CreateCommand(interp, "Parflow::pfloadtop", (Tcl_CmdProc*)LoadTopCommand,
+                    (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
+  Tcl_CreateCommand(interp, "Parflow::pfloadwatertabledepth", (Tcl_CmdProc*)LoadWaterTableDepthCommand,
+                    (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfreload", (Tcl_CmdProc*)ReLoadPFCommand,
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfdist", (Tcl_CmdProc*)PFDistCommand,
@@ -150,6 +156,14 @@ EXPORT(int, Parflow_Init)(Tcl_Interp * interp)
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfgridtype", (Tcl_CmdProc*)GridTypeCommand,
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
+  Tcl_CreateCommand(interp, "Parflow::pfsetthreads", (Tcl_CmdProc*)SetThreadsCommand,
+                    (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
+  Tcl_CreateCommand(interp, "Parflow::pfcache", (Tcl_CmdProc*)CacheCommand,
+                    (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
+  Tcl_CreateCommand(interp, "Parflow::pfserve", (Tcl_CmdProc*)ServeCommand,
+                    (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
+  Tcl_CreateCommand(interp, "Parflow::pfsend", (Tcl_CmdProc*)SendCommand,
+                    (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfgetgrid", (Tcl_CmdProc*)GetGridCommand,
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfsetgrid", (Tcl_CmdProc*)SetGridCommand,
@@ -228,6 +242,8 @@ EXPORT(int, Parflow_Init)(Tcl_Interp * interp)
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfsurfacerunoff", (Tcl_CmdProc*)SurfaceRunoffCommand,
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
+  Tcl_CreateCommand(interp, "Parflow::pfreduceseries", (Tcl_CmdProc*)ReduceSeriesCommand,
+                    (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfwatertabledepth", (Tcl_CmdProc*)WaterTableDepthCommand,
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfslopex", (Tcl_CmdProc*)SlopeXUpwindCommand,
@@ -240,6 +256,8 @@ EXPORT(int, Parflow_Init)(Tcl_Interp * interp)
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfpitfilldem", (Tcl_CmdProc*)PitFillCommand,
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
+  Tcl_CreateCommand(interp, "Parflow::pfpriorityfilldem", (Tcl_CmdProc*)PriorityFillCommand,
+                    (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfmovingavgdem", (Tcl_CmdProc*)MovingAvgCommand,
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfsattrans", (Tcl_CmdProc*)SatTransmissivityCommand,
@@ -276,6 +294,8 @@ EXPORT(int, Parflow_Init)(Tcl_Interp * interp)
   //NBE: Adding another write module
   Tcl_CreateCommand(interp, "Parflow::pfvtksave", (Tcl_CmdProc*)SavePFVTKCommand,
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
+  Tcl_CreateCommand(interp, "Parflow::pfvtssave", (Tcl_CmdProc*)SaveVTSCommand,
+                    (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
 
 #ifdef SGS
   Tcl_CreateExitHandler((Tcl_ExitProc*)PFTExitProc, (ClientData)data);
@@ -71,7 +71,11 @@
 #include "compute_domain.h"
 #include "water_table.h"
 #include "water_balance.h"
+#include "time_series.h"
 #include "toposlopes.h"
+#include "parallel.h"
+#include "cache.h"
+#include "server.h"
 
 #include "region.h"
 #include "grid.h"
@@ -82,27 +86,58 @@
 
 /*-----------------------------------------------------------------------
  * Load:
- *   distribute the data
+ *   distribute the data in src_filename to filename, returns 0 on
+ *   success
  *-----------------------------------------------------------------------*/
 
-void           Load(
+int            Load(
                     int           type,
+                    char *        src_filename,
                     char *        filename,
                     SubgridArray *all_subgrids,
-                    Background *  background,
-                    Databox *     databox)
+                    Background *  background)
 {
   switch (type)
   {
     case ParflowB:
-      LoadParflowB(filename, all_subgrids, background, databox);
-      break;
+      return DistParflowB(src_filename, filename, all_subgrids, background);
 
     default:
       printf("Cannot load onto a file of that type\n");
+      return 1;
   }
 }
 
+/*-----------------------------------------------------------------------
+ * DistFile:
+ *   move filename to a backup and distribute the backup back to
+ *   filename one slab at a time, the whole file is never loaded.  On
+ *   failure the original file is restored.  Returns 0 on success.
+ *-----------------------------------------------------------------------*/
+
+static int     DistFile(
+                        char *        filename,
+                        SubgridArray *all_subgrids,
+                        Background *  background)
+{
+  char backup[2048];
+
+  sprintf(backup, "%s.bak", filename);
+
+  if (rename(filename, backup))
+    return 1;
+
+  if (Load(ParflowB, backup, filename, all_subgrids, background))
+  {
+    rename(backup, filename);
+    return 1;
+  }
+
+  unlink(backup);
+
+  return 0;
+}
+
 /*-----------------------------------------------------------------------
  * routine for `pfdist' command
  * Description: distributes the file to the virtual distributed file
@@ -130,9 +165,7 @@ int            PFDistCommand(
   Grid          *user_grid;
   SubgridArray  *all_subgrids;
 
-  Databox *inbox;
-
-  char command[1024];
+  int error;
 
   // Setup and error checking for manual nz spec
   if ((argc == 2)||(argc == 4))
@@ -198,12 +231,6 @@ int            PFDistCommand(
       nz_in = SubgridNZ(user_subgrid); // Save the correct nz
       SubgridNZ(user_subgrid)=nz_manual; // Set the manual nz
     }
-    /*--------------------------------------------------------------------
-     * Get inbox from input_filename
-     *--------------------------------------------------------------------*/
-
-    inbox = Read(ParflowB, filename);
-
     /*--------------------------------------------------------------------
      * Load the data
      *--------------------------------------------------------------------*/
@@ -220,29 +247,21 @@ int            PFDistCommand(
       exit(1);
     }
 
-#ifdef _WIN32
-    sprintf(command, "move %s %s.bak", filename, filename);
-    system(command);
-#else
-    sprintf(command, "mv %s %s.bak", filename, filename);
-    system(command);
-#endif
-
-    Load(ParflowB, filename, all_subgrids, background, inbox);
-
-#ifdef _WIN32
-    sprintf(command, "del %s.bak", filename);
-    system(command);
-#else
-    sprintf(command, "%s.bak", filename);
-    unlink(command);
-#endif
+    /*--------------------------------------------------------------------
+     * The file is streamed from a backup copy to the distributed file
+     *--------------------------------------------------------------------*/
 
+    error = DistFile(filename, all_subgrids, background);
 
     FreeBackground(background);
     FreeGrid(user_grid);
     FreeSubgridArray(all_subgrids);
-    FreeDatabox(inbox);
+
+    if (error)
+    {
+      ReadWriteError(interp);
+      return TCL_ERROR;
+    }
 
     return TCL_OK;
   }
@@ -273,10 +292,7 @@ int            PFDistOnDomainCommand(
   char *filename;
   char *filetype;
 
-
-  Databox *inbox;
-
-  char command[1024];
+  int error;
 
   if (argc != 3)
   {
@@ -301,12 +317,6 @@ int            PFDistOnDomainCommand(
      *--------------------------------------------------------------------*/
     Background    *background = ReadBackground(interp);
 
-    /*--------------------------------------------------------------------
-     * Get inbox from input_filename
-     *--------------------------------------------------------------------*/
-
-    inbox = Read(ParflowB, filename);
-
     /*--------------------------------------------------------------------
      * Get domain from user argument
      *--------------------------------------------------------------------*/
@@ -329,26 +339,15 @@ int            PFDistOnDomainCommand(
       exit(1);
     }
 
-#ifdef _WIN32
-    sprintf(command, "move %s %s.bak", filename, filename);
-    system(command);
-#else
-    sprintf(command, "mv %s %s.bak", filename, filename);
-    system(command);
-#endif
-
-    Load(ParflowB, filename, domain, background, inbox);
-
-#ifdef _WIN32
-    sprintf(command, "del %s.bak", filename);
-    system(command);
-#else
-    sprintf(command, "%s.bak", filename);
-    unlink(command);
-#endif
+    error = DistFile(filename, domain, background);
 
     FreeBackground(background);
-    FreeDatabox(inbox);
+
+    if (error)
+    {
+      ReadWriteError(interp);
+      return TCL_ERROR;
+    }
 
     return TCL_OK;
   }
@@ -663,9 +662,10 @@ void               PFTExitProc(
     entryPtr = Tcl_NextHashEntry(&search);
   }
 
-  /* Free the hash table */
+  /* Free the hash table and the cached files */
 
   Tcl_DeleteHashTable(&DataMembers(data));
+  FlushCache();
 
   /* Free the struct that was allocated during initialization */
 
@@ -1052,6 +1052,8 @@ int            ReLoadPFCommand(
 
   if (strcmp(filetype, "pfb") == 0)
     databox = ReadParflowB(filename, default_value);
+  else if (strcmp(filetype, "cpfb") == 0)
+    databox = ReadParflowCB(filename, default_value);
   else if (strcmp(filetype, "pfsb") == 0)
     databox = ReadParflowSB(filename, default_value);
   else if (strcmp(filetype, "sa") == 0)
@@ -1164,20 +1166,30 @@ int            LoadPFCommand(
     }
   }
 
-  if (strcmp(filetype, "pfb") == 0)
-    databox = ReadParflowB(filename, default_value);
-  else if (strcmp(filetype, "pfsb") == 0)
-    databox = ReadParflowSB(filename, default_value);
-  else if (strcmp(filetype, "sa") == 0)
-    databox = ReadSimpleA(filename, default_value);
-  else if (strcmp(filetype, "sb") == 0)
-    databox = ReadSimpleB(filename, default_value);
-  else if (strcmp(filetype, "fld") == 0)
-    databox = ReadAVSField(filename, default_value);
-  else if (strcmp(filetype, "silo") == 0)
-    databox = ReadSilo(filename, default_value);
-  else
-    databox = ReadRealSA(filename, default_value);
+  /* Copy the data from the cache when the file has been loaded before */
+
+  if ((databox = CacheLookup(filename, filetype, default_value)) == NULL)
+  {
+    if (strcmp(filetype, "pfb") == 0)
+      databox = ReadParflowB(filename, default_value);
+    else if (strcmp(filetype, "cpfb") == 0)
+      databox = ReadParflowCB(filename, default_value);
+    else if (strcmp(filetype, "pfsb") == 0)
+      databox = ReadParflowSB(filename, default_value);
+    else if (strcmp(filetype, "sa") == 0)
+      databox = ReadSimpleA(filename, default_value);
+    else if (strcmp(filetype, "sb") == 0)
+      databox = ReadSimpleB(filename, default_value);
+    else if (strcmp(filetype, "fld") == 0)
+      databox = ReadAVSField(filename, default_value);
+    else if (strcmp(filetype, "silo") == 0)
+      databox = ReadSilo(filename, default_value);
+    else
+      databox = ReadRealSA(filename, default_value);
+
+    if (databox)
+      CacheInsert(filename, filetype, default_value, databox);
+  }
 
   /* Make sure the memory for the data was allocated */
 
@@ -1202,6 +1214,270 @@ int            LoadPFCommand(
   return TCL_OK;
 }
 
+/*-----------------------------------------------------------------------
+ * routine for `pfloadsubbox' command
+ * Description: Load the subbox [il,iu) x [jl,ju) x [kl,ku) of a file.
+ *              The pfb and cpfb files are indexed by subgrid so only
+ *              the values overlapping the subbox are read.
+ * Cmd. syntax: pfloadsubbox filename il jl kl iu ju ku [default_value]
+ *-----------------------------------------------------------------------*/
+
+int            LoadSubBoxCommand(
+                                 ClientData  clientData,
+                                 Tcl_Interp *interp,
+                                 int         argc,
+                                 char *      argv[])
+{
+  Data       *data = (Data*)clientData;
+
+  Databox    *databox;
+
+  char       *filetype, *filename;
+  char newhashkey[MAX_KEY_SIZE];
+
+  int box[6];
+  int n;
+
+  double default_value = 0.0;
+
+
+  if (argc != 8 && argc != 9)
+  {
+    WrongNumArgsError(interp, LOADSUBBOXUSAGE);
+    return TCL_ERROR;
+  }
+
+  filename = argv[1];
+
+  if ((filetype = GetValidFileExtension(filename)) == (char*)NULL
+      || (strcmp(filetype, "pfb") != 0 && strcmp(filetype, "cpfb") != 0))
+  {
+    InvalidFileExtensionError(interp, 1, LOADSUBBOXUSAGE);
+    return TCL_ERROR;
+  }
+
+  for (n = 0; n < 6; n++)
+  {
+    if (Tcl_GetInt(interp, argv[n + 2], &box[n]) == TCL_ERROR)
+    {
+      NotAnIntError(interp, n + 2, LOADSUBBOXUSAGE);
+      return TCL_ERROR;
+    }
+  }
+
+  if (argc == 9)
+  {
+    if (Tcl_GetDouble(interp, argv[8], &default_value) == TCL_ERROR)
+    {
+      NotADoubleError(interp, 8, LOADSUBBOXUSAGE);
+      return TCL_ERROR;
+    }
+  }
+
+  if (strcmp(filetype, "pfb") == 0)
+    databox = ReadParflowBSubBox(filename, box[0], box[1], box[2],
+                                 box[3], box[4], box[5], default_value);
+  else
+    databox = ReadParflowCBSubBox(filename, box[0], box[1], box[2],
+                                  box[3], box[4], box[5], default_value);
+
+  if (databox)
+  {
+    if (!AddData(data, databox, filename, newhashkey))
+      FreeDatabox(databox);
+    else
+    {
+      Tcl_AppendElement(interp, newhashkey);
+    }
+  }
+  else
+  {
+    ReadWriteError(interp);
+    return TCL_ERROR;
+  }
+
+  return TCL_OK;
+}
+
+/*-----------------------------------------------------------------------
+ * routine for `pfloadtop' command
+ * Description: Load the values of a file at the top of the domain, the
+ *              layer given by top (see pfcomputetop) in each column.
+ *              Only the values in the layers holding a top cell are
+ *              read, the result is the same as pfextracttop on the
+ *              loaded file.
+ * Cmd. syntax: pfloadtop filename top [default_value]
+ *-----------------------------------------------------------------------*/
+
+int            LoadTopCommand(
+                              ClientData  clientData,
+                              Tcl_Interp *interp,
+                              int         argc,
+                              char *      argv[])
+{
+  Tcl_HashEntry *entryPtr;   /* Points to new hash table entry         */
+  Data       *data = (Data*)clientData;
+
+  Databox    *top;
+  Databox    *databox;
+
+  char       *filetype, *filename;
+  char       *top_hashkey;
+  char newhashkey[MAX_KEY_SIZE];
+
+  double default_value = 0.0;
+
+
+  if (argc != 3 && argc != 4)
+  {
+    WrongNumArgsError(interp, LOADTOPUSAGE);
+    return TCL_ERROR;
+  }
+
+  filename = argv[1];
+  top_hashkey = argv[2];
+
+  if ((filetype = GetValidFileExtension(filename)) == (char*)NULL
+      || (strcmp(filetype, "pfb") != 0 && strcmp(filetype, "cpfb") != 0))
+  {
+    InvalidFileExtensionError(interp, 1, LOADTOPUSAGE);
+    return TCL_ERROR;
+  }
+
+  if ((top = DataMember(data, top_hashkey, entryPtr)) == NULL)
+  {
+    SetNonExistantError(interp, top_hashkey);
+    return TCL_ERROR;
+  }
+
+  if (argc == 4)
+  {
+    if (Tcl_GetDouble(interp, argv[3], &default_value) == TCL_ERROR)
+    {
+      NotADoubleError(interp, 3, LOADTOPUSAGE);
+      return TCL_ERROR;
+    }
+  }
+
+  if (strcmp(filetype, "pfb") == 0)
+    databox = ReadParflowBTop(filename, top, default_value);
+  else
+    databox = ReadParflowCBTop(filename, top, default_value);
+
+  if (databox)
+  {
+    if (!AddData(data, databox, filename, newhashkey))
+      FreeDatabox(databox);
+    else
+    {
+      Tcl_AppendElement(interp, newhashkey);
+    }
+  }
+  else
+  {
+    ReadWriteError(interp);
+    return TCL_ERROR;
+  }
+
+  return TCL_OK;
+}
+
+/*-----------------------------------------------------------------------
+ * routine for `pfloadwatertabledepth' command
+ * Description: Compute the water table depth, as pfwatertabledepth, of
+ *              the saturation in a file.  The layers of a pfb file are
+ *              read one at a time from the top down only until the water
+ *              table of every column is found.
+ * Cmd. syntax: pfloadwatertabledepth filename top
+ *-----------------------------------------------------------------------*/
+
+int            LoadWaterTableDepthCommand(
+                                          ClientData  clientData,
+                                          Tcl_Interp *interp,
+                                          int         argc,
+                                          char *      argv[])
+{
+  Tcl_HashEntry *entryPtr;   /* Points to new hash table entry         */
+  Data       *data = (Data*)clientData;
+
+  Databox    *top;
+  Databox    *saturation;
+  Databox    *water_table_depth;
+
+  char       *filetype, *filename;
+  char       *top_hashkey;
+  char newhashkey[MAX_KEY_SIZE];
+
+
+  if (argc != 3)
+  {
+    WrongNumArgsError(interp, LOADWATERTABLEDEPTHUSAGE);
+    return TCL_ERROR;
+  }
+
+  filename = argv[1];
+  top_hashkey = argv[2];
+
+  if ((filetype = GetValidFileExtension(filename)) == (char*)NULL
+      || (strcmp(filetype, "pfb") != 0 && strcmp(filetype, "cpfb") != 0))
+  {
+    InvalidFileExtensionError(interp, 1, LOADWATERTABLEDEPTHUSAGE);
+    return TCL_ERROR;
+  }
+
+  if ((top = DataMember(data, top_hashkey, entryPtr)) == NULL)
+  {
+    SetNonExistantError(interp, top_hashkey);
+    return TCL_ERROR;
+  }
+
+  if (strcmp(filetype, "pfb") == 0)
+  {
+    water_table_depth = ReadParflowBWaterTableDepth(filename, top);
+  }
+  else
+  {
+    /* Compressed files are read whole */
+    water_table_depth = NULL;
+
+    if ((saturation = ReadParflowCB(filename, 0.0)))
+    {
+      if (DataboxNx(top) == DataboxNx(saturation)
+          && DataboxNy(top) == DataboxNy(saturation)
+          && (water_table_depth = NewDatabox(DataboxNx(saturation),
+                                             DataboxNy(saturation), 1,
+                                             DataboxX(saturation),
+                                             DataboxY(saturation),
+                                             DataboxZ(saturation),
+                                             DataboxDx(saturation),
+                                             DataboxDy(saturation),
+                                             DataboxDz(saturation))))
+      {
+        ComputeWaterTableDepth(top, saturation, water_table_depth);
+      }
+
+      FreeDatabox(saturation);
+    }
+  }
+
+  if (water_table_depth)
+  {
+    if (!AddData(data, water_table_depth, "water table depth", newhashkey))
+      FreeDatabox(water_table_depth);
+    else
+    {
+      Tcl_AppendElement(interp, newhashkey);
+    }
+  }
+  else
+  {
+    ReadWriteError(interp);
+    return TCL_ERROR;
+  }
+
+  return TCL_OK;
+}
+
 #ifdef HAVE_HDF
 
 /*-----------------------------------------------------------------------
@@ -1305,11 +1581,13 @@ int               SavePFCommand(
   Tcl_HashEntry *entryPtr;
   Databox       *databox;
 
+  double tolerance = 0.0;
 
 
-  /* The command three arguments */
+  /* The command three arguments, the cpfb file type takes an optional */
+  /* error tolerance                                                    */
 
-  if (argc != 4)
+  if (argc != 4 && !(argc == 5 && strcmp(argv[2], "-cpfb") == 0))
   {
     WrongNumArgsError(interp, SAVEPFUSAGE);
     return TCL_ERROR;
@@ -1357,9 +1635,34 @@ int               SavePFCommand(
 
     PrintParflowB(fp, databox);
   }
-  else if (strcmp(filetype, "sa") == 0)
+  else if (strcmp(filetype, "cpfb") == 0)
   {
-    /* Make sure the file could be opened */
+    if (argc == 5)
+    {
+      if (Tcl_GetDouble(interp, argv[4], &tolerance) == TCL_ERROR)
+      {
+        NotADoubleError(interp, 4, SAVEPFUSAGE);
+        return TCL_ERROR;
+      }
+    }
+
+    /* Make sure the file could be opened */
+    if ((fp = fopen(filename, "wb")) == NULL)
+    {
+      ReadWriteError(interp);
+      return TCL_ERROR;
+    }
+
+    if (PrintParflowCB(fp, databox, tolerance))
+    {
+      fclose(fp);
+      ReadWriteError(interp);
+      return TCL_ERROR;
+    }
+  }
+  else if (strcmp(filetype, "sa") == 0)
+  {
+    /* Make sure the file could be opened */
     if ((fp = fopen(filename, "wb")) == NULL)
     {
       ReadWriteError(interp);
@@ -1878,6 +2181,244 @@ int SavePFVTKCommand(
   return TCL_OK;
 }
 
+/*-----------------------------------------------------------------------
+ * routine for `pfvtssave' command
+ * Description: Save one or more datasets as cell data of a VTK XML
+ *              structured grid with the points and data in a binary
+ *              appended block.  The grid may follow the top of a dem,
+ *              use variable dz and be a subset of the datasets.
+ *
+ * Cmd. syntax: pfvtssave filename {name dataset [name dataset ...]}
+ *                [-flt] [-dem dem] [-dzscale {dz_1 ... dz_nz}]
+ *                [-box {il jl kl iu ju ku}] [-stride {sx sy sz}]
+ *-----------------------------------------------------------------------*/
+int            SaveVTSCommand(
+                              ClientData  clientData,
+                              Tcl_Interp *interp,
+                              int         argc,
+                              char *      argv[])
+{
+  Tcl_HashEntry *entryPtr;   /* Points to new hash table entry         */
+  Data       *data = (Data*)clientData;
+
+  char       *filename;
+  FILE       *fp;
+
+  const char **field_list = NULL;
+  const char **option_list = NULL;
+  int num_fields, num_items;
+
+  Databox   **fields = NULL;
+  char      **names = NULL;
+  Databox    *dem = NULL;
+  double     *dz = NULL;
+
+  int lo[3], hi[3], stride[3];
+  int nx, ny, nz;
+  int flt = 0;
+  int n, m, error;
+
+
+  if (argc < 3)
+  {
+    WrongNumArgsError(interp, PFVTSSAVEUSAGE);
+    return TCL_ERROR;
+  }
+
+  filename = argv[1];
+
+  if (Tcl_SplitList(interp, argv[2], &num_items, &field_list) != TCL_OK
+      || num_items < 2 || num_items % 2)
+  {
+    if (field_list)
+      Tcl_Free((char*)field_list);
+    InvalidArgError(interp, 2, PFVTSSAVEUSAGE);
+    return TCL_ERROR;
+  }
+
+  num_fields = num_items / 2;
+  names = talloc(char *, num_fields);
+  fields = talloc(Databox *, num_fields);
+
+  error = 1;
+
+  if (names == NULL || fields == NULL)
+  {
+    MemoryError(interp);
+    goto done;
+  }
+
+  for (m = 0; m < num_fields; m++)
+  {
+    names[m] = (char*)field_list[2 * m];
+    if ((fields[m] = DataMember(data, field_list[2 * m + 1], entryPtr)) == NULL)
+    {
+      SetNonExistantError(interp, (char*)field_list[2 * m + 1]);
+      goto done;
+    }
+
+    if (!SameDimensions(fields[0], fields[m]))
+    {
+      DimensionError(interp);
+      goto done;
+    }
+  }
+
+  nx = DataboxNx(fields[0]);
+  ny = DataboxNy(fields[0]);
+  nz = DataboxNz(fields[0]);
+
+  lo[0] = lo[1] = lo[2] = 0;
+  hi[0] = nx - 1;
+  hi[1] = ny - 1;
+  hi[2] = nz - 1;
+  stride[0] = stride[1] = stride[2] = 1;
+
+  /* options, each followed by its argument except -flt */
+  for (n = 3; n < argc; n++)
+  {
+    if (strcmp(argv[n], "-flt") == 0)
+    {
+      flt = 1;
+      continue;
+    }
+
+    if (n + 1 >= argc)
+    {
+      WrongNumArgsError(interp, PFVTSSAVEUSAGE);
+      goto done;
+    }
+
+    if (strcmp(argv[n], "-dem") == 0)
+    {
+      if ((dem = DataMember(data, argv[n + 1], entryPtr)) == NULL)
+      {
+        SetNonExistantError(interp, argv[n + 1]);
+        goto done;
+      }
+
+      if (DataboxNx(dem) != nx || DataboxNy(dem) != ny)
+      {
+        DimensionError(interp);
+        goto done;
+      }
+    }
+    else if (strcmp(argv[n], "-dzscale") == 0)
+    {
+      if (Tcl_SplitList(interp, argv[n + 1], &num_items, &option_list) != TCL_OK
+          || num_items != nz)
+      {
+        InvalidArgError(interp, n + 1, PFVTSSAVEUSAGE);
+        goto done;
+      }
+
+      tfree(dz);
+      if ((dz = talloc(double, nz)) == NULL)
+      {
+        MemoryError(interp);
+        goto done;
+      }
+
+      for (m = 0; m < nz; m++)
+      {
+        if (Tcl_GetDouble(interp, option_list[m], &dz[m]) != TCL_OK
+            || dz[m] <= 0.0)
+        {
+          NotADoubleError(interp, n + 1, PFVTSSAVEUSAGE);
+          goto done;
+        }
+        dz[m] *= DataboxDz(fields[0]);
+      }
+    }
+    else if (strcmp(argv[n], "-box") == 0)
+    {
+      if (Tcl_SplitList(interp, argv[n + 1], &num_items, &option_list) != TCL_OK
+          || num_items != 6)
+      {
+        InvalidArgError(interp, n + 1, PFVTSSAVEUSAGE);
+        goto done;
+      }
+
+      for (m = 0; m < 3; m++)
+      {
+        if (Tcl_GetInt(interp, option_list[m], &lo[m]) != TCL_OK
+            || Tcl_GetInt(interp, option_list[m + 3], &hi[m]) != TCL_OK)
+        {
+          NotAnIntError(interp, n + 1, PFVTSSAVEUSAGE);
+          goto done;
+        }
+      }
+
+      if (lo[0] < 0 || lo[1] < 0 || lo[2] < 0
+          || hi[0] >= nx || hi[1] >= ny || hi[2] >= nz
+          || lo[0] > hi[0] || lo[1] > hi[1] || lo[2] > hi[2])
+      {
+        InvalidArgError(interp, n + 1, PFVTSSAVEUSAGE);
+        goto done;
+      }
+    }
+    else if (strcmp(argv[n], "-stride") == 0)
+    {
+      if (Tcl_SplitList(interp, argv[n + 1], &num_items, &option_list) != TCL_OK
+          || num_items != 3)
+      {
+        InvalidArgError(interp, n + 1, PFVTSSAVEUSAGE);
+        goto done;
+      }
+
+      for (m = 0; m < 3; m++)
+      {
+        if (Tcl_GetInt(interp, option_list[m], &stride[m]) != TCL_OK)
+        {
+          NotAnIntError(interp, n + 1, PFVTSSAVEUSAGE);
+          goto done;
+        }
+
+        if (stride[m] < 1)
+        {
+          InvalidArgError(interp, n + 1, PFVTSSAVEUSAGE);
+          goto done;
+        }
+      }
+    }
+    else
+    {
+      InvalidOptionError(interp, n, PFVTSSAVEUSAGE);
+      goto done;
+    }
+
+    if (option_list)
+    {
+      Tcl_Free((char*)option_list);
+      option_list = NULL;
+    }
+    n++;
+  }
+
+  if ((fp = fopen(filename, "wb")) == NULL)
+  {
+    ReadWriteError(interp);
+    goto done;
+  }
+
+  error = PrintVTS(fp, num_fields, fields, names, dem, dz, lo, hi, stride, flt);
+  if (fclose(fp))
+    error = 1;
+
+  if (error)
+    ReadWriteError(interp);
+
+done:
+  if (option_list)
+    Tcl_Free((char*)option_list);
+  Tcl_Free((char*)field_list);
+  tfree(names);
+  tfree(fields);
+  tfree(dz);
+
+  return error ? TCL_ERROR : TCL_OK;
+}
+
 // END of PFVsave
 /* -------------------------------------------------------------------------------------- */
 
@@ -2194,83 +2735,268 @@ int               GetGridCommand(
   Tcl_HashEntry *entryPtr;
   Databox       *databox;
 
-  /* One argument must be passed to the pfgetgrid command */
+  /* One argument must be passed to the pfgetgrid command */
+
+  if (argc != 2)
+  {
+    WrongNumArgsError(interp, GETGRIDUSAGE);
+    return TCL_ERROR;
+  }
+
+  /* Make sure that the dat set given exists */
+
+  if ((databox = DataMember(data, argv[1], entryPtr)) == NULL)
+  {
+    SetNonExistantError(interp, argv[1]);
+    return TCL_ERROR;
+  }
+
+  GetDataboxGrid(interp, databox);
+  return TCL_OK;
+}
+
+
+/*-----------------------------------------------------------------------
+ * routine for `pfgridtype' command
+ * Description: The argument is either vertex or cell.  A vertex grid
+ *              type means that the grid is vertex centerd and the cell
+ *              type means that the grid is cell centered.  If no argument
+ *              is given, then the current setting is returned as the TCL
+ *              result.
+ * Cmd. syntax: pfgridtype [vertex | cell]
+ *-----------------------------------------------------------------------*/
+
+int            GridTypeCommand(
+                               ClientData  clientData,
+                               Tcl_Interp *interp,
+                               int         argc,
+                               char *      argv[])
+{
+  Data       *data = (Data*)clientData;
+
+  char       *newtype;
+
+
+  /* There must be zero or one arguments */
+
+  if (argc > 2)
+  {
+    WrongNumArgsError(interp, GRIDTYPEUSAGE);
+    return TCL_ERROR;
+  }
+
+  /* If there is an argument, we must change the grid type */
+
+  if (argc == 2)
+  {
+    newtype = argv[1];
+
+    /* Determine what the new grid type is */
+
+    if (strcmp(newtype, "vertex") == 0)
+      DataGridType(data) = vertex;
+    else if (strcmp(newtype, "cell") == 0)
+      DataGridType(data) = cell;
+    else
+    {
+      InvalidArgError(interp, 1, GRIDTYPEUSAGE);
+      return TCL_ERROR;
+    }
+  }
+
+  /* Append the new grid type to the Tcl result */
+
+  if (DataGridType(data) == vertex)
+    Tcl_SetResult(interp, "vertex", TCL_STATIC);
+  else
+    Tcl_SetResult(interp, "cell", TCL_STATIC);
+
+  return TCL_OK;
+}
+
+
+/*-----------------------------------------------------------------------
+ * routine for `pfsetthreads' command
+ * Description: The argument is the number of threads used by the cell-wise
+ *              and stencil commands (pfcellsum, pfaxpy, pfflux, pfcvel,
+ *              pfslopex, ...).  Builds without thread support always use
+ *              one thread.  The number of threads in use is returned as
+ *              the TCL result.
+ * Cmd. syntax: pfsetthreads [num_threads]
+ *-----------------------------------------------------------------------*/
+
+int            SetThreadsCommand(
+                                 ClientData  clientData,
+                                 Tcl_Interp *interp,
+                                 int         argc,
+                                 char *      argv[])
+{
+  int num_threads;
+
+
+  /* There must be zero or one arguments */
+
+  if (argc > 2)
+  {
+    WrongNumArgsError(interp, SETTHREADSUSAGE);
+    return TCL_ERROR;
+  }
+
+  if (argc == 2)
+  {
+    if (Tcl_GetInt(interp, argv[1], &num_threads) == TCL_ERROR)
+    {
+      NotAnIntError(interp, 1, SETTHREADSUSAGE);
+      return TCL_ERROR;
+    }
+
+    if (num_threads < 1)
+    {
+      InvalidArgError(interp, 1, SETTHREADSUSAGE);
+      return TCL_ERROR;
+    }
+
+    SetToolsNumThreads(num_threads);
+  }
+
+  Tcl_SetObjResult(interp, Tcl_NewIntObj(GetToolsNumThreads()));
+
+  return TCL_OK;
+}
+
+
+/*-----------------------------------------------------------------------
+ * routine for `pfcache' command
+ * Description: Files loaded with pfload are kept in an LRU cache of up to
+ *              the given number of megabytes, so loading a file again
+ *              copies the cached values instead of reading the file.
+ *              Files that changed since they were cached are read again.
+ *              A limit of 0, the default, disables the cache.  The
+ *              -flush option empties the cache.  The limit, the memory
+ *              used in megabytes, the number of cached files and the
+ *              number of hits and misses are returned as a list of
+ *              names and values.
+ * Cmd. syntax: pfcache [-limit megabytes | -flush]
+ *-----------------------------------------------------------------------*/
+
+int            CacheCommand(
+                            ClientData  clientData,
+                            Tcl_Interp *interp,
+                            int         argc,
+                            char *      argv[])
+{
+  CacheStats stats;
+  Tcl_Obj    *result;
+  double limit;
+
+
+  if (argc == 2 && strcmp(argv[1], "-flush") == 0)
+  {
+    FlushCache();
+  }
+  else if (argc == 3 && strcmp(argv[1], "-limit") == 0)
+  {
+    if (Tcl_GetDouble(interp, argv[2], &limit) == TCL_ERROR)
+    {
+      NotADoubleError(interp, 2, CACHEUSAGE);
+      return TCL_ERROR;
+    }
+
+    if (limit < 0.0)
+    {
+      NumberNotPositiveError(interp, 2);
+      return TCL_ERROR;
+    }
 
-  if (argc != 2)
+    SetCacheLimit(limit * 1024.0 * 1024.0);
+  }
+  else if (argc == 2 || argc == 3)
   {
-    WrongNumArgsError(interp, GETGRIDUSAGE);
+    InvalidOptionError(interp, 1, CACHEUSAGE);
     return TCL_ERROR;
   }
-
-  /* Make sure that the dat set given exists */
-
-  if ((databox = DataMember(data, argv[1], entryPtr)) == NULL)
+  else if (argc != 1)
   {
-    SetNonExistantError(interp, argv[1]);
+    WrongNumArgsError(interp, CACHEUSAGE);
     return TCL_ERROR;
   }
 
-  GetDataboxGrid(interp, databox);
+  GetCacheStats(&stats);
+
+  result = Tcl_NewListObj(0, NULL);
+  Tcl_ListObjAppendElement(interp, result, Tcl_NewStringObj("limit", -1));
+  Tcl_ListObjAppendElement(interp, result,
+                           Tcl_NewDoubleObj(stats.limit / (1024.0 * 1024.0)));
+  Tcl_ListObjAppendElement(interp, result, Tcl_NewStringObj("used", -1));
+  Tcl_ListObjAppendElement(interp, result,
+                           Tcl_NewDoubleObj(stats.used / (1024.0 * 1024.0)));
+  Tcl_ListObjAppendElement(interp, result, Tcl_NewStringObj("entries", -1));
+  Tcl_ListObjAppendElement(interp, result, Tcl_NewIntObj(stats.entries));
+  Tcl_ListObjAppendElement(interp, result, Tcl_NewStringObj("hits", -1));
+  Tcl_ListObjAppendElement(interp, result, Tcl_NewWideIntObj(stats.hits));
+  Tcl_ListObjAppendElement(interp, result, Tcl_NewStringObj("misses", -1));
+  Tcl_ListObjAppendElement(interp, result, Tcl_NewWideIntObj(stats.misses));
+
+  Tcl_SetObjResult(interp, result);
+
   return TCL_OK;
 }
 
 
 /*-----------------------------------------------------------------------
- * routine for `pfgridtype' command
- * Description: The argument is either vertex or cell.  A vertex grid
- *              type means that the grid is vertex centerd and the cell
- *              type means that the grid is cell centered.  If no argument
- *              is given, then the current setting is returned as the TCL
- *              result.
- * Cmd. syntax: pfgridtype [vertex | cell]
+ * routine for `pfserve' command
+ * Description: Listen on the given UNIX domain socket and evaluate the
+ *              commands sent by clients, for example with pfsend, in
+ *              this interpreter.  Data sets and cached files are kept
+ *              between commands.  The command returns when a client
+ *              sends `pfserve -stop'.
+ * Cmd. syntax: pfserve socket
+ *              pfserve -stop
  *-----------------------------------------------------------------------*/
 
-int            GridTypeCommand(
-                               ClientData  clientData,
-                               Tcl_Interp *interp,
-                               int         argc,
-                               char *      argv[])
+int            ServeCommand(
+                            ClientData  clientData,
+                            Tcl_Interp *interp,
+                            int         argc,
+                            char *      argv[])
 {
-  Data       *data = (Data*)clientData;
-
-  char       *newtype;
-
-
-  /* There must be zero or one arguments */
-
-  if (argc > 2)
+  if (argc != 2)
   {
-    WrongNumArgsError(interp, GRIDTYPEUSAGE);
+    WrongNumArgsError(interp, SERVEUSAGE);
     return TCL_ERROR;
   }
 
-  /* If there is an argument, we must change the grid type */
-
-  if (argc == 2)
+  if (strcmp(argv[1], "-stop") == 0)
   {
-    newtype = argv[1];
+    StopServer();
+    return TCL_OK;
+  }
 
-    /* Determine what the new grid type is */
+  return ServeSocket(interp, argv[1]);
+}
 
-    if (strcmp(newtype, "vertex") == 0)
-      DataGridType(data) = vertex;
-    else if (strcmp(newtype, "cell") == 0)
-      DataGridType(data) = cell;
-    else
-    {
-      InvalidArgError(interp, 1, GRIDTYPEUSAGE);
-      return TCL_ERROR;
-    }
-  }
 
-  /* Append the new grid type to the Tcl result */
+/*-----------------------------------------------------------------------
+ * routine for `pfsend' command
+ * Description: Evaluate a script in the pftools server listening on the
+ *              given socket.  The result of the script on the server is
+ *              returned, errors on the server are raised as errors.
+ * Cmd. syntax: pfsend socket script
+ *-----------------------------------------------------------------------*/
 
-  if (DataGridType(data) == vertex)
-    Tcl_SetResult(interp, "vertex", TCL_STATIC);
-  else
-    Tcl_SetResult(interp, "cell", TCL_STATIC);
+int            SendCommand(
+                           ClientData  clientData,
+                           Tcl_Interp *interp,
+                           int         argc,
+                           char *      argv[])
+{
+  if (argc != 3)
+  {
+    WrongNumArgsError(interp, SENDUSAGE);
+    return TCL_ERROR;
+  }
 
-  return TCL_OK;
+  return SendToServer(interp, argv[1], argv[2]);
 }
 
 
@@ -5605,6 +6331,220 @@ int            SurfaceRunoffCommand(
   return TCL_OK;
 }
 
+/*-----------------------------------------------------------------------
+ * routine for `pfreduceseries' command
+ * Description: Reduce a time series of pfb files one layer at a time.
+ *              Each timestep gives the min, max, mean and sum of the
+ *              pressure, with -subsurface the total subsurface storage
+ *              and with -surface the total surface storage and runoff.
+ *              The next file is prefetched while a file is reduced.
+ *
+ * Cmd. syntax: pfreduceseries pattern start stop [increment]
+ *                [-subsurface saturation_pattern mask porosity
+ *                 specific_storage]
+ *                [-surface top slope_x slope_y mannings]
+ *-----------------------------------------------------------------------*/
+int            ReduceSeriesCommand(
+                                   ClientData  clientData,
+                                   Tcl_Interp *interp,
+                                   int         argc,
+                                   char *      argv[])
+{
+  Tcl_HashEntry *entryPtr;   /* Points to new hash table entry         */
+  Data       *data = (Data*)clientData;
+
+  char       *pressure_pattern;
+  char       *saturation_pattern = NULL;
+
+  Databox    *mask = NULL;
+  Databox    *porosity = NULL;
+  Databox    *specific_storage = NULL;
+  Databox    *top = NULL;
+  Databox    *slope_x = NULL;
+  Databox    *slope_y = NULL;
+  Databox    *mannings = NULL;
+
+  Databox   **databoxes[4];
+
+  char pressure_name[2048];
+  char saturation_name[2048];
+  char next_name[2048];
+
+  int start, stop, increment = 1;
+  int timestep, n, m;
+  int error;
+
+  SeriesStep step;
+
+  Tcl_Obj    *result;
+  Tcl_Obj    *step_obj;
+
+
+  if (argc < 4)
+  {
+    WrongNumArgsError(interp, PFREDUCESERIESUSAGE);
+    return TCL_ERROR;
+  }
+
+  pressure_pattern = argv[1];
+
+  if (SeriesFileName(pressure_pattern, 0, pressure_name, sizeof(pressure_name)))
+  {
+    InvalidArgError(interp, 1, PFREDUCESERIESUSAGE);
+    return TCL_ERROR;
+  }
+
+  if (Tcl_GetInt(interp, argv[2], &start) == TCL_ERROR)
+  {
+    NotAnIntError(interp, 2, PFREDUCESERIESUSAGE);
+    return TCL_ERROR;
+  }
+
+  if (Tcl_GetInt(interp, argv[3], &stop) == TCL_ERROR)
+  {
+    NotAnIntError(interp, 3, PFREDUCESERIESUSAGE);
+    return TCL_ERROR;
+  }
+
+  n = 4;
+  if (n < argc && argv[n][0] != '-')
+  {
+    if (Tcl_GetInt(interp, argv[n], &increment) == TCL_ERROR)
+    {
+      NotAnIntError(interp, n, PFREDUCESERIESUSAGE);
+      return TCL_ERROR;
+    }
+
+    if (increment < 1)
+    {
+      InvalidArgError(interp, n, PFREDUCESERIESUSAGE);
+      return TCL_ERROR;
+    }
+    n++;
+  }
+
+  /* options, each followed by a pattern or data sets */
+  while (n < argc)
+  {
+    if (strcmp(argv[n], "-subsurface") == 0 && n + 4 < argc)
+    {
+      saturation_pattern = argv[n + 1];
+      if (SeriesFileName(saturation_pattern, 0, saturation_name,
+                         sizeof(saturation_name)))
+      {
+        InvalidArgError(interp, n + 1, PFREDUCESERIESUSAGE);
+        return TCL_ERROR;
+      }
+
+      databoxes[0] = &mask;
+      databoxes[1] = &porosity;
+      databoxes[2] = &specific_storage;
+      databoxes[3] = NULL;
+      n += 2;
+    }
+    else if (strcmp(argv[n], "-surface") == 0 && n + 4 < argc)
+    {
+      databoxes[0] = &top;
+      databoxes[1] = &slope_x;
+      databoxes[2] = &slope_y;
+      databoxes[3] = &mannings;
+      n += 1;
+    }
+    else
+    {
+      InvalidOptionError(interp, n, PFREDUCESERIESUSAGE);
+      return TCL_ERROR;
+    }
+
+    for (m = 0; m < 4 && databoxes[m]; m++, n++)
+    {
+      if ((*databoxes[m] = DataMember(data, argv[n], entryPtr)) == NULL)
+      {
+        SetNonExistantError(interp, argv[n]);
+        return TCL_ERROR;
+      }
+    }
+  }
+
+  result = Tcl_NewListObj(0, NULL);
+
+  for (timestep = start; timestep <= stop; timestep += increment)
+  {
+    SeriesFileName(pressure_pattern, timestep, pressure_name,
+                   sizeof(pressure_name));
+    if (saturation_pattern)
+      SeriesFileName(saturation_pattern, timestep, saturation_name,
+                     sizeof(saturation_name));
+
+    /* start reading the next timestep while this one is reduced */
+    if (timestep + increment <= stop)
+    {
+      SeriesFileName(pressure_pattern, timestep + increment, next_name,
+                     sizeof(next_name));
+      PrefetchSeriesFile(next_name);
+      if (saturation_pattern)
+      {
+        SeriesFileName(saturation_pattern, timestep + increment, next_name,
+                       sizeof(next_name));
+        PrefetchSeriesFile(next_name);
+      }
+    }
+
+    error = ReduceSeriesStep(pressure_name,
+                             saturation_pattern ? saturation_name : NULL,
+                             mask, porosity, specific_storage,
+                             top, slope_x, slope_y, mannings, &step);
+    if (error)
+    {
+      Tcl_DecrRefCount(result);
+      if (error == SERIES_DIMENSION_ERROR)
+        DimensionError(interp);
+      else
+        ReadWriteError(interp);
+      return TCL_ERROR;
+    }
+
+    step_obj = Tcl_NewListObj(0, NULL);
+
+    Tcl_ListObjAppendElement(interp, step_obj, Tcl_NewStringObj("timestep", -1));
+    Tcl_ListObjAppendElement(interp, step_obj, Tcl_NewIntObj(timestep));
+    Tcl_ListObjAppendElement(interp, step_obj, Tcl_NewStringObj("min", -1));
+    Tcl_ListObjAppendElement(interp, step_obj, Tcl_NewDoubleObj(step.min));
+    Tcl_ListObjAppendElement(interp, step_obj, Tcl_NewStringObj("max", -1));
+    Tcl_ListObjAppendElement(interp, step_obj, Tcl_NewDoubleObj(step.max));
+    Tcl_ListObjAppendElement(interp, step_obj, Tcl_NewStringObj("mean", -1));
+    Tcl_ListObjAppendElement(interp, step_obj, Tcl_NewDoubleObj(step.mean));
+    Tcl_ListObjAppendElement(interp, step_obj, Tcl_NewStringObj("sum", -1));
+    Tcl_ListObjAppendElement(interp, step_obj, Tcl_NewDoubleObj(step.sum));
+
+    if (saturation_pattern)
+    {
+      Tcl_ListObjAppendElement(interp, step_obj,
+                               Tcl_NewStringObj("subsurface_storage", -1));
+      Tcl_ListObjAppendElement(interp, step_obj,
+                               Tcl_NewDoubleObj(step.subsurface_storage));
+    }
+
+    if (top)
+    {
+      Tcl_ListObjAppendElement(interp, step_obj,
+                               Tcl_NewStringObj("surface_storage", -1));
+      Tcl_ListObjAppendElement(interp, step_obj,
+                               Tcl_NewDoubleObj(step.surface_storage));
+      Tcl_ListObjAppendElement(interp, step_obj,
+                               Tcl_NewStringObj("surface_runoff", -1));
+      Tcl_ListObjAppendElement(interp, step_obj,
+                               Tcl_NewDoubleObj(step.surface_runoff));
+    }
+
+    Tcl_ListObjAppendElement(interp, result, step_obj);
+  }
+
+  Tcl_SetObjResult(interp, result);
+
+  return TCL_OK;
+}
+
 /*-----------------------------------------------------------------------
  * routine for `pfwatertabledepth' command
  * Description: Compute the water depth
@@ -6155,6 +7095,110 @@ int            PitFillCommand(
 }
 
 
+/*-----------------------------------------------------------------------
+ * routine for `pfpriorityfilldem' command
+ * Description: Single pass priority-flood depression filling, every
+ *              cell drains to the edge of the DEM or a nodata cell.
+ *
+ * Notes:       Assumes that user specifies epsilon in same units as DEM
+ *
+ * Cmd. syntax: pfpriorityfilldem dem [epsilon]
+ *-----------------------------------------------------------------------*/
+int            PriorityFillCommand(
+                                   ClientData  clientData,
+                                   Tcl_Interp *interp,
+                                   int         argc,
+                                   char *      argv[])
+{
+  Tcl_HashEntry *entryPtr;    // Points to new hash table entry
+  Data          *data = (Data*)clientData;
+
+  // Inputs
+  Databox       *dem;
+  char          *dem_hashkey;
+  double epsilon;
+
+  // Output
+  Databox       *newdem;
+  char          *filename = "Priority-Filled DEM";
+  char newdem_hashkey[MAX_KEY_SIZE];
+
+  // Local
+  int nraised;
+  int nx, ny, nz;
+  double x, y, z;
+  double dx, dy, dz;
+
+  /* Check if one or two arguments following command  */
+  if ((argc < 2) || (argc > 3))
+  {
+    WrongNumArgsError(interp, PFPRIORITYFILLDEMUSAGE);
+    return TCL_ERROR;
+  }
+
+  dem_hashkey = argv[1];
+
+  epsilon = 0.0;
+  if (argc == 3)
+  {
+    if ((Tcl_GetDouble(interp, argv[2], &epsilon) == TCL_ERROR)
+        || (epsilon < 0.0))
+    {
+      NotADoubleError(interp, 1, PFPRIORITYFILLDEMUSAGE);
+      return TCL_ERROR;
+    }
+  }
+
+  if ((dem = DataMember(data, dem_hashkey, entryPtr)) == NULL)
+  {
+    SetNonExistantError(interp, dem_hashkey);
+    return TCL_ERROR;
+  }
+
+  {
+    nx = DataboxNx(dem);
+    ny = DataboxNy(dem);
+    nz = 1;
+
+    x = DataboxX(dem);
+    y = DataboxY(dem);
+    z = DataboxZ(dem);
+
+    dx = DataboxDx(dem);
+    dy = DataboxDy(dem);
+    dz = DataboxDz(dem);
+
+    /* create the new databox structure for filled dem  */
+    if ((newdem = NewDatabox(nx, ny, nz, x, y, z, dx, dy, dz)))
+    {
+      /* Make sure the data set pointer was added to */
+      /* the hash table successfully.                */
+      if (!AddData(data, newdem, filename, newdem_hashkey))
+        FreeDatabox(newdem);
+      else
+      {
+        Tcl_AppendElement(interp, newdem_hashkey);
+      }
+
+      nraised = ComputePriorityFill(dem, epsilon, newdem);
+
+      // Print summary...
+      printf("*******************************************************\n");
+      printf("SUMMARY: pfpriorityfilldem  \n");
+      printf("*******************************************************\n");
+      printf("RAISED CELLS: \t\t %d \n", nraised);
+      printf("   \n");
+    }
+    else
+    {
+      ReadWriteError(interp);
+      return TCL_ERROR;
+    }
+  }
+  return TCL_OK;
+}
+
+
 /*-----------------------------------------------------------------------
  * routine for `pfmovingavgdem' command
  * Description: Iterative moving average routine to fill sinks in DEM
@@ -105,6 +105,9 @@ int GetSubBoxCommand (ClientData clientData, Tcl_Interp *interp, int argc, char
 int EnlargeBoxCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int ReLoadPFCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int LoadPFCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
+int LoadSubBoxCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
+int LoadTopCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
+int LoadWaterTableDepthCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int LoadSDSCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int SavePFCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int SaveSDSCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
@@ -113,6 +116,10 @@ int GetEltCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *ar
 int GetGridCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int SetGridCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int GridTypeCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
+int SetThreadsCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
+int CacheCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
+int ServeCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
+int SendCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int CVelCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int VVelCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int BFCVelCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
@@ -149,10 +156,12 @@ int SurfaceStorageCommand (ClientData clientData, Tcl_Interp *interp, int argc,
 int SubsurfaceStorageCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int GWStorageCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int SurfaceRunoffCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
+int ReduceSeriesCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int WaterTableDepthCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 
 //NBE: Adding a new write tool
 int SavePFVTKCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
+int SaveVTSCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 
 void Axpy(double alpha, Databox *X, Databox *Y);
 void Sum(Databox *X, double *sum);
@@ -173,6 +182,7 @@ int SlopeD8Command   (ClientData clientData, Tcl_Interp *interp, int argc, char
 int UpstreamAreaCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int FillFlatsCommand    (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int PitFillCommand   (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
+int PriorityFillCommand   (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int MovingAvgCommand (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int SegmentD8Command (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int ChildD8Command   (ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
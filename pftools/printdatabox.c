@@ -38,6 +38,7 @@
 #include "parflow_config.h"
 
 #include <stdlib.h>
+#include <stdint.h>
 
 #ifdef HAVE_SILO
 #include <silo.h>
@@ -45,6 +46,8 @@
 
 #include "printdatabox.h"
 #include "tools_io.h"
+#include "cpfb.h"
+#include "general.h"
 
 #include "string.h"
 #include "unistd.h"
@@ -185,6 +188,105 @@ void            PrintParflowB(
   tools_WriteDouble(fp, DataboxCoeffs(v), nx * ny * nz);
 }
 
+/*-----------------------------------------------------------------------
+ * print a Databox in compressed `parflow' binary format, the data is
+ * split into CPFB_TILE_SIZE x CPFB_TILE_SIZE x NZ blocks.  A positive
+ * tolerance selects error bounded compression.  Returns 0 on success.
+ *-----------------------------------------------------------------------*/
+
+int             PrintParflowCB(
+                               FILE *   fp,
+                               Databox *v,
+                               double   tolerance)
+{
+  double X = DataboxX(v);
+  double Y = DataboxY(v);
+  double Z = DataboxZ(v);
+  int NX = DataboxNx(v);
+  int NY = DataboxNy(v);
+  int NZ = DataboxNz(v);
+  double DX = DataboxDx(v);
+  double DY = DataboxDy(v);
+  double DZ = DataboxDz(v);
+
+  int method = (tolerance > 0.0) ? CPFB_ERROR_BOUNDED : CPFB_LOSSLESS;
+
+  int tiles_x = (NX + CPFB_TILE_SIZE - 1) / CPFB_TILE_SIZE;
+  int tiles_y = (NY + CPFB_TILE_SIZE - 1) / CPFB_TILE_SIZE;
+  int ns = tiles_x * tiles_y;    /* num_subgrids */
+
+  int            *index, *entry;
+  unsigned char **blocks;
+  double         *values;
+
+  int tx, ty, s, i, j, k, m;
+  int error = 0;
+
+  index = ctalloc(int, 11 * ns);
+  blocks = ctalloc(unsigned char *, ns);
+
+  for (ty = 0; ty < tiles_y; ty++)
+    for (tx = 0; tx < tiles_x; tx++)
+    {
+      s = tx + tiles_x * ty;
+      entry = index + 11 * s;
+
+      entry[0] = tx * CPFB_TILE_SIZE;
+      entry[1] = ty * CPFB_TILE_SIZE;
+      entry[2] = 0;
+      entry[3] = min(CPFB_TILE_SIZE, NX - entry[0]);
+      entry[4] = min(CPFB_TILE_SIZE, NY - entry[1]);
+      entry[5] = NZ;
+      entry[6] = 0;
+      entry[7] = 0;
+      entry[8] = 0;
+
+      values = talloc(double, entry[3] * entry[4] * NZ);
+      m = 0;
+      for (k = 0; k < NZ; k++)
+        for (j = entry[1]; j < entry[1] + entry[4]; j++)
+          for (i = entry[0]; i < entry[0] + entry[3]; i++)
+            values[m++] = *DataboxCoeff(v, i, j, k);
+
+      entry[9] = CPFBEncode(values, m, method, tolerance,
+                            &blocks[s], &entry[10]);
+      if (entry[9] < 0)
+        error = 1;
+
+      tfree(values);
+    }
+
+  if (!error)
+  {
+    tools_WriteDouble(fp, &X, 1);
+    tools_WriteDouble(fp, &Y, 1);
+    tools_WriteDouble(fp, &Z, 1);
+    tools_WriteInt(fp, &NX, 1);
+    tools_WriteInt(fp, &NY, 1);
+    tools_WriteInt(fp, &NZ, 1);
+    tools_WriteDouble(fp, &DX, 1);
+    tools_WriteDouble(fp, &DY, 1);
+    tools_WriteDouble(fp, &DZ, 1);
+
+    tools_WriteInt(fp, &ns, 1);
+
+    tools_WriteInt(fp, &method, 1);
+    tools_WriteDouble(fp, &tolerance, 1);
+
+    tools_WriteInt(fp, index, 11 * ns);
+
+    for (s = 0; s < ns; s++)
+      fwrite(blocks[s], 1, index[11 * s + 10], fp);
+  }
+
+  for (s = 0; s < ns; s++)
+    tfree(blocks[s]);
+  tfree(blocks);
+  tfree(index);
+
+  return error;
+}
+
 /*-----------------------------------------------------------------------
  * print a Databox in AVS .fld format
  *-----------------------------------------------------------------------*/
@@ -1093,3 +1195,228 @@ void            PrintTFG_CLMVTK(
     }
   }
 }
+
+/*-----------------------------------------------------------------------
+ * print Databoxes as a VTK XML structured grid (.vts) with the points
+ * and cell data in a raw appended binary block
+ *
+ * All fields must have the same dimensions.  Cells il..iu, jl..ju and
+ * kl..ku (lo and hi) are written, taking every stride-th cell in each
+ * direction; a written cell spans the stride cells that start at it.
+ * Layer thicknesses are dz[k], or the Databox dz when dz is NULL.  With
+ * a dem the top of the grid follows the top layer of the dem, using the
+ * average of the four cells around each point.
+ *
+ * Data are written in the native byte order one plane at a time, so
+ * only a plane of values is ever held in memory.  Returns nonzero if
+ * memory could not be allocated or the file could not be written.
+ *-----------------------------------------------------------------------*/
+
+static int     *VTSPointIndices(
+                                int  lo,
+                                int  hi,
+                                int  stride,
+                                int *num_cells)
+{
+  int *index;
+  int n, m;
+
+  n = (hi - lo) / stride + 1;
+  if ((index = talloc(int, n + 1)) != NULL)
+  {
+    for (m = 0; m < n; m++)
+      index[m] = lo + m * stride;
+    index[n] = hi + 1;
+  }
+
+  *num_cells = n;
+  return index;
+}
+
+static void     VTSWriteValues(
+                               FILE *  fp,
+                               double *values,
+                               float * values_flt,
+                               int     n,
+                               int     flt)
+{
+  int m;
+
+  if (flt)
+  {
+    for (m = 0; m < n; m++)
+      values_flt[m] = (float)values[m];
+    fwrite(values_flt, sizeof(float), n, fp);
+  }
+  else
+    fwrite(values, sizeof(double), n, fp);
+}
+
+static void     VTSWriteBlockSize(
+                                  FILE *   fp,
+                                  uint64_t size)
+{
+  fwrite(&size, sizeof(uint64_t), 1, fp);
+}
+
+int             PrintVTS(
+                         FILE *    fp,
+                         int       num_fields,
+                         Databox **fields,
+                         char **   names,
+                         Databox * dem,
+                         double *  dz,
+                         int *     lo,
+                         int *     hi,
+                         int *     stride,
+                         int       flt)
+{
+  Databox  *v = fields[0];
+
+  int nx = DataboxNx(v);
+  int ny = DataboxNy(v);
+  int nz = DataboxNz(v);
+
+  double x = DataboxX(v);
+  double y = DataboxY(v);
+  double z = DataboxZ(v);
+  double dx = DataboxDx(v);
+  double dy = DataboxDy(v);
+
+  int      *pi = NULL, *pj = NULL, *pk = NULL;
+  int mx, my, mz;
+  int num_points, num_cells, plane_points;
+
+  double   *depth = NULL;
+  double   *top = NULL;
+  double   *values = NULL;
+  float    *values_flt = NULL;
+
+  uint64_t size = flt ? sizeof(float) : sizeof(double);
+  uint64_t offset;
+
+  int i, j, k, m, n, f;
+  int il, iu, jl, ju;
+  int error = 1;
+
+
+  pi = VTSPointIndices(lo[0], hi[0], stride[0], &mx);
+  pj = VTSPointIndices(lo[1], hi[1], stride[1], &my);
+  pk = VTSPointIndices(lo[2], hi[2], stride[2], &mz);
+
+  plane_points = (mx + 1) * (my + 1);
+  num_points = plane_points * (mz + 1);
+  num_cells = mx * my * mz;
+
+  depth = ctalloc(double, nz + 1);
+  top = ctalloc(double, plane_points);
+  values = talloc(double, 3 * plane_points);
+  if (flt)
+    values_flt = talloc(float, 3 * plane_points);
+
+  if (!pi || !pj || !pk || !depth || !top || !values || (flt && !values_flt))
+    goto done;
+
+  /* depth[k] is the height of the bottom of layer k above the bottom */
+  for (k = 0; k < nz; k++)
+    depth[k + 1] = depth[k] + (dz ? dz[k] : DataboxDz(v));
+
+  /* elevation of the bottom of each point column */
+  for (j = 0, n = 0; j <= my; j++)
+  {
+    for (i = 0; i <= mx; i++, n++)
+    {
+      if (dem)
+      {
+        il = max(pi[i] - 1, 0);
+        iu = min(pi[i], nx - 1);
+        jl = max(pj[j] - 1, 0);
+        ju = min(pj[j], ny - 1);
+
+        k = DataboxNz(dem) - 1;
+        top[n] = (*DataboxCoeff(dem, il, jl, k) + *DataboxCoeff(dem, iu, jl, k)
+                  + *DataboxCoeff(dem, il, ju, k) + *DataboxCoeff(dem, iu, ju, k))
+                 / 4.0 - depth[nz];
+      }
+      else
+        top[n] = z;
+    }
+  }
+
+  fprintf(fp, "<?xml version=\"1.0\"?>\n");
+  fprintf(fp, "<VTKFile type=\"StructuredGrid\" version=\"1.0\" byte_order=\"%s\" header_type=\"UInt64\">\n",
+#ifdef CASC_HAVE_BIGENDIAN
+          "BigEndian"
+#else
+          "LittleEndian"
+#endif
+          );
+  fprintf(fp, "  <StructuredGrid WholeExtent=\"0 %d 0 %d 0 %d\">\n", mx, my, mz);
+  fprintf(fp, "    <Piece Extent=\"0 %d 0 %d 0 %d\">\n", mx, my, mz);
+
+  offset = sizeof(uint64_t) + 3 * size * num_points;
+
+  fprintf(fp, "      <CellData Scalars=\"%s\">\n", names[0]);
+  for (f = 0; f < num_fields; f++)
+  {
+    fprintf(fp, "        <DataArray type=\"%s\" Name=\"%s\" format=\"appended\" offset=\"%llu\"/>\n",
+            flt ? "Float32" : "Float64", names[f], (unsigned long long)offset);
+    offset += sizeof(uint64_t) + size * num_cells;
+  }
+  fprintf(fp, "      </CellData>\n");
+
+  fprintf(fp, "      <Points>\n");
+  fprintf(fp, "        <DataArray type=\"%s\" NumberOfComponents=\"3\" format=\"appended\" offset=\"0\"/>\n",
+          flt ? "Float32" : "Float64");
+  fprintf(fp, "      </Points>\n");
+  fprintf(fp, "    </Piece>\n");
+  fprintf(fp, "  </StructuredGrid>\n");
+  fprintf(fp, "  <AppendedData encoding=\"raw\">\n   _");
+
+  /* points, one plane at a time */
+  VTSWriteBlockSize(fp, 3 * size * num_points);
+  for (k = 0; k <= mz; k++)
+  {
+    for (j = 0, n = 0, m = 0; j <= my; j++)
+    {
+      for (i = 0; i <= mx; i++, n++)
+      {
+        values[m++] = x + pi[i] * dx;
+        values[m++] = y + pj[j] * dy;
+        values[m++] = top[n] + depth[pk[k]];
+      }
+    }
+    VTSWriteValues(fp, values, values_flt, 3 * plane_points, flt);
+  }
+
+  /* cell data, one plane at a time */
+  for (f = 0; f < num_fields; f++)
+  {
+    VTSWriteBlockSize(fp, size * num_cells);
+    for (k = 0; k < mz; k++)
+    {
+      for (j = 0, m = 0; j < my; j++)
+      {
+        for (i = 0; i < mx; i++)
+          values[m++] = *DataboxCoeff(fields[f], pi[i], pj[j], pk[k]);
+      }
+      VTSWriteValues(fp, values, values_flt, mx * my, flt);
+    }
+  }
+
+  fprintf(fp, "\n  </AppendedData>\n");
+  fprintf(fp, "</VTKFile>\n");
+
+  error = ferror(fp) ? 1 : 0;
+
+done:
+  tfree(pi);
+  tfree(pj);
+  tfree(pk);
+  tfree(depth);
+  tfree(top);
+  tfree(values);
+  tfree(values_flt);
+
+  return error;
+}
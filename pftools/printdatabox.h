@@ -62,10 +62,12 @@ void PrintSimpleA(FILE *fp, Databox *v);
 void PrintSimpleA2D(FILE *fp, Databox *v);          // Added @ IMF
 void PrintSimpleB(FILE *fp, Databox *v);
 void PrintParflowB(FILE *fp, Databox *v);
+int  PrintParflowCB(FILE *fp, Databox *v, double tolerance);
 void PrintVTK(FILE *fp, Databox *v, char *varname, int flt);   // NBE
 void PrintCLMVTK(FILE *fp, Databox *v, char *varname, int flt);   // NBE
 void PrintTFG_VTK(FILE *fp, Databox *v, double *pnts, char *varname, int flt);  // NBE
 void PrintTFG_CLMVTK(FILE *fp, Databox *v, double *pnts, char *varname, int flt);  // NBE
+int  PrintVTS(FILE *fp, int num_fields, Databox **fields, char **names, Databox *dem, double *dz, int *lo, int *hi, int *stride, int flt);
 void PrintAVSField(FILE *fp, Databox *v);
 int  PrintSDS(char *filename, int type, Databox *v);
 void PrintVizamrai(FILE *fp, Databox *v);
@@ -41,6 +41,8 @@
 
 #include "readdatabox.h"
 #include "tools_io.h"
+#include "cpfb.h"
+#include "general.h"
 
 #ifdef HAVE_SILO
 #include "silo.h"
@@ -49,6 +51,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
 #include <unistd.h>
 
 #define round(x) ((x) >= 0 ? (double)((x) + 0.5) : (double)((x) - 0.5))
@@ -397,6 +400,347 @@ Databox         *ReadParflowB(
 }
 
 
+/*-----------------------------------------------------------------------
+ * open a binary `parflow' file for reading subboxes.  Only the file and
+ * subgrid headers are read, the values are skipped over to build the
+ * subgrid index.  Returns NULL if the file cannot be opened or is
+ * truncated.
+ *-----------------------------------------------------------------------*/
+
+ParflowBFile    *OpenParflowB(
+                              char * file_name)
+{
+  ParflowBFile    *file;
+
+  FILE           *fp;
+
+  int header[9];
+  int nsg;
+  long end, size;
+
+
+  /* open the input file */
+  if ((fp = fopen(file_name, "rb")) == NULL)
+    return NULL;
+
+  file = ctalloc(ParflowBFile, 1);
+  file->fp = fp;
+
+  /* read in header info */
+  tools_ReadDouble(fp, &file->X, 1);
+  tools_ReadDouble(fp, &file->Y, 1);
+  tools_ReadDouble(fp, &file->Z, 1);
+
+  tools_ReadInt(fp, &file->NX, 1);
+  tools_ReadInt(fp, &file->NY, 1);
+  tools_ReadInt(fp, &file->NZ, 1);
+
+  tools_ReadDouble(fp, &file->DX, 1);
+  tools_ReadDouble(fp, &file->DY, 1);
+  tools_ReadDouble(fp, &file->DZ, 1);
+
+  tools_ReadInt(fp, &file->num_subgrids, 1);
+
+  if (feof(fp) || file->num_subgrids < 1)
+  {
+    CloseParflowB(file);
+    return NULL;
+  }
+
+  file->index = talloc(int, 6 * file->num_subgrids);
+  file->offsets = talloc(long, file->num_subgrids);
+
+  fseek(fp, 0L, SEEK_END);
+  end = ftell(fp);
+  fseek(fp, 6 * sizeof(double) + 4 * sizeof(int), SEEK_SET);
+
+  for (nsg = 0; nsg < file->num_subgrids; nsg++)
+  {
+    tools_ReadInt(fp, header, 9);
+    if (feof(fp))
+    {
+      CloseParflowB(file);
+      return NULL;
+    }
+
+    memcpy(file->index + 6 * nsg, header, 6 * sizeof(int));
+    file->offsets[nsg] = ftell(fp);
+
+    /* skip over the values */
+    size = (long)header[3] * header[4] * header[5] * (long)sizeof(double);
+    if (file->offsets[nsg] + size > end)
+    {
+      CloseParflowB(file);
+      return NULL;
+    }
+    fseek(fp, size, SEEK_CUR);
+  }
+
+  return file;
+}
+
+
+/*-----------------------------------------------------------------------
+ * close a binary `parflow' file opened by OpenParflowB
+ *-----------------------------------------------------------------------*/
+
+void             CloseParflowB(
+                               ParflowBFile *file)
+{
+  if (file)
+  {
+    fclose(file->fp);
+    tfree(file->offsets);
+    tfree(file->index);
+    tfree(file);
+  }
+}
+
+
+/*-----------------------------------------------------------------------
+ * read the values of an opened binary `parflow' file into v, the
+ * subbox of the file starting at il, jl, kl the size of v.  Only the
+ * rows of values overlapping the subbox are read, cells of v outside
+ * of the file are not changed.  When the subbox spans whole rows of a
+ * subgrid of the file and of v, each layer is read with a single read.
+ *-----------------------------------------------------------------------*/
+
+void             ReadParflowBBox(
+                                 ParflowBFile *file,
+                                 Databox *     v,
+                                 int           il,
+                                 int           jl,
+                                 int           kl)
+{
+  int            *entry;
+
+  int x, y, z;
+  int nx, ny, nz;
+  int nsg, j, k;
+  int i0, i1, j0, j1, k0, k1;
+
+
+  for (nsg = 0; nsg < file->num_subgrids; nsg++)
+  {
+    entry = file->index + 6 * nsg;
+
+    x = entry[0];
+    y = entry[1];
+    z = entry[2];
+
+    nx = entry[3];
+    ny = entry[4];
+    nz = entry[5];
+
+    i0 = max(x, il);
+    j0 = max(y, jl);
+    k0 = max(z, kl);
+    i1 = min(x + nx, il + DataboxNx(v));
+    j1 = min(y + ny, jl + DataboxNy(v));
+    k1 = min(z + nz, kl + DataboxNz(v));
+
+    if (i0 < i1 && j0 < j1 && k0 < k1)
+    {
+      if (i1 - i0 == nx && DataboxNx(v) == nx)
+      {
+        for (k = k0; k < k1; k++)
+        {
+          fseek(file->fp, file->offsets[nsg]
+                + ((long)(k - z) * ny + (j0 - y)) * nx
+                * (long)sizeof(double), SEEK_SET);
+          tools_ReadDouble(file->fp,
+                           DataboxCoeff(v, 0, j0 - jl, k - kl),
+                           (j1 - j0) * nx);
+        }
+      }
+      else
+      {
+        for (k = k0; k < k1; k++)
+          for (j = j0; j < j1; j++)
+          {
+            fseek(file->fp, file->offsets[nsg]
+                  + (((long)(k - z) * ny + (j - y)) * nx + (i0 - x))
+                  * (long)sizeof(double), SEEK_SET);
+            tools_ReadDouble(file->fp,
+                             DataboxCoeff(v, i0 - il, j - jl, k - kl),
+                             i1 - i0);
+          }
+      }
+    }
+  }
+}
+
+
+/*-----------------------------------------------------------------------
+ * read the values of an opened binary `parflow' file at the top of the
+ * domain into the nx x ny x 1 databox v, the layer in top (see
+ * pfcomputetop) of each column.  Only the rows of each subgrid holding
+ * a top cell are read.  Columns outside the domain (top < 0) are not
+ * changed.  Returns nonzero if top is below the domain.
+ *-----------------------------------------------------------------------*/
+
+int              ReadParflowBTopValues(
+                                       ParflowBFile *file,
+                                       Databox *     top,
+                                       Databox *     v)
+{
+  int            *entry;
+  double         *row;
+
+  int x, y, z;
+  int nx, ny, nz;
+  int nsg, i, j, k;
+  int k0, k1, ktop;
+  int error = 0;
+
+
+  row = talloc(double, file->NX);
+
+  for (nsg = 0; nsg < file->num_subgrids && !error; nsg++)
+  {
+    entry = file->index + 6 * nsg;
+
+    x = entry[0];
+    y = entry[1];
+    z = entry[2];
+
+    nx = entry[3];
+    ny = entry[4];
+    nz = entry[5];
+
+    for (j = y; j < y + ny && !error; j++)
+    {
+      /* layers of the top cells in this row of the subgrid */
+      k0 = z + nz;
+      k1 = z - 1;
+      for (i = x; i < x + nx; i++)
+      {
+        ktop = *DataboxCoeff(top, i, j, 0);
+        if (ktop >= file->NZ)
+          error = 1;
+        if (ktop >= z && ktop < z + nz)
+        {
+          k0 = min(k0, ktop);
+          k1 = max(k1, ktop);
+        }
+      }
+
+      for (k = k0; k <= k1 && !error; k++)
+      {
+        fseek(file->fp, file->offsets[nsg]
+              + ((long)(k - z) * ny + (j - y)) * nx * (long)sizeof(double),
+              SEEK_SET);
+        tools_ReadDouble(file->fp, row, nx);
+
+        for (i = x; i < x + nx; i++)
+        {
+          if ((int)*DataboxCoeff(top, i, j, 0) == k)
+            *DataboxCoeff(v, i, j, 0) = row[i - x];
+        }
+      }
+    }
+  }
+
+  tfree(row);
+
+  return error;
+}
+
+
+/*-----------------------------------------------------------------------
+ * read the subbox [il,iu) x [jl,ju) x [kl,ku) of a binary `parflow'
+ * file.  The subgrid index is built from the subgrid headers and only
+ * the rows of values overlapping the subbox are read from the file.
+ *-----------------------------------------------------------------------*/
+
+Databox         *ReadParflowBSubBox(
+                                    char * file_name,
+                                    int    il,
+                                    int    jl,
+                                    int    kl,
+                                    int    iu,
+                                    int    ju,
+                                    int    ku,
+                                    double default_value)
+{
+  Databox         *v;
+
+  ParflowBFile    *file;
+
+
+  if ((file = OpenParflowB(file_name)) == NULL)
+    return NULL;
+
+  il = max(il, 0);
+  jl = max(jl, 0);
+  kl = max(kl, 0);
+  iu = min(iu, file->NX);
+  ju = min(ju, file->NY);
+  ku = min(ku, file->NZ);
+
+  /* create the new databox structure */
+  if (il >= iu || jl >= ju || kl >= ku
+      || (v = NewDataboxDefault(iu - il, ju - jl, ku - kl,
+                                file->X + il * file->DX,
+                                file->Y + jl * file->DY,
+                                file->Z + kl * file->DZ,
+                                file->DX, file->DY, file->DZ,
+                                default_value)) == NULL)
+  {
+    CloseParflowB(file);
+    return((Databox*)NULL);
+  }
+
+  ReadParflowBBox(file, v, il, jl, kl);
+
+  CloseParflowB(file);
+
+  return v;
+}
+
+
+/*-----------------------------------------------------------------------
+ * read the values of a binary `parflow' file at the top of the domain,
+ * the layer in top (see pfcomputetop) of each column.  Only the rows of
+ * each subgrid holding a top cell are read from the file.  Columns
+ * outside the domain (top < 0) are set to default_value.
+ *-----------------------------------------------------------------------*/
+
+Databox         *ReadParflowBTop(
+                                 char *    file_name,
+                                 Databox * top,
+                                 double    default_value)
+{
+  Databox         *v;
+
+  ParflowBFile    *file;
+
+
+  if ((file = OpenParflowB(file_name)) == NULL)
+    return NULL;
+
+  if (DataboxNx(top) != file->NX || DataboxNy(top) != file->NY
+      || (v = NewDataboxDefault(file->NX, file->NY, 1,
+                                file->X, file->Y, file->Z,
+                                file->DX, file->DY, file->DZ,
+                                default_value)) == NULL)
+  {
+    CloseParflowB(file);
+    return((Databox*)NULL);
+  }
+
+  if (ReadParflowBTopValues(file, top, v))
+  {
+    FreeDatabox(v);
+    v = NULL;
+  }
+
+  CloseParflowB(file);
+
+  return v;
+}
+
+
 /*-----------------------------------------------------------------------
  * read a scattered binary `parflow' file
  *-----------------------------------------------------------------------*/
@@ -482,6 +826,329 @@ Databox         *ReadParflowSB(
 }
 
 
+/*-----------------------------------------------------------------------
+ * read a compressed binary `parflow' file
+ *-----------------------------------------------------------------------*/
+
+Databox         *ReadParflowCB(
+                               char * file_name,
+                               double default_value)
+{
+  return ReadParflowCBSubBox(file_name, 0, 0, 0, INT_MAX, INT_MAX, INT_MAX,
+                             default_value);
+}
+
+
+/*-----------------------------------------------------------------------
+ * name of snapshot number `previous' of the time series of a compressed
+ * binary `parflow' file, the number is the digits before `.cpfb', returns
+ * nonzero if the name has no such number or it is the same snapshot
+ *-----------------------------------------------------------------------*/
+
+static int       CPFBPreviousName(
+                                  char * file_name,
+                                  int    previous,
+                                  char * previous_name,
+                                  int    length)
+{
+  char *suffix = strrchr(file_name, '.');
+  char *digits;
+
+  if (suffix == NULL || strcmp(suffix, ".cpfb"))
+    return 1;
+
+  for (digits = suffix; digits > file_name && isdigit(digits[-1]); digits--)
+    ;
+
+  if (digits == suffix || atoi(digits) == previous)
+    return 1;
+
+  return snprintf(previous_name, length, "%.*s%0*d%s",
+                  (int)(digits - file_name), file_name,
+                  (int)(suffix - digits), previous, suffix) >= length;
+}
+
+
+/*-----------------------------------------------------------------------
+ * read the subbox [il,iu) x [jl,ju) x [kl,ku) of a compressed binary
+ * `parflow' file, only the blocks overlapping the subbox are read.  A
+ * snapshot delta encoded against the previous snapshot of its time
+ * series reads the overlapping blocks of the previous snapshot first.
+ *-----------------------------------------------------------------------*/
+
+Databox         *ReadParflowCBSubBox(
+                                     char * file_name,
+                                     int    il,
+                                     int    jl,
+                                     int    kl,
+                                     int    iu,
+                                     int    ju,
+                                     int    ku,
+                                     double default_value)
+{
+  Databox         *v;
+
+  FILE           *fp;
+
+  double X, Y, Z;
+  int NX, NY, NZ;
+  double DX, DY, DZ;
+  int num_subgrids;
+
+  int method;
+  double tolerance;
+  int previous;
+
+  Databox        *reference = NULL;
+  char previous_name[2048];
+  int ri0, ri1, rj0, rj1, rk0, rk1;
+
+  int            *index, *entry;
+  unsigned char  *buffer;
+  double         *values, *ref_values;
+  long offset;
+
+  int x, y, z;
+  int nx, ny, nz;
+  int nsg, i, j, k;
+  int i0, i1, j0, j1, k0, k1;
+  int error = 0;
+
+
+  /* open the input file */
+  if ((fp = fopen(file_name, "rb")) == NULL)
+    return NULL;
+
+  /* read in header info */
+  tools_ReadDouble(fp, &X, 1);
+  tools_ReadDouble(fp, &Y, 1);
+  tools_ReadDouble(fp, &Z, 1);
+
+  tools_ReadInt(fp, &NX, 1);
+  tools_ReadInt(fp, &NY, 1);
+  tools_ReadInt(fp, &NZ, 1);
+
+  tools_ReadDouble(fp, &DX, 1);
+  tools_ReadDouble(fp, &DY, 1);
+  tools_ReadDouble(fp, &DZ, 1);
+
+  tools_ReadInt(fp, &num_subgrids, 1);
+
+  tools_ReadInt(fp, &method, 1);
+  tools_ReadDouble(fp, &tolerance, 1);
+  if (method & CPFB_DELTA)
+    tools_ReadInt(fp, &previous, 1);
+
+  /* the subgrid index, the blocks follow in index order */
+  index = talloc(int, 11 * num_subgrids);
+  tools_ReadInt(fp, index, 11 * num_subgrids);
+  offset = ftell(fp);
+
+  il = max(il, 0);
+  jl = max(jl, 0);
+  kl = max(kl, 0);
+  iu = min(iu, NX);
+  ju = min(ju, NY);
+  ku = min(ku, NZ);
+
+  /* create the new databox structure */
+  if (il >= iu || jl >= ju || kl >= ku
+      || (v = NewDataboxDefault(iu - il, ju - jl, ku - kl,
+                                X + il * DX, Y + jl * DY, Z + kl * DZ,
+                                DX, DY, DZ, default_value)) == NULL)
+  {
+    tfree(index);
+    fclose(fp);
+    return((Databox*)NULL);
+  }
+
+  /* read the previous snapshot over the delta encoded blocks */
+  if (method & CPFB_DELTA)
+  {
+    ri0 = rj0 = rk0 = INT_MAX;
+    ri1 = rj1 = rk1 = 0;
+
+    for (nsg = 0; nsg < num_subgrids; nsg++)
+    {
+      entry = index + 11 * nsg;
+
+      if ((entry[9] & CPFB_DELTA)
+          && max(entry[0], il) < min(entry[0] + entry[3], iu)
+          && max(entry[1], jl) < min(entry[1] + entry[4], ju)
+          && max(entry[2], kl) < min(entry[2] + entry[5], ku))
+      {
+        ri0 = min(ri0, entry[0]);
+        rj0 = min(rj0, entry[1]);
+        rk0 = min(rk0, entry[2]);
+        ri1 = max(ri1, entry[0] + entry[3]);
+        rj1 = max(rj1, entry[1] + entry[4]);
+        rk1 = max(rk1, entry[2] + entry[5]);
+      }
+    }
+
+    if (ri0 < ri1
+        && (CPFBPreviousName(file_name, previous, previous_name,
+                             sizeof(previous_name))
+            || (reference = ReadParflowCBSubBox(previous_name,
+                                                ri0, rj0, rk0,
+                                                ri1, rj1, rk1,
+                                                0.0)) == NULL
+            || DataboxNx(reference) != ri1 - ri0
+            || DataboxNy(reference) != rj1 - rj0
+            || DataboxNz(reference) != rk1 - rk0))
+    {
+      if (reference)
+        FreeDatabox(reference);
+      FreeDatabox(v);
+      tfree(index);
+      fclose(fp);
+      return((Databox*)NULL);
+    }
+  }
+
+  /* read in the blocks overlapping the subbox */
+  for (nsg = 0; nsg < num_subgrids && !error; nsg++)
+  {
+    entry = index + 11 * nsg;
+
+    x = entry[0];
+    y = entry[1];
+    z = entry[2];
+
+    nx = entry[3];
+    ny = entry[4];
+    nz = entry[5];
+
+    i0 = max(x, il);
+    j0 = max(y, jl);
+    k0 = max(z, kl);
+    i1 = min(x + nx, iu);
+    j1 = min(y + ny, ju);
+    k1 = min(z + nz, ku);
+
+    if (i0 < i1 && j0 < j1 && k0 < k1)
+    {
+      buffer = talloc(unsigned char, entry[10]);
+      values = talloc(double, nx * ny * nz);
+      ref_values = NULL;
+
+      if (entry[9] & CPFB_DELTA)
+      {
+        ref_values = talloc(double, nx * ny * nz);
+        for (k = 0; k < nz; k++)
+          for (j = 0; j < ny; j++)
+            for (i = 0; i < nx; i++)
+              ref_values[i + nx * (j + ny * k)] =
+                *DataboxCoeff(reference, x + i - ri0, y + j - rj0,
+                              z + k - rk0);
+      }
+
+      fseek(fp, offset, SEEK_SET);
+      if (fread(buffer, 1, entry[10], fp) != (size_t)entry[10]
+          || CPFBDecode(buffer, entry[10], entry[9], tolerance,
+                        ref_values, values, nx * ny * nz))
+      {
+        error = 1;
+      }
+      else
+      {
+        for (k = k0; k < k1; k++)
+          for (j = j0; j < j1; j++)
+            for (i = i0; i < i1; i++)
+              *DataboxCoeff(v, i - il, j - jl, k - kl) =
+                values[(i - x) + nx * ((j - y) + ny * (k - z))];
+      }
+
+      tfree(ref_values);
+      tfree(values);
+      tfree(buffer);
+    }
+
+    offset += entry[10];
+  }
+
+  if (reference)
+    FreeDatabox(reference);
+  tfree(index);
+  fclose(fp);
+
+  if (error)
+  {
+    FreeDatabox(v);
+    return((Databox*)NULL);
+  }
+
+  return v;
+}
+
+
+/*-----------------------------------------------------------------------
+ * read the values of a compressed binary `parflow' file at the top of
+ * the domain, as ReadParflowBTop.  Only the blocks overlapping the
+ * layers holding a top cell are read.
+ *-----------------------------------------------------------------------*/
+
+Databox         *ReadParflowCBTop(
+                                  char *    file_name,
+                                  Databox * top,
+                                  double    default_value)
+{
+  Databox         *v;
+  Databox         *layers;
+
+  int nx, ny;
+  int i, j;
+  int k0, k1, ktop;
+
+
+  nx = DataboxNx(top);
+  ny = DataboxNy(top);
+
+  k0 = INT_MAX;
+  k1 = -1;
+  for (j = 0; j < ny; j++)
+    for (i = 0; i < nx; i++)
+    {
+      ktop = *DataboxCoeff(top, i, j, 0);
+      if (ktop >= 0)
+      {
+        k0 = min(k0, ktop);
+        k1 = max(k1, ktop);
+      }
+    }
+
+  if (k1 < 0)
+    k0 = k1 = 0;
+
+  if ((layers = ReadParflowCBSubBox(file_name, 0, 0, k0, nx, ny, k1 + 1,
+                                    default_value)) == NULL)
+    return NULL;
+
+  if (DataboxNx(layers) != nx || DataboxNy(layers) != ny
+      || DataboxNz(layers) != k1 + 1 - k0
+      || (v = NewDataboxDefault(nx, ny, 1, DataboxX(layers), DataboxY(layers),
+                                DataboxZ(layers) - k0 * DataboxDz(layers),
+                                DataboxDx(layers), DataboxDy(layers),
+                                DataboxDz(layers), default_value)) == NULL)
+  {
+    FreeDatabox(layers);
+    return NULL;
+  }
+
+  for (j = 0; j < ny; j++)
+    for (i = 0; i < nx; i++)
+    {
+      ktop = *DataboxCoeff(top, i, j, 0);
+      if (ktop >= 0)
+        *DataboxCoeff(v, i, j, 0) = *DataboxCoeff(layers, i, j, ktop - k0);
+    }
+
+  FreeDatabox(layers);
+
+  return v;
+}
+
+
 /*-----------------------------------------------------------------------
  * read a `simple ascii' file
  *-----------------------------------------------------------------------*/
@@ -59,13 +59,38 @@ extern "C" {
 #define NULL ((void*)0)
 #endif
 
+/*-----------------------------------------------------------------------
+ * binary `parflow' file opened for reading subboxes
+ *-----------------------------------------------------------------------*/
+
+typedef struct {
+  FILE           *fp;
+
+  double X, Y, Z;
+  int NX, NY, NZ;
+  double DX, DY, DZ;
+
+  int num_subgrids;
+  int            *index;      /* x, y, z, nx, ny, nz of each subgrid */
+  long           *offsets;    /* file offset of the values of each subgrid */
+} ParflowBFile;
+
 /*-----------------------------------------------------------------------
  * function prototypes
  *-----------------------------------------------------------------------*/
 
 /* readdatabox.c */
 Databox *ReadParflowB(char *file_name, double default_value);
+ParflowBFile *OpenParflowB(char *file_name);
+void CloseParflowB(ParflowBFile *file);
+void ReadParflowBBox(ParflowBFile *file, Databox *v, int il, int jl, int kl);
+int ReadParflowBTopValues(ParflowBFile *file, Databox *top, Databox *v);
+Databox *ReadParflowBSubBox(char *file_name, int il, int jl, int kl, int iu, int ju, int ku, double default_value);
+Databox *ReadParflowBTop(char *file_name, Databox *top, double default_value);
 Databox *ReadParflowSB(char *file_name, double default_value);
+Databox *ReadParflowCB(char *file_name, double default_value);
+Databox *ReadParflowCBSubBox(char *file_name, int il, int jl, int kl, int iu, int ju, int ku, double default_value);
+Databox *ReadParflowCBTop(char *file_name, Databox *top, double default_value);
 Databox *ReadSimpleA(char *file_name, double default_value);
 Databox *ReadRealSA(char *file_name, double default_value);
 Databox *ReadSimpleB(char *file_name, double default_value);
@@ -0,0 +1,450 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+
+/*****************************************************************************
+* Serving pftools commands over a local socket.
+*
+* pfserve turns a tclsh with the parflow package loaded into a long lived
+* server listening on a UNIX domain socket.  Clients send Tcl commands,
+* which are evaluated in the interpreter of the server one at a time, so
+* data sets loaded by one command remain available to later commands and
+* to later clients.  Together with the Databox cache this lets repeated
+* analyses of the same run reuse the files already in memory.
+*
+* Each command sent is terminated by a newline once it is complete.  The
+* reply to each command is a line holding the Tcl return code and the
+* length of the result, followed by the result itself and a newline.
+*
+*****************************************************************************/
+
+#include "parflow_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
+
+#include "server.h"
+
+#define SERVER_BUFFER_SIZE 65536
+
+static int server_stop = 0;
+
+
+/*-----------------------------------------------------------------------
+ * Assign a failed socket operation error to the TCL result
+ *-----------------------------------------------------------------------*/
+
+static void SocketError(
+                        Tcl_Interp *interp,
+                        char *      socket_name,
+                        char *      message)
+{
+  Tcl_AppendResult(interp, "\nError: Socket `", socket_name, "': ", message,
+                   "\n", (char*)NULL);
+}
+
+#ifndef _WIN32
+
+/*-----------------------------------------------------------------------
+ * Fill in the address of a socket, returns zero if the name is too long
+ *-----------------------------------------------------------------------*/
+
+static int SocketAddress(
+                         char *              socket_name,
+                         struct sockaddr_un *address)
+{
+  if (strlen(socket_name) >= sizeof(address->sun_path))
+    return 0;
+
+  memset(address, 0, sizeof(struct sockaddr_un));
+  address->sun_family = AF_UNIX;
+  strcpy(address->sun_path, socket_name);
+
+  return 1;
+}
+
+
+/*-----------------------------------------------------------------------
+ * Write all of a buffer to a socket, returns zero on failure
+ *-----------------------------------------------------------------------*/
+
+static int WriteAll(
+                    int         fd,
+                    const char *buffer,
+                    size_t      length)
+{
+  ssize_t written;
+
+  while (length > 0)
+  {
+    if ((written = write(fd, buffer, length)) < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return 0;
+    }
+
+    buffer += written;
+    length -= written;
+  }
+
+  return 1;
+}
+
+
+/*-----------------------------------------------------------------------
+ * Evaluate the complete commands at the start of the buffered input of a
+ * connection and send back their results.  The evaluated commands are
+ * removed from the buffer.  Returns zero if a reply could not be sent.
+ *-----------------------------------------------------------------------*/
+
+static int ServeCommands(
+                         Tcl_Interp * interp,
+                         int          fd,
+                         Tcl_DString *input)
+{
+  char       *start;
+  char       *end;
+  char       *newline;
+  char header[64];
+  const char *result;
+  int code;
+  int length;
+  int ok = 1;
+
+  start = Tcl_DStringValue(input);
+  end = start + Tcl_DStringLength(input);
+  newline = start;
+
+  while (ok && !server_stop
+         && (newline = memchr(newline, '\n', end - newline)) != NULL)
+  {
+    newline++;
+
+    *(newline - 1) = '\0';
+    if (!Tcl_CommandComplete(start))
+    {
+      *(newline - 1) = '\n';
+      continue;
+    }
+
+    code = Tcl_EvalEx(interp, start, -1, TCL_EVAL_GLOBAL);
+    if (code == TCL_RETURN)
+      code = TCL_OK;
+
+    result = Tcl_GetStringResult(interp);
+    length = strlen(result);
+
+    sprintf(header, "%d %d\n", code, length);
+    ok = WriteAll(fd, header, strlen(header))
+         && WriteAll(fd, result, length)
+         && WriteAll(fd, "\n", 1);
+
+    Tcl_ResetResult(interp);
+
+    start = newline;
+  }
+
+  length = end - start;
+  memmove(Tcl_DStringValue(input), start, length);
+  Tcl_DStringSetLength(input, length);
+
+  return ok;
+}
+
+
+/*-----------------------------------------------------------------------
+ * Serve the commands of one client until it closes the connection
+ *-----------------------------------------------------------------------*/
+
+static void ServeConnection(
+                            Tcl_Interp *interp,
+                            int         fd)
+{
+  Tcl_DString input;
+  char buffer[SERVER_BUFFER_SIZE];
+  ssize_t count;
+
+  Tcl_DStringInit(&input);
+
+  while (!server_stop)
+  {
+    if ((count = read(fd, buffer, SERVER_BUFFER_SIZE)) < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+
+    if (count == 0)
+      break;
+
+    Tcl_DStringAppend(&input, buffer, count);
+
+    if (!ServeCommands(interp, fd, &input))
+      break;
+  }
+
+  Tcl_DStringFree(&input);
+}
+
+#endif
+
+
+/*-----------------------------------------------------------------------
+ * ServeSocket:
+ *   Listen on a UNIX domain socket and evaluate the commands sent by
+ *   clients until StopServer is called by one of the commands.  The
+ *   socket is only accessible by the user running the server.
+ *-----------------------------------------------------------------------*/
+
+int ServeSocket(
+                Tcl_Interp *interp,
+                char *      socket_name)
+{
+#ifdef _WIN32
+  SocketError(interp, socket_name, "UNIX domain sockets are not supported");
+  return TCL_ERROR;
+#else
+  struct sockaddr_un address;
+  struct stat file_stat;
+  int listen_fd;
+  int fd;
+  void (*old_handler)(int);
+  mode_t old_mask;
+
+  if (!SocketAddress(socket_name, &address))
+  {
+    SocketError(interp, socket_name, "name is too long");
+    return TCL_ERROR;
+  }
+
+  if ((listen_fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+  {
+    SocketError(interp, socket_name, strerror(errno));
+    return TCL_ERROR;
+  }
+
+  /*
+   * The socket is created accessible only by its owner, so no other user
+   * can connect between bind and chmod
+   */
+  old_mask = umask(S_IRWXG | S_IRWXO);
+
+  /* Replace a socket left behind by a server that is no longer running */
+  if (bind(listen_fd, (struct sockaddr*)&address, sizeof(address)) < 0)
+  {
+    if (errno == EADDRINUSE
+        && stat(socket_name, &file_stat) == 0 && S_ISSOCK(file_stat.st_mode)
+        && (fd = socket(AF_UNIX, SOCK_STREAM, 0)) >= 0)
+    {
+      if (connect(fd, (struct sockaddr*)&address, sizeof(address)) < 0
+          && errno == ECONNREFUSED)
+        unlink(socket_name);
+      close(fd);
+    }
+
+    if (bind(listen_fd, (struct sockaddr*)&address, sizeof(address)) < 0)
+    {
+      SocketError(interp, socket_name, strerror(errno));
+      umask(old_mask);
+      close(listen_fd);
+      return TCL_ERROR;
+    }
+  }
+
+  umask(old_mask);
+
+  if (chmod(socket_name, S_IRUSR | S_IWUSR) < 0 || listen(listen_fd, 8) < 0)
+  {
+    SocketError(interp, socket_name, strerror(errno));
+    close(listen_fd);
+    unlink(socket_name);
+    return TCL_ERROR;
+  }
+
+  /* A client going away must not terminate the server */
+  old_handler = signal(SIGPIPE, SIG_IGN);
+
+  server_stop = 0;
+
+  while (!server_stop)
+  {
+    if ((fd = accept(listen_fd, NULL, NULL)) < 0)
+    {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      break;
+    }
+
+    ServeConnection(interp, fd);
+
+    close(fd);
+  }
+
+  signal(SIGPIPE, old_handler);
+
+  close(listen_fd);
+  unlink(socket_name);
+
+  Tcl_ResetResult(interp);
+
+  if (!server_stop)
+  {
+    SocketError(interp, socket_name, strerror(errno));
+    return TCL_ERROR;
+  }
+
+  server_stop = 0;
+
+  return TCL_OK;
+#endif
+}
+
+
+/*-----------------------------------------------------------------------
+ * StopServer:
+ *   Stop serving once the reply to the current command has been sent
+ *-----------------------------------------------------------------------*/
+
+void StopServer()
+{
+  server_stop = 1;
+}
+
+
+/*-----------------------------------------------------------------------
+ * SendToServer:
+ *   Send a script to a server, which evaluates it as a single command,
+ *   and set the result of the interpreter to the result of the script.
+ *   Returns TCL_ERROR if the script failed on the server.
+ *-----------------------------------------------------------------------*/
+
+int SendToServer(
+                 Tcl_Interp *interp,
+                 char *      socket_name,
+                 char *      script)
+{
+#ifdef _WIN32
+  SocketError(interp, socket_name, "UNIX domain sockets are not supported");
+  return TCL_ERROR;
+#else
+  struct sockaddr_un address;
+  Tcl_DString command;
+  Tcl_DString reply;
+  char buffer[SERVER_BUFFER_SIZE];
+  char       *newline;
+  ssize_t count;
+  int fd;
+  int code;
+  int length;
+  int ok;
+
+  if (!SocketAddress(socket_name, &address))
+  {
+    SocketError(interp, socket_name, "name is too long");
+    return TCL_ERROR;
+  }
+
+  if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+  {
+    SocketError(interp, socket_name, strerror(errno));
+    return TCL_ERROR;
+  }
+
+  if (connect(fd, (struct sockaddr*)&address, sizeof(address)) < 0)
+  {
+    SocketError(interp, socket_name, strerror(errno));
+    close(fd);
+    return TCL_ERROR;
+  }
+
+  /* Send the script as one eval command so it gets a single reply */
+  Tcl_DStringInit(&command);
+  Tcl_DStringAppendElement(&command, "eval");
+  Tcl_DStringAppendElement(&command, script);
+  Tcl_DStringAppend(&command, "\n", 1);
+
+  ok = WriteAll(fd, Tcl_DStringValue(&command), Tcl_DStringLength(&command));
+  Tcl_DStringFree(&command);
+
+  if (ok)
+    shutdown(fd, SHUT_WR);
+
+  Tcl_DStringInit(&reply);
+
+  while (ok)
+  {
+    if ((count = read(fd, buffer, SERVER_BUFFER_SIZE)) < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      ok = 0;
+    }
+    else if (count == 0)
+      break;
+    else
+      Tcl_DStringAppend(&reply, buffer, count);
+  }
+
+  close(fd);
+
+  if (ok)
+  {
+    newline = memchr(Tcl_DStringValue(&reply), '\n', Tcl_DStringLength(&reply));
+    ok = newline != NULL
+         && sscanf(Tcl_DStringValue(&reply), "%d %d", &code, &length) == 2
+         && length >= 0
+         && newline + 1 + length <= Tcl_DStringValue(&reply)
+         + Tcl_DStringLength(&reply);
+  }
+
+  if (!ok)
+  {
+    Tcl_DStringFree(&reply);
+    SocketError(interp, socket_name, "no reply from the server");
+    return TCL_ERROR;
+  }
+
+  *(newline + 1 + length) = '\0';
+  Tcl_SetResult(interp, newline + 1, TCL_VOLATILE);
+  Tcl_DStringFree(&reply);
+
+  return (code == TCL_OK) ? TCL_OK : TCL_ERROR;
+#endif
+}
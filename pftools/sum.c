@@ -27,6 +27,7 @@
  **********************************************************************EHEADER*/
 
 #include "databox.h"
+#include "parallel.h"
 
 
 /*****************************************************************************
@@ -63,89 +64,113 @@ void       Sum(Databox *X, double *sum)
 
 
 /*-----------------------------------------------------------------------
- * Compute x = cell-wise sum of X and Y
+ * Cell-wise operations, threaded over the rows of X.  Y is NULL for an
+ * operation with the constant val.
  *-----------------------------------------------------------------------*/
-void       CellSum(Databox *X, Databox *Y, Databox *mask, Databox *sum)
-{
-  int m, nx, ny, nz;
-  double         *xp, *yp;
-  double         *mask_val;
-  double         *sum_val;
 
-  nx = DataboxNx(X);
-  ny = DataboxNy(X);
-  nz = DataboxNz(X);
+typedef enum {
+  CellAdd,
+  CellSubtract,
+  CellMultiply,
+  CellDivide
+} CellOperator;
+
+typedef struct {
+  CellOperator op;
+  double      *xp, *yp;
+  double val;
+  double      *mask_val;
+  double      *result_val;
+  int nx;
+} CellOpArgs;
+
+static void CellOpRows(void *arg, int lo, int hi, int thread)
+{
+  CellOpArgs     *args = (CellOpArgs*)arg;
+  double         *xp = args->xp;
+  double         *yp = args->yp;
+  double         *mask_val = args->mask_val;
+  double         *result_val = args->result_val;
+  double val = args->val;
+  int m, m_end;
 
-  xp = DataboxCoeffs(X);
-  yp = DataboxCoeffs(Y);
-  mask_val = DataboxCoeffs(mask);
-  sum_val = DataboxCoeffs(sum);
+  m_end = hi * args->nx;
 
-  for (m = 0; m < (nx * ny * nz); m++)
+  for (m = lo * args->nx; m < m_end; m++)
   {
     if (mask_val[m] > 0)
     {
-      sum_val[m] = xp[m] + yp[m];
+      if (yp)
+        val = yp[m];
+
+      switch (args->op)
+      {
+        case CellAdd:
+          result_val[m] = xp[m] + val;
+          break;
+
+        case CellSubtract:
+          result_val[m] = xp[m] - val;
+          break;
+
+        case CellMultiply:
+          result_val[m] = xp[m] * val;
+          break;
+
+        case CellDivide:
+          result_val[m] = xp[m] / val;
+          break;
+      }
     }
   }
 }
 
-
-/*-----------------------------------------------------------------------
- * Compute x = cell-wise difference of X and Y
- *-----------------------------------------------------------------------*/
-void       CellDiff(Databox *X, Databox *Y, Databox *mask, Databox *diff)
+static void CellOp(CellOperator op, Databox *X, Databox *Y, double val,
+                   Databox *mask, Databox *result)
 {
-  int m, nx, ny, nz;
-  double         *xp, *yp;
-  double         *mask_val;
-  double         *diff_val;
+  CellOpArgs args;
+  int nx, ny, nz;
 
   nx = DataboxNx(X);
   ny = DataboxNy(X);
   nz = DataboxNz(X);
 
-  xp = DataboxCoeffs(X);
-  yp = DataboxCoeffs(Y);
-  mask_val = DataboxCoeffs(mask);
-  diff_val = DataboxCoeffs(diff);
+  args.op = op;
+  args.xp = DataboxCoeffs(X);
+  args.yp = Y ? DataboxCoeffs(Y) : NULL;
+  args.val = val;
+  args.mask_val = DataboxCoeffs(mask);
+  args.result_val = DataboxCoeffs(result);
+  args.nx = nx;
 
-  for (m = 0; m < (nx * ny * nz); m++)
-  {
-    if (mask_val[m] > 0)
-    {
-      diff_val[m] = xp[m] - yp[m];
-    }
-  }
+  ParallelFor(ny * nz, (double)nx * ny * nz, CellOpRows, &args);
 }
 
 
 /*-----------------------------------------------------------------------
- * Compute x = cell-wise product of X and Y
+ * Compute x = cell-wise sum of X and Y
  *-----------------------------------------------------------------------*/
-void       CellMult(Databox *X, Databox *Y, Databox *mask, Databox *mult)
+void       CellSum(Databox *X, Databox *Y, Databox *mask, Databox *sum)
 {
-  int m, nx, ny, nz;
-  double         *xp, *yp;
-  double         *mask_val;
-  double         *mult_val;
+  CellOp(CellAdd, X, Y, 0.0, mask, sum);
+}
 
-  nx = DataboxNx(X);
-  ny = DataboxNy(X);
-  nz = DataboxNz(X);
 
-  xp = DataboxCoeffs(X);
-  yp = DataboxCoeffs(Y);
-  mask_val = DataboxCoeffs(mask);
-  mult_val = DataboxCoeffs(mult);
+/*-----------------------------------------------------------------------
+ * Compute x = cell-wise difference of X and Y
+ *-----------------------------------------------------------------------*/
+void       CellDiff(Databox *X, Databox *Y, Databox *mask, Databox *diff)
+{
+  CellOp(CellSubtract, X, Y, 0.0, mask, diff);
+}
 
-  for (m = 0; m < (nx * ny * nz); m++)
-  {
-    if (mask_val[m] > 0)
-    {
-      mult_val[m] = xp[m] * yp[m];
-    }
-  }
+
+/*-----------------------------------------------------------------------
+ * Compute x = cell-wise product of X and Y
+ *-----------------------------------------------------------------------*/
+void       CellMult(Databox *X, Databox *Y, Databox *mask, Databox *mult)
+{
+  CellOp(CellMultiply, X, Y, 0.0, mask, mult);
 }
 
 
@@ -154,27 +179,7 @@ void       CellMult(Databox *X, Databox *Y, Databox *mask, Databox *mult)
  *-----------------------------------------------------------------------*/
 void       CellDiv(Databox *X, Databox *Y, Databox *mask, Databox *div)
 {
-  int m, nx, ny, nz;
-  double         *xp, *yp;
-  double         *mask_val;
-  double         *div_val;
-
-  nx = DataboxNx(X);
-  ny = DataboxNy(X);
-  nz = DataboxNz(X);
-
-  xp = DataboxCoeffs(X);
-  yp = DataboxCoeffs(Y);
-  mask_val = DataboxCoeffs(mask);
-  div_val = DataboxCoeffs(div);
-
-  for (m = 0; m < (nx * ny * nz); m++)
-  {
-    if (mask_val[m] > 0)
-    {
-      div_val[m] = xp[m] / yp[m];
-    }
-  }
+  CellOp(CellDivide, X, Y, 0.0, mask, div);
 }
 
 
@@ -183,26 +188,7 @@ void       CellDiv(Databox *X, Databox *Y, Databox *mask, Databox *div)
  *-----------------------------------------------------------------------*/
 void       CellSumConst(Databox *X, double val, Databox *mask, Databox *sum)
 {
-  int m, nx, ny, nz;
-  double         *xp;
-  double         *mask_val;
-  double         *sum_val;
-
-  nx = DataboxNx(X);
-  ny = DataboxNy(X);
-  nz = DataboxNz(X);
-
-  xp = DataboxCoeffs(X);
-  mask_val = DataboxCoeffs(mask);
-  sum_val = DataboxCoeffs(sum);
-
-  for (m = 0; m < (nx * ny * nz); m++)
-  {
-    if (mask_val[m] > 0)
-    {
-      sum_val[m] = xp[m] + val;
-    }
-  }
+  CellOp(CellAdd, X, NULL, val, mask, sum);
 }
 
 
@@ -211,26 +197,7 @@ void       CellSumConst(Databox *X, double val, Databox *mask, Databox *sum)
  *-----------------------------------------------------------------------*/
 void       CellDiffConst(Databox *X, double val, Databox *mask, Databox *diff)
 {
-  int m, nx, ny, nz;
-  double         *xp;
-  double         *mask_val;
-  double         *diff_val;
-
-  nx = DataboxNx(X);
-  ny = DataboxNy(X);
-  nz = DataboxNz(X);
-
-  xp = DataboxCoeffs(X);
-  mask_val = DataboxCoeffs(mask);
-  diff_val = DataboxCoeffs(diff);
-
-  for (m = 0; m < (nx * ny * nz); m++)
-  {
-    if (mask_val[m] > 0)
-    {
-      diff_val[m] = xp[m] - val;
-    }
-  }
+  CellOp(CellSubtract, X, NULL, val, mask, diff);
 }
 
 
@@ -239,26 +206,7 @@ void       CellDiffConst(Databox *X, double val, Databox *mask, Databox *diff)
  *-----------------------------------------------------------------------*/
 void       CellMultConst(Databox *X, double val, Databox *mask, Databox *mult)
 {
-  int m, nx, ny, nz;
-  double         *xp;
-  double         *mask_val;
-  double         *mult_val;
-
-  nx = DataboxNx(X);
-  ny = DataboxNy(X);
-  nz = DataboxNz(X);
-
-  xp = DataboxCoeffs(X);
-  mask_val = DataboxCoeffs(mask);
-  mult_val = DataboxCoeffs(mult);
-
-  for (m = 0; m < (nx * ny * nz); m++)
-  {
-    if (mask_val[m] > 0)
-    {
-      mult_val[m] = xp[m] * val;
-    }
-  }
+  CellOp(CellMultiply, X, NULL, val, mask, mult);
 }
 
 
@@ -267,25 +215,5 @@ void       CellMultConst(Databox *X, double val, Databox *mask, Databox *mult)
  *-----------------------------------------------------------------------*/
 void       CellDivConst(Databox *X, double val, Databox *mask, Databox *div)
 {
-  int m, nx, ny, nz;
-  double         *xp;
-  double         *mask_val;
-  double         *div_val;
-
-  nx = DataboxNx(X);
-  ny = DataboxNy(X);
-  nz = DataboxNz(X);
-
-  xp = DataboxCoeffs(X);
-  mask_val = DataboxCoeffs(mask);
-  div_val = DataboxCoeffs(div);
-
-  for (m = 0; m < (nx * ny * nz); m++)
-  {
-    if (mask_val[m] > 0)
-    {
-      div_val[m] = xp[m] / val;
-    }
-  }
+  CellOp(CellDivide, X, NULL, val, mask, div);
 }
-
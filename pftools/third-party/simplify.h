@@ -301,13 +301,17 @@ namespace Simplify
 	  
 	  bool used;
 	  int new_index;
+
+	  // Locked vertices are treated as border vertices and never removed
+	  bool locked;
 	};
 
 
+	// Each thread simplifies its own mesh
 	struct Ref { int tid,tvertex; };
-	std::vector<Triangle> triangles;
-	std::vector<Vertex> vertices;
-	std::vector<Ref> refs;
+	thread_local std::vector<Triangle> triangles;
+	thread_local std::vector<Vertex> vertices;
+	thread_local std::vector<Ref> refs;
 
 	double heron(double a, double b,double c)
 	{
@@ -807,7 +811,7 @@ namespace Simplify
 			std::vector<int> vcount,vids;
 
 			loopi(0,vertices.size())
-				vertices[i].border=0;
+				vertices[i].border=vertices[i].locked;
 
 			loopi(0,vertices.size())
 			{
@@ -0,0 +1,337 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+
+/*****************************************************************************
+* Streaming reductions over a time series of binary `parflow' files.
+*
+* Each timestep is read one layer at a time, so the memory used does not
+* depend on the number of layers or timesteps.  The layers are reduced
+* with the same kernels and in the same order as pfgetstats, pfsum,
+* pfsubsurfacestorage, pfsurfacestorage and pfsurfacerunoff on the fully
+* loaded files, giving the same results.
+*
+*****************************************************************************/
+
+#include "time_series.h"
+#include "readdatabox.h"
+#include "water_balance.h"
+#include "general.h"
+
+#include <ctype.h>
+#include <float.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+/*-----------------------------------------------------------------------
+ * SeriesFileName:
+ *
+ * Name of the file of a timestep, pattern is a printf format with a
+ * single integer conversion such as `run.out.press.%05d.pfb'.  Returns
+ * nonzero if pattern is not such a format or the name is too long.
+ *
+ *-----------------------------------------------------------------------*/
+
+int SeriesFileName(
+                   char *pattern,
+                   int   timestep,
+                   char *file_name,
+                   int   length)
+{
+  char *conversion = NULL;
+  char *c;
+
+  for (c = pattern; *c; c++)
+  {
+    if (*c != '%')
+      continue;
+
+    if (c[1] == '%')
+    {
+      c++;
+      continue;
+    }
+
+    if (conversion)
+      return 1;
+
+    conversion = c++;
+    if (*c == '0')
+      c++;
+    while (isdigit(*c))
+      c++;
+    if (*c != 'd')
+      return 1;
+  }
+
+  if (conversion == NULL)
+    return 1;
+
+  return snprintf(file_name, length, pattern, timestep) >= length;
+}
+
+
+/*-----------------------------------------------------------------------
+ * PrefetchSeriesFile:
+ *
+ * Ask the operating system to start reading a file that will be reduced
+ * next, so reading it overlaps the reduction of the current file.
+ *
+ *-----------------------------------------------------------------------*/
+
+void PrefetchSeriesFile(
+                        char *file_name)
+{
+#ifdef POSIX_FADV_WILLNEED
+  int fd;
+
+  if ((fd = open(file_name, O_RDONLY)) >= 0)
+  {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+  }
+#endif
+}
+
+
+/*-----------------------------------------------------------------------
+ * ReduceSeriesStep:
+ *
+ * Reduce the pressure file of one timestep to its min, max, mean and
+ * sum.  With a saturation file the total subsurface storage is computed
+ * from mask, porosity and specific_storage, and with top the total
+ * surface storage and the total surface runoff from slope_x, slope_y and
+ * mannings.  saturation_name and top may be NULL.
+ *
+ * Returns 0, SERIES_READ_ERROR if a file can not be read or
+ * SERIES_DIMENSION_ERROR if the files and data sets do not match.
+ *
+ *-----------------------------------------------------------------------*/
+
+int ReduceSeriesStep(
+                     char *      pressure_name,
+                     char *      saturation_name,
+                     Databox *   mask,
+                     Databox *   porosity,
+                     Databox *   specific_storage,
+                     Databox *   top,
+                     Databox *   slope_x,
+                     Databox *   slope_y,
+                     Databox *   mannings,
+                     SeriesStep *step)
+{
+  ParflowBFile   *pressure_file;
+  ParflowBFile   *saturation_file = NULL;
+
+  Databox        *pressure;
+  Databox        *saturation = NULL;
+  Databox        *storage = NULL;
+  Databox        *active = NULL;
+  Databox        *pressure_top = NULL;
+  Databox        *surface = NULL;
+
+  Databox mask_layer, porosity_layer, specific_storage_layer;
+
+  double         *p;
+
+  int nx, ny, nz;
+  int i, j, k, m, ktop;
+  int error = 0;
+
+
+  if ((pressure_file = OpenParflowB(pressure_name)) == NULL)
+    return SERIES_READ_ERROR;
+
+  nx = pressure_file->NX;
+  ny = pressure_file->NY;
+  nz = pressure_file->NZ;
+
+  if (saturation_name
+      && (saturation_file = OpenParflowB(saturation_name)) == NULL)
+  {
+    CloseParflowB(pressure_file);
+    return SERIES_READ_ERROR;
+  }
+
+  if ((saturation_file && (saturation_file->NX != nx
+                           || saturation_file->NY != ny
+                           || saturation_file->NZ != nz
+                           || DataboxNx(mask) != nx || DataboxNy(mask) != ny
+                           || DataboxNz(mask) != nz
+                           || DataboxNx(porosity) != nx
+                           || DataboxNy(porosity) != ny
+                           || DataboxNz(porosity) != nz
+                           || DataboxNx(specific_storage) != nx
+                           || DataboxNy(specific_storage) != ny
+                           || DataboxNz(specific_storage) != nz))
+      || (top && (DataboxNx(top) != nx || DataboxNy(top) != ny
+                  || DataboxNx(slope_x) != nx || DataboxNy(slope_x) != ny
+                  || DataboxNx(slope_y) != nx || DataboxNy(slope_y) != ny
+                  || DataboxNx(mannings) != nx || DataboxNy(mannings) != ny)))
+  {
+    CloseParflowB(saturation_file);
+    CloseParflowB(pressure_file);
+    return SERIES_DIMENSION_ERROR;
+  }
+
+  /* one layer of the files */
+  pressure = NewDatabox(nx, ny, 1, pressure_file->X, pressure_file->Y,
+                        pressure_file->Z, pressure_file->DX,
+                        pressure_file->DY, pressure_file->DZ);
+
+  if (saturation_file)
+  {
+    saturation = NewDatabox(nx, ny, 1, pressure_file->X, pressure_file->Y,
+                            pressure_file->Z, pressure_file->DX,
+                            pressure_file->DY, pressure_file->DZ);
+    storage = NewDatabox(nx, ny, 1, pressure_file->X, pressure_file->Y,
+                         pressure_file->Z, pressure_file->DX,
+                         pressure_file->DY, pressure_file->DZ);
+  }
+
+  /* the surface cells, active is the top of the single layer of */
+  /* pressure_top                                                */
+  if (top)
+  {
+    active = NewDatabox(nx, ny, 1, pressure_file->X, pressure_file->Y,
+                        pressure_file->Z, pressure_file->DX,
+                        pressure_file->DY, pressure_file->DZ);
+    pressure_top = NewDatabox(nx, ny, 1, pressure_file->X, pressure_file->Y,
+                              pressure_file->Z, pressure_file->DX,
+                              pressure_file->DY, pressure_file->DZ);
+    surface = NewDatabox(nx, ny, 1, pressure_file->X, pressure_file->Y,
+                         pressure_file->Z, pressure_file->DX,
+                         pressure_file->DY, pressure_file->DZ);
+
+    for (j = 0; j < ny; j++)
+      for (i = 0; i < nx; i++)
+      {
+        ktop = *DataboxCoeff(top, i, j, 0);
+        if (ktop >= nz)
+          error = SERIES_DIMENSION_ERROR;
+        *DataboxCoeff(active, i, j, 0) = (ktop < 0) ? -1.0 : 0.0;
+      }
+  }
+
+  step->min = DBL_MAX;
+  step->max = -DBL_MAX;
+  step->sum = 0.0;
+  step->subsurface_storage = 0.0;
+  step->surface_storage = 0.0;
+  step->surface_runoff = 0.0;
+
+  for (k = 0; k < nz && !error; k++)
+  {
+    ReadParflowBBox(pressure_file, pressure, 0, 0, k);
+
+    p = DataboxCoeffs(pressure);
+    for (m = 0; m < nx * ny; m++)
+    {
+      if (p[m] < step->min)
+        step->min = p[m];
+
+      if (p[m] > step->max)
+        step->max = p[m];
+
+      step->sum += p[m];
+    }
+
+    if (saturation_file)
+    {
+      ReadParflowBBox(saturation_file, saturation, 0, 0, k);
+
+      /* layer k of the data sets */
+      mask_layer = *mask;
+      DataboxCoeffs(&mask_layer) = DataboxCoeff(mask, 0, 0, k);
+      DataboxNz(&mask_layer) = 1;
+      porosity_layer = *porosity;
+      DataboxCoeffs(&porosity_layer) = DataboxCoeff(porosity, 0, 0, k);
+      DataboxNz(&porosity_layer) = 1;
+      specific_storage_layer = *specific_storage;
+      DataboxCoeffs(&specific_storage_layer) =
+        DataboxCoeff(specific_storage, 0, 0, k);
+      DataboxNz(&specific_storage_layer) = 1;
+
+      memset(DataboxCoeffs(storage), 0, nx * ny * sizeof(double));
+      ComputeSubsurfaceStorage(&mask_layer, &porosity_layer, pressure,
+                               saturation, &specific_storage_layer, storage);
+
+      p = DataboxCoeffs(storage);
+      for (m = 0; m < nx * ny; m++)
+        step->subsurface_storage += p[m];
+    }
+
+    if (top)
+    {
+      for (j = 0; j < ny; j++)
+        for (i = 0; i < nx; i++)
+        {
+          if ((int)*DataboxCoeff(top, i, j, 0) == k)
+            *DataboxCoeff(pressure_top, i, j, 0) =
+              *DataboxCoeff(pressure, i, j, 0);
+        }
+    }
+  }
+
+  step->mean = step->sum / ((double)nx * ny * nz);
+
+  if (top && !error)
+  {
+    ComputeSurfaceStorage(active, pressure_top, surface);
+
+    p = DataboxCoeffs(surface);
+    for (m = 0; m < nx * ny; m++)
+      step->surface_storage += p[m];
+
+    memset(DataboxCoeffs(surface), 0, nx * ny * sizeof(double));
+    ComputeSurfaceRunoff(active, slope_x, slope_y, mannings, pressure_top,
+                         surface);
+
+    for (m = 0; m < nx * ny; m++)
+      step->surface_runoff += p[m];
+  }
+
+  if (surface)
+    FreeDatabox(surface);
+  if (pressure_top)
+    FreeDatabox(pressure_top);
+  if (active)
+    FreeDatabox(active);
+  if (storage)
+    FreeDatabox(storage);
+  if (saturation)
+    FreeDatabox(saturation);
+  FreeDatabox(pressure);
+
+  CloseParflowB(saturation_file);
+  CloseParflowB(pressure_file);
+
+  return error;
+}
@@ -0,0 +1,82 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+#ifndef TIME_SERIES_HEADER
+#define TIME_SERIES_HEADER
+
+#include "databox.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------------------
+ * aggregates of one timestep of a time series
+ *-----------------------------------------------------------------------*/
+
+typedef struct {
+  double min, max, mean, sum;
+
+  double subsurface_storage;
+  double surface_storage;
+  double surface_runoff;
+} SeriesStep;
+
+/* error returns of ReduceSeriesStep */
+#define SERIES_READ_ERROR      1
+#define SERIES_DIMENSION_ERROR 2
+
+/*-----------------------------------------------------------------------
+ * function prototypes
+ *-----------------------------------------------------------------------*/
+
+int SeriesFileName(
+                   char *pattern,
+                   int   timestep,
+                   char *file_name,
+                   int   length);
+
+void PrefetchSeriesFile(
+                        char *file_name);
+
+int ReduceSeriesStep(
+                     char *      pressure_name,
+                     char *      saturation_name,
+                     Databox *   mask,
+                     Databox *   porosity,
+                     Databox *   specific_storage,
+                     Databox *   top,
+                     Databox *   slope_x,
+                     Databox *   slope_y,
+                     Databox *   mannings,
+                     SeriesStep *step);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -26,25 +26,37 @@
  *  USA
  **********************************************************************EHEADER*/
 #include "toposlopes.h"
+#include "parallel.h"
+#include "general.h"
 #include <math.h>
+#include <string.h>
 
 
 /*-----------------------------------------------------------------------
- * ComputeSlopeXUpwind:
- *
- * Calculate the topographic slope at [i,j] in the x-direction using a first-
- * order upwind finite difference scheme.
+ * Arguments of the slope kernels, which are threaded over rows j of the
+ * DEM.  arbcount has one counter per thread.
+ *-----------------------------------------------------------------------*/
+
+typedef struct {
+  Databox *dem;
+  Databox *slope;
+  double d;
+  int     *arbcount;
+} SlopeArgs;
+
+
+/*-----------------------------------------------------------------------
+ * SlopeXUpwindRows:
  *
- * If cell is a local maximum in x, largest downward slope to neightbor is used.
- * If cell is a local minimum in x, slope is set to zero (no drainage in x).
- * Otherwise, upwind slope is used (slope from parent to [i,j]).
+ * Rows [lo, hi) of the x-direction upwind slopes, see ComputeSlopeXUpwind.
  *
  *-----------------------------------------------------------------------*/
-void ComputeSlopeXUpwind(
-                         Databox *dem,
-                         double   dx,
-                         Databox *sx)
+static void SlopeXUpwindRows(void *arg, int lo, int hi, int thread)
 {
+  SlopeArgs *args = (SlopeArgs*)arg;
+  Databox   *dem = args->dem;
+  double dx = args->d;
+  Databox   *sx = args->slope;
   int i, j;
   int nx, ny;
   double s1, s2;
@@ -53,7 +65,7 @@ void ComputeSlopeXUpwind(
   ny = DataboxNy(dem);
 
   // Loop over all [i,j]
-  for (j = 0; j < ny; j++)
+  for (j = lo; j < hi; j++)
   {
     for (i = 0; i < nx; i++)
     {
@@ -197,24 +209,47 @@ void ComputeSlopeXUpwind(
       }
     }    // end loop over i
   }  // end loop over j
-} // END FUNCTION:  ComputeSlopeXUpwind
+}
 
 /*-----------------------------------------------------------------------
- * ComputeSlopeYUpwind:
+ * ComputeSlopeXUpwind:
  *
- * Calculate the topographic slope at [i,j] in the y-direction using a first-
+ * Calculate the topographic slope at [i,j] in the x-direction using a first-
  * order upwind finite difference scheme.
  *
- * If cell is a local maximum in y, largest downward slope to neightbor is used.
- * If cell is a local minimum in y, slope is set to zero (no drainage in y).
+ * If cell is a local maximum in x, largest downward slope to neightbor is used.
+ * If cell is a local minimum in x, slope is set to zero (no drainage in x).
  * Otherwise, upwind slope is used (slope from parent to [i,j]).
  *
  *-----------------------------------------------------------------------*/
-void ComputeSlopeYUpwind(
+void ComputeSlopeXUpwind(
                          Databox *dem,
-                         double   dy,
-                         Databox *sy)
+                         double   dx,
+                         Databox *sx)
+{
+  SlopeArgs args;
+
+  args.dem = dem;
+  args.slope = sx;
+  args.d = dx;
+  args.arbcount = NULL;
+
+  ParallelFor(DataboxNy(dem), (double)DataboxNx(dem) * DataboxNy(dem),
+              SlopeXUpwindRows, &args);
+} // END FUNCTION:  ComputeSlopeXUpwind
+
+/*-----------------------------------------------------------------------
+ * SlopeYUpwindRows:
+ *
+ * Rows [lo, hi) of the y-direction upwind slopes, see ComputeSlopeYUpwind.
+ *
+ *-----------------------------------------------------------------------*/
+static void SlopeYUpwindRows(void *arg, int lo, int hi, int thread)
 {
+  SlopeArgs *args = (SlopeArgs*)arg;
+  Databox   *dem = args->dem;
+  double dy = args->d;
+  Databox   *sy = args->slope;
   int i, j;
   int nx, ny;
   double s1, s2;
@@ -223,7 +258,7 @@ void ComputeSlopeYUpwind(
   ny = DataboxNy(dem);
 
   // Loop over all [i,j]
-  for (j = 0; j < ny; j++)
+  for (j = lo; j < hi; j++)
   {
     for (i = 0; i < nx; i++)
     {
@@ -367,24 +402,47 @@ void ComputeSlopeYUpwind(
       }
     }    // end loop over i
   }  // end loop over j
-} // END FUNCTION: CompuateSlopeYUpwind
-
+}
 
 /*-----------------------------------------------------------------------
- * ComputeSlopeXD4:
+ * ComputeSlopeYUpwind:
  *
- * Calculate the topographic slope at [i,j] in the x-direction based on D4 method
- * (Same as common D8, but no diagonal slopes -- adjacent only)
+ * Calculate the topographic slope at [i,j] in the y-direction using a first-
+ * order upwind finite difference scheme.
  *
- * D4 sets slope at each cell as the maximum downward gradient to an adjacent cell;
- * If max down grad is in x, SX gets set; if max down grad is in y, SX==0.
+ * If cell is a local maximum in y, largest downward slope to neightbor is used.
+ * If cell is a local minimum in y, slope is set to zero (no drainage in y).
+ * Otherwise, upwind slope is used (slope from parent to [i,j]).
  *
  *-----------------------------------------------------------------------*/
-void ComputeSlopeXD4(
-                     Databox *dem,
-                     Databox *sx)
+void ComputeSlopeYUpwind(
+                         Databox *dem,
+                         double   dy,
+                         Databox *sy)
+{
+  SlopeArgs args;
+
+  args.dem = dem;
+  args.slope = sy;
+  args.d = dy;
+  args.arbcount = NULL;
+
+  ParallelFor(DataboxNy(dem), (double)DataboxNx(dem) * DataboxNy(dem),
+              SlopeYUpwindRows, &args);
+} // END FUNCTION: CompuateSlopeYUpwind
+
 
+/*-----------------------------------------------------------------------
+ * SlopeXD4Rows:
+ *
+ * Rows [lo, hi) of the x-direction D4 slopes, see ComputeSlopeXD4.
+ *
+ *-----------------------------------------------------------------------*/
+static void SlopeXD4Rows(void *arg, int lo, int hi, int thread)
 {
+  SlopeArgs *args = (SlopeArgs*)arg;
+  Databox   *dem = args->dem;
+  Databox   *sx = args->slope;
   int i, j;
   int nx, ny;
   int arbcount;
@@ -398,7 +456,7 @@ void ComputeSlopeXD4(
   arbcount = 0;
 
   // Loop over all [i,j]
-  for (j = 0; j < ny; j++)
+  for (j = lo; j < hi; j++)
   {
     for (i = 0; i < nx; i++)
     {
@@ -860,25 +918,58 @@ void ComputeSlopeXD4(
     }    // end loop over i
   }  // end loop over j
 
-  printf("ARBITRARY CELLS: arbcount = %d \n", arbcount);
-} // END FUCTION: ComputeSlopeXD4
-
+  args->arbcount[thread] += arbcount;
+}
 
 /*-----------------------------------------------------------------------
- * ComputeSlopeYD4:
+ * ComputeSlopeXD4:
  *
- * Calculate the topographic slope at [i,j] in the y-direction based on D4 method
+ * Calculate the topographic slope at [i,j] in the x-direction based on D4 method
  * (Same as common D8, but no diagonal slopes -- adjacent only)
  *
  * D4 sets slope at each cell as the maximum downward gradient to an adjacent cell;
- * If max down grad is in y, SY gets set; if max down grad is in x, SY==0.
+ * If max down grad is in x, SX gets set; if max down grad is in y, SX==0.
  *
  *-----------------------------------------------------------------------*/
-void ComputeSlopeYD4(
+void ComputeSlopeXD4(
                      Databox *dem,
-                     Databox *sy)
+                     Databox *sx)
+
+{
+  SlopeArgs args;
+  int       *arbcount;
+  int t, total;
+
+  arbcount = ctalloc(int, GetToolsNumThreads());
+
+  args.dem = dem;
+  args.slope = sx;
+  args.d = 0.0;
+  args.arbcount = arbcount;
+
+  ParallelFor(DataboxNy(dem), (double)DataboxNx(dem) * DataboxNy(dem),
+              SlopeXD4Rows, &args);
+
+  total = 0;
+  for (t = 0; t < GetToolsNumThreads(); t++)
+    total += arbcount[t];
+  tfree(arbcount);
+
+  printf("ARBITRARY CELLS: arbcount = %d \n", total);
+} // END FUCTION: ComputeSlopeXD4
+
 
+/*-----------------------------------------------------------------------
+ * SlopeYD4Rows:
+ *
+ * Rows [lo, hi) of the y-direction D4 slopes, see ComputeSlopeYD4.
+ *
+ *-----------------------------------------------------------------------*/
+static void SlopeYD4Rows(void *arg, int lo, int hi, int thread)
 {
+  SlopeArgs *args = (SlopeArgs*)arg;
+  Databox   *dem = args->dem;
+  Databox   *sy = args->slope;
   int i, j;
   int nx, ny;
   int arbcount;
@@ -892,7 +983,7 @@ void ComputeSlopeYD4(
   arbcount = 0;
 
   // Loop over all [i,j]
-  for (j = 0; j < ny; j++)
+  for (j = lo; j < hi; j++)
   {
     for (i = 0; i < nx; i++)
     {
@@ -1353,7 +1444,44 @@ void ComputeSlopeYD4(
     }    // end loop over i
   }  // end loop over j
 
-  printf("ARBITRARY CELLS: arbcount = %d \n", arbcount);
+  args->arbcount[thread] += arbcount;
+}
+
+/*-----------------------------------------------------------------------
+ * ComputeSlopeYD4:
+ *
+ * Calculate the topographic slope at [i,j] in the y-direction based on D4 method
+ * (Same as common D8, but no diagonal slopes -- adjacent only)
+ *
+ * D4 sets slope at each cell as the maximum downward gradient to an adjacent cell;
+ * If max down grad is in y, SY gets set; if max down grad is in x, SY==0.
+ *
+ *-----------------------------------------------------------------------*/
+void ComputeSlopeYD4(
+                     Databox *dem,
+                     Databox *sy)
+
+{
+  SlopeArgs args;
+  int       *arbcount;
+  int t, total;
+
+  arbcount = ctalloc(int, GetToolsNumThreads());
+
+  args.dem = dem;
+  args.slope = sy;
+  args.d = 0.0;
+  args.arbcount = arbcount;
+
+  ParallelFor(DataboxNy(dem), (double)DataboxNx(dem) * DataboxNy(dem),
+              SlopeYD4Rows, &args);
+
+  total = 0;
+  for (t = 0; t < GetToolsNumThreads(); t++)
+    total += arbcount[t];
+  tfree(arbcount);
+
+  printf("ARBITRARY CELLS: arbcount = %d \n", total);
 } // END FUNCTION: ComputeSlopeYD4
 
 
@@ -1500,73 +1628,396 @@ void ComputeParentMap(int      i,
 
 
 /*-----------------------------------------------------------------------
- * ComputeUpstreamArea:
+ * FlowGraph:
  *
- * Computes upstream area for all cells by looping over grid and calling
- * ComputeUpstreamAreaIJ for each cell.
+ * Receiver graph of the cells of a 2D grid, cell [i,j] is i + nx*j.
+ * Each cell drains to at most FLOW_MAX_RECEIVERS cells (D4: one along x
+ * from sx and one along y from sy; D8: the lowest neighbor), -1 if none.
+ * The parents of cell c are parents[first[c]] ... parents[first[c+1]-1].
  *
- * Area returned as NUMBER OF CELLS
- * To get actual area, multiply area_ij*dx*dy
+ * The graph is built once, in O(nx*ny), and shared by the accumulation
+ * sweeps below instead of searching the neighbors of every cell again
+ * from each downstream cell.
  *
  *-----------------------------------------------------------------------*/
-void ComputeUpstreamArea(
-                         Databox *dem,
-                         Databox *sx,
-                         Databox *sy,
-                         Databox *area)
+#define FLOW_MAX_RECEIVERS 2
+
+typedef struct {
+  int nx, ny;
+  int  *receivers;
+  int  *first;
+  int  *parents;
+
+  // D8 only: lowest neighbor (-1 if none) and number of nodata neighbors
+  int  *lowest;
+  int  *nodata;
+} FlowGraph;
+
+static void FlowGraphParents(
+                             FlowGraph *graph)
 {
-  int i, j;
-  int ii, jj;
-  int nx, ny, nz;
-  double x, y, z;
-  double dx, dy, dz;
-  Databox        *parentmap;
+  int n = graph->nx * graph->ny;
+  int c, r, m;
+  int *next;
 
-  // create new databox for parentmap
-  nx = DataboxNx(sx);
-  ny = DataboxNy(sx);
-  nz = DataboxNz(sx);
-  x = DataboxX(sx);
-  y = DataboxY(sx);
-  z = DataboxZ(sx);
-  dx = DataboxDx(sx);
-  dy = DataboxDy(sx);
-  dz = DataboxDz(sx);
-  parentmap = NewDatabox(nx, ny, nz, x, y, z, dx, dy, dz);
+  graph->first = ctalloc(int, n + 1);
+  for (c = 0; c < n; c++)
+  {
+    for (m = 0; m < FLOW_MAX_RECEIVERS; m++)
+    {
+      if ((r = graph->receivers[FLOW_MAX_RECEIVERS * c + m]) >= 0)
+      {
+        graph->first[r + 1]++;
+      }
+    }
+  }
+  for (c = 0; c < n; c++)
+  {
+    graph->first[c + 1] += graph->first[c];
+  }
+
+  graph->parents = talloc(int, max(graph->first[n], 1));
+  next = talloc(int, n);
+  memcpy(next, graph->first, n * sizeof(int));
+  for (c = 0; c < n; c++)
+  {
+    for (m = 0; m < FLOW_MAX_RECEIVERS; m++)
+    {
+      if ((r = graph->receivers[FLOW_MAX_RECEIVERS * c + m]) >= 0)
+      {
+        graph->parents[next[r]++] = c;
+      }
+    }
+  }
+  tfree(next);
+}
+
+static FlowGraph *NewFlowGraph(
+                               int nx,
+                               int ny)
+{
+  FlowGraph *graph = ctalloc(FlowGraph, 1);
+  int c;
+
+  graph->nx = nx;
+  graph->ny = ny;
+  graph->receivers = talloc(int, FLOW_MAX_RECEIVERS * nx * ny);
+  for (c = 0; c < FLOW_MAX_RECEIVERS * nx * ny; c++)
+  {
+    graph->receivers[c] = -1;
+  }
+
+  return graph;
+}
+
+static void FreeFlowGraph(
+                          FlowGraph *graph)
+{
+  tfree(graph->receivers);
+  tfree(graph->first);
+  tfree(graph->parents);
+  tfree(graph->lowest);
+  tfree(graph->nodata);
+  tfree(graph);
+}
+
+/*-----------------------------------------------------------------------
+ * NewFlowGraphD4:
+ *
+ * D4 receivers from the slopes, as tested by ComputeTestParent: [i,j]
+ * drains to [i+1,j] if sx<0, to [i-1,j] if sx>0 and likewise in y.
+ * Nodata cells and off-grid cells are not connected.
+ *
+ *-----------------------------------------------------------------------*/
+static FlowGraph *NewFlowGraphD4(
+                                 Databox *dem,
+                                 Databox *sx,
+                                 Databox *sy)
+{
+  int nx = DataboxNx(sx);
+  int ny = DataboxNy(sx);
+  int i, j, ii, jj;
+  int *receivers;
+  FlowGraph *graph = NewFlowGraph(nx, ny);
 
-  // loop over all [i,j]
   for (j = 0; j < ny; j++)
   {
     for (i = 0; i < nx; i++)
     {
-      // zero out parentmap
-      for (jj = 0; jj < ny; jj++)
+      if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
       {
-        for (ii = 0; ii < nx; ii++)
+        continue;
+      }
+
+      receivers = graph->receivers + FLOW_MAX_RECEIVERS * (i + nx * j);
+
+      ii = i;
+      if (*DataboxCoeff(sx, i, j, 0) < 0.)
+      {
+        ii = i + 1;
+      }
+      else if (*DataboxCoeff(sx, i, j, 0) > 0.)
+      {
+        ii = i - 1;
+      }
+      if (ii != i && ii >= 0 && ii < nx && *DataboxCoeff(dem, ii, j, 0) != -9999.0)
+      {
+        receivers[0] = ii + nx * j;
+      }
+
+      jj = j;
+      if (*DataboxCoeff(sy, i, j, 0) < 0.)
+      {
+        jj = j + 1;
+      }
+      else if (*DataboxCoeff(sy, i, j, 0) > 0.)
+      {
+        jj = j - 1;
+      }
+      if (jj != j && jj >= 0 && jj < ny && *DataboxCoeff(dem, i, jj, 0) != -9999.0)
+      {
+        receivers[1] = i + nx * jj;
+      }
+    }
+  }
+
+  FlowGraphParents(graph);
+
+  return graph;
+}
+
+/*-----------------------------------------------------------------------
+ * NewFlowGraphD8:
+ *
+ * D8 receivers from the elevations, as tested by ComputeTestParentD8:
+ * [i,j] drains to its lowest neighbor (the first in [ii,jj] order on
+ * ties) if that is lower than [i,j] and not a nodata cell.
+ *
+ *-----------------------------------------------------------------------*/
+static FlowGraph *NewFlowGraphD8(
+                                 Databox *dem)
+{
+  int nx = DataboxNx(dem);
+  int ny = DataboxNy(dem);
+  int i, j, ii, jj, c, lowest;
+  double zmin;
+  FlowGraph *graph = NewFlowGraph(nx, ny);
+
+  graph->lowest = talloc(int, nx * ny);
+  graph->nodata = ctalloc(int, nx * ny);
+
+  for (j = 0; j < ny; j++)
+  {
+    for (i = 0; i < nx; i++)
+    {
+      c = i + nx * j;
+
+      lowest = -1;
+      zmin = 100000000000.0;
+      for (jj = max(j - 1, 0); jj <= min(j + 1, ny - 1); jj++)
+      {
+        for (ii = max(i - 1, 0); ii <= min(i + 1, nx - 1); ii++)
         {
-          *DataboxCoeff(parentmap, ii, jj, 0) = 0.0;
+          if ((ii == i) && (jj == j))
+          {
+            continue;
+          }
+
+          if (*DataboxCoeff(dem, ii, jj, 0) == -9999.0)
+          {
+            graph->nodata[c]++;
+          }
+          if (*DataboxCoeff(dem, ii, jj, 0) < zmin)
+          {
+            zmin = *DataboxCoeff(dem, ii, jj, 0);
+            lowest = ii + nx * jj;
+          }
         }
       }
+      graph->lowest[c] = lowest;
 
-      // generate parent map for [i,j]
-      // (skip nodata cells...if not nodata, recursive loop)
-      if (*DataboxCoeff(dem, i, j, 0) != -9999.0)
+      if ((lowest >= 0) && (zmin != -9999.0)
+          && (*DataboxCoeff(dem, i, j, 0) != -9999.0)
+          && (zmin < *DataboxCoeff(dem, i, j, 0)))
       {
-        ComputeParentMap(i, j, dem, sx, sy, parentmap);
+        graph->receivers[FLOW_MAX_RECEIVERS * c] = lowest;
       }
+    }
+  }
 
-      // calculate area as sum over parentmap
-      for (jj = 0; jj < ny; jj++)
+  FlowGraphParents(graph);
+
+  return graph;
+}
+
+/*-----------------------------------------------------------------------
+ * FlowUpstreamArea:
+ *
+ * Number of cells draining to each cell, including itself, over the
+ * graph (0 for nodata cells).
+ *
+ * One topological sweep from the ridges down accumulates the area of
+ * every cell whose upstream cells all have a single receiver; this is
+ * every cell for D4 and D8 graphs, in O(nx*ny).  Where flow splits (a
+ * cell with receivers in x and y) or loops, a cell with a single parent
+ * adds itself to the area of its parent; otherwise its upstream cells
+ * are counted once each by a search that stops at cells whose upstream
+ * cells all have a single receiver, as those can only drain through
+ * them.  The search is proportional to the upstream area rather than
+ * to the size of the grid.
+ *
+ *-----------------------------------------------------------------------*/
+static void FlowUpstreamArea(
+                             FlowGraph *graph,
+                             Databox *  dem,
+                             Databox *  area)
+{
+  int nx = graph->nx;
+  int ny = graph->ny;
+  int n = nx * ny;
+  int c, m, p, r, u, head, tail, top;
+  int *order = talloc(int, n);
+  int *count = talloc(int, n);
+  int *mark = talloc(int, n);
+  int *stack = talloc(int, n);
+  char *done = ctalloc(char, n);
+  char *single = ctalloc(char, n);
+  double *tree = ctalloc(double, n);
+  double sum;
+
+  // topological order of the cells not in or below a loop, parents first
+  tail = 0;
+  for (c = 0; c < n; c++)
+  {
+    count[c] = graph->first[c + 1] - graph->first[c];
+    mark[c] = -1;
+    if (count[c] == 0)
+    {
+      order[tail++] = c;
+    }
+  }
+
+  for (head = 0; head < tail; head++)
+  {
+    c = order[head];
+
+    // area of c, exact if single: no upstream cell has a second receiver
+    tree[c] = 1.0;
+    single[c] = 1;
+    for (m = graph->first[c]; m < graph->first[c + 1]; m++)
+    {
+      p = graph->parents[m];
+      tree[c] += tree[p];
+      single[c] = single[c] && single[p]
+                  && !((graph->receivers[FLOW_MAX_RECEIVERS * p] >= 0)
+                       && (graph->receivers[FLOW_MAX_RECEIVERS * p + 1] >= 0));
+    }
+    done[c] = 1;
+
+    for (m = 0; m < FLOW_MAX_RECEIVERS; m++)
+    {
+      if ((r = graph->receivers[FLOW_MAX_RECEIVERS * c + m]) >= 0)
       {
-        for (ii = 0; ii < nx; ii++)
+        if (--count[r] == 0)
         {
-          *DataboxCoeff(area, i, j, 0) = *DataboxCoeff(area, i, j, 0) + *DataboxCoeff(parentmap, ii, jj, 0);
+          order[tail++] = r;
         }
       }
-    }   // end loop over i
-  }  // end loop over j
+    }
+  }
 
-  FreeDatabox(parentmap);
+  // cells in topological order, then the cells in or below a loop
+  for (c = 0; c < n; c++)
+  {
+    if (!done[c])
+    {
+      order[tail++] = c;
+    }
+  }
+
+  for (head = 0; head < n; head++)
+  {
+    c = order[head];
+    m = graph->first[c];
+
+    if (*DataboxCoeff(dem, c % nx, c / nx, 0) == -9999.0)
+    {
+      sum = 0.0;
+    }
+    else if (done[c] && single[c])
+    {
+      sum = tree[c];
+    }
+    else if (done[c] && (graph->first[c + 1] - m == 1))
+    {
+      // a single parent, its upstream cells are those of c
+      p = graph->parents[m];
+      sum = *DataboxCoeff(area, p % nx, p / nx, 0) + 1.0;
+    }
+    else
+    {
+      // search upstream of c, marking each cell with c once visited
+      sum = 0.0;
+      top = 0;
+      stack[top++] = c;
+      mark[c] = c;
+      while (top > 0)
+      {
+        u = stack[--top];
+        if (done[u] && single[u])
+        {
+          sum += tree[u];
+        }
+        else
+        {
+          sum += 1.0;
+          for (m = graph->first[u]; m < graph->first[u + 1]; m++)
+          {
+            p = graph->parents[m];
+            if (mark[p] != c)
+            {
+              mark[p] = c;
+              stack[top++] = p;
+            }
+          }
+        }
+      }
+    }
+    *DataboxCoeff(area, c % nx, c / nx, 0) = sum;
+  }
+
+  tfree(order);
+  tfree(count);
+  tfree(mark);
+  tfree(stack);
+  tfree(done);
+  tfree(single);
+  tfree(tree);
+}
+
+
+/*-----------------------------------------------------------------------
+ * ComputeUpstreamArea:
+ *
+ * Computes upstream area for all cells, the number of cells that drain
+ * to each cell through the D4 receivers given by sx and sy (the cells
+ * ComputeParentMap would find), in a single sweep over the receiver graph.
+ *
+ * Area returned as NUMBER OF CELLS
+ * To get actual area, multiply area_ij*dx*dy
+ *
+ *-----------------------------------------------------------------------*/
+void ComputeUpstreamArea(
+                         Databox *dem,
+                         Databox *sx,
+                         Databox *sy,
+                         Databox *area)
+{
+  FlowGraph      *graph;
+
+  graph = NewFlowGraphD4(dem, sx, sy);
+  FlowUpstreamArea(graph, dem, area);
+  FreeFlowGraph(graph);
 }
 
 
@@ -1968,6 +2419,183 @@ int ComputePitFill(
 }
 
 
+/*-----------------------------------------------------------------------
+ * ComputePriorityFill:
+ *
+ * Fill all depressions in the DEM in a single pass using the
+ * priority-flood algorithm (Barnes et al., 2014).  Cells on the edge of
+ * the grid or next to a nodata cell (-9999.0, assumed to be ocean) drain
+ * off the DEM and seed a priority queue ordered by elevation.  The lowest
+ * cell is removed from the queue and its unvisited neighbors (adjacent
+ * only, as for the D4 and upwind slopes) are raised to at least its
+ * elevation plus epsilon and added to the queue, until every cell is
+ * visited.
+ *
+ * With epsilon > 0 every cell has an adjacent neighbor lower than itself,
+ * so all cells drain to the edge or a nodata cell; with epsilon = 0
+ * depressions are filled to flats at their spill elevation.
+ *
+ * Filled DEM returned in newdem, returns the number of raised cells.
+ *
+ *-----------------------------------------------------------------------*/
+typedef struct {
+  double z;
+  int seq;
+  int cell;
+} FillNode;
+
+// true if a is removed from the queue before b: lower cells first,
+// cells of the same elevation in the order they were added
+#define FillBefore(a, b) \
+  (((a).z < (b).z) || (((a).z == (b).z) && ((a).seq < (b).seq)))
+
+static void FillPush(
+                     FillNode *heap,
+                     int *     size,
+                     FillNode  node)
+{
+  int m = (*size)++;
+
+  while ((m > 0) && FillBefore(node, heap[(m - 1) / 2]))
+  {
+    heap[m] = heap[(m - 1) / 2];
+    m = (m - 1) / 2;
+  }
+  heap[m] = node;
+}
+
+static FillNode FillPop(
+                        FillNode *heap,
+                        int *     size)
+{
+  FillNode top = heap[0];
+  FillNode last = heap[--(*size)];
+  int m = 0;
+  int child;
+
+  while ((child = 2 * m + 1) < *size)
+  {
+    if ((child + 1 < *size) && FillBefore(heap[child + 1], heap[child]))
+    {
+      child++;
+    }
+    if (!FillBefore(heap[child], last))
+    {
+      break;
+    }
+    heap[m] = heap[child];
+    m = child;
+  }
+  heap[m] = last;
+
+  return top;
+}
+
+int ComputePriorityFill(
+                        Databox *dem,
+                        double   epsilon,
+                        Databox *newdem)
+{
+  int i, j, ii, jj, m;
+  int nx, ny;
+  int size, seq, nraised;
+  double znew;
+  char          *visited;
+  FillNode      *heap;
+  FillNode node, next;
+
+  static int di[4] = { -1, 1, 0, 0 };
+  static int dj[4] = { 0, 0, -1, 1 };
+
+  nx = DataboxNx(dem);
+  ny = DataboxNy(dem);
+
+  visited = ctalloc(char, nx * ny);
+  heap = talloc(FillNode, nx * ny);
+  size = 0;
+  seq = 0;
+  nraised = 0;
+
+  // Seed the queue with the cells draining off the DEM
+  for (j = 0; j < ny; j++)
+  {
+    for (i = 0; i < nx; i++)
+    {
+      *DataboxCoeff(newdem, i, j, 0) = *DataboxCoeff(dem, i, j, 0);
+
+      if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
+      {
+        visited[i + nx * j] = 1;
+        continue;
+      }
+
+      for (m = 0; m < 4; m++)
+      {
+        ii = i + di[m];
+        jj = j + dj[m];
+        if ((ii < 0) || (jj < 0) || (ii > nx - 1) || (jj > ny - 1)
+            || (*DataboxCoeff(dem, ii, jj, 0) == -9999.0))
+        {
+          break;
+        }
+      }
+
+      if (m < 4)
+      {
+        node.z = *DataboxCoeff(dem, i, j, 0);
+        node.seq = seq++;
+        node.cell = i + nx * j;
+        FillPush(heap, &size, node);
+        visited[i + nx * j] = 1;
+      }
+    }
+  }
+
+  // Flood inwards from the lowest cell in the queue
+  while (size > 0)
+  {
+    node = FillPop(heap, &size);
+    i = node.cell % nx;
+    j = node.cell / nx;
+
+    for (m = 0; m < 4; m++)
+    {
+      ii = i + di[m];
+      jj = j + dj[m];
+      if ((ii < 0) || (jj < 0) || (ii > nx - 1) || (jj > ny - 1)
+          || visited[ii + nx * jj])
+      {
+        continue;
+      }
+      visited[ii + nx * jj] = 1;
+
+      znew = *DataboxCoeff(newdem, ii, jj, 0);
+      if ((znew < node.z) || ((epsilon > 0.0) && (znew <= node.z)))
+      {
+        znew = node.z + epsilon;
+        // epsilon below the precision of z still gives a higher cell
+        if ((epsilon > 0.0) && (znew == node.z))
+        {
+          znew = nextafter(node.z, HUGE_VAL);
+        }
+        *DataboxCoeff(newdem, ii, jj, 0) = znew;
+        nraised++;
+      }
+
+      next.z = znew;
+      next.seq = seq++;
+      next.cell = ii + nx * jj;
+      FillPush(heap, &size, next);
+    }
+  }
+
+  tfree(visited);
+  tfree(heap);
+
+  return nraised;
+}
+
+
 /*-----------------------------------------------------------------------
  * ComputeMovingAvg:
  *
@@ -3225,28 +3853,23 @@ void ComputeSlopeD8(
  * If cell is a local minimum --> ds = 0.0
  *
  *-----------------------------------------------------------------------*/
-void ComputeSegmentD8(
-                      Databox *dem,
-                      Databox *ds)
+static void FlowSegmentD8(
+                          FlowGraph *graph,
+                          Databox *  dem,
+                          Databox *  ds)
 {
-  int i, j, ii, jj;
+  int i, j, c;
   int imin, jmin;
-  int nx, ny, nz;
+  int nx, ny;
   int nodata;
-  double x, y, z;
-  double dx, dy, dz;
+  double dx, dy;
   double dxy, zmin;
   double s1, s2, s3, smax;
 
   nx = DataboxNx(dem);
   ny = DataboxNy(dem);
-  nz = DataboxNz(dem);
-  x = DataboxX(dem);
-  y = DataboxY(dem);
-  z = DataboxZ(dem);
   dx = DataboxDx(dem);
   dy = DataboxDy(dem);
-  dz = DataboxDz(dem);
 
   dxy = sqrt(dx * dx + dy * dy);
 
@@ -3268,40 +3891,19 @@ void ComputeSegmentD8(
 
       else
       {
-        // Loop over neighbors (adjacent and diagonal)
-        // ** Find elevation and indices of lowest neighbor
-        // ** Exclude self and off-grid cells
-        imin = -9999;
-        jmin = -9999;
-        zmin = 100000000000.0;
-        nodata = 0;
-        for (jj = j - 1; jj <= j + 1; jj++)
+        // Lowest neighbor and number of nodata neighbors from the D8 graph
+        // ** zmin is the lowest elevation including self
+        c = i + nx * j;
+        nodata = graph->nodata[c];
+        zmin = *DataboxCoeff(dem, i, j, 0);
+        imin = i;
+        jmin = j;
+        if ((graph->lowest[c] >= 0)
+            && (*DataboxCoeff(dem, graph->lowest[c] % nx, graph->lowest[c] / nx, 0) < zmin))
         {
-          for (ii = i - 1; ii <= i + 1; ii++)
-          {
-            // skip if off grid
-            if ((ii < 0) || (jj < 0) || (ii > nx - 1) || (jj > ny - 1))
-            {
-              ;
-            }
-
-            // find lowest neighbor
-            else
-            {
-              // count number of nodata neighbors
-              if (*DataboxCoeff(dem, ii, jj, 0) == -9999.0)
-              {
-                nodata = nodata + 1;
-              }
-              // set zmin, imin, jmin if lower than previous zmin
-              if (*DataboxCoeff(dem, ii, jj, 0) < zmin)
-              {
-                zmin = *DataboxCoeff(dem, ii, jj, 0);
-                imin = ii;
-                jmin = jj;
-              }
-            }       // end find lowest neighbor
-          }
+          imin = graph->lowest[c] % nx;
+          jmin = graph->lowest[c] / nx;
+          zmin = *DataboxCoeff(dem, imin, jmin, 0);
         }
 
         // Calculate slope towards lowest neighbor
@@ -3458,6 +4060,17 @@ void ComputeSegmentD8(
   }  // end loop over j
 }
 
+void ComputeSegmentD8(
+                      Databox *dem,
+                      Databox *ds)
+{
+  FlowGraph      *graph;
+
+  graph = NewFlowGraphD8(dem);
+  FlowSegmentD8(graph, dem, ds);
+  FreeFlowGraph(graph);
+}
+
 
 /*-----------------------------------------------------------------------
  * ComputeChildD8:
@@ -3752,6 +4365,74 @@ void ComputeFlintsLawRec(
 }
 
 
+/*-----------------------------------------------------------------------
+ * FlowFlintsLaw:
+ *
+ * Elevations from Flint's law up the D8 graph, as ComputeFlintsLawRec
+ * from every local minimum but with an explicit stack: cells without a
+ * receiver keep their DEM elevation and each parent is set from its
+ * receiver.
+ *
+ *-----------------------------------------------------------------------*/
+static void FlowFlintsLaw(
+                          FlowGraph *graph,
+                          Databox *  dem,
+                          Databox *  area,
+                          Databox *  ds,
+                          double     c,
+                          double     p,
+                          Databox *  demflint)
+{
+  int nx = graph->nx;
+  int n = nx * graph->ny;
+  int cell, m, u, q, top;
+  int *stack = talloc(int, n);
+
+  // initialize all cells of computed DEM to -1111.0
+  for (cell = 0; cell < n; cell++)
+  {
+    *DataboxCoeff(demflint, cell % nx, cell / nx, 0) = -1111.0;
+  }
+
+  for (cell = 0; cell < n; cell++)
+  {
+    // nodata cell (assumed to be ocean/estuary cell)
+    if (*DataboxCoeff(dem, cell % nx, cell / nx, 0) == -9999.0)
+    {
+      *DataboxCoeff(demflint, cell % nx, cell / nx, 0) = -9999.0;
+    }
+
+    // local minimum (no D8 child) -- loop upstream from the DEM value
+    else if (graph->receivers[FLOW_MAX_RECEIVERS * cell] < 0)
+    {
+      *DataboxCoeff(demflint, cell % nx, cell / nx, 0) =
+        *DataboxCoeff(dem, cell % nx, cell / nx, 0);
+
+      top = 0;
+      stack[top++] = cell;
+      while (top > 0)
+      {
+        u = stack[--top];
+        for (m = graph->first[u]; m < graph->first[u + 1]; m++)
+        {
+          q = graph->parents[m];
+          if (*DataboxCoeff(demflint, q % nx, q / nx, 0) == -1111.0)
+          {
+            *DataboxCoeff(demflint, q % nx, q / nx, 0) =
+              *DataboxCoeff(demflint, u % nx, u / nx, 0)
+              + c * pow(*DataboxCoeff(area, q % nx, q / nx, 0), p)
+              * *DataboxCoeff(ds, q % nx, q / nx, 0);
+            stack[top++] = q;
+          }
+        }
+      }
+    }
+  }
+
+  tfree(stack);
+}
+
+
 /*-----------------------------------------------------------------------
  * ComputeFlintsLaw:
  *
@@ -3771,10 +4452,10 @@ void ComputeFlintsLawRec(
  * value is set to value of original DEM.
  *
  * NOTE: This routine loops over all cells to find local minima, then
- *       recursively loops upstream from child to parent, calculating
- *       each successive parent's elevation based on the child elevation
- *       and Flint's law. Every drainage path therefore satisfies Flint's
- *       law perfectly.
+ *       loops upstream from child to parent over the D8 graph (built once,
+ *       see FlowGraph), calculating each successive parent's elevation
+ *       based on the child elevation and Flint's law. Every drainage path
+ *       therefore satisfies Flint's law perfectly.
  *
  *-----------------------------------------------------------------------*/
 void ComputeFlintsLaw(
@@ -3792,7 +4473,7 @@ void ComputeFlintsLaw(
   Databox        *sy;
   Databox        *area;
   Databox        *ds;
-  Databox        *child;
+  FlowGraph      *graph;
 
   nx = DataboxNx(dem);
   ny = DataboxNy(dem);
@@ -3821,55 +4502,17 @@ void ComputeFlintsLaw(
     }
   }
 
-  // compute segment lengths and child elevations for D8 grid
+  // compute segment lengths and elevations on the D8 grid
+  graph = NewFlowGraphD8(dem);
   ds = NewDatabox(nx, ny, nz, x, y, z, dx, dy, dz);
-  child = NewDatabox(nx, ny, nz, x, y, z, dx, dy, dz);
-  ComputeSegmentD8(dem, ds);
-  ComputeChildD8(dem, child);
-
-  // initialize all cells of computed DEM to -1111.0
-  for (j = 0; j < ny; j++)
-  {
-    for (i = 0; i < nx; i++)
-    {
-      *DataboxCoeff(demflint, i, j, 0) = -1111.0;
-    }
-  }
-
-  // compute elevations using Flint's law
-  for (j = 0; j < ny; j++)
-  {
-    for (i = 0; i < nx; i++)
-    {
-      // If original DEM elevation is -9999.0
-      // -- nodata cell (assumed to be ocean/estuary cell)
-      // -- set demflint to -9999.0
-      // -- continue loop
-      if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
-      {
-        *DataboxCoeff(demflint, i, j, 0) = -9999.0;
-      }
-
-      // If child elevation is set to -9999.0...
-      // -- cell is a local minimum (no child)
-      // -- set demflint elevation to original DEM value
-      // -- then loop upstream (recursively) to calculate parent elevations
-      else if (*DataboxCoeff(child, i, j, 0) == -9999.0)
-      {
-        // set value at [i,j]
-        *DataboxCoeff(demflint, i, j, 0) = *DataboxCoeff(dem, i, j, 0);
-
-        // call recursive function
-        ComputeFlintsLawRec(i, j, dem, demflint, child, area, ds, c, p);
-      }
-    }   // end loop over i
-  }  // end loop over j
+  FlowSegmentD8(graph, dem, ds);
+  FlowFlintsLaw(graph, dem, area, ds, c, p, demflint);
 
+  FreeFlowGraph(graph);
   FreeDatabox(sx);
   FreeDatabox(sy);
   FreeDatabox(area);
   FreeDatabox(ds);
-  FreeDatabox(child);
 }
 
 
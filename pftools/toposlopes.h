@@ -79,6 +79,11 @@ int ComputePitFill(
                    Databox *dem,
                    double   dpit);
 
+int ComputePriorityFill(
+                        Databox *dem,
+                        double   epsilon,
+                        Databox *newdem);
+
 int ComputeMovingAvg(
                      Databox *dem,
                      double   wsize);
@@ -40,6 +40,7 @@
 #include <stdlib.h>
 
 #include "velocity.h"
+#include "parallel.h"
 
 
 #if 0
@@ -49,6 +50,237 @@
 #define Mean(a, b) (2*((a) * (b)) / ((a) + (b)))
 
 
+typedef struct {
+  double         *kp, *hp;
+  double         *vxp, *vyp, *vzp, *vp;
+  int nx, ny, nz;
+  double dx, dy, dz;
+} VelocityArgs;
+
+
+static void SetVelocityArgs(
+                            VelocityArgs *args,
+                            Databox *     k,
+                            Databox *     h,
+                            Databox **    v)
+{
+  args->kp = DataboxCoeffs(k);
+  args->hp = DataboxCoeffs(h);
+  args->vxp = DataboxCoeffs(v[0]);
+  args->vyp = DataboxCoeffs(v[1]);
+  args->vzp = DataboxCoeffs(v[2]);
+  args->vp = NULL;
+
+  args->nx = DataboxNx(k);
+  args->ny = DataboxNy(k);
+  args->nz = DataboxNz(k);
+
+  args->dx = DataboxDx(k);
+  args->dy = DataboxDy(k);
+  args->dz = DataboxDz(k);
+}
+
+
+/*-----------------------------------------------------------------------
+ * Cell-centered velocities on k-planes [lo, hi)
+ *-----------------------------------------------------------------------*/
+
+static void CellVelPlanes(void *arg, int lo, int hi, int thread)
+{
+  VelocityArgs   *args = (VelocityArgs*)arg;
+  int nx = args->nx;
+  int ny = args->ny;
+  double dx = args->dx;
+  double dy = args->dy;
+  double dz = args->dz;
+
+  double         *kp, *hp;
+  double         *vxp, *vyp, *vzp;
+
+  int m1, m2, m3, m4, m5, m6, m7, m8;
+  int ii, jj, kk;
+
+  m1 = 0;
+  m2 = m1 + 1;
+  m3 = m1 + nx;
+  m4 = m3 + 1;
+  m5 = m1 + ny * nx;
+  m6 = m5 + 1;
+  m7 = m5 + nx;
+  m8 = m7 + 1;
+
+  for (kk = lo; kk < hi; kk++)
+  {
+    kp = args->kp + kk * nx * ny;
+    hp = args->hp + kk * nx * ny;
+    vxp = args->vxp + kk * (nx - 1) * (ny - 1);
+    vyp = args->vyp + kk * (nx - 1) * (ny - 1);
+    vzp = args->vzp + kk * (nx - 1) * (ny - 1);
+
+    for (jj = 0; jj < (ny - 1); jj++)
+    {
+      for (ii = 0; ii < (nx - 1); ii++)
+      {
+        *vxp = -(Mean(kp[m1], kp[m2]) * (hp[m2] - hp[m1]) +
+                 Mean(kp[m3], kp[m4]) * (hp[m4] - hp[m3]) +
+                 Mean(kp[m5], kp[m6]) * (hp[m6] - hp[m5]) +
+                 Mean(kp[m7], kp[m8]) * (hp[m8] - hp[m7])) / (4.0 * dx);
+        *vyp = -(Mean(kp[m1], kp[m3]) * (hp[m3] - hp[m1]) +
+                 Mean(kp[m2], kp[m4]) * (hp[m4] - hp[m2]) +
+                 Mean(kp[m5], kp[m7]) * (hp[m7] - hp[m5]) +
+                 Mean(kp[m6], kp[m8]) * (hp[m8] - hp[m6])) / (4.0 * dy);
+        *vzp = -(Mean(kp[m1], kp[m5]) * (hp[m5] - hp[m1] + dz) +
+                 Mean(kp[m3], kp[m7]) * (hp[m7] - hp[m3] + dz) +
+                 Mean(kp[m2], kp[m6]) * (hp[m6] - hp[m2] + dz) +
+                 Mean(kp[m4], kp[m8]) * (hp[m8] - hp[m4] + dz)) / (4.0 * dz);
+
+        vxp++;
+        vyp++;
+        vzp++;
+
+        kp++;
+        hp++;
+      }
+      kp++;
+      hp++;
+    }
+  }
+}
+
+
+/*-----------------------------------------------------------------------
+ * Vertex-centered velocities on interior k-planes [lo + 1, hi + 1)
+ *-----------------------------------------------------------------------*/
+
+static void VertVelPlanes(void *arg, int lo, int hi, int thread)
+{
+  VelocityArgs   *args = (VelocityArgs*)arg;
+  int nx = args->nx;
+  int ny = args->ny;
+  double dx = args->dx;
+  double dy = args->dy;
+  double dz = args->dz;
+
+  double         *kp = args->kp;
+  double         *hp = args->hp;
+  double         *vxp = args->vxp;
+  double         *vyp = args->vyp;
+  double         *vzp = args->vzp;
+
+  int m, sx, sy, sz;
+  int ii, jj, kk;
+
+  sx = 1;
+  sy = nx;
+  sz = ny * nx;
+
+  for (kk = lo + 1; kk < hi + 1; kk++)
+  {
+    for (jj = 1; jj < (ny - 1); jj++)
+    {
+      m = kk * sz + jj * sy + sx;
+
+      for (ii = 1; ii < (nx - 1); ii++)
+      {
+        vxp[m] = -(Mean(kp[m], kp[m + sx]) * (hp[m + sx] - hp[m])) / dx;
+        vyp[m] = -(Mean(kp[m], kp[m + sy]) * (hp[m + sy] - hp[m])) / dy;
+        vzp[m] = -(Mean(kp[m], kp[m + sz]) * (hp[m + sz] - hp[m] + dz)) / dz;
+
+        m++;
+      }
+    }
+  }
+}
+
+
+/*-----------------------------------------------------------------------
+ * Block face-centered velocities on k-planes [lo, hi)
+ *-----------------------------------------------------------------------*/
+
+static void BFCVelPlanes(void *arg, int lo, int hi, int thread)
+{
+  VelocityArgs   *args = (VelocityArgs*)arg;
+  int nx = args->nx;
+  int ny = args->ny;
+  int nz = args->nz;
+  int nx1 = nx - 1;
+  int ny1 = ny - 1;
+  double dx = args->dx;
+  double dy = args->dy;
+  double dz = args->dz;
+
+  double         *kp = args->kp;
+  double         *hp = args->hp;
+  double         *vxp = args->vxp;
+  double         *vyp = args->vyp;
+  double         *vzp = args->vzp;
+
+  int m, m_bfc, sx, sy, sz;
+  int ii, jj, kk;
+
+  sx = 1;
+  sy = nx;
+  sz = ny * nx;
+
+  for (kk = lo; kk < hi; kk++)
+  {
+    for (jj = 0; jj < (ny - 1); jj++)
+    {
+      for (ii = 0; ii < (nx - 2); ii++)
+      {
+        m = ii + nx * jj + nx * ny * kk;
+        m_bfc = ii + nx1 * jj + nx1 * ny * kk;
+        vxp[m_bfc] = -(Mean(kp[m], kp[m + sx]) * (hp[m + sx] - hp[m])) / dx;
+      }
+    }
+
+    for (jj = 0; jj < (ny - 2); jj++)
+    {
+      for (ii = 0; ii < (nx - 1); ii++)
+      {
+        m = ii + nx * jj + nx * ny * kk;
+        m_bfc = ii + nx * jj + nx * ny1 * kk;
+        vyp[m_bfc] = -(Mean(kp[m], kp[m + sy]) * (hp[m + sy] - hp[m])) / dy;
+      }
+    }
+
+    if (kk < (nz - 2))
+    {
+      for (jj = 0; jj < (ny - 1); jj++)
+      {
+        for (ii = 0; ii < (nx - 1); ii++)
+        {
+          m = ii + nx * jj + nx * ny * kk;
+          m_bfc = ii + nx * jj + nx * ny * kk;
+          vzp[m_bfc] = -(Mean(kp[m], kp[m + sz]) * (hp[m + sz] - hp[m] + dz)) / dz;
+        }
+      }
+    }
+  }
+}
+
+
+/*-----------------------------------------------------------------------
+ * Velocity magnitude on cells [lo, hi)
+ *-----------------------------------------------------------------------*/
+
+static void VMagCells(void *arg, int lo, int hi, int thread)
+{
+  VelocityArgs   *args = (VelocityArgs*)arg;
+  double         *vxp = args->vxp;
+  double         *vyp = args->vyp;
+  double         *vzp = args->vzp;
+  double         *vp = args->vp;
+
+  int m;
+
+  for (m = lo; m < hi; m++)
+  {
+    vp[m] = sqrt(vxp[m] * vxp[m] + vyp[m] * vyp[m] + vzp[m] * vzp[m]);
+  }
+}
+
+
 /*-----------------------------------------------------------------------
  * Compute cell-centered velocities from conductivity and pressure head
  *-----------------------------------------------------------------------*/
@@ -63,11 +295,7 @@ Databox       **CompCellVel(
   double x, y, z;
   double dx, dy, dz;
 
-  double         *kp, *hp;
-  double         *vxp, *vyp, *vzp;
-
-  int m1, m2, m3, m4, m5, m6, m7, m8;
-  int ii, jj, kk;
+  VelocityArgs args;
 
 
   nx = DataboxNx(k);
@@ -117,53 +345,9 @@ Databox       **CompCellVel(
     return((Databox**)NULL);
   }
 
-  kp = DataboxCoeffs(k);
-  hp = DataboxCoeffs(h);
-  vxp = DataboxCoeffs(v[0]);
-  vyp = DataboxCoeffs(v[1]);
-  vzp = DataboxCoeffs(v[2]);
+  SetVelocityArgs(&args, k, h, v);
 
-  m1 = 0;
-  m2 = m1 + 1;
-  m3 = m1 + nx;
-  m4 = m3 + 1;
-  m5 = m1 + ny * nx;
-  m6 = m5 + 1;
-  m7 = m5 + nx;
-  m8 = m7 + 1;
-
-  for (kk = 0; kk < (nz - 1); kk++)
-  {
-    for (jj = 0; jj < (ny - 1); jj++)
-    {
-      for (ii = 0; ii < (nx - 1); ii++)
-      {
-        *vxp = -(Mean(kp[m1], kp[m2]) * (hp[m2] - hp[m1]) +
-                 Mean(kp[m3], kp[m4]) * (hp[m4] - hp[m3]) +
-                 Mean(kp[m5], kp[m6]) * (hp[m6] - hp[m5]) +
-                 Mean(kp[m7], kp[m8]) * (hp[m8] - hp[m7])) / (4.0 * dx);
-        *vyp = -(Mean(kp[m1], kp[m3]) * (hp[m3] - hp[m1]) +
-                 Mean(kp[m2], kp[m4]) * (hp[m4] - hp[m2]) +
-                 Mean(kp[m5], kp[m7]) * (hp[m7] - hp[m5]) +
-                 Mean(kp[m6], kp[m8]) * (hp[m8] - hp[m6])) / (4.0 * dy);
-        *vzp = -(Mean(kp[m1], kp[m5]) * (hp[m5] - hp[m1] + dz) +
-                 Mean(kp[m3], kp[m7]) * (hp[m7] - hp[m3] + dz) +
-                 Mean(kp[m2], kp[m6]) * (hp[m6] - hp[m2] + dz) +
-                 Mean(kp[m4], kp[m8]) * (hp[m8] - hp[m4] + dz)) / (4.0 * dz);
-
-        vxp++;
-        vyp++;
-        vzp++;
-
-        kp++;
-        hp++;
-      }
-      kp++;
-      hp++;
-    }
-    kp += nx;
-    hp += nx;
-  }
+  ParallelFor(nz - 1, (double)nx * ny * nz, CellVelPlanes, &args);
 
   return (Databox**)v;
 }
@@ -183,11 +367,7 @@ Databox       **CompVertVel(
   double x, y, z;
   double dx, dy, dz;
 
-  double         *kp, *hp;
-  double         *vxp, *vyp, *vzp;
-
-  int m, sx, sy, sz;
-  int ii, jj, kk;
+  VelocityArgs args;
 
 
   nx = DataboxNx(k);
@@ -237,33 +417,10 @@ Databox       **CompVertVel(
   }
 
 
-  kp = DataboxCoeffs(k);
-  hp = DataboxCoeffs(h);
-  vxp = DataboxCoeffs(v[0]);
-  vyp = DataboxCoeffs(v[1]);
-  vzp = DataboxCoeffs(v[2]);
-
-  m = 0;
-  sx = 1;
-  sy = nx;
-  sz = ny * nx;
+  SetVelocityArgs(&args, k, h, v);
 
-  for (kk = 1; kk < (nz - 1); kk++)
-  {
-    for (jj = 1; jj < (ny - 1); jj++)
-    {
-      m = kk * sz + jj * sy + sx;
-
-      for (ii = 1; ii < (nx - 1); ii++)
-      {
-        vxp[m] = -(Mean(kp[m], kp[m + sx]) * (hp[m + sx] - hp[m])) / dx;
-        vyp[m] = -(Mean(kp[m], kp[m + sy]) * (hp[m + sy] - hp[m])) / dy;
-        vzp[m] = -(Mean(kp[m], kp[m + sz]) * (hp[m + sz] - hp[m] + dz)) / dz;
-
-        m++;
-      }
-    }
-  }
+  if (nz > 2)
+    ParallelFor(nz - 2, (double)nx * ny * nz, VertVelPlanes, &args);
 
   return (Databox**)v;
 }
@@ -283,11 +440,7 @@ Databox       **CompBFCVel(
   double x, y, z;
   double dx, dy, dz;
 
-  double         *kp, *hp;
-  double         *vxp, *vyp, *vzp;
-
-  int m, m_bfc, sx, sy, sz;
-  int ii, jj, kk;
+  VelocityArgs args;
 
 
   nx = DataboxNx(k);
@@ -341,53 +494,9 @@ Databox       **CompBFCVel(
   }
 
 
-  kp = DataboxCoeffs(k);
-  hp = DataboxCoeffs(h);
-  vxp = DataboxCoeffs(v[0]);
-  vyp = DataboxCoeffs(v[1]);
-  vzp = DataboxCoeffs(v[2]);
+  SetVelocityArgs(&args, k, h, v);
 
-  sx = 1;
-  sy = nx;
-  sz = ny * nx;
-
-  for (kk = 0; kk < (nz - 1); kk++)
-  {
-    for (jj = 0; jj < (ny - 1); jj++)
-    {
-      for (ii = 0; ii < (nx - 2); ii++)
-      {
-        m = ii + nx * jj + nx * ny * kk;
-        m_bfc = ii + nx1 * jj + nx1 * ny * kk;
-        vxp[m_bfc] = -(Mean(kp[m], kp[m + sx]) * (hp[m + sx] - hp[m])) / dx;
-      }
-    }
-  }
-
-  for (kk = 0; kk < (nz - 1); kk++)
-  {
-    for (jj = 0; jj < (ny - 2); jj++)
-    {
-      for (ii = 0; ii < (nx - 1); ii++)
-      {
-        m = ii + nx * jj + nx * ny * kk;
-        m_bfc = ii + nx * jj + nx * ny1 * kk;
-        vyp[m_bfc] = -(Mean(kp[m], kp[m + sy]) * (hp[m + sy] - hp[m])) / dy;
-      }
-    }
-  }
-  for (kk = 0; kk < (nz - 2); kk++)
-  {
-    for (jj = 0; jj < (ny - 1); jj++)
-    {
-      for (ii = 0; ii < (nx - 1); ii++)
-      {
-        m = ii + nx * jj + nx * ny * kk;
-        m_bfc = ii + nx * jj + nx * ny * kk;
-        vzp[m_bfc] = -(Mean(kp[m], kp[m + sz]) * (hp[m + sz] - hp[m] + dz)) / dz;
-      }
-    }
-  }
+  ParallelFor(nz - 1, (double)nx * ny * nz, BFCVelPlanes, &args);
 
   return (Databox**)v;
 }
@@ -408,9 +517,7 @@ Databox        *CompVMag(
   double x, y, z;
   double dx, dy, dz;
 
-  double         *vxp, *vyp, *vzp, *vp;
-
-  int m, ii;
+  VelocityArgs args;
 
 
   nx = DataboxNx(vx);
@@ -428,18 +535,12 @@ Databox        *CompVMag(
   if ((v = NewDatabox(nx, ny, nz, x, y, z, dx, dy, dz)) == NULL)
     return((Databox*)NULL);
 
-  vxp = DataboxCoeffs(vx);
-  vyp = DataboxCoeffs(vy);
-  vzp = DataboxCoeffs(vz);
-  vp = DataboxCoeffs(v);
+  args.vxp = DataboxCoeffs(vx);
+  args.vyp = DataboxCoeffs(vy);
+  args.vzp = DataboxCoeffs(vz);
+  args.vp = DataboxCoeffs(v);
 
-  m = 0;
-  for (ii = 0; ii < (nx * ny * nz); ii++)
-  {
-    vp[m] = sqrt(vxp[m] * vxp[m] + vyp[m] * vyp[m] + vzp[m] * vzp[m]);
-
-    m++;
-  }
+  ParallelFor(nx * ny * nz, (double)nx * ny * nz, VMagCells, &args);
 
   return v;
 }
@@ -26,41 +26,36 @@
  *  USA
  **********************************************************************EHEADER*/
 #include "water_table.h"
+#include "readdatabox.h"
+#include "parallel.h"
+#include "general.h"
 
-/*-----------------------------------------------------------------------
- * ComputeWaterTableDepth:
- *
- * Computes the water table depth as the first cell with a saturation=1 starting
- * from top.   Depth is depth below the top surface.
- *
- * Negative values indicate the water table was not found, either below domain or
- * the column at (i,j) is outside of domain
- *
- * Returns a Databox water_table_depth with depth values at
- * each (i,j) location.
- *
- *-----------------------------------------------------------------------*/
-
+#include <stdio.h>
 #include <math.h>
 
-void ComputeWaterTableDepth(
-                            Databox *top,
-                            Databox *saturation,
-                            Databox *water_table_depth)
+#define WATER_TABLE_NOT_FOUND -9999999.0
+
+typedef struct {
+  Databox *top;
+  Databox *saturation;
+  Databox *water_table_depth;
+} WaterTableArgs;
+
+static void WaterTableRows(void *arg, int lo, int hi, int thread)
 {
+  WaterTableArgs *args = (WaterTableArgs*)arg;
+  Databox        *top = args->top;
+  Databox        *saturation = args->saturation;
+  Databox        *water_table_depth = args->water_table_depth;
   int i, j;
-  int nx, ny, nz;
-  double dx, dy, dz;
+  int nx, nz;
+  double dz;
 
   nx = DataboxNx(saturation);
-  ny = DataboxNy(saturation);
   nz = DataboxNz(saturation);
-
-  dx = DataboxDx(saturation);
-  dy = DataboxDy(saturation);
   dz = DataboxDz(saturation);
 
-  for (j = 0; j < ny; j++)
+  for (j = lo; j < hi; j++)
   {
     for (i = 0; i < nx; i++)
     {
@@ -68,7 +63,7 @@ void ComputeWaterTableDepth(
       if (top_k < 0)
       {
         /* inactive column so set to bogus value */
-        *(DataboxCoeff(water_table_depth, i, j, 0)) = -9999999.0;
+        *(DataboxCoeff(water_table_depth, i, j, 0)) = WATER_TABLE_NOT_FOUND;
       }
       else if (top_k < nz)
       {
@@ -89,15 +84,222 @@ void ComputeWaterTableDepth(
         }
         else
         {
-          *(DataboxCoeff(water_table_depth, i, j, 0)) = -9999999.0;
+          *(DataboxCoeff(water_table_depth, i, j, 0)) = WATER_TABLE_NOT_FOUND;
         }
       }
-      else
-      {
-        printf("Error: Index in top (k=%d) is outside of domain (nz=%d)\n", top_k, nz);
-      }
     }
   }
 }
 
 
+/*-----------------------------------------------------------------------
+ * Print an error for each column with a top outside of the domain
+ *-----------------------------------------------------------------------*/
+
+static void WaterTableCheckTop(
+                               Databox *top,
+                               int      nz)
+{
+  int m;
+  int n = DataboxNx(top) * DataboxNy(top);
+
+  for (m = 0; m < n; m++)
+  {
+    int top_k = DataboxCoeffs(top)[m];
+    if (top_k >= nz)
+      printf("Error: Index in top (k=%d) is outside of domain (nz=%d)\n", top_k, nz);
+  }
+}
+
+
+/*-----------------------------------------------------------------------
+ * ComputeWaterTableDepth:
+ *
+ * Computes the water table depth as the first cell with a saturation=1 starting
+ * from top.   Depth is depth below the top surface.
+ *
+ * Negative values indicate the water table was not found, either below domain or
+ * the column at (i,j) is outside of domain
+ *
+ * Returns a Databox water_table_depth with depth values at
+ * each (i,j) location.
+ *
+ * The rows of columns are split over the pftools threads.
+ *
+ *-----------------------------------------------------------------------*/
+
+void ComputeWaterTableDepth(
+                            Databox *top,
+                            Databox *saturation,
+                            Databox *water_table_depth)
+{
+  WaterTableArgs args;
+  int nx, ny, nz;
+
+  nx = DataboxNx(saturation);
+  ny = DataboxNy(saturation);
+  nz = DataboxNz(saturation);
+
+  WaterTableCheckTop(top, nz);
+
+  args.top = top;
+  args.saturation = saturation;
+  args.water_table_depth = water_table_depth;
+
+  ParallelFor(ny, (double)nx * ny * nz, WaterTableRows, &args);
+}
+
+
+/*-----------------------------------------------------------------------
+ * Sweep of the layers of a saturation file for the water table.  The
+ * layer of the top and of the water table of each column are kept in
+ * arrays, the layers are visited from the highest top downward and the
+ * loop over the cells of a layer has no branches so it can be
+ * vectorized.
+ *-----------------------------------------------------------------------*/
+
+/* top_k of columns with a top outside of the domain, which are skipped */
+#define WATER_TABLE_BAD_TOP -2
+
+/*-----------------------------------------------------------------------
+ * Set up the sweep of n columns: the layer of the top of each column,
+ * -1 outside of the domain, and no water table found yet.  Returns the
+ * highest top layer.
+ *-----------------------------------------------------------------------*/
+
+static int WaterTableStart(
+                           double *top,
+                           int     n,
+                           int     nz,
+                           int *   top_k,
+                           int *   water_k)
+{
+  int kmax = -1;
+  int m;
+
+  for (m = 0; m < n; m++)
+  {
+    top_k[m] = top[m];
+    if (top_k[m] < 0)
+      top_k[m] = -1;
+    else if (top_k[m] >= nz)
+      top_k[m] = WATER_TABLE_BAD_TOP;
+    water_k[m] = -1;
+    kmax = max(kmax, top_k[m]);
+  }
+
+  return kmax;
+}
+
+
+/*-----------------------------------------------------------------------
+ * Update the sweep of n columns with layer k of the saturation: the
+ * water table of a column is the first saturated cell at or below its
+ * top.  Returns the number of columns still without a water table.
+ *-----------------------------------------------------------------------*/
+
+static int WaterTableLayer(
+                           double *saturation,
+                           int     k,
+                           int     n,
+                           int *   top_k,
+                           int *   water_k)
+{
+  int remaining = 0;
+  int m;
+
+  for (m = 0; m < n; m++)
+  {
+    int found = (water_k[m] < 0) & (k <= top_k[m]) & !(saturation[m] < 1);
+    water_k[m] = found ? k : water_k[m];
+    remaining += (water_k[m] < 0) & (top_k[m] >= 0);
+  }
+
+  return remaining;
+}
+
+
+/*-----------------------------------------------------------------------
+ * ReadParflowBWaterTableDepth:
+ *
+ * Computes the water table depth of the saturation in a binary `parflow'
+ * file, as ComputeWaterTableDepth.  The layers of the file are read one
+ * at a time from the highest top down, only until the water table of
+ * every column is found, so the saturation is never held in memory and
+ * usually only the layers near the surface are read.
+ *
+ * Returns NULL if the file could not be read or top does not match it.
+ *
+ *-----------------------------------------------------------------------*/
+
+Databox *ReadParflowBWaterTableDepth(
+                                     char *   file_name,
+                                     Databox *top)
+{
+  ParflowBFile *file;
+  Databox      *layer;
+  Databox      *water_table_depth;
+  double       *depth;
+  int          *top_k, *water_k;
+  int m, n, k, remaining;
+
+  if ((file = OpenParflowB(file_name)) == NULL)
+    return NULL;
+
+  if (DataboxNx(top) != file->NX || DataboxNy(top) != file->NY)
+  {
+    CloseParflowB(file);
+    return NULL;
+  }
+
+  if ((water_table_depth = NewDatabox(file->NX, file->NY, 1,
+                                      file->X, file->Y, file->Z,
+                                      file->DX, file->DY, file->DZ)) == NULL)
+  {
+    CloseParflowB(file);
+    return NULL;
+  }
+
+  if ((layer = NewDatabox(file->NX, file->NY, 1,
+                          file->X, file->Y, file->Z,
+                          file->DX, file->DY, file->DZ)) == NULL)
+  {
+    FreeDatabox(water_table_depth);
+    CloseParflowB(file);
+    return NULL;
+  }
+
+  WaterTableCheckTop(top, file->NZ);
+
+  n = file->NX * file->NY;
+  top_k = talloc(int, n);
+  water_k = talloc(int, n);
+
+  k = WaterTableStart(DataboxCoeffs(top), n, file->NZ, top_k, water_k);
+
+  for (remaining = n; k >= 0 && remaining > 0; k--)
+  {
+    ReadParflowBBox(file, layer, 0, 0, k);
+    remaining = WaterTableLayer(DataboxCoeffs(layer), k, n, top_k, water_k);
+  }
+
+  depth = DataboxCoeffs(water_table_depth);
+  for (m = 0; m < n; m++)
+  {
+    if (top_k[m] == WATER_TABLE_BAD_TOP)
+      continue;
+
+    if (top_k[m] >= 0 && water_k[m] >= 0)
+      depth[m] = (top_k[m] - water_k[m]) * file->DZ;
+    else
+      depth[m] = WATER_TABLE_NOT_FOUND;
+  }
+
+  tfree(top_k);
+  tfree(water_k);
+
+  FreeDatabox(layer);
+  CloseParflowB(file);
+
+  return water_table_depth;
+}
@@ -43,6 +43,10 @@ void ComputeWaterTableDepth(
                             Databox *saturation,
                             Databox *surface_storage);
 
+Databox *ReadParflowBWaterTableDepth(
+                                     char *   file_name,
+                                     Databox *top);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,156 @@
+#
+# Threaded cell-wise and stencil commands give the same results with one
+# and with several threads
+#
+
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+source pftest.tcl
+
+set passed 1
+
+#
+# Write an nx by ny by nz dataset with values f(i, j, k) as a simple
+# ascii file and load it
+#
+proc parallelData {name nx ny nz dx dy dz f} {
+    set fp [open $name w]
+    puts $fp "$nx $ny $nz"
+    for {set k 0} {$k < $nz} {incr k} {
+	for {set j 0} {$j < $ny} {incr j} {
+	    for {set i 0} {$i < $nx} {incr i} {
+		puts $fp [expr $f]
+	    }
+	}
+    }
+    close $fp
+    set data [pfload -sa $name]
+    pfsetgrid [list $nx $ny $nz] {0.0 0.0 0.0} [list $dx $dy $dz] $data
+    return $data
+}
+
+#
+# Fail unless datasets a and b are identical; with a negative number of
+# digits pfmdiff reports any difference
+#
+proc parallelCompare {a b message} {
+    set diff [pfmdiff $a $b -1]
+    if {[string length $diff] != 0} {
+	puts "FAILED : $message differs between 1 and 4 threads: $diff"
+	return 0
+    }
+    return 1
+}
+
+#
+# Run each command with 1 and with 4 threads.  The datasets are larger
+# than the minimum amount of work that is split between threads.
+#
+proc parallelRun {script} {
+    set results {}
+    foreach threads {1 4} {
+	pfsetthreads $threads
+	lappend results [uplevel 1 $script]
+    }
+    pfsetthreads 1
+    return $results
+}
+
+set nx 48
+set ny 40
+set nz 24
+
+set mask  [parallelData "parallel_ops.mask.sa" $nx $ny $nz 10.0 10.0 1.0 \
+	       {(($i + $j + $k) % 7) ? 1.0 : 0.0}]
+set perm  [parallelData "parallel_ops.perm.sa" $nx $ny $nz 10.0 10.0 1.0 \
+	       {1.0 + 0.5 * sin(0.3 * $i) * cos(0.2 * $j) + 0.01 * $k}]
+set press [parallelData "parallel_ops.press.sa" $nx $ny $nz 10.0 10.0 1.0 \
+	       {0.25 * $i - 0.1 * $j + cos(0.7 * $k + 0.1 * $i)}]
+
+#
+# pfsetthreads returns the number of threads in use, which is one when
+# pftools was built without thread support
+#
+set threads [pfsetthreads 4]
+if {$threads != 4 && $threads != 1} {
+    puts "FAILED : pfsetthreads 4 returned $threads"
+    set passed 0
+}
+if {[pfsetthreads] != $threads} {
+    puts "FAILED : pfsetthreads did not return the number of threads"
+    set passed 0
+}
+if {![catch {pfsetthreads 0}]} {
+    puts "FAILED : pfsetthreads accepted 0 threads"
+    set passed 0
+}
+pfsetthreads 1
+
+foreach {command script} {
+    pfcellsum       {pfcellsum $perm $press $mask}
+    pfcelldiff      {pfcelldiff $perm $press $mask}
+    pfcellmult      {pfcellmult $perm $press $mask}
+    pfcelldiv       {pfcelldiv $perm $press $mask}
+    pfcellsumconst  {pfcellsumconst $press 2.5 $mask}
+    pfcelldiffconst {pfcelldiffconst $press 2.5 $mask}
+    pfcellmultconst {pfcellmultconst $press 2.5 $mask}
+    pfcelldivconst  {pfcelldivconst $press 2.5 $mask}
+    pfhhead         {pfhhead $press}
+    pfphead         {pfphead $press}
+    pfflux          {pfflux $perm [pfhhead $press]}
+    pfvmag          {pfvmag $perm $press $mask}
+} {
+    set results [parallelRun $script]
+    if {![parallelCompare [lindex $results 0] [lindex $results 1] $command]} {
+	set passed 0
+    }
+}
+
+#
+# pfaxpy updates its second argument
+#
+foreach threads {1 4} {
+    pfsetthreads $threads
+    set y($threads) [pfload -sa "parallel_ops.press.sa"]
+    pfsetgrid [list $nx $ny $nz] {0.0 0.0 0.0} {10.0 10.0 1.0} $y($threads)
+    pfaxpy 0.75 $perm $y($threads)
+}
+pfsetthreads 1
+if {![parallelCompare $y(1) $y(4) pfaxpy]} {
+    set passed 0
+}
+
+#
+# The velocity commands return one dataset per direction
+#
+foreach command {pfcvel pfvvel pfbfcvel} {
+    set results [parallelRun "$command \$perm \$press"]
+    for {set d 0} {$d < 3} {incr d} {
+	if {![parallelCompare [lindex $results 0 $d] [lindex $results 1 $d] \
+		  "$command direction $d"]} {
+	    set passed 0
+	}
+    }
+}
+
+#
+# Slopes of a 200 x 200 DEM with nodata cells
+#
+set n 200
+set dem [parallelData "parallel_ops.dem.sa" $n $n 1 10.0 10.0 1.0 \
+	     {($i == 0 && $j % 5 == 0) ? -9999.0 : 100.0 + 10.0 * sin(0.05 * $i) * cos(0.07 * $j) + 0.01 * $j}]
+
+foreach command {pfslopex pfslopey pfslopexD4 pfslopeyD4} {
+    set results [parallelRun "$command \$dem"]
+    if {![parallelCompare [lindex $results 0] [lindex $results 1] $command]} {
+	set passed 0
+    }
+}
+
+if $passed {
+    puts "parallel_ops : PASSED"
+} {
+    puts "parallel_ops : FAILED"
+}
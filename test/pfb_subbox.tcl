@@ -0,0 +1,124 @@
+#
+# Subbox, element and top layer reads of a distributed PFB file checked
+# against the same operations on the fully loaded file
+#
+
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+source pftest.tcl
+
+set passed 1
+
+set nx 7
+set ny 5
+set nz 4
+
+#
+# Write a simple ascii file with one value per cell and load it
+#
+proc subboxSA {name nx ny nz expr} {
+    set fp [open $name w]
+    puts $fp "$nx $ny $nz"
+    for {set k 0} {$k < $nz} {incr k} {
+	for {set j 0} {$j < $ny} {incr j} {
+	    for {set i 0} {$i < $nx} {incr i} {
+		puts $fp [expr $expr]
+	    }
+	}
+    }
+    close $fp
+    set data [pfload -sa $name]
+    pfsetgrid [list $nx $ny $nz] {0.0 0.0 0.0} {10.0 10.0 1.0} $data
+    return $data
+}
+
+#
+# True if the two datasets have the same grid and values
+#
+proc subboxSame {a b} {
+    if {[pfgetgrid $a] != [pfgetgrid $b]} {
+	return 0
+    }
+    set grid [pfgetgrid $a]
+    set n [lindex $grid 0]
+    for {set k 0} {$k < [lindex $n 2]} {incr k} {
+	for {set j 0} {$j < [lindex $n 1]} {incr j} {
+	    for {set i 0} {$i < [lindex $n 0]} {incr i} {
+		if {[pfgetelt $a $i $j $k] != [pfgetelt $b $i $j $k]} {
+		    return 0
+		}
+	    }
+	}
+    }
+    return 1
+}
+
+set data [subboxSA "pfb_subbox.sa" $nx $ny $nz {$i + 100 * $j + 10000 * $k + 0.5}]
+pfsave $data -pfb pfb_subbox.pfb
+
+#
+# Distribute the file over 2 x 2 x 2 subgrids, undistributing keeps the
+# subgrids in a single file
+#
+pfset Process.Topology.P 2
+pfset Process.Topology.Q 2
+pfset Process.Topology.R 2
+
+pfset ComputationalGrid.Lower.X 0.0
+pfset ComputationalGrid.Lower.Y 0.0
+pfset ComputationalGrid.Lower.Z 0.0
+
+pfset ComputationalGrid.DX 10.0
+pfset ComputationalGrid.DY 10.0
+pfset ComputationalGrid.DZ 1.0
+
+pfset ComputationalGrid.NX $nx
+pfset ComputationalGrid.NY $ny
+pfset ComputationalGrid.NZ $nz
+
+pfdist pfb_subbox.pfb
+pfundist pfb_subbox.pfb
+
+set full [pfload pfb_subbox.pfb]
+
+#
+# Boxes and the boxes they are clipped to by pfloadsubbox
+#
+foreach {box clipped} {
+    {0 0 0 7 5 4}     {0 0 0 7 5 4}
+    {2 1 1 6 4 3}     {2 1 1 6 4 3}
+    {3 2 0 4 3 4}     {3 2 0 4 3 4}
+    {4 4 3 5 5 4}     {4 4 3 5 5 4}
+    {-2 -2 -2 3 2 1}  {0 0 0 3 2 1}
+    {5 3 2 99 99 99}  {5 3 2 7 5 4}
+} {
+    set subbox [eval pfloadsubbox pfb_subbox.pfb $box]
+    if {![subboxSame $subbox [eval pfgetsubbox $full $clipped]]} {
+	puts "FAILED : pfloadsubbox $box differs from pfgetsubbox"
+	set passed 0
+    }
+}
+
+#
+# Top layer varying over the columns, with columns outside the domain
+#
+set top [subboxSA "pfb_subbox.top.sa" $nx $ny 1 {(($i + 2 * $j) % 5) - 1}]
+if {![subboxSame [pfloadtop pfb_subbox.pfb $top] [pfextracttop $top $full]]} {
+    puts "FAILED : pfloadtop differs from pfextracttop"
+    set passed 0
+}
+
+if {[pfgetelt [pfloadtop pfb_subbox.pfb $top -1.0] 0 0 0] != -1.0} {
+    puts "FAILED : pfloadtop default value outside the domain"
+    set passed 0
+}
+
+file delete pfb_subbox.sa pfb_subbox.top.sa pfb_subbox.pfb pfb_subbox.pfb.dist
+
+if $passed {
+    puts "pfb_subbox : PASSED"
+} {
+    puts "pfb_subbox : FAILED"
+}
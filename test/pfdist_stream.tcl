@@ -0,0 +1,273 @@
+#
+# Streaming pfdist of single and multiple subgrid PFB files, and a run
+# reading an input PFB file that has not been distributed
+#
+
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+source pftest.tcl
+
+set passed 1
+
+set nx 18
+set ny 15
+set nz 8
+
+#
+# Write a simple ascii file with one value per cell and save it as a PFB
+# file
+#
+proc distPFB {name nx ny nz expr} {
+    set fp [open $name.sa w]
+    puts $fp "$nx $ny $nz"
+    for {set k 0} {$k < $nz} {incr k} {
+	for {set j 0} {$j < $ny} {incr j} {
+	    for {set i 0} {$i < $nx} {incr i} {
+		puts $fp [expr $expr]
+	    }
+	}
+    }
+    close $fp
+    set data [pfload -sa $name.sa]
+    pfsetgrid [list $nx $ny $nz] {-10.0 10.0 1.0} \
+	{8.8888888888888893 10.666666666666666 1.0} $data
+    pfsave $data -pfb $name.pfb
+    return $data
+}
+
+#
+# Fail unless the file holds exactly the values of dataset data
+#
+proc distCheck {name data message} {
+    set diff [pfmdiff [pfload $name] $data -1]
+    if {[string length $diff] != 0} {
+	puts "FAILED : $message: $diff"
+	return 0
+    }
+    return 1
+}
+
+proc distTopology {p q r} {
+    pfset Process.Topology.P $p
+    pfset Process.Topology.Q $q
+    pfset Process.Topology.R $r
+}
+
+pfset ComputationalGrid.Lower.X                -10.0
+pfset ComputationalGrid.Lower.Y                 10.0
+pfset ComputationalGrid.Lower.Z                  1.0
+
+pfset ComputationalGrid.DX	                 8.8888888888888893
+pfset ComputationalGrid.DY                      10.666666666666666
+pfset ComputationalGrid.DZ	                 1.0
+
+pfset ComputationalGrid.NX                      $nx
+pfset ComputationalGrid.NY                      $ny
+pfset ComputationalGrid.NZ                      $nz
+
+#
+# Distribute over 2 x 2 x 2 subgrids, then redistribute the resulting
+# multiple subgrid file over 3 x 1 x 2 and back to 1 x 1 x 1
+#
+set perm [distPFB pfdist_stream.perm $nx $ny $nz \
+	      {1.0 + $i + 0.01 * $j + 0.0001 * $k}]
+
+foreach topology {{2 2 2} {3 1 2} {1 1 1}} {
+    eval distTopology $topology
+    pfdist pfdist_stream.perm.pfb
+    pfundist pfdist_stream.perm.pfb
+    if {![distCheck pfdist_stream.perm.pfb $perm "pfdist over $topology"]} {
+	set passed 0
+    }
+}
+
+#
+# Two dimensional file distributed with -nz
+#
+set slope [distPFB pfdist_stream.slope $nx $ny 1 {0.001 * ($i - $j)}]
+distTopology 2 3 1
+pfdist -nz 1 pfdist_stream.slope.pfb
+pfundist pfdist_stream.slope.pfb
+if {![distCheck pfdist_stream.slope.pfb $slope "pfdist -nz 1"]} {
+    set passed 0
+}
+
+#
+# Simulation with the permeability read from a PFB file
+#
+pfset FileVersion 4
+
+distTopology [lindex $argv 0] [lindex $argv 1] [lindex $argv 2]
+
+pfset GeomInput.Names "domain_input background_input"
+
+pfset GeomInput.domain_input.InputType            Box
+pfset GeomInput.domain_input.GeomName             domain
+
+pfset Geom.domain.Lower.X                        -10.0
+pfset Geom.domain.Lower.Y                         10.0
+pfset Geom.domain.Lower.Z                          1.0
+
+pfset Geom.domain.Upper.X                        150.0
+pfset Geom.domain.Upper.Y                        170.0
+pfset Geom.domain.Upper.Z                          9.0
+
+pfset Geom.domain.Patches "left right front back bottom top"
+
+pfset GeomInput.background_input.InputType         Box
+pfset GeomInput.background_input.GeomName          background
+
+pfset Geom.background.Lower.X -99999999.0
+pfset Geom.background.Lower.Y -99999999.0
+pfset Geom.background.Lower.Z -99999999.0
+pfset Geom.background.Upper.X  99999999.0
+pfset Geom.background.Upper.Y  99999999.0
+pfset Geom.background.Upper.Z  99999999.0
+
+pfset Geom.Perm.Names "background"
+
+pfset Geom.background.Perm.Type     PFBFile
+pfset Geom.background.Perm.FileName pfdist_stream.perm.pfb
+
+pfset Perm.TensorType               TensorByGeom
+
+pfset Geom.Perm.TensorByGeom.Names  "background"
+
+pfset Geom.background.Perm.TensorValX  1.0
+pfset Geom.background.Perm.TensorValY  1.0
+pfset Geom.background.Perm.TensorValZ  1.0
+
+pfset SpecificStorage.Type            Constant
+pfset SpecificStorage.GeomNames       ""
+pfset Geom.domain.SpecificStorage.Value 1.0e-4
+
+pfset Phase.Names "water"
+
+pfset Phase.water.Density.Type	Constant
+pfset Phase.water.Density.Value	1.0
+
+pfset Phase.water.Viscosity.Type	Constant
+pfset Phase.water.Viscosity.Value	1.0
+
+pfset Contaminants.Names			""
+
+pfset Gravity				1.0
+
+pfset TimingInfo.BaseUnit		1.0
+pfset TimingInfo.StartCount		0
+pfset TimingInfo.StartTime		0.0
+pfset TimingInfo.StopTime            1000.0
+pfset TimingInfo.DumpInterval	       -1
+
+pfset Geom.Porosity.GeomNames          background
+
+pfset Geom.background.Porosity.Type    Constant
+pfset Geom.background.Porosity.Value   1.0
+
+pfset Domain.GeomName domain
+
+pfset Phase.water.Mobility.Type        Constant
+pfset Phase.water.Mobility.Value       1.0
+
+pfset Geom.Retardation.GeomNames           ""
+
+pfset Wells.Names ""
+
+pfset Cycle.Names constant
+pfset Cycle.constant.Names		"alltime"
+pfset Cycle.constant.alltime.Length	 1
+pfset Cycle.constant.Repeat		-1
+
+pfset BCPressure.PatchNames "left right front back bottom top"
+
+pfset Patch.left.BCPressure.Type			DirEquilRefPatch
+pfset Patch.left.BCPressure.Cycle			"constant"
+pfset Patch.left.BCPressure.RefGeom			domain
+pfset Patch.left.BCPressure.RefPatch			bottom
+pfset Patch.left.BCPressure.alltime.Value		14.0
+
+pfset Patch.right.BCPressure.Type			DirEquilRefPatch
+pfset Patch.right.BCPressure.Cycle			"constant"
+pfset Patch.right.BCPressure.RefGeom			domain
+pfset Patch.right.BCPressure.RefPatch			bottom
+pfset Patch.right.BCPressure.alltime.Value		9.0
+
+foreach patch {front back bottom top} {
+    pfset Patch.$patch.BCPressure.Type			FluxConst
+    pfset Patch.$patch.BCPressure.Cycle			"constant"
+    pfset Patch.$patch.BCPressure.alltime.Value		0.0
+}
+
+pfset TopoSlopesX.Type "Constant"
+pfset TopoSlopesX.GeomNames ""
+pfset TopoSlopesX.Geom.domain.Value 0.0
+
+pfset TopoSlopesY.Type "Constant"
+pfset TopoSlopesY.GeomNames ""
+pfset TopoSlopesY.Geom.domain.Value 0.0
+
+pfset Mannings.Type "Constant"
+pfset Mannings.GeomNames ""
+pfset Mannings.Geom.domain.Value 0.
+
+pfset PhaseSources.water.Type                         Constant
+pfset PhaseSources.water.GeomNames                    background
+pfset PhaseSources.water.Geom.background.Value        0.0
+
+pfset Solver.MaxIter 5
+
+#
+# The permeability file is left undistributed; it holds the 3 x 1 x 2
+# subgrids of the last redistribution above
+#
+distTopology 3 1 2
+pfdist pfdist_stream.perm.pfb
+pfundist pfdist_stream.perm.pfb
+
+distTopology [lindex $argv 0] [lindex $argv 1] [lindex $argv 2]
+
+pfrun pfdist_stream.undist
+pfundist pfdist_stream.undist
+
+#
+# The same run with the permeability distributed
+#
+pfdist pfdist_stream.perm.pfb
+pfrun pfdist_stream.dist
+pfundist pfdist_stream.dist
+pfundist pfdist_stream.perm.pfb
+
+#
+# An undistributed permeability file with one layer too few must stop
+# the run
+#
+distPFB pfdist_stream.short $nx $ny [expr $nz - 1] {1.0}
+pfset Geom.background.Perm.FileName pfdist_stream.short.pfb
+if {![catch {pfrun pfdist_stream.short}]} {
+    puts "FAILED : run with a permeability file of the wrong dimensions"
+    set passed 0
+}
+pfset Geom.background.Perm.FileName pfdist_stream.perm.pfb
+
+if {![distCheck pfdist_stream.undist.out.perm_x.pfb $perm \
+	  "permeability read from an undistributed file"]} {
+    set passed 0
+}
+
+set diff [pfmdiff [pfload pfdist_stream.undist.out.press.00000.pfb] \
+	      [pfload pfdist_stream.dist.out.press.00000.pfb] -1]
+if {[string length $diff] != 0} {
+    puts "FAILED : pressure differs between undistributed and distributed input: $diff"
+    set passed 0
+}
+
+file delete pfdist_stream.perm.pfb pfdist_stream.slope.pfb \
+    pfdist_stream.short.pfb
+
+if $passed {
+    puts "pfdist_stream : PASSED"
+} {
+    puts "pfdist_stream : FAILED"
+}
@@ -0,0 +1,202 @@
+#
+# pfmask-to-pfsol builds the same domain and patches from a mask when
+# the mask is processed in tiles
+#
+
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+source pftest.tcl
+
+set passed 1
+
+set nx 18
+set ny 14
+
+#
+# Mask with two top patches and cells outside of the domain
+#
+set fp [open pfmask_tiles.mask.sa w]
+puts $fp "$nx $ny 1"
+for {set j 0} {$j < $ny} {incr j} {
+    for {set i 0} {$i < $nx} {incr i} {
+	if {($i - 9) * ($i - 9) + ($j - 7) * ($j - 7) > 60 || ($i + $j) % 11 == 0} {
+	    puts $fp 0
+	} elseif {$i > 2 * $j - 4} {
+	    puts $fp 5
+	} else {
+	    puts $fp 1
+	}
+    }
+}
+close $fp
+
+set mask [pfload -sa pfmask_tiles.mask.sa]
+pfsetgrid [list $nx $ny 1] {0.0 0.0 0.0} {10.0 10.0 1.0} $mask
+pfsave $mask -pfb pfmask_tiles.mask.pfb
+
+exec $env(PARFLOW_DIR)/bin/pfmask-to-pfsol --mask pfmask_tiles.mask.pfb \
+    --pfsol pfmask_tiles.whole.pfsol --vtk pfmask_tiles.whole.vtk \
+    --z-top 0.0 --z-bottom 5.0
+#
+# Each band of 4 tiles is built by 2 threads
+#
+exec $env(PARFLOW_DIR)/bin/pfmask-to-pfsol --mask pfmask_tiles.mask.pfb \
+    --pfsol pfmask_tiles.tiled.pfsol --vtk pfmask_tiles.tiled.vtk \
+    --z-top 0.0 --z-bottom 5.0 --tile-size 5 --threads 2
+
+#
+# Run the same problem on both solids
+#
+pfset FileVersion 4
+
+pfset Process.Topology.P [lindex $argv 0]
+pfset Process.Topology.Q [lindex $argv 1]
+pfset Process.Topology.R [lindex $argv 2]
+
+pfset ComputationalGrid.Lower.X                0.0
+pfset ComputationalGrid.Lower.Y                0.0
+pfset ComputationalGrid.Lower.Z                0.0
+
+pfset ComputationalGrid.DX                     10.0
+pfset ComputationalGrid.DY                     10.0
+pfset ComputationalGrid.DZ                     1.0
+
+pfset ComputationalGrid.NX                     $nx
+pfset ComputationalGrid.NY                     $ny
+pfset ComputationalGrid.NZ                     5
+
+pfset GeomInput.Names                 "solidinput background"
+
+pfset GeomInput.solidinput.InputType  SolidFile
+pfset GeomInput.solidinput.GeomNames  domain
+
+pfset GeomInput.background.InputType  Box
+pfset GeomInput.background.GeomName   background
+
+pfset Geom.background.Lower.X         -99999999.0
+pfset Geom.background.Lower.Y         -99999999.0
+pfset Geom.background.Lower.Z         -99999999.0
+pfset Geom.background.Upper.X          99999999.0
+pfset Geom.background.Upper.Y          99999999.0
+pfset Geom.background.Upper.Z          99999999.0
+
+#
+# Patches are numbered in the order of their labels: the top labels 1
+# and 5 and the default bottom and side labels 2 and 3
+#
+pfset Geom.domain.Patches             "land bottom side river"
+
+pfset Geom.Perm.Names                 "domain"
+
+pfset Geom.domain.Perm.Type            Constant
+pfset Geom.domain.Perm.Value           1.0
+
+pfset Perm.TensorType               TensorByGeom
+
+pfset Geom.Perm.TensorByGeom.Names  "background"
+
+pfset Geom.background.Perm.TensorValX  1.0
+pfset Geom.background.Perm.TensorValY  1.0
+pfset Geom.background.Perm.TensorValZ  1.0
+
+pfset SpecificStorage.Type            Constant
+pfset SpecificStorage.GeomNames       ""
+pfset Geom.domain.SpecificStorage.Value 1.0e-4
+
+pfset Phase.Names "water"
+
+pfset Phase.water.Density.Type	Constant
+pfset Phase.water.Density.Value	1.0
+
+pfset Phase.water.Viscosity.Type	Constant
+pfset Phase.water.Viscosity.Value	1.0
+
+pfset Contaminants.Names			""
+
+pfset Gravity				1.0
+
+pfset TimingInfo.BaseUnit		1.0
+pfset TimingInfo.StartCount		0
+pfset TimingInfo.StartTime		0.0
+pfset TimingInfo.StopTime            1000.0
+pfset TimingInfo.DumpInterval	       -1
+
+pfset Geom.Porosity.GeomNames          domain
+
+pfset Geom.domain.Porosity.Type    Constant
+pfset Geom.domain.Porosity.Value   1.0
+
+pfset Domain.GeomName domain
+
+pfset Phase.water.Mobility.Type        Constant
+pfset Phase.water.Mobility.Value       1.0
+
+pfset Geom.Retardation.GeomNames           ""
+
+pfset Wells.Names ""
+
+pfset Cycle.Names constant
+pfset Cycle.constant.Names		"alltime"
+pfset Cycle.constant.alltime.Length	 1
+pfset Cycle.constant.Repeat		-1
+
+pfset BCPressure.PatchNames "land bottom side river"
+
+pfset Patch.land.BCPressure.Type			DirEquilRefPatch
+pfset Patch.land.BCPressure.Cycle			"constant"
+pfset Patch.land.BCPressure.RefGeom			domain
+pfset Patch.land.BCPressure.RefPatch			bottom
+pfset Patch.land.BCPressure.alltime.Value		8.0
+
+pfset Patch.river.BCPressure.Type			DirEquilRefPatch
+pfset Patch.river.BCPressure.Cycle			"constant"
+pfset Patch.river.BCPressure.RefGeom			domain
+pfset Patch.river.BCPressure.RefPatch			bottom
+pfset Patch.river.BCPressure.alltime.Value		3.0
+
+foreach patch {bottom side} {
+    pfset Patch.$patch.BCPressure.Type			FluxConst
+    pfset Patch.$patch.BCPressure.Cycle			"constant"
+    pfset Patch.$patch.BCPressure.alltime.Value		0.0
+}
+
+pfset TopoSlopesX.Type "Constant"
+pfset TopoSlopesX.GeomNames ""
+pfset TopoSlopesX.Geom.domain.Value 0.0
+
+pfset TopoSlopesY.Type "Constant"
+pfset TopoSlopesY.GeomNames ""
+pfset TopoSlopesY.Geom.domain.Value 0.0
+
+pfset Mannings.Type "Constant"
+pfset Mannings.GeomNames ""
+pfset Mannings.Geom.domain.Value 0.
+
+pfset PhaseSources.water.Type                         Constant
+pfset PhaseSources.water.GeomNames                    background
+pfset PhaseSources.water.Geom.background.Value        0.0
+
+pfset Solver.MaxIter 5
+
+foreach run {whole tiled} {
+    pfset GeomInput.solidinput.FileName   pfmask_tiles.$run.pfsol
+    pfrun pfmask_tiles.$run
+    pfundist pfmask_tiles.$run
+}
+
+foreach file {perm_x porosity press.00000} {
+    set diff [pfmdiff [pfload pfmask_tiles.whole.out.$file.pfb] \
+		  [pfload pfmask_tiles.tiled.out.$file.pfb] -1]
+    if {[string length $diff] != 0} {
+	puts "FAILED : $file differs between whole and tiled mask: $diff"
+	set passed 0
+    }
+}
+
+if $passed {
+    puts "pfmask_tiles : PASSED"
+} {
+    puts "pfmask_tiles : FAILED"
+}
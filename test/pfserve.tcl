@@ -0,0 +1,133 @@
+#
+# pftools server: commands sent over a socket share data sets, and files
+# loaded again come from the cache unless they changed
+#
+
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+source pftest.tcl
+
+set passed 1
+
+set socket pfserve.sock
+
+#
+# Write a PFB file with values offset + i + 10 j + 100 k
+#
+proc serveData {name offset} {
+    set fp [open pfserve.data.sa w]
+    puts $fp "4 3 2"
+    for {set k 0} {$k < 2} {incr k} {
+	for {set j 0} {$j < 3} {incr j} {
+	    for {set i 0} {$i < 4} {incr i} {
+		puts $fp [expr $offset + $i + 10 * $j + 100 * $k]
+	    }
+	}
+    }
+    close $fp
+    set data [pfload -sa pfserve.data.sa]
+    pfsetgrid {4 3 2} {0.0 0.0 0.0} {1.0 1.0 1.0} $data
+    pfsave $data -pfb $name
+    pfdelete $data
+}
+
+proc serveCheck {value expected message} {
+    if {$value != $expected} {
+	puts "FAILED : $message: $value instead of $expected"
+	return 0
+    }
+    return 1
+}
+
+serveData pfserve.data.pfb 0.0
+
+#
+# A socket left by an earlier run would be taken for the new server
+#
+file delete $socket
+
+exec [info nameofexecutable] $env(PARFLOW_DIR)/bin/pfserver -cache 16 $socket \
+    >& /dev/null &
+
+#
+# Data sets loaded by one client are available to the next ones.  The
+# first request is repeated until the server listens on the socket.
+#
+for {set wait 0} \
+    {[catch {pfsend $socket {set data [pfload pfserve.data.pfb]}} message]} \
+    {incr wait} {
+    if {$wait == 100} {
+	puts "FAILED : can't connect to the server: $message"
+	puts "pfserve : FAILED"
+	exit 1
+    }
+    after 100
+}
+if {![serveCheck [pfsend $socket {pfgetelt $data 3 2 1}] 123.0 "value of a loaded file"]} {
+    set passed 0
+}
+
+set value [pfsend $socket {
+    set cached [pfload pfserve.data.pfb]
+    pfgetelt $cached 1 2 0
+}]
+if {![serveCheck $value 21.0 "value of a cached file"]} {
+    set passed 0
+}
+
+set stats [pfsend $socket pfcache]
+if {![serveCheck [dict get $stats hits] 1 "cache hits"] ||
+    ![serveCheck [dict get $stats misses] 1 "cache misses"] ||
+    ![serveCheck [dict get $stats entries] 1 "cached files"]} {
+    set passed 0
+}
+
+#
+# A file that was rewritten is read again
+#
+serveData pfserve.data.pfb 1000.0
+
+if {![serveCheck [pfsend $socket {pfgetelt [pfload pfserve.data.pfb] 1 2 0}] 1021.0 \
+	  "value of a rewritten file"]} {
+    set passed 0
+}
+
+set stats [pfsend $socket pfcache]
+if {![serveCheck [dict get $stats misses] 2 "cache misses after rewrite"]} {
+    set passed 0
+}
+
+#
+# Lowering the limit drops the cached files
+#
+set stats [pfsend $socket {pfcache -limit 0.0001}]
+if {![serveCheck [dict get $stats entries] 0 "cached files after lowering the limit"]} {
+    set passed 0
+}
+
+#
+# Errors on the server are raised by pfsend
+#
+if {![catch {pfsend $socket {pfload pfserve.missing.pfb}}]} {
+    puts "FAILED : pfsend did not raise an error of the server"
+    set passed 0
+}
+
+pfsend $socket {pfserve -stop}
+
+for {set wait 0} {$wait < 100 && [file exists $socket]} {incr wait} {
+    after 100
+}
+
+if {[file exists $socket]} {
+    puts "FAILED : server did not stop"
+    set passed 0
+}
+
+if $passed {
+    puts "pfserve : PASSED"
+} {
+    puts "pfserve : FAILED"
+}
@@ -0,0 +1,119 @@
+#
+# Priority-flood depression filling on a small DEM with a pit, a
+# nested depression and nodata cells
+#
+
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+source pftest.tcl
+
+set passed 1
+
+#
+# Write an nx by ny DEM as a simple ascii file and load it
+#
+proc fillDEM {name nx ny values} {
+    set fp [open $name w]
+    puts $fp "$nx $ny 1"
+    foreach value $values {
+	puts $fp $value
+    }
+    close $fp
+    set dem [pfload -sa $name]
+    pfsetgrid [list $nx $ny 1] {0.0 0.0 0.0} {10.0 10.0 1.0} $dem
+    return $dem
+}
+
+#
+# True if [i,j] is on the edge of the grid or next to a nodata cell
+#
+proc fillOutlet {dem nx ny i j} {
+    foreach {ii jj} [list [expr $i - 1] $j [expr $i + 1] $j \
+	    $i [expr $j - 1] $i [expr $j + 1]] {
+	if {$ii < 0 || $jj < 0 || $ii >= $nx || $jj >= $ny
+	    || [pfgetelt $dem $ii $jj 0] == -9999.0} {
+	    return 1
+	}
+    }
+    return 0
+}
+
+#
+# 7 x 6 DEM, x varies fastest.  A rim at 5 surrounds a pit at 1 and
+# two depressions at 2 and 3; the cell at 4 on the last row is on the
+# edge and drains off the DEM.  The first column is nodata.
+#
+set nx 7
+set ny 6
+set dem [fillDEM "priority_fill.sa" $nx $ny {
+    -9999.0 5.0 5.0 5.0 5.0 5.0 5.0
+    -9999.0 5.0 1.0 5.0 3.0 2.0 5.0
+    -9999.0 5.0 5.0 5.0 5.0 3.0 5.0
+    -9999.0 5.0 2.0 3.0 5.0 5.0 5.0
+    -9999.0 5.0 5.0 5.0 5.0 5.0 5.0
+    -9999.0 4.0 5.0 5.0 5.0 5.0 5.0
+}]
+
+#
+# With epsilon = 0 the depressions are filled to the rim at 5, the rest
+# of the DEM is unchanged
+#
+set filled [pfpriorityfilldem $dem]
+for {set j 0} {$j < $ny} {incr j} {
+    for {set i 0} {$i < $nx} {incr i} {
+	set z [pfgetelt $dem $i $j 0]
+	set expected [expr ($z == -9999.0) ? $z : (($z < 5.0 && $j != 5) ? 5.0 : $z)]
+	if {[pfgetelt $filled $i $j 0] != $expected} {
+	    puts "FAILED : pfpriorityfilldem at ($i, $j) is [pfgetelt $filled $i $j 0], expected $expected"
+	    set passed 0
+	}
+    }
+}
+
+#
+# With epsilon > 0 every cell is at least its original elevation and
+# every cell that is not an outlet has a strictly lower neighbor
+#
+set filled [pfpriorityfilldem $dem 0.01]
+for {set j 0} {$j < $ny} {incr j} {
+    for {set i 0} {$i < $nx} {incr i} {
+	set z [pfgetelt $dem $i $j 0]
+	set znew [pfgetelt $filled $i $j 0]
+	if {$z == -9999.0} {
+	    if {$znew != $z} {
+		puts "FAILED : pfpriorityfilldem changed nodata at ($i, $j)"
+		set passed 0
+	    }
+	    continue
+	}
+	if {$znew < $z} {
+	    puts "FAILED : pfpriorityfilldem lowered ($i, $j) from $z to $znew"
+	    set passed 0
+	}
+	if {[fillOutlet $dem $nx $ny $i $j]} {
+	    continue
+	}
+	set lower 0
+	foreach {ii jj} [list [expr $i - 1] $j [expr $i + 1] $j \
+		$i [expr $j - 1] $i [expr $j + 1]] {
+	    set zn [pfgetelt $filled $ii $jj 0]
+	    if {$zn != -9999.0 && $zn < $znew} {
+		set lower 1
+	    }
+	}
+	if {!$lower} {
+	    puts "FAILED : pfpriorityfilldem ($i, $j) at $znew does not drain"
+	    set passed 0
+	}
+    }
+}
+
+file delete priority_fill.sa
+
+if $passed {
+    puts "priority_fill : PASSED"
+} {
+    puts "priority_fill : FAILED"
+}
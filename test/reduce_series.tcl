@@ -0,0 +1,149 @@
+#
+# Streaming time series reductions checked against the same reductions
+# of the fully loaded files
+#
+
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+source pftest.tcl
+
+set passed 1
+
+set nx 6
+set ny 5
+set nz 3
+
+#
+# Write a simple ascii file with one value per cell and load it
+#
+proc seriesSA {name nx ny nz t expr} {
+    set fp [open $name w]
+    puts $fp "$nx $ny $nz"
+    for {set k 0} {$k < $nz} {incr k} {
+	for {set j 0} {$j < $ny} {incr j} {
+	    for {set i 0} {$i < $nx} {incr i} {
+		puts $fp [expr $expr]
+	    }
+	}
+    }
+    close $fp
+    set data [pfload -sa $name]
+    pfsetgrid [list $nx $ny $nz] {0.0 0.0 0.0} {10.0 10.0 1.0} $data
+    file delete $name
+    return $data
+}
+
+set mask [seriesSA "reduce_series.sa" $nx $ny $nz 0 {($i == 0) ? 0.0 : 1.0}]
+set porosity [seriesSA "reduce_series.sa" $nx $ny $nz 0 {0.3 + 0.01 * $k}]
+set specific_storage [seriesSA "reduce_series.sa" $nx $ny $nz 0 {1.0e-4}]
+set slope_x [seriesSA "reduce_series.sa" $nx $ny 1 0 {0.01 * ($i - 2.5)}]
+set slope_y [seriesSA "reduce_series.sa" $nx $ny 1 0 {-0.02 * ($j - 1.5)}]
+set mannings [seriesSA "reduce_series.sa" $nx $ny 1 0 {5.5e-5}]
+set top [pfcomputetop $mask]
+
+#
+# Pressure and saturation files of timesteps 0 to 4, distributed over
+# several subgrids
+#
+pfset Process.Topology.P 2
+pfset Process.Topology.Q 2
+pfset Process.Topology.R 1
+
+pfset ComputationalGrid.Lower.X 0.0
+pfset ComputationalGrid.Lower.Y 0.0
+pfset ComputationalGrid.Lower.Z 0.0
+
+pfset ComputationalGrid.DX 10.0
+pfset ComputationalGrid.DY 10.0
+pfset ComputationalGrid.DZ 1.0
+
+pfset ComputationalGrid.NX $nx
+pfset ComputationalGrid.NY $ny
+pfset ComputationalGrid.NZ $nz
+
+for {set t 0} {$t <= 4} {incr t} {
+    set name [format "reduce_series.out.press.%05d.pfb" $t]
+    set press [seriesSA "reduce_series.sa" $nx $ny $nz $t \
+		   {$k - 1.5 + 0.1 * $i - 0.05 * $j + 0.3 * $t}]
+    pfsave $press -pfb $name
+    pfdist $name
+    pfundist $name
+
+    set name [format "reduce_series.out.satur.%05d.pfb" $t]
+    set satur [seriesSA "reduce_series.sa" $nx $ny $nz $t \
+		   {0.5 + 0.1 * $k + 0.01 * $t}]
+    pfsave $satur -pfb $name
+    pfdist $name
+    pfundist $name
+}
+
+set series [pfreduceseries reduce_series.out.press.%05d.pfb 1 4 2 \
+		-subsurface reduce_series.out.satur.%05d.pfb $mask $porosity $specific_storage \
+		-surface $top $slope_x $slope_y $mannings]
+
+if {[llength $series] != 2} {
+    puts "FAILED : pfreduceseries returned [llength $series] timesteps, expected 2"
+    set passed 0
+}
+
+foreach step $series {
+    array set reduced $step
+    set t $reduced(timestep)
+
+    set press [pfload [format "reduce_series.out.press.%05d.pfb" $t]]
+    set satur [pfload [format "reduce_series.out.satur.%05d.pfb" $t]]
+
+    set stats [pfgetstats $press]
+    set expected(min) [lindex $stats 0]
+    set expected(max) [lindex $stats 1]
+    set expected(mean) [lindex $stats 2]
+    set expected(sum) [lindex $stats 3]
+    set expected(subsurface_storage) \
+	[pfsum [pfsubsurfacestorage $mask $porosity $press $satur $specific_storage]]
+    set expected(surface_storage) [pfsum [pfsurfacestorage $top $press]]
+    set expected(surface_runoff) \
+	[pfsum [pfsurfacerunoff $top $slope_x $slope_y $mannings $press]]
+
+    foreach name [array names expected] {
+	if {$reduced($name) != $expected($name)} {
+	    puts "FAILED : pfreduceseries $name at timestep $t is $reduced($name), expected $expected($name)"
+	    set passed 0
+	}
+    }
+
+    if {$expected(surface_runoff) == 0.0 || $expected(surface_storage) == 0.0} {
+	puts "FAILED : no surface water at timestep $t"
+	set passed 0
+    }
+}
+
+#
+# Statistics only
+#
+set series [pfreduceseries reduce_series.out.press.%05d.pfb 0 0]
+unset reduced
+array set reduced [lindex $series 0]
+if {[llength $series] != 1 || $reduced(timestep) != 0
+    || [info exists reduced(surface_storage)]
+    || $reduced(sum) != [lindex [pfgetstats [pfload reduce_series.out.press.00000.pfb]] 3]} {
+    puts "FAILED : pfreduceseries without options"
+    set passed 0
+}
+
+if {![catch {pfreduceseries reduce_series.out.press.%05d.pfb 0 5}]} {
+    puts "FAILED : pfreduceseries of a missing file did not fail"
+    set passed 0
+}
+
+for {set t 0} {$t <= 4} {incr t} {
+    file delete [format "reduce_series.out.press.%05d.pfb" $t] \
+	[format "reduce_series.out.satur.%05d.pfb" $t]
+}
+
+if $passed {
+    puts "reduce_series : PASSED"
+} {
+    puts "reduce_series : FAILED"
+}
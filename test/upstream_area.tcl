@@ -0,0 +1,150 @@
+#
+# Upstream area, D8 segment lengths and Flint's law on small DEMs,
+# checked against a direct search of the upstream cells
+#
+
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+source pftest.tcl
+
+set passed 1
+
+#
+# Write an nx by ny DEM as a simple ascii file and load it
+#
+proc upstreamDEM {name nx ny values} {
+    set fp [open $name w]
+    puts $fp "$nx $ny 1"
+    foreach value $values {
+	puts $fp $value
+    }
+    close $fp
+    set dem [pfload -sa $name]
+    pfsetgrid [list $nx $ny 1] {0.0 0.0 0.0} {10.0 10.0 1.0} $dem
+    return $dem
+}
+
+#
+# Number of cells draining to [i,j], including itself, found by a
+# search of the cells draining to each cell in turn
+#
+proc upstreamCount {dem sx sy nx ny i j} {
+    set count 0
+    set stack [list [list $i $j]]
+    set visited([list $i $j]) 1
+    while {[llength $stack] > 0} {
+	set cell [lindex $stack end]
+	set stack [lrange $stack 0 end-1]
+	incr count
+	set ci [lindex $cell 0]
+	set cj [lindex $cell 1]
+	foreach {ii jj slope sign} [list \
+		[expr $ci - 1] $cj $sx -1 [expr $ci + 1] $cj $sx 1 \
+		$ci [expr $cj - 1] $sy -1 $ci [expr $cj + 1] $sy 1] {
+	    if {$ii < 0 || $jj < 0 || $ii >= $nx || $jj >= $ny
+		|| [info exists visited([list $ii $jj])]
+		|| [pfgetelt $dem $ii $jj 0] == -9999.0} {
+		continue
+	    }
+	    if {$sign * [pfgetelt $slope $ii $jj 0] > 0.0} {
+		set visited([list $ii $jj]) 1
+		lappend stack [list $ii $jj]
+	    }
+	}
+    }
+    return $count
+}
+
+proc upstreamCheck {dem sx sy nx ny message} {
+    set area [pfupstreamarea $dem $sx $sy]
+    set ok 1
+    for {set j 0} {$j < $ny} {incr j} {
+	for {set i 0} {$i < $nx} {incr i} {
+	    if {[pfgetelt $dem $i $j 0] == -9999.0} {
+		set expected 0
+	    } {
+		set expected [upstreamCount $dem $sx $sy $nx $ny $i $j]
+	    }
+	    if {[pfgetelt $area $i $j 0] != $expected} {
+		puts "FAILED : $message area at ($i, $j) is [pfgetelt $area $i $j 0], expected $expected"
+		set ok 0
+	    }
+	}
+    }
+    return $ok
+}
+
+#
+# Plane sloping down in x, each cell drains the cells upstream in its row
+#
+set nx 6
+set ny 4
+set values {}
+for {set j 0} {$j < $ny} {incr j} {
+    for {set i 0} {$i < $nx} {incr i} {
+	lappend values [expr 100.0 - $i]
+    }
+}
+set plane [upstreamDEM upstream_area.plane.sa $nx $ny $values]
+set area [pfupstreamarea $plane [pfslopexD4 $plane] [pfslopeyD4 $plane]]
+for {set j 0} {$j < $ny} {incr j} {
+    for {set i 0} {$i < $nx} {incr i} {
+	if {[pfgetelt $area $i $j 0] != $i + 1} {
+	    puts "FAILED : plane area at ($i, $j) is [pfgetelt $area $i $j 0]"
+	    set passed 0
+	}
+    }
+}
+
+#
+# Rough terrain with a nodata cell, D4 and upwind slopes (which may
+# drain a cell in both x and y)
+#
+set nx 9
+set ny 7
+set values {}
+for {set j 0} {$j < $ny} {incr j} {
+    for {set i 0} {$i < $nx} {incr i} {
+	if {$i == 4 && $j == 3} {
+	    lappend values -9999.0
+	} {
+	    lappend values [expr 50.0 + 2.0 * $i + $j + ((7 * $i + 3 * $j) % 5)]
+	}
+    }
+}
+set rough [upstreamDEM upstream_area.rough.sa $nx $ny $values]
+
+if ![upstreamCheck $rough [pfslopexD4 $rough] [pfslopeyD4 $rough] $nx $ny "D4"] {
+    set passed 0
+}
+if ![upstreamCheck $rough [pfslopex $rough] [pfslopey $rough] $nx $ny "upwind"] {
+    set passed 0
+}
+
+#
+# D8 segment lengths and Flint's law down a single row: every cell
+# drains one cell in x, the outlet (a corner) keeps its elevation
+#
+set row [upstreamDEM upstream_area.row.sa 6 1 {105.0 104.0 103.0 102.0 101.0 100.0}]
+set ds [pfsegmentD8 $row]
+set flint [pfflintslaw $row 0.1 0.5]
+set z 100.0
+for {set i 5} {$i >= 0} {incr i -1} {
+    if {$i < 5} {
+	if ![pftestIsEqual [pfgetelt $ds $i 0 0] 10.0 "segment length at ($i, 0)"] {
+	    set passed 0
+	}
+	set z [expr $z + 0.1 * pow(100.0 * ($i + 1), 0.5) * 10.0]
+    }
+    if ![pftestIsEqual [pfgetelt $flint $i 0 0] $z "Flint's law at ($i, 0)"] {
+	set passed 0
+    }
+}
+
+if $passed {
+    puts "upstream_area : PASSED"
+} {
+    puts "upstream_area : FAILED"
+}
@@ -0,0 +1,214 @@
+#
+# Binary VTK structured grid output of several datasets, with a terrain
+# following grid and a subset of the cells
+#
+
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+source pftest.tcl
+
+set passed 1
+
+set nx 6
+set ny 5
+set nz 4
+
+#
+# Write an nx by ny by nz dataset with values f(i, j, k) as a simple
+# ascii file and load it
+#
+proc vtsData {name nx ny nz f} {
+    set fp [open $name w]
+    puts $fp "$nx $ny $nz"
+    for {set k 0} {$k < $nz} {incr k} {
+	for {set j 0} {$j < $ny} {incr j} {
+	    for {set i 0} {$i < $nx} {incr i} {
+		puts $fp [expr $f]
+	    }
+	}
+    }
+    close $fp
+    set data [pfload -sa $name]
+    pfsetgrid [list $nx $ny $nz] {0.0 0.0 0.0} {10.0 20.0 2.0} $data
+    return $data
+}
+
+#
+# Read a .vts file written by pfvtssave.  Returns a list with the extent
+# and a dictionary of the arrays in the appended data block.
+#
+proc vtsRead {filename} {
+    global tcl_platform
+
+    set fp [open $filename r]
+    fconfigure $fp -translation binary
+    set contents [read $fp]
+    close $fp
+
+    if {$tcl_platform(byteOrder) == "littleEndian"} {
+	set scan(Float64) q
+	set scan(Float32) r
+	set size_code w
+    } {
+	set scan(Float64) Q
+	set scan(Float32) R
+	set size_code W
+    }
+    set bytes(Float64) 8
+    set bytes(Float32) 4
+
+    regexp {WholeExtent="([^"]*)"} $contents match extent
+    set start [expr [string first "<AppendedData encoding=\"raw\">" $contents]]
+    set start [expr [string first "_" $contents $start] + 1]
+
+    set arrays {}
+    foreach {match type name offset} [regexp -all -inline \
+	    {<DataArray type="([^"]*)" (?:Name="([^"]*)" )?[^>]*offset="([0-9]+)"} \
+	    $contents] {
+	if {$name == ""} {
+	    set name Points
+	}
+	set position [expr $start + $offset]
+	binary scan $contents @${position}$size_code size
+	set count [expr $size / $bytes($type)]
+	binary scan $contents @[expr $position + 8]$scan($type)$count values
+	dict set arrays $name $values
+    }
+
+    return [list $extent $arrays]
+}
+
+proc vtsCheck {value expected message} {
+    if {abs($value - $expected) > 1.0e-4 * (1.0 + abs($expected))} {
+	puts "FAILED : $message: $value instead of $expected"
+	return 0
+    }
+    return 1
+}
+
+set press [vtsData "vts_save.press.sa" $nx $ny $nz {$i + 10 * $j + 100 * $k}]
+set perm  [vtsData "vts_save.perm.sa" $nx $ny $nz {1.0 + 0.5 * $i}]
+set dem   [vtsData "vts_save.dem.sa" $nx $ny 1 {100.0 + $i + 2.0 * $j}]
+
+#
+# The whole grid with two fields
+#
+pfvtssave vts_save.full.vts [list press $press perm $perm]
+lassign [vtsRead vts_save.full.vts] extent arrays
+
+if {$extent != "0 $nx 0 $ny 0 $nz"} {
+    puts "FAILED : extent $extent of the full grid"
+    set passed 0
+}
+
+set points [dict get $arrays Points]
+set n 0
+for {set k 0} {$k <= $nz} {incr k} {
+    for {set j 0} {$j <= $ny} {incr j} {
+	for {set i 0} {$i <= $nx} {incr i} {
+	    foreach value [lrange $points $n [expr $n + 2]] \
+		expected [list [expr 10.0 * $i] [expr 20.0 * $j] [expr 2.0 * $k]] {
+		if {![vtsCheck $value $expected "point $i $j $k"]} {
+		    set passed 0
+		}
+	    }
+	    incr n 3
+	}
+    }
+}
+
+foreach {name data} [list press $press perm $perm] {
+    set values [dict get $arrays $name]
+    set n 0
+    for {set k 0} {$k < $nz} {incr k} {
+	for {set j 0} {$j < $ny} {incr j} {
+	    for {set i 0} {$i < $nx} {incr i} {
+		if {[lindex $values $n] != [pfgetelt $data $i $j $k]} {
+		    puts "FAILED : $name at $i $j $k"
+		    set passed 0
+		}
+		incr n
+	    }
+	}
+    }
+}
+
+#
+# Every other cell in x and y of a box, on a terrain following grid with
+# variable dz, written as float
+#
+set dzscale {1.0 1.0 0.5 0.5}
+set depth {0.0 2.0 4.0 5.0 6.0}
+
+pfvtssave vts_save.subset.vts [list press $press] -flt -dem $dem \
+    -dzscale $dzscale -box {1 0 1 5 4 3} -stride {2 2 1}
+lassign [vtsRead vts_save.subset.vts] extent arrays
+
+set pi {1 3 5 6}
+set pj {0 2 4 5}
+set pk {1 2 3 4}
+
+if {$extent != "0 3 0 3 0 3"} {
+    puts "FAILED : extent $extent of the subset"
+    set passed 0
+}
+
+set points [dict get $arrays Points]
+set n 0
+foreach k $pk {
+    foreach j $pj {
+	foreach i $pi {
+	    set il [expr max($i - 1, 0)]
+	    set iu [expr min($i, $nx - 1)]
+	    set jl [expr max($j - 1, 0)]
+	    set ju [expr min($j, $ny - 1)]
+	    set elevation [expr ([pfgetelt $dem $il $jl 0] + [pfgetelt $dem $iu $jl 0] \
+				     + [pfgetelt $dem $il $ju 0] + [pfgetelt $dem $iu $ju 0]) / 4.0]
+	    set z [expr $elevation - [lindex $depth end] + [lindex $depth $k]]
+	    foreach value [lrange $points $n [expr $n + 2]] \
+		expected [list [expr 10.0 * $i] [expr 20.0 * $j] $z] {
+		if {![vtsCheck $value $expected "subset point $i $j $k"]} {
+		    set passed 0
+		}
+	    }
+	    incr n 3
+	}
+    }
+}
+
+set values [dict get $arrays press]
+set n 0
+foreach k [lrange $pk 0 end-1] {
+    foreach j [lrange $pj 0 end-1] {
+	foreach i [lrange $pi 0 end-1] {
+	    if {![vtsCheck [lindex $values $n] [pfgetelt $press $i $j $k] \
+		      "subset press at $i $j $k"]} {
+		set passed 0
+	    }
+	    incr n
+	}
+    }
+}
+
+#
+# Invalid arguments
+#
+foreach {arguments message} [list \
+	[list vts_save.error.vts [list press $press perm $dem]] "mismatched fields" \
+	[list vts_save.error.vts [list press $press] -box {0 0 0 6 4 3}] "box outside the grid" \
+	[list vts_save.error.vts [list press $press] -stride {1 0 1}] "zero stride" \
+	[list vts_save.error.vts [list press $press] -dzscale {1.0 1.0}] "short dz list" \
+	[list vts_save.error.vts [list press]] "missing dataset"] {
+    if {![catch {eval pfvtssave $arguments}]} {
+	puts "FAILED : pfvtssave accepted $message"
+	set passed 0
+    }
+}
+
+if $passed {
+    puts "vts_save : PASSED"
+} {
+    puts "vts_save : FAILED"
+}
@@ -0,0 +1,111 @@
+#
+# Water table depth read layer by layer from a distributed PFB file, and
+# the top, bottom and water table operations with threads, checked
+# against the same operations on the fully loaded file with one thread
+#
+
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+source pftest.tcl
+
+set passed 1
+
+#
+# The top, bottom and water table operations share their work over rows
+# only for at least PARALLEL_MIN_WORK (32768) cells, and pfextracttop
+# counts only the nx * ny columns
+#
+set nx 192
+set ny 176
+set nz 4
+
+#
+# Write a simple ascii file with one value per cell and load it
+#
+proc waterTableSA {name nx ny nz expr} {
+    set fp [open $name w]
+    puts $fp "$nx $ny $nz"
+    for {set k 0} {$k < $nz} {incr k} {
+	for {set j 0} {$j < $ny} {incr j} {
+	    for {set i 0} {$i < $nx} {incr i} {
+		puts $fp [expr $expr]
+	    }
+	}
+    }
+    close $fp
+    set data [pfload -sa $name]
+    pfsetgrid [list $nx $ny $nz] {0.0 0.0 0.0} {10.0 10.0 2.0} $data
+    return $data
+}
+
+proc waterTableSame {a b message} {
+    set diff [pfmdiff $a $b -1]
+    if {[string length $diff] != 0} {
+	puts "FAILED : $message: $diff"
+	return 0
+    }
+    return 1
+}
+
+#
+# Mask with a ragged top and columns outside of the domain, saturation
+# with a water table at a varying depth and columns that are never
+# saturated
+#
+set mask [waterTableSA "water_table_stream.mask.sa" $nx $ny $nz \
+	      {($i + $j) % 13 != 0 && $k <= 2 + ($i * $j) % 4}]
+set sat [waterTableSA "water_table_stream.sat.sa" $nx $ny $nz \
+	     {($i + 3 * $j) % 7 != 0 && $k <= ($i + 2 * $j) % 5 ? 1.0 : 0.5}]
+
+pfsave $sat -pfb water_table_stream.sat.pfb
+
+pfset Process.Topology.P 2
+pfset Process.Topology.Q 2
+pfset Process.Topology.R 2
+
+pfset ComputationalGrid.Lower.X 0.0
+pfset ComputationalGrid.Lower.Y 0.0
+pfset ComputationalGrid.Lower.Z 0.0
+
+pfset ComputationalGrid.DX 10.0
+pfset ComputationalGrid.DY 10.0
+pfset ComputationalGrid.DZ 2.0
+
+pfset ComputationalGrid.NX $nx
+pfset ComputationalGrid.NY $ny
+pfset ComputationalGrid.NZ $nz
+
+pfdist water_table_stream.sat.pfb
+pfundist water_table_stream.sat.pfb
+
+set top [pfcomputetop $mask]
+set bottom [pfcomputebottom $mask]
+set extract [pfextracttop $top $sat]
+set depth [pfwatertabledepth $top $sat]
+
+if {![waterTableSame [pfloadwatertabledepth water_table_stream.sat.pfb $top] $depth \
+	  "pfloadwatertabledepth differs from pfwatertabledepth"]} {
+    set passed 0
+}
+
+pfsetthreads 3
+
+if {![waterTableSame [pfcomputetop $mask] $top "pfcomputetop with threads"] ||
+    ![waterTableSame [pfcomputebottom $mask] $bottom "pfcomputebottom with threads"] ||
+    ![waterTableSame [pfextracttop $top $sat] $extract "pfextracttop with threads"] ||
+    ![waterTableSame [pfwatertabledepth $top $sat] $depth "pfwatertabledepth with threads"]} {
+    set passed 0
+}
+
+pfsetthreads 1
+
+file delete water_table_stream.mask.sa water_table_stream.sat.sa \
+    water_table_stream.sat.pfb water_table_stream.sat.pfb.dist
+
+if $passed {
+    puts "water_table_stream : PASSED"
+} {
+    puts "water_table_stream : FAILED"
+}